@@ -0,0 +1,14 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+using UnrealBuildTool;
+
+public class ClimbCore : ModuleRules
+{
+	public ClimbCore(ReadOnlyTargetRules Target) : base(Target)
+	{
+		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
+
+		// Core only, climbing decisions see the world through IClimbTraceProvider and nothing else
+		PublicDependencyModuleNames.AddRange(new string[] { "Core" });
+	}
+}
@@ -0,0 +1,447 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ClimbDecisions.h"
+#include "ClimbStats.h"
+#include "Math/RotationMatrix.h"
+
+DECLARE_CYCLE_STAT(TEXT("ClimbVertical"), STAT_ClimbVertical, STATGROUP_Climbing);
+DECLARE_CYCLE_STAT(TEXT("ClimbVertical Ledge Mantle"), STAT_ClimbLedgeMantle, STATGROUP_Climbing);
+DECLARE_CYCLE_STAT(TEXT("ClimbLateral"), STAT_ClimbLateral, STATGROUP_Climbing);
+DECLARE_CYCLE_STAT(TEXT("ClimbDiagonal"), STAT_ClimbDiagonal, STATGROUP_Climbing);
+DECLARE_CYCLE_STAT(TEXT("ClimbLateral Side Wall"), STAT_ClimbSideWall, STATGROUP_Climbing);
+DECLARE_CYCLE_STAT(TEXT("ClimbLateral Shimmy"), STAT_ClimbShimmy, STATGROUP_Climbing);
+DECLARE_CYCLE_STAT(TEXT("ClimbLateral Feet Probe"), STAT_ClimbFeetProbe, STATGROUP_Climbing);
+
+namespace ClimbDecisions
+{
+	//Reach of the grab probes
+	const float GrabReach = 75.0f;
+
+	//Capsules swept to check for room, the shimmy one covers the whole body
+	const float StepRadius = 12.0f;
+	const float StepHalfHeight = 27.0f;
+	const float ShimmyHalfHeight = 54.0f;
+
+	//Outside corner probe, how far past the edge it starts and behind the wall it runs
+	const float CornerReach = 60.0f;
+	const float CornerDepth = 30.0f;
+
+	//Sine of the smallest turn that is wrapped as a corner, shallower walls are just followed
+	const float MinCornerSine = 0.34f;
+
+	//Facing a wall, the rotation that looks into it
+	FRotator FaceWall(const FVector& Normal)
+	{
+		return FRotationMatrix::MakeFromX(Normal * -1).Rotator();
+	}
+}
+
+bool FClimbDecisions::FindBakedGrab(const IClimbTraceProvider& Traces, const FClimbSnapshot& Snapshot, FClimbGrab& OutGrab)
+{
+	FVector BodyPoint, BodyNormal;
+	if (Traces.FindBakedWall(Snapshot.Location, Snapshot.Forward, ClimbDecisions::GrabReach, BodyPoint, BodyNormal)
+		&& Traces.FindBakedWall(Snapshot.Head, Snapshot.Forward, ClimbDecisions::GrabReach, OutGrab.WallPoint, OutGrab.WallNormal))
+	{
+		OutGrab.Surface = FClimbSurface();
+		return true;
+	}
+	return false;
+}
+
+void FClimbDecisions::AddGrabProbes(IClimbTraceProvider& Traces, const FClimbSnapshot& Snapshot)
+{
+	const FVector& Forward = Snapshot.Forward;
+
+	//Trace from Body
+	FVector TraceStartPointMidBody = Snapshot.Location + Forward;
+	FVector TraceEndPointMidBody = Snapshot.Location + (Forward * ClimbDecisions::GrabReach);
+
+	//Trace from Head
+	FVector TraceStartPointHead = Snapshot.Head + Forward;
+	FVector TraceEndPointHead = Snapshot.Head + (Forward * ClimbDecisions::GrabReach);
+
+	Traces.AddLine(EClimbProbe::GrabBody, TraceStartPointMidBody, TraceEndPointMidBody, 0);
+	Traces.AddLine(EClimbProbe::GrabHead, TraceStartPointHead, TraceEndPointHead, 0);
+}
+
+bool FClimbDecisions::ResolveGrab(IClimbTraceProvider& Traces, FClimbGrab& OutGrab)
+{
+	//If two points of contact are met (At Body and Head), attach player to wall
+	if (!Traces.IsHit(EClimbProbe::GrabBody) || !Traces.IsHit(EClimbProbe::GrabHead))
+	{
+		return false;
+	}
+
+	const FClimbTraceHit SweepResultHead = Traces.GetHit(EClimbProbe::GrabHead);
+	OutGrab.WallPoint = SweepResultHead.Location;
+	OutGrab.WallNormal = SweepResultHead.Normal;
+	OutGrab.Surface = Traces.GetHit(EClimbProbe::GrabBody).Surface;
+	return true;
+}
+
+void FClimbDecisions::EvaluateStep(IClimbTraceProvider& Traces, const FClimbSnapshot& Snapshot, const FVector2D& Input, float StepTime,
+	const FClimbStepSettings& Settings, const FVector& WallNormal, const FClimbSurface& WallSurface, FClimbStepPlan& OutPlan)
+{
+	OutPlan.Delta = FVector::ZeroVector;
+	OutPlan.Rotation = Snapshot.Rotation;
+	OutPlan.bMantle = false;
+	OutPlan.MantleTarget = FVector::ZeroVector;
+	OutPlan.bCorner = false;
+	OutPlan.WallNormal = WallNormal;
+	OutPlan.WallSurface = WallSurface;
+
+	//Diagonal input is one move along the wall, the axes are only resolved one by one at an edge
+	bool bResolved = false;
+	if (Input.X != 0.0f && Input.Y != 0.0f)
+	{
+		bResolved = ClimbDiagonal(Traces, Snapshot, Input, StepTime, Settings, OutPlan);
+	}
+
+	if (!bResolved)
+	{
+		if (Input.X != 0.0f && !ClimbVertical(Traces, Snapshot, Input.X, StepTime, Settings, OutPlan))
+		{
+			return;
+		}
+
+		if (Input.Y != 0.0f)
+		{
+			ClimbLateral(Traces, Snapshot, Input.Y, StepTime, Settings, OutPlan);
+		}
+	}
+}
+
+void FClimbDecisions::FollowWall(const FClimbTraceHit& Hit, const FVector& Location, float Scale, bool bFlat, float StepTime, const FClimbStepSettings& Settings, FClimbStepPlan& InOutPlan)
+{
+	InOutPlan.WallSurface = Hit.Surface;
+	InOutPlan.WallNormal = Hit.Normal;
+
+	FRotator NormalImpact = ClimbDecisions::FaceWall(Hit.Normal);
+
+	FVector TempV = Hit.Location + (Hit.Normal * Settings.WallOffset);
+	FVector Direction = TempV - Location;
+	if (bFlat)
+	{
+		Direction.Z = 0.0f;
+	}
+
+	InOutPlan.Delta += Direction.GetClampedToMaxSize(InOutPlan.GetClimbSpeed(Settings) * Scale * StepTime);
+	InOutPlan.Rotation = FMath::RInterpTo(InOutPlan.Rotation, NormalImpact, StepTime, 4);
+}
+
+bool FClimbDecisions::MakeCorner(const FClimbTraceHit& Hit, const FVector& Location, const FClimbStepSettings& Settings, FClimbStepPlan& InOutPlan)
+{
+	const FVector OldNormal = InOutPlan.WallNormal.GetSafeNormal2D();
+	const FVector NewNormal = Hit.Normal.GetSafeNormal2D();
+	const float Det = (OldNormal.X * NewNormal.Y) - (OldNormal.Y * NewNormal.X);
+	if (FMath::Abs(Det) < ClimbDecisions::MinCornerSine)
+	{
+		return false;
+	}
+
+	//Line the two wall planes meet on, the climber holds WallOffset off the old one
+	const float OldDistance = FVector::DotProduct(OldNormal, Location - (OldNormal * Settings.WallOffset));
+	const float NewDistance = FVector::DotProduct(NewNormal, Hit.Location);
+	InOutPlan.CornerPivot = FVector(((OldDistance * NewNormal.Y) - (NewDistance * OldNormal.Y)) / Det, ((OldNormal.X * NewDistance) - (NewNormal.X * OldDistance)) / Det, Location.Z);
+
+	InOutPlan.CornerTarget = Hit.Location + (NewNormal * Settings.WallOffset);
+	InOutPlan.CornerTarget.Z = Location.Z;
+	InOutPlan.CornerRotation = ClimbDecisions::FaceWall(Hit.Normal);
+	InOutPlan.bCorner = true;
+
+	InOutPlan.WallNormal = Hit.Normal;
+	InOutPlan.WallSurface = Hit.Surface;
+	return true;
+}
+
+bool FClimbDecisions::ClimbVertical(IClimbTraceProvider& Traces, const FClimbSnapshot& Snapshot, float Val, float StepTime, const FClimbStepSettings& Settings, FClimbStepPlan& InOutPlan)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ClimbVertical);
+
+	const FVector& Location = Snapshot.Location;
+	const FVector& Forward = Snapshot.Forward;
+	const FVector& Up = Snapshot.Up;
+	const FVector& Head = Snapshot.Head;
+	const int8 Intent = (Val > 0.0f) ? 1 : -1;
+
+	//Trace from Body to see if there is room to move
+	FVector TraceStartPoint = Location + (Forward * (-10.0f));
+	FVector TraceEndPoint = Location + (Forward * (-10.0f)) + (Up * (Val * 15.0f));
+
+	FVector HitLocation;
+
+	//Check the direction above and below of the Actor to see if they can transition that direction
+	Traces.AddCapsule(EClimbProbe::VerticalStep, TraceStartPoint, TraceEndPoint, ClimbDecisions::StepRadius, ClimbDecisions::StepHalfHeight, Intent);
+	if (Traces.HasResult(EClimbProbe::VerticalStep, Intent) && Traces.IsHit(EClimbProbe::VerticalStep))
+	{
+		// If Location hit, move to the max distance allowed based off the hit
+		HitLocation = Traces.GetHit(EClimbProbe::VerticalStep).Location;
+	}
+	else
+	{
+		// No Location hit, move to at max distance
+		HitLocation = TraceEndPoint;
+	}
+
+	//Set the offset of the traces
+	FVector TargetOffset = HitLocation - Location;
+
+	//Trace from Body with Offset
+	FVector TraceStartPointMidBody = Location + TargetOffset + (Forward * -10.0f);
+	FVector TraceEndPointMidBody = Location + TargetOffset + (Forward * 100.0f);
+
+	//Trace from Head with Offset
+	FVector TraceStartPointHead = Head + TargetOffset + (Forward * -10.0f);
+	FVector TraceEndPointHead = Head + TargetOffset + (Forward * 100.0f);
+
+	Traces.AddLine(EClimbProbe::VerticalBody, TraceStartPointMidBody, TraceEndPointMidBody, Intent);
+	Traces.AddLine(EClimbProbe::VerticalHead, TraceStartPointHead, TraceEndPointHead, Intent);
+
+	//A baked wall already knows where its ledges are, no need to sweep for them
+	const bool bBakedWall = Traces.IsBakedWall(Location, Settings.WallOffset * 2.0f);
+
+	//Trace from Body for the ledge climb
+	FVector TraceStartPointClimb = Location + (Forward * (-10.0f));
+	TraceStartPointClimb.Z += Settings.CapsuleHalfHeight;
+	FVector TraceEndPointClimb = Location + (Forward * (-10.0f)) + (Up * (50.0f));
+	TraceEndPointClimb.Z += Settings.CapsuleHalfHeight;
+
+	//Trace to make sure climb is able to be performed on Ledge
+	FVector FreeLedgeEndPoint = TraceEndPointClimb + (Forward * (-10.0f)) + (Forward * (50.0f));
+
+	if (!bBakedWall)
+	{
+		Traces.AddCapsule(EClimbProbe::LedgeRise, TraceStartPointClimb, TraceEndPointClimb, ClimbDecisions::StepRadius, ClimbDecisions::StepHalfHeight, Intent);
+		Traces.AddCapsule(EClimbProbe::LedgeFree, TraceEndPointClimb, FreeLedgeEndPoint, ClimbDecisions::StepRadius, ClimbDecisions::StepHalfHeight, Intent);
+	}
+
+	//Async results trail by a frame, nothing to decide until the whole chain has come back once
+	if (!Traces.HasResults({ EClimbProbe::VerticalBody, EClimbProbe::VerticalHead }, Intent)
+		|| (!bBakedWall && !Traces.HasResults({ EClimbProbe::LedgeRise, EClimbProbe::LedgeFree }, Intent)))
+	{
+		return true;
+	}
+
+	//Are you legally able to move there? If there is a hit move normally
+	if (Traces.IsHit(EClimbProbe::VerticalBody) && Traces.IsHit(EClimbProbe::VerticalHead))
+	{
+		FollowWall(Traces.GetHit(EClimbProbe::VerticalBody), Location, FMath::Abs(Val), false, StepTime, Settings, InOutPlan);
+	}
+	else //If no wall is found to move up on AKA Move up Edge at a tilt
+	{
+		SCOPE_CYCLE_COUNTER(STAT_ClimbLedgeMantle);
+
+		bool bLedgeClear;
+		if (bBakedWall)
+		{
+			bLedgeClear = Val > 0.0f && Traces.FindBakedLedge(TraceStartPointClimb, 60.0f, FreeLedgeEndPoint);
+		}
+		else
+		{
+			bLedgeClear = !Traces.IsHit(EClimbProbe::LedgeRise) && !Traces.IsHit(EClimbProbe::LedgeFree);
+		}
+
+		if (bLedgeClear)
+		{
+			InOutPlan.bMantle = true;
+			InOutPlan.MantleTarget = FreeLedgeEndPoint;
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool FClimbDecisions::ClimbDiagonal(IClimbTraceProvider& Traces, const FClimbSnapshot& Snapshot, const FVector2D& Input, float StepTime, const FClimbStepSettings& Settings, FClimbStepPlan& InOutPlan)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ClimbDiagonal);
+
+	const FVector& Location = Snapshot.Location;
+	const FVector& Forward = Snapshot.Forward;
+	const int8 Intent = ((Input.X > 0.0f) ? 1 : -1) + ((Input.Y > 0.0f) ? 2 : -2);
+
+	//Up/down and to the side in one go, never faster than a single axis
+	const FVector Direction = ((Snapshot.Up * Input.X) + (Snapshot.Right * Input.Y)).GetSafeNormal();
+	const float Scale = FMath::Min(Input.Size(), 1.0f);
+
+	//Trace from Body to see if there is room to move
+	FVector TraceStartPoint = Location + (Forward * (-10.0f));
+	FVector TraceEndPoint = Location + (Forward * (-10.0f)) + (Direction * 15.0f);
+
+	FVector HitLocation;
+
+	Traces.AddCapsule(EClimbProbe::DiagonalStep, TraceStartPoint, TraceEndPoint, ClimbDecisions::StepRadius, ClimbDecisions::StepHalfHeight, Intent);
+	if (Traces.HasResult(EClimbProbe::DiagonalStep, Intent) && Traces.IsHit(EClimbProbe::DiagonalStep))
+	{
+		HitLocation = Traces.GetHit(EClimbProbe::DiagonalStep).Location;
+	}
+	else
+	{
+		HitLocation = TraceEndPoint;
+	}
+
+	FVector TargetOffset = HitLocation - Location;
+
+	//Trace from Body with Offset
+	FVector TraceStartPointMidBody = Location + TargetOffset + (Forward * -10.0f);
+	FVector TraceEndPointMidBody = Location + TargetOffset + (Forward * 100.0f);
+
+	//Trace from Head with Offset
+	FVector TraceStartPointHead = Snapshot.Head + TargetOffset + (Forward * -10.0f);
+	FVector TraceEndPointHead = Snapshot.Head + TargetOffset + (Forward * 100.0f);
+
+	Traces.AddLine(EClimbProbe::DiagonalBody, TraceStartPointMidBody, TraceEndPointMidBody, Intent);
+	Traces.AddLine(EClimbProbe::DiagonalHead, TraceStartPointHead, TraceEndPointHead, Intent);
+
+	//Async results trail by a frame, hold still until they come back
+	if (!Traces.HasResults({ EClimbProbe::DiagonalBody, EClimbProbe::DiagonalHead }, Intent))
+	{
+		return true;
+	}
+
+	//No wall there, a ledge or an edge that each axis has to handle on its own
+	if (!Traces.IsHit(EClimbProbe::DiagonalBody) || !Traces.IsHit(EClimbProbe::DiagonalHead))
+	{
+		return false;
+	}
+
+	FollowWall(Traces.GetHit(EClimbProbe::DiagonalBody), Location, Scale, false, StepTime, Settings, InOutPlan);
+	return true;
+}
+
+void FClimbDecisions::ClimbLateral(IClimbTraceProvider& Traces, const FClimbSnapshot& Snapshot, float Val, float StepTime, const FClimbStepSettings& Settings, FClimbStepPlan& InOutPlan)
+{
+	/*
+	//////////////////
+	This is split between two parts compared to the up and down code base for movement
+
+	PART 1:
+	Check to see if there is a wall to the right or left of the player and if the player can attach to it
+
+	PART 2: IF NOT WALL IS FOUND RIGHT OR LEFT THAT IS SUITABLE
+	Check to see if you can shimmy
+	//////////////////
+	*/
+
+	SCOPE_CYCLE_COUNTER(STAT_ClimbLateral);
+
+	const FVector& Location = Snapshot.Location;
+	const FVector& Forward = Snapshot.Forward;
+	const FVector& Right = Snapshot.Right;
+	const FVector& Head = Snapshot.Head;
+	const FVector& Feet = Snapshot.Feet;
+	const int8 Intent = (Val > 0.0f) ? 1 : -1;
+
+	//PART 1 - Looking to see if a wall is directly to my left or Right
+	//Trace from Body with Offset
+	FVector P1_TraceStartPointMidBody = Location + (Forward * (-10.0f));
+	FVector P1_TraceEndPointMidBody = Location + (Forward * (-10.0f)) + (Right * (Val * 35.0f)); //Distance of Each shimmy
+
+	//Trace from Head with Offset
+	FVector P1_TraceStartPointHead = Head + (Forward * (-10.0f));
+	FVector P1_TraceEndPointHead = Head + (Forward * (-10.0f)) + (Right * (Val * 35.0f)); //Distance of Each shimmy
+
+	bool bSideWall;
+	{
+		SCOPE_CYCLE_COUNTER(STAT_ClimbSideWall);
+
+		Traces.AddLine(EClimbProbe::SideBody, P1_TraceStartPointMidBody, P1_TraceEndPointMidBody, Intent);
+		Traces.AddLine(EClimbProbe::SideHead, P1_TraceStartPointHead, P1_TraceEndPointHead, Intent);
+
+		bSideWall = Traces.HasResults({ EClimbProbe::SideBody, EClimbProbe::SideHead }, Intent)
+			&& Traces.IsHit(EClimbProbe::SideBody) && Traces.IsHit(EClimbProbe::SideHead);
+	}
+
+	//PART 2 - Shimmy probes, in async mode these are always sent since PART 1 is only known next frame
+	//Trace from Body
+	FVector TraceStartPoint = Location + (Forward * (-10.0f));
+	FVector TraceEndPoint = Location + (Forward * (-10.0f)) + (Right * (Val * 15.0f)); //Distance of Each shimmy
+
+	FVector HitLocation;
+
+	Traces.AddCapsule(EClimbProbe::ShimmyStep, TraceStartPoint, TraceEndPoint, ClimbDecisions::StepRadius, ClimbDecisions::ShimmyHalfHeight, Intent);
+
+	//Only worth tracing in sync mode when PART 1 failed
+	if (Traces.IsAsync() || !bSideWall)
+	{
+		SCOPE_CYCLE_COUNTER(STAT_ClimbShimmy);
+
+		if (Traces.HasResult(EClimbProbe::ShimmyStep, Intent) && Traces.IsHit(EClimbProbe::ShimmyStep))
+		{
+			// If Location hit, move to the max distance
+			HitLocation = Traces.GetHit(EClimbProbe::ShimmyStep).Location;
+		}
+		else
+		{
+			// No Location hit, move to the right
+			HitLocation = TraceEndPoint;
+		}
+
+		FVector TargetOffset = HitLocation - Location;
+
+		//Trace from Body with Offset
+		FVector TraceStartPointMidBody = Location + TargetOffset + (Forward * -10.0f);
+		FVector TraceEndPointMidBody = Location + TargetOffset + (Forward * 60.0f);
+
+		//Trace from Head with Offset
+		FVector TraceStartPointHead = Head + TargetOffset + (Forward * -10.0f);
+		FVector TraceEndPointHead = Head + TargetOffset + (Forward * 60.0f);
+
+		//Trace from Feet with Offset
+		FVector TraceStartPointFeet = Feet + TargetOffset + (Forward * -10.0f);
+		FVector TraceEndPointFeet = Feet + TargetOffset + (Forward * 60.0f);
+
+		Traces.AddLine(EClimbProbe::ShimmyBody, TraceStartPointMidBody, TraceEndPointMidBody, Intent);
+		Traces.AddLine(EClimbProbe::ShimmyHead, TraceStartPointHead, TraceEndPointHead, Intent);
+		Traces.AddLine(EClimbProbe::ShimmyFeet, TraceStartPointFeet, TraceEndPointFeet, Intent);
+	}
+
+	//Async results trail by a frame, nothing to decide until the whole chain has come back once
+	if (!Traces.HasResults({ EClimbProbe::SideBody, EClimbProbe::SideHead, EClimbProbe::ShimmyBody, EClimbProbe::ShimmyHead, EClimbProbe::ShimmyFeet }, Intent))
+	{
+		return;
+	}
+
+	if (bSideWall)
+	{
+		//Wall to the side, an inside corner, wrap onto it in one go
+		if (MakeCorner(Traces.GetHit(EClimbProbe::SideBody), Location, Settings, InOutPlan))
+		{
+			return;
+		}
+
+		//Too shallow to be a corner, turn into it
+		InOutPlan.Rotation = FMath::RInterpTo(InOutPlan.Rotation, InOutPlan.Rotation + FRotator(0, 15 * Val, 0), StepTime, 16);
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_ClimbShimmy);
+
+	if (Traces.IsHit(EClimbProbe::ShimmyBody) && Traces.IsHit(EClimbProbe::ShimmyHead))
+	{
+		//PART 2 - No wall has been found on my left or right, keep going with shimmy
+		FollowWall(Traces.GetHit(EClimbProbe::ShimmyBody), Location, FMath::Abs(Val), true, StepTime, Settings, InOutPlan);
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_ClimbFeetProbe);
+
+	if (!Traces.IsHit(EClimbProbe::ShimmyFeet))
+	{
+		//Nothing under the hands or feet, an outside corner. One probe back across behind the wall finds the face round the edge
+		const FVector WrapStart = Location + (Forward * (Settings.WallOffset + ClimbDecisions::CornerDepth)) + (Right * (Intent * ClimbDecisions::CornerReach));
+		const FVector WrapEnd = WrapStart - (Right * (Intent * 2.0f * ClimbDecisions::CornerReach));
+
+		Traces.AddLine(EClimbProbe::CornerWrap, WrapStart, WrapEnd, Intent);
+		if (Traces.HasResult(EClimbProbe::CornerWrap, Intent) && Traces.IsHit(EClimbProbe::CornerWrap)
+			&& MakeCorner(Traces.GetHit(EClimbProbe::CornerWrap), Location, Settings, InOutPlan))
+		{
+			return;
+		}
+
+		//Too thin to have a face round the edge, or the probe is not back yet, edge round it a step at a time
+		InOutPlan.Delta += Right * (InOutPlan.GetClimbSpeed(Settings) * Val * StepTime);
+		InOutPlan.Rotation = FMath::RInterpTo(InOutPlan.Rotation, InOutPlan.Rotation + FRotator(0, -10 * Val, 0), StepTime, 8);
+	}
+}
@@ -0,0 +1,124 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ClimbTraceProvider.h"
+
+/** Where the character stood at the start of a climbing step, every probe of that step starts from here */
+struct FClimbSnapshot
+{
+	FVector Location;
+	FRotator Rotation;
+	FVector Forward;
+	FVector Right;
+	FVector Up;
+	FVector Head;
+	FVector Feet;
+};
+
+/** Climber settings a step is decided with */
+struct FClimbStepSettings
+{
+	/** Climb speed before the wall's ClimbSpeedScale */
+	float MaxClimbSpeed;
+
+	/** Distance kept between the capsule centre and the wall */
+	float WallOffset;
+
+	/** Of the character's capsule, unscaled */
+	float CapsuleHalfHeight;
+
+	FClimbStepSettings()
+		: MaxClimbSpeed(150.0f), WallOffset(25.0f), CapsuleHalfHeight(55.0f)
+	{
+	}
+};
+
+/** What one climbing step decided to do, worked out from probes before anything is moved */
+struct FClimbStepPlan
+{
+	FVector Delta;
+	FRotator Rotation;
+
+	/** Reached a ledge, the step mantles to MantleTarget instead of moving */
+	bool bMantle;
+	FVector MantleTarget;
+
+	/** Found the wall round a corner, the step starts a wrap around CornerPivot to CornerTarget instead of moving */
+	bool bCorner;
+	FVector CornerPivot;
+	FVector CornerTarget;
+	FRotator CornerRotation;
+
+	/** Wall the climber holds after the step, the one it started on unless a probe found another */
+	FVector WallNormal;
+	FClimbSurface WallSurface;
+
+	FClimbStepPlan()
+		: Delta(ForceInitToZero), Rotation(ForceInitToZero), bMantle(false), MantleTarget(ForceInitToZero)
+		, bCorner(false), CornerPivot(ForceInitToZero), CornerTarget(ForceInitToZero), CornerRotation(ForceInitToZero), WallNormal(ForceInitToZero)
+	{
+	}
+
+	/** Climb speed on the plan's wall */
+	float GetClimbSpeed(const FClimbStepSettings& Settings) const { return Settings.MaxClimbSpeed * WallSurface.ClimbSpeedScale; }
+};
+
+/** A wall to attach to */
+struct FClimbGrab
+{
+	FVector WallPoint;
+	FVector WallNormal;
+	FClimbSurface Surface;
+
+	FClimbGrab()
+		: WallPoint(ForceInitToZero), WallNormal(ForceInitToZero)
+	{
+	}
+};
+
+/**
+ * The climbing decisions, grab, up/down and over ledges, shimmy and around corners, as pure functions of a
+ * snapshot, the input and whatever the probes answer. Nothing in here moves a character or reads a world,
+ * so they run the same on the game thread, a worker thread or against a mock scene in a benchmark.
+ * UClimbingMovementComponent takes the snapshot, supplies the probes and applies the plan.
+ */
+class CLIMBCORE_API FClimbDecisions
+{
+public:
+	/** A wall at body and head height in the baked graph, false if the probes have to look */
+	static bool FindBakedGrab(const IClimbTraceProvider& Traces, const FClimbSnapshot& Snapshot, FClimbGrab& OutGrab);
+
+	/** Body and head probes for a wall in front of the character */
+	static void AddGrabProbes(IClimbTraceProvider& Traces, const FClimbSnapshot& Snapshot);
+
+	/** Were there two points of contact (body and head) to attach to */
+	static bool ResolveGrab(IClimbTraceProvider& Traces, FClimbGrab& OutGrab);
+
+	/**
+	 * Probes and decides one climbing step. Input X is up, Y is right.
+	 * WallNormal and WallSurface are where the climber is holding on now, the plan starts from them.
+	 */
+	static void EvaluateStep(IClimbTraceProvider& Traces, const FClimbSnapshot& Snapshot, const FVector2D& Input, float StepTime,
+		const FClimbStepSettings& Settings, const FVector& WallNormal, const FClimbSurface& WallSurface, FClimbStepPlan& OutPlan);
+
+private:
+	/** Up/down along the wall, or over the ledge. Returns false at a ledge, with the mantle set on the plan */
+	static bool ClimbVertical(IClimbTraceProvider& Traces, const FClimbSnapshot& Snapshot, float Val, float StepTime, const FClimbStepSettings& Settings, FClimbStepPlan& InOutPlan);
+
+	/** Left/right along the wall, wrapping round inside and outside corners in one go */
+	static void ClimbLateral(IClimbTraceProvider& Traces, const FClimbSnapshot& Snapshot, float Val, float StepTime, const FClimbStepSettings& Settings, FClimbStepPlan& InOutPlan);
+
+	/** Both axes along the wall with a single probe chain. Returns false at an edge, where each axis is resolved on its own */
+	static bool ClimbDiagonal(IClimbTraceProvider& Traces, const FClimbSnapshot& Snapshot, const FVector2D& Input, float StepTime, const FClimbStepSettings& Settings, FClimbStepPlan& InOutPlan);
+
+	/**
+	 * Sets up a wrap from the wall the plan holds onto the one Hit landed on, both taken as vertical planes.
+	 * The pivot is where they meet at the climber's height. False if they are too close to parallel to have a corner
+	 */
+	static bool MakeCorner(const FClimbTraceHit& Hit, const FVector& Location, const FClimbStepSettings& Settings, FClimbStepPlan& InOutPlan);
+
+	/** Moves towards WallOffset off a wall hit at Scale of the climb speed on it, and turns to face it. Flat keeps the move horizontal */
+	static void FollowWall(const FClimbTraceHit& Hit, const FVector& Location, float Scale, bool bFlat, float StepTime, const FClimbStepSettings& Settings, FClimbStepPlan& InOutPlan);
+};
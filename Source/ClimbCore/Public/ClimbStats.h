@@ -0,0 +1,9 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+
+//"stat Climbing" in game, shared by every climbing module. Cycle counters are declared next to the code they time
+DECLARE_STATS_GROUP(TEXT("Climbing"), STATGROUP_Climbing, STATCAT_Advanced);
@@ -0,0 +1,116 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+//Every probe the climbing code can fire in a frame, each one owns a slot in the batch
+enum class EClimbProbe : uint8
+{
+	GrabBody,
+	GrabHead,
+	VerticalStep,
+	VerticalBody,
+	VerticalHead,
+	LedgeRise,
+	LedgeFree,
+	SideBody,
+	SideHead,
+	ShimmyStep,
+	ShimmyBody,
+	ShimmyHead,
+	ShimmyFeet,
+	DiagonalStep,
+	DiagonalBody,
+	DiagonalHead,
+	CornerWrap,
+	Count
+};
+
+//How a surface behaves under a climber's hands
+struct FClimbSurface
+{
+	FClimbSurface()
+		: bClimbable(true)
+		, bTraceComplex(false)
+		, ClimbSpeedScale(1.0f)
+		, Grip(1.0f)
+	{
+	}
+
+	bool bClimbable;
+	bool bTraceComplex;
+	float ClimbSpeedScale;
+	float Grip;
+};
+
+//The parts of a blocking probe hit the climbing decisions read
+struct FClimbTraceHit
+{
+	/** Where the ray, or the centre of the swept shape, stopped */
+	FVector Location;
+
+	/** From the contact to the centre of the swept shape, the surface normal for rays */
+	FVector Normal;
+
+	FClimbSurface Surface;
+
+	FClimbTraceHit()
+		: Location(ForceInitToZero), Normal(ForceInitToZero)
+	{
+	}
+};
+
+/**
+ * Everything FClimbDecisions knows about the world, as probes named by EClimbProbe.
+ *
+ * A probe is added with its geometry and the intent that drove it (usually the sign of the axis), then asked
+ * whether it hit. A synchronous provider answers every probe it is asked about. An asynchronous one answers
+ * a frame late, and only has a result while the intent it was added with last frame still matches.
+ *
+ * In the game this is the character's FClimbProbeBatch and the level's baked climb graph, elsewhere anything
+ * that can cast rays and sweep upright capsules.
+ */
+class CLIMBCORE_API IClimbTraceProvider
+{
+public:
+	virtual ~IClimbTraceProvider() {}
+
+	virtual void AddLine(EClimbProbe Probe, const FVector& Start, const FVector& End, int8 Intent) = 0;
+
+	/** Upright capsule swept from Start to End */
+	virtual void AddCapsule(EClimbProbe Probe, const FVector& Start, const FVector& End, float Radius, float HalfHeight, int8 Intent) = 0;
+
+	/** Is there an answer for the probe as it was added with Intent */
+	virtual bool HasResult(EClimbProbe Probe, int8 Intent) const = 0;
+
+	/** Did the probe block */
+	virtual bool IsHit(EClimbProbe Probe) = 0;
+
+	/** Only meaningful after IsHit returned true */
+	virtual FClimbTraceHit GetHit(EClimbProbe Probe) const = 0;
+
+	/** Answers trail the probes by a frame */
+	virtual bool IsAsync() const = 0;
+
+	/** Baked wall a ray from Start along Direction hits within MaxDistance, false if nothing is baked there */
+	virtual bool FindBakedWall(const FVector& Start, const FVector& Direction, float MaxDistance, FVector& OutPoint, FVector& OutNormal) const { return false; }
+
+	/** Baked ledge within Radius of Location, with the point a mantle over it ends at */
+	virtual bool FindBakedLedge(const FVector& Location, float Radius, FVector& OutMantlePoint) const { return false; }
+
+	/** Is Location within MaxDistance in front of a baked wall, whose ledges FindBakedLedge knows */
+	virtual bool IsBakedWall(const FVector& Location, float MaxDistance) const { return false; }
+
+	bool HasResults(std::initializer_list<EClimbProbe> Probes, int8 Intent) const
+	{
+		for (EClimbProbe Probe : Probes)
+		{
+			if (!HasResult(Probe, Intent))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+};
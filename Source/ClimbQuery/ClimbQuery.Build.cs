@@ -0,0 +1,14 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+using UnrealBuildTool;
+
+public class ClimbQuery : ModuleRules
+{
+	public ClimbQuery(ReadOnlyTargetRules Target) : base(Target)
+	{
+		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
+
+		// Core only, nothing in here knows about worlds, actors or the physics scene
+		PublicDependencyModuleNames.AddRange(new string[] { "Core" });
+	}
+}
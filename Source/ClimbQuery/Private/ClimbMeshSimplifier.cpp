@@ -0,0 +1,409 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ClimbMeshSimplifier.h"
+#include "ClimbTriangleBVH.h"
+
+namespace ClimbMeshSimplifier
+{
+	//Least cosine between a triangle's normal before and after a collapse
+	const float MinNormalDot = 0.2f;
+
+	//Triangles thinner than this, relative to the squared length of their longest edge, count as squashed
+	const float MinAreaRatio = 1.e-4f;
+
+	uint64 EdgeKey(int32 A, int32 B)
+	{
+		return ((uint64)(uint32)FMath::Min(A, B) << 32) | (uint64)(uint32)FMath::Max(A, B);
+	}
+
+	//Cheapest collapse on top of the heap
+	struct FCollapseLess
+	{
+		template<typename T>
+		bool operator()(const T& A, const T& B) const
+		{
+			return A.Cost < B.Cost;
+		}
+	};
+}
+
+FClimbMeshSimplifier::FQuadric::FQuadric()
+	: XX(0.0), XY(0.0), XZ(0.0), YY(0.0), YZ(0.0), ZZ(0.0), X(0.0), Y(0.0), Z(0.0), W(0.0)
+{
+}
+
+void FClimbMeshSimplifier::FQuadric::AddPlane(const FVector& Normal, float Distance)
+{
+	XX += (double)Normal.X * Normal.X;
+	XY += (double)Normal.X * Normal.Y;
+	XZ += (double)Normal.X * Normal.Z;
+	YY += (double)Normal.Y * Normal.Y;
+	YZ += (double)Normal.Y * Normal.Z;
+	ZZ += (double)Normal.Z * Normal.Z;
+	X += (double)Normal.X * Distance;
+	Y += (double)Normal.Y * Distance;
+	Z += (double)Normal.Z * Distance;
+	W += (double)Distance * Distance;
+}
+
+void FClimbMeshSimplifier::FQuadric::Add(const FQuadric& Other)
+{
+	XX += Other.XX;
+	XY += Other.XY;
+	XZ += Other.XZ;
+	YY += Other.YY;
+	YZ += Other.YZ;
+	ZZ += Other.ZZ;
+	X += Other.X;
+	Y += Other.Y;
+	Z += Other.Z;
+	W += Other.W;
+}
+
+double FClimbMeshSimplifier::FQuadric::Evaluate(const FVector& Point) const
+{
+	const double PX = Point.X;
+	const double PY = Point.Y;
+	const double PZ = Point.Z;
+
+	const double Cost = PX * PX * XX + 2.0 * PX * PY * XY + 2.0 * PX * PZ * XZ
+		+ PY * PY * YY + 2.0 * PY * PZ * YZ + PZ * PZ * ZZ
+		+ 2.0 * (PX * X + PY * Y + PZ * Z) + W;
+
+	//Rounding can take an exact fit a hair below zero
+	return FMath::Max(Cost, 0.0);
+}
+
+FClimbMeshSimplifier::FClimbMeshSimplifier(TArrayView<const FVector> Vertices, float WeldDistance)
+	: NumLiveTriangles(0)
+{
+	const float InvWeld = 1.0f / FMath::Max(WeldDistance, KINDA_SMALL_NUMBER);
+
+	TMap<FIntVector, int32> Welded;
+	Welded.Reserve(Vertices.Num() / 2);
+
+	auto Weld = [&](const FVector& Position)
+	{
+		const FIntVector Key(FMath::RoundToInt(Position.X * InvWeld), FMath::RoundToInt(Position.Y * InvWeld), FMath::RoundToInt(Position.Z * InvWeld));
+		if (const int32* Existing = Welded.Find(Key))
+		{
+			return *Existing;
+		}
+		return Welded.Add(Key, Positions.Add(Position));
+	};
+
+	Triangles.Reserve(Vertices.Num() / 3);
+	for (int32 Index = 0; Index + 2 < Vertices.Num(); Index += 3)
+	{
+		const FIntVector Triangle(Weld(Vertices[Index]), Weld(Vertices[Index + 1]), Weld(Vertices[Index + 2]));
+		if (Triangle.X == Triangle.Y || Triangle.Y == Triangle.Z || Triangle.Z == Triangle.X)
+		{
+			continue;
+		}
+
+		const FVector Cross = (Positions[Triangle.Y] - Positions[Triangle.X]) ^ (Positions[Triangle.Z] - Positions[Triangle.X]);
+		if (Cross.IsNearlyZero(SMALL_NUMBER))
+		{
+			continue;
+		}
+
+		Triangles.Add(Triangle);
+	}
+
+	NumLiveTriangles = Triangles.Num();
+	TriangleRemoved.Init(false, Triangles.Num());
+	Quadrics.SetNum(Positions.Num());
+	Stamps.Init(0, Positions.Num());
+	VertexTriangles.SetNum(Positions.Num());
+
+	//Every vertex starts with the planes of its own triangles, an edge with one triangle also gets a plane standing on it
+	TMap<uint64, int32> EdgeTriangles;
+	for (int32 TriangleIndex = 0; TriangleIndex < Triangles.Num(); TriangleIndex++)
+	{
+		const FIntVector& Triangle = Triangles[TriangleIndex];
+		const FVector Normal = ((Positions[Triangle.Y] - Positions[Triangle.X]) ^ (Positions[Triangle.Z] - Positions[Triangle.X])).GetSafeNormal();
+		const float Distance = -(Normal | Positions[Triangle.X]);
+
+		for (int32 Corner = 0; Corner < 3; Corner++)
+		{
+			Quadrics[Triangle[Corner]].AddPlane(Normal, Distance);
+			VertexTriangles[Triangle[Corner]].Add(TriangleIndex);
+
+			const uint64 Key = ClimbMeshSimplifier::EdgeKey(Triangle[Corner], Triangle[(Corner + 1) % 3]);
+			int32& Count = EdgeTriangles.FindOrAdd(Key);
+			Count = (Count == 0) ? TriangleIndex + 1 : -1;
+		}
+	}
+
+	for (const TPair<uint64, int32>& Edge : EdgeTriangles)
+	{
+		if (Edge.Value <= 0)
+		{
+			continue;
+		}
+
+		const FIntVector& Triangle = Triangles[Edge.Value - 1];
+		const FVector Normal = ((Positions[Triangle.Y] - Positions[Triangle.X]) ^ (Positions[Triangle.Z] - Positions[Triangle.X])).GetSafeNormal();
+
+		const int32 A = (int32)(Edge.Key >> 32);
+		const int32 B = (int32)(Edge.Key & 0xFFFFFFFF);
+		const FVector Side = ((Positions[B] - Positions[A]) ^ Normal).GetSafeNormal();
+		const float Distance = -(Side | Positions[A]);
+
+		Quadrics[A].AddPlane(Side, Distance);
+		Quadrics[B].AddPlane(Side, Distance);
+	}
+}
+
+void FClimbMeshSimplifier::Simplify(float MaxError)
+{
+	const double MaxErrorSq = (double)MaxError * MaxError;
+
+	Heap.Reset();
+	for (int32 Vertex = 0; Vertex < Positions.Num(); Vertex++)
+	{
+		PushCollapses(Vertex, MaxErrorSq);
+	}
+
+	while (Heap.Num() > 0)
+	{
+		FCollapse Queued;
+		Heap.HeapPop(Queued, ClimbMeshSimplifier::FCollapseLess(), false);
+
+		if (Stamps[Queued.Keep] != Queued.KeepStamp || Stamps[Queued.Remove] != Queued.RemoveStamp)
+		{
+			continue;
+		}
+
+		//Neighbours may have moved since this was queued, which changes what flips
+		FCollapse Collapse;
+		if (!FindCollapse(Queued.Keep, Queued.Remove, MaxErrorSq, Collapse))
+		{
+			continue;
+		}
+
+		const int32 Keep = Collapse.Keep;
+		const int32 Remove = Collapse.Remove;
+
+		Positions[Keep] = Collapse.Target;
+		Quadrics[Keep].Add(Quadrics[Remove]);
+
+		for (int32 TriangleIndex : VertexTriangles[Remove])
+		{
+			FIntVector& Triangle = Triangles[TriangleIndex];
+			if (Triangle.X == Keep || Triangle.Y == Keep || Triangle.Z == Keep)
+			{
+				//The edge's own triangles go away
+				TriangleRemoved[TriangleIndex] = true;
+				NumLiveTriangles--;
+				for (int32 Corner = 0; Corner < 3; Corner++)
+				{
+					if (Triangle[Corner] != Remove)
+					{
+						VertexTriangles[Triangle[Corner]].RemoveSwap(TriangleIndex);
+					}
+				}
+				continue;
+			}
+
+			for (int32 Corner = 0; Corner < 3; Corner++)
+			{
+				if (Triangle[Corner] == Remove)
+				{
+					Triangle[Corner] = Keep;
+				}
+			}
+			VertexTriangles[Keep].Add(TriangleIndex);
+		}
+
+		VertexTriangles[Remove].Reset();
+		Stamps[Keep]++;
+		Stamps[Remove]++;
+
+		PushCollapses(Keep, MaxErrorSq);
+	}
+}
+
+void FClimbMeshSimplifier::GetTriangles(TArray<FVector>& OutVertices) const
+{
+	OutVertices.Reset(NumLiveTriangles * 3);
+	for (int32 TriangleIndex = 0; TriangleIndex < Triangles.Num(); TriangleIndex++)
+	{
+		if (!TriangleRemoved[TriangleIndex])
+		{
+			const FIntVector& Triangle = Triangles[TriangleIndex];
+			OutVertices.Append({ Positions[Triangle.X], Positions[Triangle.Y], Positions[Triangle.Z] });
+		}
+	}
+}
+
+float FClimbMeshSimplifier::MeasureDeviation(TArrayView<const FVector> From, const FClimbTriangleBVH& To, float SearchDistance)
+{
+	float Deviation = 0.0f;
+
+	for (int32 Index = 0; Index + 2 < From.Num(); Index += 3)
+	{
+		const FVector Normal = ((From[Index + 1] - From[Index]) ^ (From[Index + 2] - From[Index])).GetSafeNormal();
+		if (Normal.IsZero())
+		{
+			continue;
+		}
+
+		const FVector Samples[] = { From[Index], From[Index + 1], From[Index + 2], (From[Index] + From[Index + 1] + From[Index + 2]) / 3.0f };
+		for (const FVector& Sample : Samples)
+		{
+			float Distance = SearchDistance;
+			for (float Sign : { 1.0f, -1.0f })
+			{
+				FClimbQueryHit Hit;
+				if (To.Raycast(Sample, Sample + Normal * (Sign * SearchDistance), 0xFF, Hit))
+				{
+					Distance = FMath::Min(Distance, Hit.Time * SearchDistance);
+				}
+			}
+			Deviation = FMath::Max(Deviation, Distance);
+		}
+	}
+
+	return Deviation;
+}
+
+bool FClimbMeshSimplifier::FindCollapse(int32 Keep, int32 Remove, double MaxErrorSq, FCollapse& OutCollapse) const
+{
+	if (VertexTriangles[Keep].Num() == 0 || VertexTriangles[Remove].Num() == 0 || IsNonManifold(Keep, Remove))
+	{
+		return false;
+	}
+
+	FQuadric Quadric = Quadrics[Keep];
+	Quadric.Add(Quadrics[Remove]);
+
+	//Either end or the middle, cheapest first
+	FVector Targets[] = { Positions[Keep], Positions[Remove], (Positions[Keep] + Positions[Remove]) * 0.5f };
+	double Costs[] = { Quadric.Evaluate(Targets[0]), Quadric.Evaluate(Targets[1]), Quadric.Evaluate(Targets[2]) };
+
+	for (int32 Pass = 0; Pass < UE_ARRAY_COUNT(Targets); Pass++)
+	{
+		int32 Best = INDEX_NONE;
+		for (int32 Candidate = 0; Candidate < UE_ARRAY_COUNT(Targets); Candidate++)
+		{
+			if (Costs[Candidate] <= MaxErrorSq && (Best == INDEX_NONE || Costs[Candidate] < Costs[Best]))
+			{
+				Best = Candidate;
+			}
+		}
+
+		if (Best == INDEX_NONE)
+		{
+			return false;
+		}
+
+		if (!FlipsTriangle(Keep, Remove, Targets[Best]) && !FlipsTriangle(Remove, Keep, Targets[Best]))
+		{
+			OutCollapse.Cost = Costs[Best];
+			OutCollapse.Target = Targets[Best];
+			OutCollapse.Keep = Keep;
+			OutCollapse.Remove = Remove;
+			OutCollapse.KeepStamp = Stamps[Keep];
+			OutCollapse.RemoveStamp = Stamps[Remove];
+			return true;
+		}
+
+		Costs[Best] = MAX_dbl;
+	}
+
+	return false;
+}
+
+bool FClimbMeshSimplifier::FlipsTriangle(int32 Vertex, int32 Other, const FVector& Target) const
+{
+	for (int32 TriangleIndex : VertexTriangles[Vertex])
+	{
+		const FIntVector& Triangle = Triangles[TriangleIndex];
+		if (Triangle.X == Other || Triangle.Y == Other || Triangle.Z == Other)
+		{
+			continue;
+		}
+
+		FVector Corners[3] = { Positions[Triangle.X], Positions[Triangle.Y], Positions[Triangle.Z] };
+		const FVector Before = (Corners[1] - Corners[0]) ^ (Corners[2] - Corners[0]);
+
+		for (int32 Corner = 0; Corner < 3; Corner++)
+		{
+			if (Triangle[Corner] == Vertex)
+			{
+				Corners[Corner] = Target;
+			}
+		}
+		const FVector After = (Corners[1] - Corners[0]) ^ (Corners[2] - Corners[0]);
+
+		const float LongestSq = FMath::Max3((Corners[1] - Corners[0]).SizeSquared(), (Corners[2] - Corners[1]).SizeSquared(), (Corners[0] - Corners[2]).SizeSquared());
+		if (After.Size() <= LongestSq * ClimbMeshSimplifier::MinAreaRatio)
+		{
+			return true;
+		}
+
+		if ((Before.GetSafeNormal() | After.GetSafeNormal()) < ClimbMeshSimplifier::MinNormalDot)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool FClimbMeshSimplifier::IsNonManifold(int32 Keep, int32 Remove) const
+{
+	int32 EdgeTriangles = 0;
+	for (int32 TriangleIndex : VertexTriangles[Keep])
+	{
+		const FIntVector& Triangle = Triangles[TriangleIndex];
+		EdgeTriangles += (Triangle.X == Remove || Triangle.Y == Remove || Triangle.Z == Remove) ? 1 : 0;
+	}
+
+	TArray<int32, TInlineAllocator<16>> KeepNeighbours;
+	TArray<int32, TInlineAllocator<16>> RemoveNeighbours;
+	GetNeighbours(Keep, KeepNeighbours);
+	GetNeighbours(Remove, RemoveNeighbours);
+
+	//Every neighbour the two ends share has to be the far corner of one of the edge's triangles
+	int32 SharedNeighbours = 0;
+	for (int32 Neighbour : KeepNeighbours)
+	{
+		SharedNeighbours += RemoveNeighbours.Contains(Neighbour) ? 1 : 0;
+	}
+
+	return SharedNeighbours > EdgeTriangles;
+}
+
+void FClimbMeshSimplifier::GetNeighbours(int32 Vertex, TArray<int32, TInlineAllocator<16>>& OutNeighbours) const
+{
+	OutNeighbours.Reset();
+	for (int32 TriangleIndex : VertexTriangles[Vertex])
+	{
+		const FIntVector& Triangle = Triangles[TriangleIndex];
+		for (int32 Corner = 0; Corner < 3; Corner++)
+		{
+			if (Triangle[Corner] != Vertex)
+			{
+				OutNeighbours.AddUnique(Triangle[Corner]);
+			}
+		}
+	}
+}
+
+void FClimbMeshSimplifier::PushCollapses(int32 Vertex, double MaxErrorSq)
+{
+	TArray<int32, TInlineAllocator<16>> Neighbours;
+	GetNeighbours(Vertex, Neighbours);
+
+	for (int32 Neighbour : Neighbours)
+	{
+		FCollapse Collapse;
+		if (FindCollapse(Vertex, Neighbour, MaxErrorSq, Collapse))
+		{
+			Heap.HeapPush(Collapse, ClimbMeshSimplifier::FCollapseLess());
+		}
+	}
+}
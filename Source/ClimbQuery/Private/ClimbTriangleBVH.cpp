@@ -0,0 +1,608 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ClimbTriangleBVH.h"
+#include "Math/VectorRegister.h"
+
+namespace ClimbTriangleBVH
+{
+	//Deep enough for any median split tree that fits in memory
+	const int32 MaxStackSize = 64;
+
+	FORCEINLINE VectorRegister Dot3(const VectorRegister& AX, const VectorRegister& AY, const VectorRegister& AZ, const VectorRegister& BX, const VectorRegister& BY, const VectorRegister& BZ)
+	{
+		return VectorMultiplyAdd(AX, BX, VectorMultiplyAdd(AY, BY, VectorMultiply(AZ, BZ)));
+	}
+
+	//A flat axis gets a huge inverse instead of an infinite one, so the slab test never sees 0 * inf
+	FORCEINLINE float GetInverse(float Value)
+	{
+		return (FMath::Abs(Value) > SMALL_NUMBER) ? 1.0f / Value : MAX_flt;
+	}
+
+	FORCEINLINE FVector GetInverse(const FVector& Direction)
+	{
+		return FVector(GetInverse(Direction.X), GetInverse(Direction.Y), GetInverse(Direction.Z));
+	}
+
+	bool IntersectBox(const FVector& Origin, const FVector& InvDirection, const FVector& Min, const FVector& Max, float MaxTime)
+	{
+		float Near = 0.0f;
+		float Far = MaxTime;
+		for (int32 Axis = 0; Axis < 3; Axis++)
+		{
+			const float T1 = (Min[Axis] - Origin[Axis]) * InvDirection[Axis];
+			const float T2 = (Max[Axis] - Origin[Axis]) * InvDirection[Axis];
+			Near = FMath::Max(Near, FMath::Min(T1, T2));
+			Far = FMath::Min(Far, FMath::Max(T1, T2));
+		}
+		return Near <= Far;
+	}
+
+	//Point already on the triangle's plane
+	bool IsInside(const FVector& Point, const FVector& V0, const FVector& E1, const FVector& E2)
+	{
+		const FVector ToPoint = Point - V0;
+		const float D00 = FVector::DotProduct(E1, E1);
+		const float D01 = FVector::DotProduct(E1, E2);
+		const float D11 = FVector::DotProduct(E2, E2);
+		const float D20 = FVector::DotProduct(ToPoint, E1);
+		const float D21 = FVector::DotProduct(ToPoint, E2);
+		const float Denom = D00 * D11 - D01 * D01;
+		if (FMath::Abs(Denom) <= SMALL_NUMBER)
+		{
+			return false;
+		}
+
+		const float V = (D11 * D20 - D01 * D21) / Denom;
+		const float W = (D00 * D21 - D01 * D20) / Denom;
+		return V >= 0.0f && W >= 0.0f && V + W <= 1.0f;
+	}
+
+	//Sphere moving along Direction against the capsule around the edge A-B, which is the edge plus both corners
+	bool SweepSphereEdge(const FVector& Centre, const FVector& Direction, const FVector& A, const FVector& B, float Radius, float& OutTime)
+	{
+		const float RadiusSq = Radius * Radius;
+
+		if (FVector::DistSquared(Centre, FMath::ClosestPointOnSegment(Centre, A, B)) <= RadiusSq)
+		{
+			OutTime = 0.0f;
+			return true;
+		}
+
+		float Time = MAX_flt;
+
+		//Side of the edge
+		const FVector BA = B - A;
+		const FVector OA = Centre - A;
+		const float BABA = FVector::DotProduct(BA, BA);
+		const float BARD = FVector::DotProduct(BA, Direction);
+		const float BAOA = FVector::DotProduct(BA, OA);
+		const float K2 = BABA * FVector::DotProduct(Direction, Direction) - BARD * BARD;
+		const float K1 = BABA * FVector::DotProduct(OA, Direction) - BAOA * BARD;
+		const float K0 = BABA * FVector::DotProduct(OA, OA) - BAOA * BAOA - RadiusSq * BABA;
+
+		if (K2 > SMALL_NUMBER)
+		{
+			const float H = K1 * K1 - K2 * K0;
+			if (H >= 0.0f)
+			{
+				const float T = (-K1 - FMath::Sqrt(H)) / K2;
+				const float Y = BAOA + T * BARD;
+				if (T >= 0.0f && Y > 0.0f && Y < BABA)
+				{
+					Time = T;
+				}
+			}
+		}
+
+		//Corners
+		const float DD = FVector::DotProduct(Direction, Direction);
+		if (DD > SMALL_NUMBER)
+		{
+			for (const FVector& Corner : { A, B })
+			{
+				const FVector OC = Centre - Corner;
+				const float HalfB = FVector::DotProduct(OC, Direction);
+				const float H = HalfB * HalfB - DD * (FVector::DotProduct(OC, OC) - RadiusSq);
+				if (H >= 0.0f)
+				{
+					const float T = (-HalfB - FMath::Sqrt(H)) / DD;
+					if (T >= 0.0f)
+					{
+						Time = FMath::Min(Time, T);
+					}
+				}
+			}
+		}
+
+		if (Time == MAX_flt)
+		{
+			return false;
+		}
+
+		OutTime = Time;
+		return true;
+	}
+
+	//Sphere moving along Direction against one triangle, only reports a hit earlier than InOutTime
+	bool SweepSphere(const FVector& Centre, const FVector& Direction, float Radius, const FVector& V0, const FVector& E1, const FVector& E2, float& InOutTime, FVector& OutContact)
+	{
+		FVector Normal = FVector::CrossProduct(E1, E2).GetSafeNormal();
+		if (FVector::DotProduct(Normal, Direction) > 0.0f)
+		{
+			Normal = -Normal;
+		}
+
+		const float Distance = FVector::DotProduct(Centre - V0, Normal);
+		const float Approach = -FVector::DotProduct(Direction, Normal);
+
+		//Behind the plane and moving away from it
+		if (Distance < -Radius)
+		{
+			return false;
+		}
+
+		//Face first, it is the earliest contact whenever it counts
+		if (Distance <= Radius)
+		{
+			const FVector Projected = Centre - Normal * Distance;
+			if (IsInside(Projected, V0, E1, E2))
+			{
+				if (InOutTime <= 0.0f)
+				{
+					return false;
+				}
+				InOutTime = 0.0f;
+				OutContact = Projected;
+				return true;
+			}
+		}
+		else
+		{
+			//Out of reach of the plane and not closing in, so out of reach of the edges too
+			if (Approach <= SMALL_NUMBER)
+			{
+				return false;
+			}
+
+			const float Time = (Distance - Radius) / Approach;
+			if (Time >= InOutTime)
+			{
+				return false;
+			}
+
+			const FVector Contact = Centre + Direction * Time - Normal * Radius;
+			if (IsInside(Contact, V0, E1, E2))
+			{
+				InOutTime = Time;
+				OutContact = Contact;
+				return true;
+			}
+		}
+
+		//Edges and corners
+		const FVector V1 = V0 + E1;
+		const FVector V2 = V0 + E2;
+		const FVector Edges[3][2] = { { V0, V1 }, { V1, V2 }, { V2, V0 } };
+
+		bool bHit = false;
+		for (const FVector* Edge : Edges)
+		{
+			float Time;
+			if (SweepSphereEdge(Centre, Direction, Edge[0], Edge[1], Radius, Time) && Time < InOutTime)
+			{
+				InOutTime = Time;
+				OutContact = FMath::ClosestPointOnSegment(Centre + Direction * Time, Edge[0], Edge[1]);
+				bHit = true;
+			}
+		}
+
+		return bHit;
+	}
+}
+
+FClimbTriangleBVH::FClimbTriangleBVH()
+	: Bounds(ForceInit)
+{
+}
+
+void FClimbTriangleBVH::Reset()
+{
+	Nodes.Reset();
+	Triangles.Reset();
+	TriangleChannels.Reset();
+	TriangleIds.Reset();
+	Bounds = FBox(ForceInit);
+}
+
+void FClimbTriangleBVH::Build(TArrayView<const FVector> Vertices, TArrayView<const uint8> Channels)
+{
+	Reset();
+
+	const int32 NumInput = Vertices.Num() / 3;
+	check(Channels.Num() == NumInput);
+
+	TArray<FBuildTriangle> BuildTriangles;
+	BuildTriangles.Reserve(NumInput);
+
+	for (int32 Id = 0; Id < NumInput; Id++)
+	{
+		const FVector& A = Vertices[Id * 3];
+		const FVector& B = Vertices[Id * 3 + 1];
+		const FVector& C = Vertices[Id * 3 + 2];
+
+		//Nothing can hit a triangle with no area
+		if (FVector::CrossProduct(B - A, C - A).SizeSquared() <= SMALL_NUMBER)
+		{
+			continue;
+		}
+
+		FBuildTriangle& BuildTriangle = BuildTriangles.AddDefaulted_GetRef();
+		BuildTriangle.Bounds = FBox(ForceInit);
+		BuildTriangle.Bounds += A;
+		BuildTriangle.Bounds += B;
+		BuildTriangle.Bounds += C;
+		BuildTriangle.Centroid = (A + B + C) / 3.0f;
+		BuildTriangle.Id = Id;
+	}
+
+	if (BuildTriangles.Num() == 0)
+	{
+		return;
+	}
+
+	Nodes.Reserve(2 * FMath::DivideAndRoundUp(BuildTriangles.Num(), MaxLeafTriangles));
+	BuildNode(BuildTriangles, 0, BuildTriangles.Num());
+	Nodes.Shrink();
+
+	Triangles.SetNumUninitialized(BuildTriangles.Num());
+	TriangleChannels.SetNumUninitialized(BuildTriangles.Num());
+	TriangleIds.SetNumUninitialized(BuildTriangles.Num());
+
+	for (int32 Index = 0; Index < BuildTriangles.Num(); Index++)
+	{
+		const int32 Id = BuildTriangles[Index].Id;
+		const FVector& A = Vertices[Id * 3];
+
+		Triangles[Index].V0 = A;
+		Triangles[Index].E1 = Vertices[Id * 3 + 1] - A;
+		Triangles[Index].E2 = Vertices[Id * 3 + 2] - A;
+		TriangleChannels[Index] = Channels[Id];
+		TriangleIds[Index] = Id;
+	}
+
+	Bounds = FBox(Nodes[0].Min, Nodes[0].Max);
+}
+
+int32 FClimbTriangleBVH::BuildNode(TArray<FBuildTriangle>& BuildTriangles, int32 First, int32 Count)
+{
+	const int32 NodeIndex = Nodes.AddUninitialized();
+
+	FBox NodeBounds(ForceInit);
+	FBox CentroidBounds(ForceInit);
+	for (int32 Index = First; Index < First + Count; Index++)
+	{
+		NodeBounds += BuildTriangles[Index].Bounds;
+		CentroidBounds += BuildTriangles[Index].Centroid;
+	}
+
+	Nodes[NodeIndex].Min = NodeBounds.Min;
+	Nodes[NodeIndex].Max = NodeBounds.Max;
+
+	const FVector Spread = CentroidBounds.GetSize();
+	const int32 Axis = (Spread.X >= Spread.Y && Spread.X >= Spread.Z) ? 0 : ((Spread.Y >= Spread.Z) ? 1 : 2);
+
+	//Small enough, or every centre in one spot so no split can separate them
+	if (Count <= MaxLeafTriangles || Spread[Axis] <= KINDA_SMALL_NUMBER)
+	{
+		Nodes[NodeIndex].Offset = First;
+		Nodes[NodeIndex].Count = Count;
+		return NodeIndex;
+	}
+
+	//Median split along the widest spread of centres, the left child always follows its parent
+	Sort(BuildTriangles.GetData() + First, Count, [Axis](const FBuildTriangle& A, const FBuildTriangle& B)
+		{
+			return A.Centroid[Axis] < B.Centroid[Axis];
+		});
+
+	const int32 LeftCount = Count / 2;
+	BuildNode(BuildTriangles, First, LeftCount);
+	const int32 Right = BuildNode(BuildTriangles, First + LeftCount, Count - LeftCount);
+
+	Nodes[NodeIndex].Offset = Right;
+	Nodes[NodeIndex].Count = 0;
+	return NodeIndex;
+}
+
+bool FClimbTriangleBVH::Raycast(const FVector& Start, const FVector& End, uint8 Channels, FClimbQueryHit& OutHit) const
+{
+	const FClimbRay Ray(Start, End, Channels);
+	RaycastBatch(MakeArrayView(&Ray, 1), MakeArrayView(&OutHit, 1));
+	return OutHit.IsHit();
+}
+
+void FClimbTriangleBVH::RaycastBatch(TArrayView<const FClimbRay> Rays, TArrayView<FClimbQueryHit> OutHits) const
+{
+	check(OutHits.Num() >= Rays.Num());
+
+	if (IsEmpty())
+	{
+		for (int32 Index = 0; Index < Rays.Num(); Index++)
+		{
+			OutHits[Index] = FClimbQueryHit();
+		}
+		return;
+	}
+
+	for (int32 First = 0; First < Rays.Num(); First += PacketWidth)
+	{
+		RaycastPacket(Rays.GetData() + First, FMath::Min(PacketWidth, Rays.Num() - First), OutHits.GetData() + First);
+	}
+}
+
+void FClimbTriangleBVH::RaycastPacket(const FClimbRay* Rays, int32 Count, FClimbQueryHit* OutHits) const
+{
+	using namespace ClimbTriangleBVH;
+
+	static_assert(PacketWidth == 4, "RaycastPacket is written for 4 wide vector registers");
+	check(Count > 0 && Count <= PacketWidth);
+
+	//Structure of arrays, one lane per ray: origin, direction and inverse direction for each axis
+	alignas(16) float Lanes[9][PacketWidth];
+	alignas(16) float Best[PacketWidth];
+	int32 BestTriangle[PacketWidth];
+	uint8 LaneChannels[PacketWidth];
+
+	for (int32 Lane = 0; Lane < PacketWidth; Lane++)
+	{
+		//Spare lanes repeat the first ray and never match a channel
+		const FClimbRay& Ray = Rays[(Lane < Count) ? Lane : 0];
+		const FVector Direction = Ray.End - Ray.Start;
+		for (int32 Axis = 0; Axis < 3; Axis++)
+		{
+			Lanes[Axis][Lane] = Ray.Start[Axis];
+			Lanes[3 + Axis][Lane] = Direction[Axis];
+			Lanes[6 + Axis][Lane] = GetInverse(Direction[Axis]);
+		}
+		Best[Lane] = 1.0f;
+		BestTriangle[Lane] = INDEX_NONE;
+		LaneChannels[Lane] = (Lane < Count) ? Ray.Channels : 0;
+	}
+
+	const VectorRegister OriginX = VectorLoadAligned(Lanes[0]);
+	const VectorRegister OriginY = VectorLoadAligned(Lanes[1]);
+	const VectorRegister OriginZ = VectorLoadAligned(Lanes[2]);
+	const VectorRegister DirX = VectorLoadAligned(Lanes[3]);
+	const VectorRegister DirY = VectorLoadAligned(Lanes[4]);
+	const VectorRegister DirZ = VectorLoadAligned(Lanes[5]);
+	const VectorRegister InvDirX = VectorLoadAligned(Lanes[6]);
+	const VectorRegister InvDirY = VectorLoadAligned(Lanes[7]);
+	const VectorRegister InvDirZ = VectorLoadAligned(Lanes[8]);
+	const VectorRegister Zero = VectorZero();
+	const VectorRegister One = VectorOne();
+	const VectorRegister Epsilon = VectorSetFloat1(SMALL_NUMBER);
+
+	VectorRegister BestTime = VectorLoadAligned(Best);
+
+	int32 Stack[MaxStackSize];
+	int32 StackSize = 0;
+	Stack[StackSize++] = 0;
+
+	while (StackSize > 0)
+	{
+		const int32 NodeIndex = Stack[--StackSize];
+		const FNode& Node = Nodes[NodeIndex];
+
+		//Slab test for every lane at once, against the closest hit each lane has so far
+		const VectorRegister T1X = VectorMultiply(VectorSubtract(VectorSetFloat1(Node.Min.X), OriginX), InvDirX);
+		const VectorRegister T2X = VectorMultiply(VectorSubtract(VectorSetFloat1(Node.Max.X), OriginX), InvDirX);
+		const VectorRegister T1Y = VectorMultiply(VectorSubtract(VectorSetFloat1(Node.Min.Y), OriginY), InvDirY);
+		const VectorRegister T2Y = VectorMultiply(VectorSubtract(VectorSetFloat1(Node.Max.Y), OriginY), InvDirY);
+		const VectorRegister T1Z = VectorMultiply(VectorSubtract(VectorSetFloat1(Node.Min.Z), OriginZ), InvDirZ);
+		const VectorRegister T2Z = VectorMultiply(VectorSubtract(VectorSetFloat1(Node.Max.Z), OriginZ), InvDirZ);
+
+		const VectorRegister Near = VectorMax(VectorMax(VectorMin(T1X, T2X), VectorMin(T1Y, T2Y)), VectorMax(VectorMin(T1Z, T2Z), Zero));
+		const VectorRegister Far = VectorMin(VectorMin(VectorMax(T1X, T2X), VectorMax(T1Y, T2Y)), VectorMin(VectorMax(T1Z, T2Z), BestTime));
+
+		if ((VectorMaskBits(VectorCompareGE(Far, Near)) & ((1 << Count) - 1)) == 0)
+		{
+			continue;
+		}
+
+		if (!Node.IsLeaf())
+		{
+			check(StackSize + 2 <= MaxStackSize);
+			Stack[StackSize++] = Node.Offset;
+			Stack[StackSize++] = NodeIndex + 1;
+			continue;
+		}
+
+		for (int32 Index = Node.Offset; Index < Node.Offset + Node.Count; Index++)
+		{
+			int32 LaneBits = 0;
+			for (int32 Lane = 0; Lane < Count; Lane++)
+			{
+				LaneBits |= (LaneChannels[Lane] & TriangleChannels[Index]) ? (1 << Lane) : 0;
+			}
+			if (LaneBits == 0)
+			{
+				continue;
+			}
+
+			//Moller-Trumbore, one triangle against every lane
+			const FTriangle& Triangle = Triangles[Index];
+			const VectorRegister E1X = VectorSetFloat1(Triangle.E1.X);
+			const VectorRegister E1Y = VectorSetFloat1(Triangle.E1.Y);
+			const VectorRegister E1Z = VectorSetFloat1(Triangle.E1.Z);
+			const VectorRegister E2X = VectorSetFloat1(Triangle.E2.X);
+			const VectorRegister E2Y = VectorSetFloat1(Triangle.E2.Y);
+			const VectorRegister E2Z = VectorSetFloat1(Triangle.E2.Z);
+
+			const VectorRegister PX = VectorSubtract(VectorMultiply(DirY, E2Z), VectorMultiply(DirZ, E2Y));
+			const VectorRegister PY = VectorSubtract(VectorMultiply(DirZ, E2X), VectorMultiply(DirX, E2Z));
+			const VectorRegister PZ = VectorSubtract(VectorMultiply(DirX, E2Y), VectorMultiply(DirY, E2X));
+
+			const VectorRegister Det = Dot3(E1X, E1Y, E1Z, PX, PY, PZ);
+			const VectorRegister InvDet = VectorDivide(One, Det);
+
+			const VectorRegister TX = VectorSubtract(OriginX, VectorSetFloat1(Triangle.V0.X));
+			const VectorRegister TY = VectorSubtract(OriginY, VectorSetFloat1(Triangle.V0.Y));
+			const VectorRegister TZ = VectorSubtract(OriginZ, VectorSetFloat1(Triangle.V0.Z));
+
+			const VectorRegister U = VectorMultiply(Dot3(TX, TY, TZ, PX, PY, PZ), InvDet);
+
+			const VectorRegister QX = VectorSubtract(VectorMultiply(TY, E1Z), VectorMultiply(TZ, E1Y));
+			const VectorRegister QY = VectorSubtract(VectorMultiply(TZ, E1X), VectorMultiply(TX, E1Z));
+			const VectorRegister QZ = VectorSubtract(VectorMultiply(TX, E1Y), VectorMultiply(TY, E1X));
+
+			const VectorRegister V = VectorMultiply(Dot3(DirX, DirY, DirZ, QX, QY, QZ), InvDet);
+			const VectorRegister Time = VectorMultiply(Dot3(E2X, E2Y, E2Z, QX, QY, QZ), InvDet);
+
+			VectorRegister Hit = VectorCompareGT(VectorAbs(Det), Epsilon);
+			Hit = VectorBitwiseAnd(Hit, VectorCompareGE(U, Zero));
+			Hit = VectorBitwiseAnd(Hit, VectorCompareGE(V, Zero));
+			Hit = VectorBitwiseAnd(Hit, VectorCompareGE(One, VectorAdd(U, V)));
+			Hit = VectorBitwiseAnd(Hit, VectorCompareGE(Time, Zero));
+			Hit = VectorBitwiseAnd(Hit, VectorCompareGT(BestTime, Time));
+
+			const int32 HitBits = VectorMaskBits(Hit) & LaneBits;
+			if (HitBits == 0)
+			{
+				continue;
+			}
+
+			alignas(16) float Times[PacketWidth];
+			VectorStoreAligned(Time, Times);
+			for (int32 Lane = 0; Lane < Count; Lane++)
+			{
+				if (HitBits & (1 << Lane))
+				{
+					Best[Lane] = Times[Lane];
+					BestTriangle[Lane] = Index;
+				}
+			}
+			BestTime = VectorLoadAligned(Best);
+		}
+	}
+
+	for (int32 Lane = 0; Lane < Count; Lane++)
+	{
+		FClimbQueryHit& Hit = OutHits[Lane];
+		Hit = FClimbQueryHit();
+
+		if (BestTriangle[Lane] == INDEX_NONE)
+		{
+			continue;
+		}
+
+		const FVector Direction = Rays[Lane].End - Rays[Lane].Start;
+		Hit.Time = Best[Lane];
+		Hit.Location = Rays[Lane].Start + Direction * Hit.Time;
+		Hit.ImpactPoint = Hit.Location;
+		Hit.ImpactNormal = GetFacingNormal(BestTriangle[Lane], Direction);
+		Hit.Normal = Hit.ImpactNormal;
+		Hit.Triangle = TriangleIds[BestTriangle[Lane]];
+	}
+}
+
+bool FClimbTriangleBVH::SweepCapsule(const FVector& Start, const FVector& End, float Radius, float HalfHeight, uint8 Channels, FClimbQueryHit& OutHit) const
+{
+	using namespace ClimbTriangleBVH;
+
+	OutHit = FClimbQueryHit();
+	if (IsEmpty())
+	{
+		return false;
+	}
+
+	const FVector Direction = End - Start;
+	const FVector InvDirection = GetInverse(Direction);
+	const float HalfSegment = FMath::Max(HalfHeight - Radius, 0.0f);
+	const FVector Extent(Radius, Radius, HalfSegment + Radius);
+
+	//Spheres down the capsule's axis, no more than a radius apart
+	const int32 NumSpheres = (HalfSegment > 0.0f && Radius > 0.0f) ? FMath::CeilToInt(2.0f * HalfSegment / Radius) + 1 : 1;
+	const float Spacing = (NumSpheres > 1) ? (2.0f * HalfSegment) / (NumSpheres - 1) : 0.0f;
+
+	float BestTime = 1.0f;
+	int32 BestTriangle = INDEX_NONE;
+	FVector BestContact = FVector::ZeroVector;
+	FVector BestCentre = FVector::ZeroVector;
+
+	int32 Stack[MaxStackSize];
+	int32 StackSize = 0;
+	Stack[StackSize++] = 0;
+
+	while (StackSize > 0)
+	{
+		const int32 NodeIndex = Stack[--StackSize];
+		const FNode& Node = Nodes[NodeIndex];
+
+		//The capsule's centre against the node grown by the capsule
+		if (!IntersectBox(Start, InvDirection, Node.Min - Extent, Node.Max + Extent, BestTime))
+		{
+			continue;
+		}
+
+		if (!Node.IsLeaf())
+		{
+			check(StackSize + 2 <= MaxStackSize);
+			Stack[StackSize++] = Node.Offset;
+			Stack[StackSize++] = NodeIndex + 1;
+			continue;
+		}
+
+		for (int32 Index = Node.Offset; Index < Node.Offset + Node.Count; Index++)
+		{
+			if ((TriangleChannels[Index] & Channels) == 0)
+			{
+				continue;
+			}
+
+			const FTriangle& Triangle = Triangles[Index];
+			for (int32 Sphere = 0; Sphere < NumSpheres; Sphere++)
+			{
+				const FVector Centre = Start + FVector(0.0f, 0.0f, Spacing * Sphere - HalfSegment);
+
+				FVector Contact;
+				if (SweepSphere(Centre, Direction, Radius, Triangle.V0, Triangle.E1, Triangle.E2, BestTime, Contact))
+				{
+					BestTriangle = Index;
+					BestContact = Contact;
+					BestCentre = Centre + Direction * BestTime;
+				}
+			}
+		}
+	}
+
+	if (BestTriangle == INDEX_NONE)
+	{
+		return false;
+	}
+
+	OutHit.Time = BestTime;
+	OutHit.Location = Start + Direction * BestTime;
+	OutHit.ImpactPoint = BestContact;
+	OutHit.ImpactNormal = GetFacingNormal(BestTriangle, Direction);
+	OutHit.Normal = (BestCentre - BestContact).GetSafeNormal();
+	if (OutHit.Normal.IsZero())
+	{
+		OutHit.Normal = OutHit.ImpactNormal;
+	}
+	OutHit.Triangle = TriangleIds[BestTriangle];
+	OutHit.bStartPenetrating = BestTime <= 0.0f;
+	return true;
+}
+
+FVector FClimbTriangleBVH::GetFacingNormal(int32 Index, const FVector& Direction) const
+{
+	const FVector Normal = FVector::CrossProduct(Triangles[Index].E1, Triangles[Index].E2).GetSafeNormal();
+	return (FVector::DotProduct(Normal, Direction) > 0.0f) ? -Normal : Normal;
+}
+
+SIZE_T FClimbTriangleBVH::GetAllocatedSize() const
+{
+	return Nodes.GetAllocatedSize() + Triangles.GetAllocatedSize() + TriangleChannels.GetAllocatedSize() + TriangleIds.GetAllocatedSize();
+}
@@ -0,0 +1,215 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ClimbTriangleBVH.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace ClimbTriangleBVHTests
+{
+	const uint8 WallChannel = 1;
+	const uint8 FloorChannel = 2;
+
+	//Two triangles, Corner + Edge1 + Edge2 opposite Corner
+	void AddQuad(TArray<FVector>& Vertices, TArray<uint8>& Channels, const FVector& Corner, const FVector& Edge1, const FVector& Edge2, uint8 Channel)
+	{
+		Vertices.Append({ Corner, Corner + Edge1, Corner + Edge1 + Edge2 });
+		Vertices.Append({ Corner, Corner + Edge1 + Edge2, Corner + Edge2 });
+		Channels.Append({ Channel, Channel });
+	}
+
+	//Every triangle on its own, no tree and no packets, the answer both query paths have to give
+	float BruteForceRaycast(TArrayView<const FVector> Vertices, TArrayView<const uint8> Channels, const FClimbRay& Ray)
+	{
+		const FVector Direction = Ray.End - Ray.Start;
+		float BestTime = MAX_flt;
+
+		for (int32 Triangle = 0; Triangle < Channels.Num(); Triangle++)
+		{
+			if ((Channels[Triangle] & Ray.Channels) == 0)
+			{
+				continue;
+			}
+
+			const FVector& V0 = Vertices[Triangle * 3];
+			const FVector E1 = Vertices[Triangle * 3 + 1] - V0;
+			const FVector E2 = Vertices[Triangle * 3 + 2] - V0;
+
+			const FVector P = FVector::CrossProduct(Direction, E2);
+			const float Det = FVector::DotProduct(E1, P);
+			if (FMath::Abs(Det) < SMALL_NUMBER)
+			{
+				continue;
+			}
+
+			const FVector S = Ray.Start - V0;
+			const float U = FVector::DotProduct(S, P) / Det;
+			const FVector Q = FVector::CrossProduct(S, E1);
+			const float V = FVector::DotProduct(Direction, Q) / Det;
+			const float Time = FVector::DotProduct(E2, Q) / Det;
+			if (U >= 0.0f && V >= 0.0f && U + V <= 1.0f && Time >= 0.0f && Time <= 1.0f)
+			{
+				BestTime = FMath::Min(BestTime, Time);
+			}
+		}
+
+		return BestTime;
+	}
+
+	//Wall facing -X at X = 100 (triangles 0 and 1) and a floor at Z = 0 (triangles 2 and 3)
+	void BuildWallAndFloor(FClimbTriangleBVH& TriangleBVH)
+	{
+		TArray<FVector> Vertices;
+		TArray<uint8> Channels;
+		AddQuad(Vertices, Channels, FVector(100.0f, -200.0f, 0.0f), FVector(0.0f, 400.0f, 0.0f), FVector(0.0f, 0.0f, 400.0f), WallChannel);
+		AddQuad(Vertices, Channels, FVector(-200.0f, -200.0f, 0.0f), FVector(300.0f, 0.0f, 0.0f), FVector(0.0f, 400.0f, 0.0f), FloorChannel);
+		TriangleBVH.Build(Vertices, Channels);
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FClimbTriangleBVHPacketTest, "Climb.Query.TriangleBVH.PacketMatchesScalar", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FClimbTriangleBVHPacketTest::RunTest(const FString& Parameters)
+{
+	//A soup dense enough that most rays cross several leaves, on two channels
+	FRandomStream Stream(1234);
+	const FBox Bounds(FVector(-1000.0f), FVector(1000.0f));
+
+	TArray<FVector> Vertices;
+	TArray<uint8> Channels;
+	for (int32 Index = 0; Index < 2000; Index++)
+	{
+		const FVector Corner = Stream.RandPointInBox(Bounds);
+		Vertices.Append({ Corner, Corner + Stream.GetUnitVector() * 60.0f, Corner + Stream.GetUnitVector() * 60.0f });
+		Channels.Add(Stream.RandBool() ? ClimbTriangleBVHTests::WallChannel : ClimbTriangleBVHTests::FloorChannel);
+	}
+
+	FClimbTriangleBVH TriangleBVH;
+	TriangleBVH.Build(Vertices, Channels);
+
+	//Not a whole number of packets, so the last one runs part full
+	const int32 NumRays = 4 * 1024 + 3;
+	TArray<FClimbRay> Rays;
+	for (int32 Index = 0; Index < NumRays; Index++)
+	{
+		const FVector Start = Stream.RandPointInBox(Bounds);
+		const uint8 RayChannels = (Index % 3 == 0) ? ClimbTriangleBVHTests::WallChannel : (ClimbTriangleBVHTests::WallChannel | ClimbTriangleBVHTests::FloorChannel);
+		Rays.Emplace(Start, Start + Stream.GetUnitVector() * Stream.FRandRange(10.0f, 400.0f), RayChannels);
+	}
+
+	TArray<FClimbQueryHit> PacketHits;
+	PacketHits.SetNum(NumRays);
+	TriangleBVH.RaycastBatch(Rays, PacketHits);
+
+	int32 NumHits = 0;
+	int32 NumMismatches = 0;
+	int32 NumReferenceMismatches = 0;
+	for (int32 Index = 0; Index < NumRays; Index++)
+	{
+		FClimbQueryHit ScalarHit;
+		TriangleBVH.Raycast(Rays[Index].Start, Rays[Index].End, Rays[Index].Channels, ScalarHit);
+		NumHits += ScalarHit.IsHit() ? 1 : 0;
+
+		//Times only, two triangles as far along the ray can come back either way round
+		const float ReferenceTime = ClimbTriangleBVHTests::BruteForceRaycast(Vertices, Channels, Rays[Index]);
+		const float ScalarTime = ScalarHit.IsHit() ? ScalarHit.Time : MAX_flt;
+		if (!FMath::IsNearlyEqual(ScalarTime, ReferenceTime, 1.e-3f) && NumReferenceMismatches++ < 10)
+		{
+			AddError(FString::Printf(TEXT("Ray %d: tree hit at %f, every triangle on its own hit at %f"), Index, ScalarTime, ReferenceTime));
+		}
+
+		const FClimbQueryHit& PacketHit = PacketHits[Index];
+		if (PacketHit.Triangle != ScalarHit.Triangle || !FMath::IsNearlyEqual(PacketHit.Time, ScalarHit.Time, KINDA_SMALL_NUMBER)
+			|| !PacketHit.ImpactPoint.Equals(ScalarHit.ImpactPoint, 0.01f) || !PacketHit.ImpactNormal.Equals(ScalarHit.ImpactNormal, KINDA_SMALL_NUMBER))
+		{
+			if (NumMismatches++ < 10)
+			{
+				AddError(FString::Printf(TEXT("Ray %d: packet hit triangle %d at %f, scalar hit triangle %d at %f"), Index, PacketHit.Triangle, PacketHit.Time, ScalarHit.Triangle, ScalarHit.Time));
+			}
+		}
+	}
+
+	//Would pass with nothing hit at all, make sure the comparison meant something
+	TestTrue(TEXT("Some rays hit"), NumHits > NumRays / 10);
+	TestTrue(TEXT("Some rays missed"), NumHits < NumRays);
+	TestEqual(TEXT("Packet and scalar mismatches"), NumMismatches, 0);
+	TestEqual(TEXT("Tree and brute force mismatches"), NumReferenceMismatches, 0);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FClimbTriangleBVHRaycastTest, "Climb.Query.TriangleBVH.RaycastKnownHits", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FClimbTriangleBVHRaycastTest::RunTest(const FString& Parameters)
+{
+	FClimbTriangleBVH TriangleBVH;
+	ClimbTriangleBVHTests::BuildWallAndFloor(TriangleBVH);
+
+	FClimbQueryHit Hit;
+	if (TestTrue(TEXT("Ray into the wall hits"), TriangleBVH.Raycast(FVector(0.0f, 0.0f, 100.0f), FVector(200.0f, 0.0f, 100.0f), ClimbTriangleBVHTests::WallChannel, Hit)))
+	{
+		TestEqual(TEXT("Ray into the wall time"), Hit.Time, 0.5f, 1.e-4f);
+		TestEqual(TEXT("Ray into the wall impact"), Hit.ImpactPoint, FVector(100.0f, 0.0f, 100.0f), 0.01f);
+		TestEqual(TEXT("Ray into the wall normal faces it"), Hit.ImpactNormal, FVector(-1.0f, 0.0f, 0.0f), 1.e-4f);
+		TestTrue(TEXT("Ray into the wall triangle"), Hit.Triangle == 0 || Hit.Triangle == 1);
+	}
+
+	//Two sided, from behind the normal still faces the ray
+	if (TestTrue(TEXT("Ray from behind the wall hits"), TriangleBVH.Raycast(FVector(200.0f, 0.0f, 100.0f), FVector(0.0f, 0.0f, 100.0f), ClimbTriangleBVHTests::WallChannel, Hit)))
+	{
+		TestEqual(TEXT("Ray from behind the wall normal"), Hit.ImpactNormal, FVector(1.0f, 0.0f, 0.0f), 1.e-4f);
+	}
+
+	TestFalse(TEXT("Ray on another channel passes through"), TriangleBVH.Raycast(FVector(0.0f, 0.0f, 100.0f), FVector(200.0f, 0.0f, 100.0f), ClimbTriangleBVHTests::FloorChannel, Hit));
+	TestFalse(TEXT("Ray short of the wall misses"), TriangleBVH.Raycast(FVector(0.0f, 0.0f, 100.0f), FVector(90.0f, 0.0f, 100.0f), ClimbTriangleBVHTests::WallChannel, Hit));
+	TestFalse(TEXT("Miss leaves no triangle"), Hit.IsHit());
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FClimbTriangleBVHSweepTest, "Climb.Query.TriangleBVH.CapsuleSweepKnownHits", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FClimbTriangleBVHSweepTest::RunTest(const FString& Parameters)
+{
+	using namespace ClimbTriangleBVHTests;
+
+	FClimbTriangleBVH TriangleBVH;
+	BuildWallAndFloor(TriangleBVH);
+
+	//The VerticalStep capsule
+	const float Radius = 12.0f;
+	const float HalfHeight = 27.0f;
+	const uint8 AllChannels = WallChannel | FloorChannel;
+
+	//Faces are exact, the capsule stops a radius short of the wall
+	FClimbQueryHit Hit;
+	if (TestTrue(TEXT("Sweep into the wall hits"), TriangleBVH.SweepCapsule(FVector(0.0f, 0.0f, 100.0f), FVector(200.0f, 0.0f, 100.0f), Radius, HalfHeight, AllChannels, Hit)))
+	{
+		TestEqual(TEXT("Sweep into the wall time"), Hit.Time, (100.0f - Radius) / 200.0f, 1.e-3f);
+		TestEqual(TEXT("Sweep into the wall location"), Hit.Location, FVector(100.0f - Radius, 0.0f, 100.0f), 0.1f);
+		TestEqual(TEXT("Sweep into the wall impact X"), Hit.ImpactPoint.X, 100.0f, 0.1f);
+		TestEqual(TEXT("Sweep into the wall normal"), Hit.Normal, FVector(-1.0f, 0.0f, 0.0f), 1.e-3f);
+		TestTrue(TEXT("Sweep into the wall triangle"), Hit.Triangle == 0 || Hit.Triangle == 1);
+		TestFalse(TEXT("Sweep into the wall starts clear"), Hit.bStartPenetrating);
+	}
+
+	//Upright, the bottom of the capsule lands HalfHeight under its centre
+	if (TestTrue(TEXT("Sweep onto the floor hits"), TriangleBVH.SweepCapsule(FVector(0.0f, 0.0f, 100.0f), FVector(0.0f, 0.0f, 0.0f), Radius, HalfHeight, AllChannels, Hit)))
+	{
+		TestEqual(TEXT("Sweep onto the floor time"), Hit.Time, (100.0f - HalfHeight) / 100.0f, 1.e-3f);
+		TestEqual(TEXT("Sweep onto the floor normal"), Hit.Normal, FVector(0.0f, 0.0f, 1.0f), 1.e-3f);
+		TestTrue(TEXT("Sweep onto the floor triangle"), Hit.Triangle == 2 || Hit.Triangle == 3);
+	}
+
+	TestFalse(TEXT("Sweep along the wall misses"), TriangleBVH.SweepCapsule(FVector(50.0f, -150.0f, 100.0f), FVector(50.0f, 150.0f, 100.0f), Radius, HalfHeight, AllChannels, Hit));
+	TestFalse(TEXT("Sweep on the floor channel passes the wall"), TriangleBVH.SweepCapsule(FVector(0.0f, 0.0f, 100.0f), FVector(200.0f, 0.0f, 100.0f), Radius, HalfHeight, FloorChannel, Hit));
+
+	if (TestTrue(TEXT("Sweep from inside the wall hits"), TriangleBVH.SweepCapsule(FVector(100.0f - Radius * 0.5f, 0.0f, 100.0f), FVector(0.0f, 0.0f, 100.0f), Radius, HalfHeight, WallChannel, Hit)))
+	{
+		TestTrue(TEXT("Sweep from inside the wall starts penetrating"), Hit.bStartPenetrating);
+		TestEqual(TEXT("Sweep from inside the wall time"), Hit.Time, 0.0f);
+	}
+
+	return true;
+}
+
+#endif //WITH_DEV_AUTOMATION_TESTS
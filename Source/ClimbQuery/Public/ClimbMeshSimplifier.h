@@ -0,0 +1,92 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FClimbTriangleBVH;
+
+/**
+ * Decimates a triangle soup into a lighter surface for climb probes, by quadric edge collapse.
+ *
+ * An edge is only collapsed while the squared distances from the new vertex to every original plane
+ * around it sum to no more than MaxError squared, so no original face plane ends up further than MaxError
+ * from the vertices that replace it. Open borders carry planes of their own and keep their outline the
+ * same way. Collapses that would flip a triangle or pinch the surface into a non-manifold are skipped.
+ *
+ * Planes are not triangles, so the result is measured against the source with MeasureDeviation rather
+ * than trusted. Nothing in here depends on the engine above Core.
+ */
+class CLIMBQUERY_API FClimbMeshSimplifier
+{
+public:
+	/** Three vertices per triangle. Vertices closer than WeldDistance are merged, degenerate triangles are dropped */
+	FClimbMeshSimplifier(TArrayView<const FVector> Vertices, float WeldDistance = 0.01f);
+
+	/** Collapses edges, cheapest first, until none is left within MaxError */
+	void Simplify(float MaxError);
+
+	int32 NumTriangles() const { return NumLiveTriangles; }
+
+	/** Three vertices per triangle */
+	void GetTriangles(TArray<FVector>& OutVertices) const;
+
+	/**
+	 * Farthest any vertex or triangle centre of From is from the surface of To, looking both ways along the
+	 * triangle's normal up to SearchDistance. Along the normal is never closer than the true distance, so this
+	 * is an upper bound at the samples. A sample with no surface within SearchDistance counts as SearchDistance.
+	 */
+	static float MeasureDeviation(TArrayView<const FVector> From, const FClimbTriangleBVH& To, float SearchDistance);
+
+private:
+	//Sum of squared distances to a set of planes, as the symmetric 4x4 matrix of the planes' outer products
+	struct FQuadric
+	{
+		double XX, XY, XZ, YY, YZ, ZZ;
+		double X, Y, Z;
+		double W;
+
+		FQuadric();
+
+		void AddPlane(const FVector& Normal, float Distance);
+		void Add(const FQuadric& Other);
+		double Evaluate(const FVector& Point) const;
+	};
+
+	struct FCollapse
+	{
+		double Cost;
+		FVector Target;
+		int32 Keep;
+		int32 Remove;
+		uint32 KeepStamp;
+		uint32 RemoveStamp;
+	};
+
+	/** Best place for Keep and Remove to meet, false if the edge can't collapse within MaxErrorSq */
+	bool FindCollapse(int32 Keep, int32 Remove, double MaxErrorSq, FCollapse& OutCollapse) const;
+
+	/** Would moving Vertex to Target flip or squash one of its triangles that does not also hold Other */
+	bool FlipsTriangle(int32 Vertex, int32 Other, const FVector& Target) const;
+
+	/** Collapsing would leave more than two triangles on an edge */
+	bool IsNonManifold(int32 Keep, int32 Remove) const;
+
+	void GetNeighbours(int32 Vertex, TArray<int32, TInlineAllocator<16>>& OutNeighbours) const;
+
+	void PushCollapses(int32 Vertex, double MaxErrorSq);
+
+	TArray<FVector> Positions;
+	TArray<FQuadric> Quadrics;
+
+	/** Bumped whenever a vertex moves or dies, so queued collapses that read it are stale */
+	TArray<uint32> Stamps;
+
+	TArray<FIntVector> Triangles;
+	TArray<bool> TriangleRemoved;
+	TArray<TArray<int32, TInlineAllocator<8>>> VertexTriangles;
+	int32 NumLiveTriangles;
+
+	/** Min-heap on Cost */
+	TArray<FCollapse> Heap;
+};
@@ -0,0 +1,144 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+//Segment from Start to End, only hits triangles that share a channel bit with it
+struct FClimbRay
+{
+	FVector Start;
+	FVector End;
+	uint8 Channels;
+
+	FClimbRay()
+		: Start(ForceInitToZero), End(ForceInitToZero), Channels(0xFF)
+	{
+	}
+
+	FClimbRay(const FVector& InStart, const FVector& InEnd, uint8 InChannels)
+		: Start(InStart), End(InEnd), Channels(InChannels)
+	{
+	}
+};
+
+//Closest hit of a ray or sweep, laid out like the parts of FHitResult the climbing code reads
+struct FClimbQueryHit
+{
+	/** Fraction of the way from Start to End */
+	float Time;
+
+	/** Where the ray, or the centre of the swept shape, stopped */
+	FVector Location;
+
+	/** Contact point on the triangle */
+	FVector ImpactPoint;
+
+	/** Triangle normal, facing the query */
+	FVector ImpactNormal;
+
+	/** From the contact to the centre of the swept shape. Same as ImpactNormal for rays */
+	FVector Normal;
+
+	/** Triangle index as it was passed to Build, INDEX_NONE on a miss */
+	int32 Triangle;
+
+	/** A sweep that started out touching a triangle */
+	bool bStartPenetrating;
+
+	FClimbQueryHit()
+		: Time(1.0f), Location(ForceInitToZero), ImpactPoint(ForceInitToZero), ImpactNormal(ForceInitToZero), Normal(ForceInitToZero), Triangle(INDEX_NONE), bStartPenetrating(false)
+	{
+	}
+
+	bool IsHit() const { return Triangle != INDEX_NONE; }
+};
+
+/**
+ * Bounding volume hierarchy over a static triangle soup, for the ray and capsule tests climbing needs.
+ *
+ * Rays are answered in packets of PacketWidth through the platform's vector registers, so every probe of a
+ * batch walks the tree together. Capsules are upright (the only kind the climb probes sweep) and are swept
+ * as a column of spheres no more than a radius apart, which is exact on faces and can miss an edge that
+ * slips between two spheres by a few percent of the radius.
+ *
+ * Triangles are two sided. Nothing in here depends on the engine above Core.
+ */
+class CLIMBQUERY_API FClimbTriangleBVH
+{
+public:
+	/** Rays tested together, one per vector lane */
+	static constexpr int32 PacketWidth = 4;
+
+	/** Most triangles in a leaf */
+	static constexpr int32 MaxLeafTriangles = 4;
+
+	FClimbTriangleBVH();
+
+	/**
+	 * Builds the tree from three vertices per triangle and one channel mask per triangle.
+	 * Degenerate triangles are dropped but keep their index.
+	 */
+	void Build(TArrayView<const FVector> Vertices, TArrayView<const uint8> Channels);
+
+	void Reset();
+
+	bool IsEmpty() const { return Nodes.Num() == 0; }
+	int32 NumTriangles() const { return Triangles.Num(); }
+	const FBox& GetBounds() const { return Bounds; }
+
+	/** Closest triangle on the segment, false if there is none */
+	bool Raycast(const FVector& Start, const FVector& End, uint8 Channels, FClimbQueryHit& OutHit) const;
+
+	/** Closest triangle on every ray, OutHits has to be as long as Rays */
+	void RaycastBatch(TArrayView<const FClimbRay> Rays, TArrayView<FClimbQueryHit> OutHits) const;
+
+	/** First triangle an upright capsule touches on its way from Start to End, false if there is none */
+	bool SweepCapsule(const FVector& Start, const FVector& End, float Radius, float HalfHeight, uint8 Channels, FClimbQueryHit& OutHit) const;
+
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	//32 bytes, children of an inner node are Index + 1 and Offset, a leaf holds Count triangles from Offset
+	struct FNode
+	{
+		FVector Min;
+		int32 Offset;
+		FVector Max;
+		int32 Count;
+
+		bool IsLeaf() const { return Count > 0; }
+	};
+
+	//Edges from V0 are what the ray test wants, the other two corners are never needed on their own
+	struct FTriangle
+	{
+		FVector V0;
+		FVector E1;
+		FVector E2;
+	};
+
+	struct FBuildTriangle
+	{
+		FBox Bounds;
+		FVector Centroid;
+		int32 Id;
+	};
+
+	int32 BuildNode(TArray<FBuildTriangle>& BuildTriangles, int32 First, int32 Count);
+
+	/** Up to PacketWidth rays at once */
+	void RaycastPacket(const FClimbRay* Rays, int32 Count, FClimbQueryHit* OutHits) const;
+
+	/** Triangle normal facing against Direction */
+	FVector GetFacingNormal(int32 Index, const FVector& Direction) const;
+
+	TArray<FNode> Nodes;
+
+	/** In tree order, TriangleIds maps back to the order they were built from */
+	TArray<FTriangle> Triangles;
+	TArray<uint8> TriangleChannels;
+	TArray<int32> TriangleIds;
+
+	FBox Bounds;
+};
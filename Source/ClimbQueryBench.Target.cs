@@ -0,0 +1,26 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+using UnrealBuildTool;
+using System.Collections.Generic;
+
+// Engine-free benchmark of the ClimbQuery triangle tree, see ClimbQueryBenchMain.cpp. Program targets need a source build of the engine
+[SupportedPlatforms(UnrealPlatformClass.Desktop)]
+public class ClimbQueryBenchTarget : TargetRules
+{
+	public ClimbQueryBenchTarget(TargetInfo Target) : base(Target)
+	{
+		Type = TargetType.Program;
+		DefaultBuildSettings = BuildSettingsVersion.V2;
+		LinkType = TargetLinkType.Monolithic;
+		LaunchModuleName = "ClimbQueryBench";
+
+		// Core and the query module, nothing else
+		bBuildDeveloperTools = false;
+		bCompileAgainstEngine = false;
+		bCompileAgainstCoreUObject = false;
+		bCompileAgainstApplicationCore = false;
+		bBuildWithEditorOnlyData = false;
+		bUseMallocProfiler = false;
+		bIsBuildingConsoleApplication = true;
+	}
+}
@@ -0,0 +1,17 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+using UnrealBuildTool;
+
+public class ClimbQueryBench : ModuleRules
+{
+	public ClimbQueryBench(ReadOnlyTargetRules Target) : base(Target)
+	{
+		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
+
+		// LaunchEngineLoop for GEngineLoop.PreInit, the way the engine's own programs start up
+		PublicIncludePaths.Add("Runtime/Launch/Public");
+		PrivateIncludePaths.Add("Runtime/Launch/Private");
+
+		PrivateDependencyModuleNames.AddRange(new string[] { "Core", "Projects", "Json", "ClimbQuery" });
+	}
+}
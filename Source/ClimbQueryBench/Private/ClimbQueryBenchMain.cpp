@@ -0,0 +1,183 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ClimbTriangleBVH.h"
+#include "RequiredProgramMainCPPInclude.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonWriter.h"
+#include "Serialization/JsonSerializer.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogClimbQueryBench, Log, All);
+
+IMPLEMENT_APPLICATION(ClimbQueryBench, "ClimbQueryBench");
+
+/**
+ * ClimbQueryBench [-Boxes=2000] [-Rays=65536] [-Seed=0] [-Output=ClimbQueryBench.json]
+ *
+ * The ClimbQueryBench commandlet without the editor: the tree is built from a generated level of box walls
+ * on a floor instead of a baked map, so it runs anywhere the engine's Core does and its numbers move only
+ * with ClimbQuery. Same rays, sweeps and report as the commandlet, exits 1 if packets and single rays disagree.
+ */
+namespace ClimbQueryBench
+{
+	//Same bits as EClimbTriangleChannel
+	const uint8 Climbable = 1;
+	const uint8 Visibility = 2;
+
+	//Longest climb probe, the body and head wall probes
+	const float RayLength = 110.0f;
+
+	//VerticalStep sweep
+	const float CapsuleRadius = 12.0f;
+	const float CapsuleHalfHeight = 27.0f;
+
+	const float LevelSize = 20000.0f;
+
+	double ToNanoseconds(double Seconds, int32 Count)
+	{
+		return (Count > 0) ? Seconds * 1.0e9 / Count : 0.0;
+	}
+
+	void AddQuad(TArray<FVector>& Vertices, TArray<uint8>& Channels, const FVector& A, const FVector& B, const FVector& C, const FVector& D, uint8 Channel)
+	{
+		Vertices.Append({ A, B, C, A, C, D });
+		Channels.Append({ Channel, Channel });
+	}
+
+	//Walls a climbable level is made of, twelve triangles each on the climbable channel, on a visibility-only floor
+	void BuildLevel(FRandomStream& Stream, int32 NumBoxes, TArray<FVector>& OutVertices, TArray<uint8>& OutChannels)
+	{
+		const float HalfLevel = LevelSize * 0.5f;
+		AddQuad(OutVertices, OutChannels, FVector(-HalfLevel, -HalfLevel, 0.0f), FVector(HalfLevel, -HalfLevel, 0.0f), FVector(HalfLevel, HalfLevel, 0.0f), FVector(-HalfLevel, HalfLevel, 0.0f), Visibility);
+
+		for (int32 Box = 0; Box < NumBoxes; Box++)
+		{
+			const FVector Extent(Stream.FRandRange(10.0f, 30.0f), Stream.FRandRange(50.0f, 400.0f), Stream.FRandRange(100.0f, 600.0f));
+			const FVector Centre(Stream.FRandRange(-HalfLevel, HalfLevel), Stream.FRandRange(-HalfLevel, HalfLevel), Extent.Z);
+			const FQuat Rotation(FVector::UpVector, Stream.FRandRange(0.0f, 2.0f * PI));
+
+			FVector Corners[8];
+			for (int32 Corner = 0; Corner < 8; Corner++)
+			{
+				const FVector Sign((Corner & 1) ? 1.0f : -1.0f, (Corner & 2) ? 1.0f : -1.0f, (Corner & 4) ? 1.0f : -1.0f);
+				Corners[Corner] = Centre + Rotation.RotateVector(Sign * Extent);
+			}
+
+			const int32 Faces[6][4] = { { 0, 2, 6, 4 }, { 1, 5, 7, 3 }, { 0, 4, 5, 1 }, { 2, 3, 7, 6 }, { 0, 1, 3, 2 }, { 4, 6, 7, 5 } };
+			for (const int32* Face : Faces)
+			{
+				AddQuad(OutVertices, OutChannels, Corners[Face[0]], Corners[Face[1]], Corners[Face[2]], Corners[Face[3]], Climbable | Visibility);
+			}
+		}
+	}
+}
+
+INT32_MAIN_INT32_ARGC_TCHAR_ARGV()
+{
+	GEngineLoop.PreInit(ArgC, ArgV);
+
+	int32 NumBoxes = 2000;
+	int32 NumRays = 65536;
+	int32 Seed = 0;
+	FParse::Value(FCommandLine::Get(), TEXT("Boxes="), NumBoxes);
+	FParse::Value(FCommandLine::Get(), TEXT("Rays="), NumRays);
+	FParse::Value(FCommandLine::Get(), TEXT("Seed="), Seed);
+	NumBoxes = FMath::Max(NumBoxes, 1);
+	NumRays = FMath::Max(NumRays, 1);
+
+	FString OutputFilename = TEXT("ClimbQueryBench.json");
+	FParse::Value(FCommandLine::Get(), TEXT("Output="), OutputFilename);
+
+	FRandomStream Stream(Seed);
+	TArray<FVector> Vertices;
+	TArray<uint8> Channels;
+	ClimbQueryBench::BuildLevel(Stream, NumBoxes, Vertices, Channels);
+
+	double StartTime = FPlatformTime::Seconds();
+	FClimbTriangleBVH TriangleBVH;
+	TriangleBVH.Build(Vertices, Channels);
+	const double BuildSeconds = FPlatformTime::Seconds() - StartTime;
+
+	//Probe-length rays from anywhere a climber could be, in every direction
+	const FBox Bounds = TriangleBVH.GetBounds();
+	const uint8 AllChannels = ClimbQueryBench::Climbable | ClimbQueryBench::Visibility;
+	TArray<FClimbRay> Rays;
+	Rays.Reserve(NumRays);
+	for (int32 Index = 0; Index < NumRays; Index++)
+	{
+		const FVector Start = Stream.RandPointInBox(Bounds);
+		Rays.Emplace(Start, Start + Stream.GetUnitVector() * ClimbQueryBench::RayLength, AllChannels);
+	}
+
+	TArray<FClimbQueryHit> ScalarHits;
+	ScalarHits.SetNum(NumRays);
+	TArray<FClimbQueryHit> PacketHits;
+	PacketHits.SetNum(NumRays);
+
+	StartTime = FPlatformTime::Seconds();
+	for (int32 Index = 0; Index < NumRays; Index++)
+	{
+		TriangleBVH.Raycast(Rays[Index].Start, Rays[Index].End, Rays[Index].Channels, ScalarHits[Index]);
+	}
+	const double ScalarSeconds = FPlatformTime::Seconds() - StartTime;
+
+	StartTime = FPlatformTime::Seconds();
+	TriangleBVH.RaycastBatch(Rays, PacketHits);
+	const double PacketSeconds = FPlatformTime::Seconds() - StartTime;
+
+	int32 NumHits = 0;
+	int32 NumMismatches = 0;
+	for (int32 Index = 0; Index < NumRays; Index++)
+	{
+		NumHits += ScalarHits[Index].IsHit() ? 1 : 0;
+		if (ScalarHits[Index].Triangle != PacketHits[Index].Triangle || !FMath::IsNearlyEqual(ScalarHits[Index].Time, PacketHits[Index].Time, KINDA_SMALL_NUMBER))
+		{
+			NumMismatches++;
+		}
+	}
+
+	const int32 NumSweeps = FMath::Max(NumRays / 8, 1);
+	int32 NumSweepHits = 0;
+	StartTime = FPlatformTime::Seconds();
+	for (int32 Index = 0; Index < NumSweeps; Index++)
+	{
+		FClimbQueryHit Hit;
+		NumSweepHits += TriangleBVH.SweepCapsule(Rays[Index].Start, Rays[Index].End, ClimbQueryBench::CapsuleRadius, ClimbQueryBench::CapsuleHalfHeight, AllChannels, Hit) ? 1 : 0;
+	}
+	const double SweepSeconds = FPlatformTime::Seconds() - StartTime;
+
+	TSharedRef<FJsonObject> Report = MakeShared<FJsonObject>();
+	Report->SetNumberField(TEXT("boxes"), NumBoxes);
+	Report->SetNumberField(TEXT("triangles"), TriangleBVH.NumTriangles());
+	Report->SetNumberField(TEXT("treeBytes"), (double)TriangleBVH.GetAllocatedSize());
+	Report->SetNumberField(TEXT("buildMs"), BuildSeconds * 1000.0);
+	Report->SetNumberField(TEXT("packetWidth"), FClimbTriangleBVH::PacketWidth);
+	Report->SetNumberField(TEXT("seed"), Seed);
+	Report->SetNumberField(TEXT("rays"), NumRays);
+	Report->SetNumberField(TEXT("rayHits"), NumHits);
+	Report->SetNumberField(TEXT("scalarNsPerRay"), ClimbQueryBench::ToNanoseconds(ScalarSeconds, NumRays));
+	Report->SetNumberField(TEXT("packetNsPerRay"), ClimbQueryBench::ToNanoseconds(PacketSeconds, NumRays));
+	Report->SetNumberField(TEXT("packetMismatches"), NumMismatches);
+	Report->SetNumberField(TEXT("sweeps"), NumSweeps);
+	Report->SetNumberField(TEXT("sweepHits"), NumSweepHits);
+	Report->SetNumberField(TEXT("nsPerSweep"), ClimbQueryBench::ToNanoseconds(SweepSeconds, NumSweeps));
+
+	FString Json;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Json);
+	FJsonSerializer::Serialize(Report, Writer);
+
+	UE_LOG(LogClimbQueryBench, Display, TEXT("ClimbQueryBench: %s"), *Json);
+
+	int32 ExitCode = NumMismatches > 0 ? 1 : 0;
+	if (!FFileHelper::SaveStringToFile(Json, *OutputFilename))
+	{
+		UE_LOG(LogClimbQueryBench, Error, TEXT("ClimbQueryBench: could not write %s"), *OutputFilename);
+		ExitCode = 1;
+	}
+
+	FEngineLoop::AppPreExit();
+	FEngineLoop::AppExit();
+	return ExitCode;
+}
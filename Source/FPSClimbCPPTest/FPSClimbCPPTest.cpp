@@ -1,6 +1,30 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "FPSClimbCPPTest.h"
+#include "ClimbMemory.h"
 #include "Modules/ModuleManager.h"
 
-IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, FPSClimbCPPTest, "FPSClimbCPPTest" );
+#if ENABLE_LOW_LEVEL_MEM_TRACKER
+DECLARE_LLM_MEMORY_STAT(TEXT("Climbing"), STAT_ClimbingLLM, STATGROUP_LLMFULL);
+DECLARE_LLM_MEMORY_STAT(TEXT("Climbing"), STAT_ClimbingSummaryLLM, STATGROUP_LLM);
+#endif
+
+class FFPSClimbCPPTestModule : public FDefaultGameModuleImpl
+{
+public:
+	virtual void StartupModule() override
+	{
+#if ENABLE_LOW_LEVEL_MEM_TRACKER
+		FLowLevelMemTracker::Get().RegisterProjectTag((int32)LLM_TAG_CLIMBING, TEXT("Climbing"), GET_STATFNAME(STAT_ClimbingLLM), GET_STATFNAME(STAT_ClimbingSummaryLLM));
+#endif
+
+		//Before any game code runs, never under a running world
+		FClimbAllocCounter::InstallIfRequested();
+	}
+};
+
+IMPLEMENT_PRIMARY_GAME_MODULE( FFPSClimbCPPTestModule, FPSClimbCPPTest, "FPSClimbCPPTest" );
+
+DEFINE_LOG_CATEGORY(LogClimb);
+
+CSV_DEFINE_CATEGORY(Climbing, true);
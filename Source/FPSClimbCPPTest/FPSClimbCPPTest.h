@@ -3,4 +3,15 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "ClimbStats.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "ProfilingDebugging/CsvProfiler.h"
 
+//Trace channel for surfaces that can be climbed, declared in DefaultEngine.ini. Ignored by default, the BlockAll,
+//BlockAllDynamic and ClimbableWall profiles block it
+#define ECC_Climbable ECC_GameTraceChannel1
+
+DECLARE_LOG_CATEGORY_EXTERN(LogClimb, Log, All);
+
+//Climbing timings and counters in csvprofile captures
+CSV_DECLARE_CATEGORY_EXTERN(Climbing);
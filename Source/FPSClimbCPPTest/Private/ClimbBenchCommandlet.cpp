@@ -0,0 +1,386 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ClimbBenchCommandlet.h"
+#include "FPSClimbCPPTest.h"
+#include "EngiPC.h"
+#include "ClimbingMovementComponent.h"
+#include "ClimbProbeBatch.h"
+#include "ClimbSurfaceGraph.h"
+#include "ClimbMemory.h"
+#include "ClimbHeadless.h"
+#include "Components/InputComponent.h"
+#include "GameFramework/PlayerStart.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonWriter.h"
+#include "Serialization/JsonSerializer.h"
+
+namespace ClimbBench
+{
+	struct FScriptEvent
+	{
+		int32 Frame;
+		FName Binding;
+		float Value;
+	};
+
+	struct FBot
+	{
+		AEngiPC* Character;
+		UInputComponent* Input;
+		FRandomStream Stream;
+		float Forward;
+		float Right;
+		int32 NextChange;
+		FDelegateHandle LatchHandle;
+		bool bJumpHeld;
+		bool bSprintHeld;
+	};
+
+	bool LoadScript(const FString& Filename, TArray<FScriptEvent>& OutEvents)
+	{
+		TArray<FString> Lines;
+		if (!FFileHelper::LoadFileToStringArray(Lines, *Filename))
+		{
+			return false;
+		}
+
+		for (const FString& Line : Lines)
+		{
+			TArray<FString> Tokens;
+			Line.TrimStartAndEnd().ParseIntoArrayWS(Tokens);
+			if (Tokens.Num() < 3 || Tokens[0].StartsWith(TEXT("#")))
+			{
+				continue;
+			}
+
+			FScriptEvent Event;
+			Event.Frame = FCString::Atoi(*Tokens[0]);
+			Event.Binding = FName(*Tokens[1]);
+			Event.Value = FCString::Atof(*Tokens[2]);
+			OutEvents.Add(Event);
+		}
+
+		OutEvents.StableSort([](const FScriptEvent& A, const FScriptEvent& B) { return A.Frame < B.Frame; });
+		return true;
+	}
+
+	//Walk at a wall, jump to grab it, climb about, now and then let go or sprint
+	void UpdateRandom(FBot& Bot, int32 Frame)
+	{
+		if (Bot.bJumpHeld)
+		{
+			ClimbHeadless::SetAction(Bot.Input, TEXT("Jump"), false);
+			Bot.bJumpHeld = false;
+		}
+
+		if (Frame >= Bot.NextChange)
+		{
+			Bot.NextChange = Frame + Bot.Stream.RandRange(30, 180);
+
+			const float ForwardChoices[] = { 1.0f, 1.0f, 0.0f, -1.0f };
+			Bot.Forward = ForwardChoices[Bot.Stream.RandRange(0, 3)];
+			Bot.Right = (float)Bot.Stream.RandRange(-1, 1);
+
+			if (Bot.Stream.FRand() < 0.4f)
+			{
+				ClimbHeadless::SetAction(Bot.Input, TEXT("Jump"), true);
+				Bot.bJumpHeld = true;
+			}
+
+			if (Bot.Stream.FRand() < 0.1f)
+			{
+				Bot.bSprintHeld = !Bot.bSprintHeld;
+				ClimbHeadless::SetAction(Bot.Input, TEXT("SpecialAction"), Bot.bSprintHeld);
+			}
+		}
+
+		ClimbHeadless::SetAxis(Bot.Input, TEXT("MoveForward"), Bot.Forward);
+		ClimbHeadless::SetAxis(Bot.Input, TEXT("MoveRight"), Bot.Right);
+	}
+}
+
+UClimbBenchCommandlet::UClimbBenchCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UClimbBenchCommandlet::Main(const FString& Params)
+{
+	FString MapName;
+	if (!FParse::Value(*Params, TEXT("Map="), MapName))
+	{
+		MapName = TEXT("/Game/TestLevel");
+	}
+
+	int32 NumClimbers = 32;
+	int32 NumFrames = 1800;
+	int32 NumWarmup = 60;
+	int32 Seed = 0;
+	FParse::Value(*Params, TEXT("Climbers="), NumClimbers);
+	FParse::Value(*Params, TEXT("Frames="), NumFrames);
+	FParse::Value(*Params, TEXT("Warmup="), NumWarmup);
+	FParse::Value(*Params, TEXT("Seed="), Seed);
+
+	int32 MaxAllocs = INDEX_NONE;
+	FParse::Value(*Params, TEXT("MaxAllocs="), MaxAllocs);
+	const bool bCountAllocs = MaxAllocs >= 0 || FParse::Param(*Params, TEXT("CountAllocs"));
+	if (bCountAllocs && !FClimbAllocCounter::IsInstalled())
+	{
+		UE_LOG(LogClimb, Error, TEXT("ClimbBench: counting allocations needs -ClimbCountAllocs on the command line, the counter is installed at startup"));
+		return 1;
+	}
+
+	FString OutputFilename = FPaths::ProjectSavedDir() / TEXT("ClimbBench.json");
+	FParse::Value(*Params, TEXT("Output="), OutputFilename);
+
+	TArray<ClimbBench::FScriptEvent> Script;
+	FString ScriptFilename;
+	if (FParse::Value(*Params, TEXT("Script="), ScriptFilename) && !ClimbBench::LoadScript(ScriptFilename, Script))
+	{
+		UE_LOG(LogClimb, Error, TEXT("ClimbBench: could not read script %s"), *ScriptFilename);
+		return 1;
+	}
+
+	UWorld* World = ClimbHeadless::LoadGameWorld(MapName);
+	if (!World)
+	{
+		UE_LOG(LogClimb, Error, TEXT("ClimbBench: could not load map %s"), *MapName);
+		return 1;
+	}
+
+	//Bots take turns at the player starts of a map that has several (ClimbStressMap), else start at the foot of a
+	//baked wall if there is a graph, around the player start otherwise
+	const UClimbSurfaceGraph* Graph = UClimbSurfaceGraph::FindForWorld(World);
+
+	TArray<APlayerStart*> PlayerStarts;
+	for (TActorIterator<APlayerStart> It(World); It; ++It)
+	{
+		PlayerStarts.Add(*It);
+	}
+	const FVector StartLocation = PlayerStarts.Num() > 0 ? PlayerStarts[0]->GetActorLocation() : FVector::ZeroVector;
+
+	FRandomStream SpawnStream(Seed);
+	TArray<ClimbBench::FBot> Bots;
+	int32 NumLatches = 0;
+	int32 NumReleases = 0;
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+	for (int32 Index = 0; Index < NumClimbers; Index++)
+	{
+		FVector Location = StartLocation + FVector(SpawnStream.FRandRange(-1000.0f, 1000.0f), SpawnStream.FRandRange(-1000.0f, 1000.0f), 0.0f);
+		FRotator Rotation(0.0f, SpawnStream.FRandRange(-180.0f, 180.0f), 0.0f);
+
+		if (PlayerStarts.Num() > 1)
+		{
+			Location = PlayerStarts[Index % PlayerStarts.Num()]->GetActorLocation();
+			Rotation = PlayerStarts[Index % PlayerStarts.Num()]->GetActorRotation();
+		}
+		else if (Graph && Graph->Patches.Num() > 0)
+		{
+			const FClimbWallPatch& Patch = Graph->Patches[SpawnStream.RandRange(0, Graph->Patches.Num() - 1)];
+			const FVector Up = FVector::CrossProduct(Patch.Normal, Patch.Right);
+			Location = Patch.Center + Patch.Normal * 60.0f + Patch.Right * SpawnStream.FRandRange(-Patch.Extent.X, Patch.Extent.X) - Up * (Patch.Extent.Y - 60.0f);
+			Rotation = (-Patch.Normal).Rotation();
+		}
+
+		AEngiPC* Character = World->SpawnActor<AEngiPC>(AEngiPC::StaticClass(), Location, Rotation, SpawnParams);
+		if (!Character)
+		{
+			continue;
+		}
+		Character->SpawnDefaultController();
+
+		//Same bindings a player gets, fed by the bench instead of a player controller
+		UInputComponent* Input = NewObject<UInputComponent>(Character, TEXT("ClimbBenchInput"));
+		Character->SetupPlayerInputComponent(Input);
+
+		ClimbBench::FBot& Bot = Bots.AddDefaulted_GetRef();
+		Bot.LatchHandle = Character->GetClimbingMovement()->OnLatchChanged.AddLambda([&NumLatches, &NumReleases](bool bLatched)
+			{
+				bLatched ? NumLatches++ : NumReleases++;
+			});
+		Bot.Character = Character;
+		Bot.Input = Input;
+		Bot.Stream.Initialize(Seed + Index + 1);
+		Bot.Forward = 1.0f;
+		Bot.Right = 0.0f;
+		Bot.NextChange = 0;
+		Bot.bJumpHeld = false;
+		Bot.bSprintHeld = false;
+	}
+
+	const float DeltaTime = 1.0f / 60.0f;
+	const bool bAsyncProbes = IConsoleManager::Get().FindConsoleVariable(TEXT("climb.AsyncProbes"))->GetInt() != 0;
+
+	TArray<double> FrameTimes;
+	FrameTimes.Reserve(NumFrames);
+	uint64 NumTraces = 0;
+	int64 ClimbingFrames = 0;
+	int32 ScriptCursor = 0;
+
+	for (int32 Frame = 0; Frame < NumWarmup + NumFrames; Frame++)
+	{
+		if (Frame == NumWarmup)
+		{
+			NumLatches = 0;
+			NumReleases = 0;
+			for (ClimbBench::FBot& Bot : Bots)
+			{
+				Bot.Character->GetClimbingMovement()->GetClimbProbes().GetContactCache().ResetCounters();
+			}
+
+			//Arrays have grown to what the run needs by now, from here on any allocation is one per frame
+			if (bCountAllocs)
+			{
+				FClimbAllocCounter::Start();
+			}
+		}
+
+		//Every bot gets the script, or its own random input
+		if (Script.Num() > 0)
+		{
+			for (; ScriptCursor < Script.Num() && Script[ScriptCursor].Frame <= Frame; ScriptCursor++)
+			{
+				const ClimbBench::FScriptEvent& Event = Script[ScriptCursor];
+				for (ClimbBench::FBot& Bot : Bots)
+				{
+					if (ClimbHeadless::IsAction(Bot.Input, Event.Binding))
+					{
+						ClimbHeadless::SetAction(Bot.Input, Event.Binding, Event.Value != 0.0f);
+					}
+					else if (Event.Binding == TEXT("MoveForward"))
+					{
+						Bot.Forward = Event.Value;
+					}
+					else if (Event.Binding == TEXT("MoveRight"))
+					{
+						Bot.Right = Event.Value;
+					}
+				}
+			}
+
+			for (ClimbBench::FBot& Bot : Bots)
+			{
+				ClimbHeadless::SetAxis(Bot.Input, TEXT("MoveForward"), Bot.Forward);
+				ClimbHeadless::SetAxis(Bot.Input, TEXT("MoveRight"), Bot.Right);
+			}
+		}
+		else
+		{
+			for (ClimbBench::FBot& Bot : Bots)
+			{
+				ClimbBench::UpdateRandom(Bot, Frame);
+			}
+		}
+
+		const uint64 TracesBefore = FClimbProbeBatch::GetNumTraces();
+		const double StartTime = FPlatformTime::Seconds();
+
+		GFrameCounter++;
+		World->Tick(LEVELTICK_All, DeltaTime);
+
+		const double FrameMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+		if (Frame < NumWarmup)
+		{
+			continue;
+		}
+
+		FrameTimes.Add(FrameMs);
+		NumTraces += FClimbProbeBatch::GetNumTraces() - TracesBefore;
+		for (const ClimbBench::FBot& Bot : Bots)
+		{
+			ClimbingFrames += Bot.Character->GetClimbingMovement()->IsClimbing() ? 1 : 0;
+		}
+	}
+
+	FClimbAllocCounter::Stop();
+	const uint64 NumAllocs = FClimbAllocCounter::GetCount();
+
+	//Wall probes answered without a trace, against the ones the cache had to send
+	uint64 CacheHits = 0;
+	uint64 CacheMisses = 0;
+	for (ClimbBench::FBot& Bot : Bots)
+	{
+		const FClimbContactCache& Cache = Bot.Character->GetClimbingMovement()->GetClimbProbes().GetContactCache();
+		CacheHits += Cache.GetHitCount();
+		CacheMisses += Cache.GetMissCount();
+	}
+
+	double TotalMs = 0.0;
+	for (double FrameMs : FrameTimes)
+	{
+		TotalMs += FrameMs;
+	}
+
+	TArray<double> SortedTimes = FrameTimes;
+	SortedTimes.Sort();
+
+	const int32 MeasuredFrames = FMath::Max(FrameTimes.Num(), 1);
+
+	TSharedRef<FJsonObject> GameThread = MakeShared<FJsonObject>();
+	GameThread->SetNumberField(TEXT("mean"), TotalMs / MeasuredFrames);
+	GameThread->SetNumberField(TEXT("p50"), ClimbHeadless::Percentile(SortedTimes, 0.5f));
+	GameThread->SetNumberField(TEXT("p99"), ClimbHeadless::Percentile(SortedTimes, 0.99f));
+	GameThread->SetNumberField(TEXT("max"), SortedTimes.Num() > 0 ? SortedTimes.Last() : 0.0);
+
+	TSharedRef<FJsonObject> Report = MakeShared<FJsonObject>();
+	Report->SetStringField(TEXT("map"), MapName);
+	Report->SetNumberField(TEXT("climbers"), Bots.Num());
+	Report->SetNumberField(TEXT("frames"), FrameTimes.Num());
+	Report->SetNumberField(TEXT("deltaTime"), DeltaTime);
+	Report->SetNumberField(TEXT("seed"), Seed);
+	Report->SetStringField(TEXT("input"), Script.Num() > 0 ? ScriptFilename : TEXT("random"));
+	Report->SetBoolField(TEXT("asyncProbes"), bAsyncProbes);
+	Report->SetBoolField(TEXT("surfaceGraph"), Graph != nullptr);
+	Report->SetObjectField(TEXT("gameThreadMs"), GameThread);
+	Report->SetNumberField(TEXT("tracesPerFrame"), (double)NumTraces / MeasuredFrames);
+	Report->SetNumberField(TEXT("climbingPerFrame"), (double)ClimbingFrames / MeasuredFrames);
+	Report->SetNumberField(TEXT("contactCacheHits"), (double)CacheHits);
+	Report->SetNumberField(TEXT("contactCacheHitRate"), (CacheHits + CacheMisses) > 0 ? (double)CacheHits / (CacheHits + CacheMisses) : 0.0);
+	Report->SetNumberField(TEXT("latches"), NumLatches);
+	Report->SetNumberField(TEXT("releases"), NumReleases);
+	if (bCountAllocs)
+	{
+		Report->SetNumberField(TEXT("climbingAllocs"), (double)NumAllocs);
+		Report->SetNumberField(TEXT("climbingAllocsPerFrame"), (double)NumAllocs / MeasuredFrames);
+	}
+
+	FString Json;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Json);
+	FJsonSerializer::Serialize(Report, Writer);
+
+	UE_LOG(LogClimb, Display, TEXT("ClimbBench: %s"), *Json);
+
+	for (const ClimbBench::FBot& Bot : Bots)
+	{
+		Bot.Character->GetClimbingMovement()->OnLatchChanged.Remove(Bot.LatchHandle);
+	}
+
+	ClimbHeadless::DestroyGameWorld(World);
+
+	if (!FFileHelper::SaveStringToFile(Json, *OutputFilename))
+	{
+		UE_LOG(LogClimb, Error, TEXT("ClimbBench: could not write %s"), *OutputFilename);
+		return 1;
+	}
+
+	if (MaxAllocs >= 0 && NumAllocs > (uint64)MaxAllocs)
+	{
+		UE_LOG(LogClimb, Error, TEXT("ClimbBench: climbing allocated %llu times in %d frames, more than -MaxAllocs=%d"), NumAllocs, FrameTimes.Num(), MaxAllocs);
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,188 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ClimbContactCache.h"
+#include "ClimbProbeBatch.h"
+#include "Components/PrimitiveComponent.h"
+#include "FPSClimbCPPTest.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Contact cache hits"), STAT_ClimbContactCacheHits, STATGROUP_Climbing);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Contact cache misses"), STAT_ClimbContactCacheMisses, STATGROUP_Climbing);
+
+static TAutoConsoleVariable<int32> CVarClimbContactCache(
+	TEXT("climb.ContactCache"),
+	1,
+	TEXT("Reuse the last body/head wall hits while a latched climber slides along the same wall."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarClimbContactCacheTolerance(
+	TEXT("climb.ContactCacheTolerance"),
+	5.0f,
+	TEXT("How far (cm) a wall probe can slide along the wall it hit before it is traced again, two climbing steps at the default speed.\n")
+	TEXT("Also how far past the end of a wall a cached hit can carry on, keep it under the distance a ledge has to be noticed in."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarClimbContactCacheAngleTolerance(
+	TEXT("climb.ContactCacheAngleTolerance"),
+	0.5f,
+	TEXT("How far (degrees) a climber can turn before its cached wall hits are traced again."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarClimbContactCacheMaxAge(
+	TEXT("climb.ContactCacheMaxAge"),
+	30,
+	TEXT("Frames a cached wall hit is reused for before it is traced again, whatever else holds. 0 keeps it until something moves."),
+	ECVF_Default);
+
+namespace ClimbContactCache
+{
+	//A probe whose length or direction changed by more than this (cm at its end) is a different probe
+	const float SegmentTolerance = 0.5f;
+}
+
+FClimbContactCache::FClimbContactCache()
+	: bComponentsChecked(false)
+	, HitCount(0)
+	, MissCount(0)
+{
+	Invalidate();
+}
+
+bool FClimbContactCache::IsCacheable(EClimbProbe Probe)
+{
+	switch (Probe)
+	{
+	case EClimbProbe::VerticalBody:
+	case EClimbProbe::VerticalHead:
+	case EClimbProbe::ShimmyBody:
+	case EClimbProbe::ShimmyHead:
+	case EClimbProbe::DiagonalBody:
+	case EClimbProbe::DiagonalHead:
+		return true;
+	default:
+		return false;
+	}
+}
+
+bool FClimbContactCache::Find(EClimbProbe Probe, int8 Intent, const FVector& Start, const FVector& End, const FTransform& ActorTransform, FHitResult& OutHit)
+{
+	//Also asked from the climb evaluate phase's worker threads
+	if (!IsCacheable(Probe) || CVarClimbContactCache.GetValueOnAnyThread() == 0)
+	{
+		return false;
+	}
+
+	FContact& Contact = Contacts[(int32)Probe];
+
+	const int32 MaxAge = CVarClimbContactCacheMaxAge.GetValueOnAnyThread();
+	bool bUsable = Contact.bValid && Contact.Intent == Intent
+		&& (MaxAge <= 0 || GFrameCounter - Contact.Frame <= (uint64)MaxAge);
+
+	//Has the character turned, or is the probe a different one from the traced segment
+	const FVector Direction = End - Start;
+	if (bUsable)
+	{
+		const float ToleranceSq = FMath::Square(CVarClimbContactCacheTolerance.GetValueOnAnyThread());
+		const float AngleTolerance = FMath::DegreesToRadians(CVarClimbContactCacheAngleTolerance.GetValueOnAnyThread());
+
+		bUsable = ActorTransform.GetRotation().AngularDistance(Contact.ActorTransform.GetRotation()) <= AngleTolerance
+			&& FVector::DistSquared(Direction, Contact.End - Contact.Start) <= FMath::Square(ClimbContactCache::SegmentTolerance)
+			&& FVector::DistSquared(Start, Contact.Start) <= ToleranceSq;
+	}
+
+	//Has the wall itself moved, CheckComponents already answered that for a worker thread
+	if (bUsable && !Contact.bStatic && !bComponentsChecked)
+	{
+		const UPrimitiveComponent* Component = Contact.Hit.GetComponent();
+		bUsable = Component && Component->GetComponentTransform().Equals(Contact.ComponentTransform, KINDA_SMALL_NUMBER);
+	}
+
+	//Where the new segment meets the wall's plane, it has to still be on the segment
+	float Time = 0.0f;
+	if (bUsable)
+	{
+		const float Approach = FVector::DotProduct(Direction, Contact.Hit.ImpactNormal);
+		Time = (Approach < -KINDA_SMALL_NUMBER) ? FVector::DotProduct(Contact.Hit.ImpactPoint - Start, Contact.Hit.ImpactNormal) / Approach : -1.0f;
+		bUsable = Time >= 0.0f && Time <= 1.0f;
+	}
+
+	if (!bUsable)
+	{
+		Contact.bValid = false;
+		MissCount++;
+		INC_DWORD_STAT(STAT_ClimbContactCacheMisses);
+		return false;
+	}
+
+	HitCount++;
+	INC_DWORD_STAT(STAT_ClimbContactCacheHits);
+	OutHit = Contact.Hit;
+	OutHit.TraceStart = Start;
+	OutHit.TraceEnd = End;
+	OutHit.Time = Time;
+	OutHit.Distance = Direction.Size() * Time;
+	OutHit.Location = Start + (Direction * Time);
+	OutHit.ImpactPoint = OutHit.Location;
+	return true;
+}
+
+void FClimbContactCache::Store(EClimbProbe Probe, int8 Intent, const FVector& Start, const FVector& End, const FTransform& ActorTransform, bool bHit, const FHitResult& Hit, const FTransform& ComponentTransform)
+{
+	if (!IsCacheable(Probe))
+	{
+		return;
+	}
+
+	FContact& Contact = Contacts[(int32)Probe];
+
+	//Misses are never cached, something can always move into the gap
+	if (!bHit)
+	{
+		Contact.bValid = false;
+		return;
+	}
+
+	Contact.Hit = Hit;
+	Contact.Start = Start;
+	Contact.End = End;
+	Contact.ActorTransform = ActorTransform;
+	Contact.ComponentTransform = ComponentTransform;
+	Contact.Frame = GFrameCounter;
+	Contact.Intent = Intent;
+	Contact.bStatic = Hit.Component.IsExplicitlyNull();
+	Contact.bValid = true;
+}
+
+void FClimbContactCache::CheckComponents()
+{
+	check(IsInGameThread());
+
+	for (FContact& Contact : Contacts)
+	{
+		if (Contact.bValid && !Contact.bStatic)
+		{
+			const UPrimitiveComponent* Component = Contact.Hit.GetComponent();
+			Contact.bValid = Component && Component->GetComponentTransform().Equals(Contact.ComponentTransform, KINDA_SMALL_NUMBER);
+		}
+	}
+
+	bComponentsChecked = true;
+}
+
+void FClimbContactCache::Invalidate()
+{
+	for (FContact& Contact : Contacts)
+	{
+		Contact.bValid = false;
+		Contact.Frame = 0;
+		Contact.Intent = 0;
+		Contact.bStatic = false;
+	}
+}
+
+void FClimbContactCache::ResetCounters()
+{
+	HitCount = 0;
+	MissCount = 0;
+}
@@ -0,0 +1,342 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ClimbCrowd.h"
+#include "FPSClimbCPPTest.h"
+#include "EngiPC.h"
+#include "ClimbSurfaceGraph.h"
+#include "ClimbingMovementComponent.h"
+#include "ClimbEvaluateSubsystem.h"
+#include "ClimbMemory.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "GameFramework/Character.h"
+#include "GameFramework/Controller.h"
+#include "GameFramework/PlayerController.h"
+#include "Engine/World.h"
+
+DECLARE_CYCLE_STAT(TEXT("Crowd Update"), STAT_ClimbCrowdUpdate, STATGROUP_Climbing);
+DECLARE_CYCLE_STAT(TEXT("Crowd Promotion"), STAT_ClimbCrowdPromotion, STATGROUP_Climbing);
+DECLARE_CYCLE_STAT(TEXT("Crowd Instances"), STAT_ClimbCrowdInstances, STATGROUP_Climbing);
+
+AClimbCrowd::AClimbCrowd()
+{
+	PrimaryActorTick.bCanEverTick = true;
+
+	Instances = CreateDefaultSubobject<UInstancedStaticMeshComponent>(TEXT("Instances"));
+	Instances->SetMobility(EComponentMobility::Movable);
+	Instances->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Instances->SetCastShadow(false);
+	RootComponent = Instances;
+
+	InitialClimbers = 500;
+	Seed = 0;
+	ClimbSpeed = 150.0f;
+	WallOffset = 25.0f;
+	BatchSize = 64;
+
+	ProxyClass = AEngiPC::StaticClass();
+	PromoteDistance = 1500.0f;
+	DemoteDistance = 2000.0f;
+	PromoteInterval = 0.25f;
+	MaxProxies = 16;
+
+	PromoteTimer = 0.0f;
+	NumProxies = 0;
+}
+
+void AClimbCrowd::BeginPlay()
+{
+	Super::BeginPlay();
+
+	SurfaceGraph = UClimbSurfaceGraph::FindForWorld(GetWorld());
+	if (!SurfaceGraph)
+	{
+		UE_LOG(LogClimb, Warning, TEXT("%s: no baked climb graph for this level, run the ClimbGraphBake commandlet"), *GetName());
+		return;
+	}
+
+	Scatter(InitialClimbers);
+
+	//Promoted climbers get their input from this tick, it has to be in before they are evaluated
+	if (UClimbEvaluateSubsystem* Evaluate = GetWorld()->GetSubsystem<UClimbEvaluateSubsystem>())
+	{
+		Evaluate->AddInputSource(this);
+	}
+}
+
+void AClimbCrowd::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	for (const TWeakObjectPtr<ACharacter>& Proxy : Proxies)
+	{
+		if (ACharacter* Character = Proxy.Get())
+		{
+			Character->Destroy();
+		}
+	}
+
+	Proxies.Reset();
+	Simulation.Reset();
+	NumProxies = 0;
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AClimbCrowd::Scatter(int32 Count)
+{
+	if (!SurfaceGraph || SurfaceGraph->Patches.Num() == 0)
+	{
+		return;
+	}
+
+	FRandomStream Stream(Seed);
+
+	for (int32 Spawned = 0; Spawned < Count; Spawned++)
+	{
+		const int32 Patch = Stream.RandRange(0, SurfaceGraph->Patches.Num() - 1);
+		const FClimbWallPatch& WallPatch = SurfaceGraph->Patches[Patch];
+		const FVector Up = FVector::CrossProduct(WallPatch.Normal, WallPatch.Right);
+
+		const FVector Location = WallPatch.Center
+			+ WallPatch.Right * Stream.FRandRange(-WallPatch.Extent.X, WallPatch.Extent.X)
+			+ Up * Stream.FRandRange(-WallPatch.Extent.Y, WallPatch.Extent.Y);
+
+		//Mostly climbing up, some drift to the side
+		const FVector2D Input(Stream.FRandRange(0.5f, 1.0f), Stream.FRandRange(-1.0f, 1.0f));
+
+		Simulation.Add(*SurfaceGraph, Patch, Location, Input);
+		Proxies.AddDefaulted();
+		Instances->AddInstance(FTransform::Identity);
+	}
+}
+
+int32 AClimbCrowd::AddClimber(const FVector& Location, const FVector& Facing, FVector2D Input)
+{
+	if (!SurfaceGraph)
+	{
+		return INDEX_NONE;
+	}
+
+	FVector WallPoint, WallNormal;
+	const int32 Patch = SurfaceGraph->FindWall(Location, Facing.GetSafeNormal(), WallOffset * 3.0f, WallPoint, WallNormal);
+	if (Patch == INDEX_NONE)
+	{
+		return INDEX_NONE;
+	}
+
+	Proxies.AddDefaulted();
+	Instances->AddInstance(FTransform::Identity);
+	return Simulation.Add(*SurfaceGraph, Patch, WallPoint, Input);
+}
+
+void AClimbCrowd::SetClimberInput(int32 Index, FVector2D Input)
+{
+	if (Simulation.Inputs.IsValidIndex(Index))
+	{
+		Simulation.Inputs[Index] = Input;
+	}
+}
+
+void AClimbCrowd::RemoveClimber(int32 Index)
+{
+	if (EnumHasAnyFlags(Simulation.Flags[Index], EClimbCrowdFlags::Promoted))
+	{
+		NumProxies--;
+	}
+
+	Simulation.RemoveAtSwap(Index);
+	Proxies.RemoveAtSwap(Index, 1, false);
+
+	//Instances are all rewritten every tick, only the count has to match
+	Instances->RemoveInstance(Instances->GetInstanceCount() - 1);
+}
+
+void AClimbCrowd::Tick(float DeltaTime)
+{
+	//Only tagged, promotions spawn characters and instance updates are the renderer's
+	LLM_SCOPE(LLM_TAG_CLIMBING);
+
+	Super::Tick(DeltaTime);
+
+	if (!SurfaceGraph)
+	{
+		return;
+	}
+
+	Simulation.ClimbSpeed = ClimbSpeed;
+	Simulation.WallOffset = WallOffset;
+	Simulation.BatchSize = BatchSize;
+	{
+		SCOPE_CYCLE_COUNTER(STAT_ClimbCrowdUpdate);
+		TRACE_CPUPROFILER_EVENT_SCOPE(AClimbCrowd::Update);
+		CSV_SCOPED_TIMING_STAT(Climbing, CrowdUpdate);
+		Simulation.Update(*SurfaceGraph, DeltaTime);
+	}
+
+	//Promoted climbers are driven by their character, keep the crowd's copy in step
+	for (int32 Index = Simulation.Num() - 1; Index >= 0; Index--)
+	{
+		if (!EnumHasAnyFlags(Simulation.Flags[Index], EClimbCrowdFlags::Promoted))
+		{
+			continue;
+		}
+
+		ACharacter* Character = Proxies[Index].Get();
+		UClimbingMovementComponent* Movement = Character ? Cast<UClimbingMovementComponent>(Character->GetCharacterMovement()) : nullptr;
+		if (!Movement)
+		{
+			RemoveClimber(Index);
+			continue;
+		}
+
+		if (!Movement->IsClimbing() && !Movement->IsGrabPending())
+		{
+			//Mantled or fell off, from here on it is a normal character
+			RemoveClimber(Index);
+			continue;
+		}
+
+		Movement->SetClimbForwardInput(Simulation.Inputs[Index].X);
+		Movement->SetClimbRightInput(Simulation.Inputs[Index].Y);
+		Simulation.Positions[Index] = Character->GetActorLocation();
+	}
+
+	PromoteTimer -= DeltaTime;
+	if (PromoteTimer <= 0.0f)
+	{
+		PromoteTimer = PromoteInterval;
+		UpdatePromotion();
+	}
+
+	UpdateInstances();
+}
+
+void AClimbCrowd::UpdatePromotion()
+{
+	SCOPE_CYCLE_COUNTER(STAT_ClimbCrowdPromotion);
+
+	if (PromoteDistance <= 0.0f || !ProxyClass)
+	{
+		return;
+	}
+
+	TArray<FVector, TInlineAllocator<4>> Viewers;
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		if (const APawn* Pawn = It->Get() ? It->Get()->GetPawn() : nullptr)
+		{
+			Viewers.Add(Pawn->GetActorLocation());
+		}
+	}
+
+	if (Viewers.Num() == 0)
+	{
+		return;
+	}
+
+	auto GetClosestSq = [&Viewers](const FVector& Location)
+	{
+		float ClosestSq = MAX_flt;
+		for (const FVector& Viewer : Viewers)
+		{
+			ClosestSq = FMath::Min(ClosestSq, FVector::DistSquared(Viewer, Location));
+		}
+		return ClosestSq;
+	};
+
+	const float PromoteDistanceSq = FMath::Square(PromoteDistance);
+	const float DemoteDistanceSq = FMath::Square(FMath::Max(DemoteDistance, PromoteDistance));
+
+	for (int32 Index = 0; Index < Simulation.Num(); Index++)
+	{
+		const EClimbCrowdFlags Flags = Simulation.Flags[Index];
+		const float ClosestSq = GetClosestSq(Simulation.Positions[Index]);
+
+		if (EnumHasAnyFlags(Flags, EClimbCrowdFlags::Promoted))
+		{
+			if (ClosestSq > DemoteDistanceSq)
+			{
+				Demote(Index);
+			}
+		}
+		else if (EnumHasAnyFlags(Flags, EClimbCrowdFlags::Latched) && ClosestSq < PromoteDistanceSq && NumProxies < MaxProxies)
+		{
+			Promote(Index);
+		}
+	}
+}
+
+void AClimbCrowd::Promote(int32 Index)
+{
+	const FVector WallNormal = Simulation.WallNormals[Index];
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+	ACharacter* Character = GetWorld()->SpawnActor<ACharacter>(ProxyClass, Simulation.Positions[Index], (-WallNormal).Rotation(), SpawnParams);
+	UClimbingMovementComponent* Movement = Character ? Cast<UClimbingMovementComponent>(Character->GetCharacterMovement()) : nullptr;
+	if (!Movement)
+	{
+		if (Character)
+		{
+			Character->Destroy();
+		}
+		UE_LOG(LogClimb, Warning, TEXT("%s: ProxyClass needs a UClimbingMovementComponent"), *GetName());
+		ProxyClass = nullptr;
+		return;
+	}
+
+	Character->SpawnDefaultController();
+	Movement->TryGrabWall();
+
+	Simulation.Flags[Index] |= EClimbCrowdFlags::Promoted;
+	Proxies[Index] = Character;
+	NumProxies++;
+}
+
+void AClimbCrowd::Demote(int32 Index)
+{
+	ACharacter* Character = Proxies[Index].Get();
+	if (!Character || Character->IsPlayerControlled())
+	{
+		return;
+	}
+
+	//Only back into the crowd on a wall the graph knows about
+	FVector WallPoint, WallNormal;
+	const int32 Patch = SurfaceGraph->FindWall(Character->GetActorLocation(), Character->GetActorForwardVector(), WallOffset * 3.0f, WallPoint, WallNormal);
+	if (Patch == INDEX_NONE)
+	{
+		return;
+	}
+
+	Simulation.Latch(*SurfaceGraph, Index, Patch, WallPoint);
+
+	if (AController* Controller = Character->GetController())
+	{
+		Controller->Destroy();
+	}
+	Character->Destroy();
+
+	Proxies[Index] = nullptr;
+	NumProxies--;
+}
+
+void AClimbCrowd::UpdateInstances()
+{
+	SCOPE_CYCLE_COUNTER(STAT_ClimbCrowdInstances);
+
+	const int32 Count = Simulation.Num();
+	InstanceTransforms.SetNum(Count, false);
+
+	for (int32 Index = 0; Index < Count; Index++)
+	{
+		//A promoted climber is drawn by its character
+		const FVector Scale = EnumHasAnyFlags(Simulation.Flags[Index], EClimbCrowdFlags::Promoted) ? FVector::ZeroVector : FVector::OneVector;
+		InstanceTransforms[Index] = FTransform((-Simulation.WallNormals[Index]).Rotation(), Simulation.Positions[Index], Scale);
+	}
+
+	if (Count > 0)
+	{
+		Instances->BatchUpdateInstancesTransforms(0, InstanceTransforms, true, true, false);
+	}
+}
@@ -0,0 +1,185 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ClimbCrowdSimulation.h"
+#include "ClimbSurfaceGraph.h"
+#include "Async/ParallelFor.h"
+
+namespace ClimbCrowd
+{
+	FVector GetUp(const FClimbWallPatch& Patch)
+	{
+		return FVector::CrossProduct(Patch.Normal, Patch.Right);
+	}
+
+	//Point WallOffset in front of the patch, X along Right and Y along Up from its centre
+	FVector GetPoint(const FClimbWallPatch& Patch, float WallOffset, float X, float Y)
+	{
+		return Patch.Center + (Patch.Normal * WallOffset) + (Patch.Right * X) + (GetUp(Patch) * Y);
+	}
+}
+
+FClimbCrowdSimulation::FClimbCrowdSimulation()
+{
+	ClimbSpeed = 150.0f;
+	WallOffset = 25.0f;
+	BatchSize = 64;
+	bWander = true;
+}
+
+int32 FClimbCrowdSimulation::Add(const UClimbSurfaceGraph& Graph, int32 Patch, const FVector& Location, const FVector2D& Input)
+{
+	Positions.AddUninitialized();
+	WallNormals.AddUninitialized();
+	Inputs.Add(Input);
+	Patches.AddUninitialized();
+	const int32 Index = Flags.Add(EClimbCrowdFlags::None);
+
+	Latch(Graph, Index, Patch, Location);
+	return Index;
+}
+
+void FClimbCrowdSimulation::Latch(const UClimbSurfaceGraph& Graph, int32 Index, int32 Patch, const FVector& Location)
+{
+	check(Graph.Patches.IsValidIndex(Patch));
+
+	const FClimbWallPatch& WallPatch = Graph.Patches[Patch];
+	const FVector Local = Location - WallPatch.Center;
+	const float X = FMath::Clamp(FVector::DotProduct(Local, WallPatch.Right), -WallPatch.Extent.X, WallPatch.Extent.X);
+	const float Y = FMath::Clamp(FVector::DotProduct(Local, ClimbCrowd::GetUp(WallPatch)), -WallPatch.Extent.Y, WallPatch.Extent.Y);
+
+	Positions[Index] = ClimbCrowd::GetPoint(WallPatch, WallOffset, X, Y);
+	WallNormals[Index] = WallPatch.Normal;
+	Patches[Index] = Patch;
+	Flags[Index] = EClimbCrowdFlags::Latched;
+}
+
+void FClimbCrowdSimulation::RemoveAtSwap(int32 Index)
+{
+	Positions.RemoveAtSwap(Index, 1, false);
+	WallNormals.RemoveAtSwap(Index, 1, false);
+	Inputs.RemoveAtSwap(Index, 1, false);
+	Patches.RemoveAtSwap(Index, 1, false);
+	Flags.RemoveAtSwap(Index, 1, false);
+}
+
+void FClimbCrowdSimulation::Reset()
+{
+	Positions.Reset();
+	WallNormals.Reset();
+	Inputs.Reset();
+	Patches.Reset();
+	Flags.Reset();
+}
+
+void FClimbCrowdSimulation::Update(const UClimbSurfaceGraph& Graph, float DeltaTime)
+{
+	const int32 Count = Num();
+	const int32 Batch = FMath::Max(BatchSize, 1);
+	const int32 NumBatches = FMath::DivideAndRoundUp(Count, Batch);
+
+	//Each task owns a contiguous run of indices, nothing is shared but the graph
+	ParallelFor(NumBatches, [this, &Graph, DeltaTime, Count, Batch](int32 BatchIndex)
+		{
+			const int32 End = FMath::Min((BatchIndex + 1) * Batch, Count);
+			for (int32 Index = BatchIndex * Batch; Index < End; Index++)
+			{
+				UpdateClimber(Graph, Index, DeltaTime);
+			}
+		}, NumBatches == 1);
+}
+
+void FClimbCrowdSimulation::UpdateClimber(const UClimbSurfaceGraph& Graph, int32 Index, float DeltaTime)
+{
+	EClimbCrowdFlags& ClimberFlags = Flags[Index];
+	ClimberFlags &= ~EClimbCrowdFlags::Mantled;
+
+	if (!EnumHasAnyFlags(ClimberFlags, EClimbCrowdFlags::Latched) || EnumHasAnyFlags(ClimberFlags, EClimbCrowdFlags::Promoted))
+	{
+		return;
+	}
+
+	int32 Patch = Patches[Index];
+	if (!Graph.Patches.IsValidIndex(Patch))
+	{
+		//Graph was rebaked under us
+		ClimberFlags &= ~EClimbCrowdFlags::Latched;
+		return;
+	}
+
+	FVector2D& Input = Inputs[Index];
+	const FClimbWallPatch* WallPatch = &Graph.Patches[Patch];
+	const FVector Local = Positions[Index] - WallPatch->Center;
+
+	//Both axes together never go faster than one
+	const FVector2D Move = Input.GetSafeNormal() * FMath::Min(Input.Size(), 1.0f) * (ClimbSpeed * DeltaTime);
+
+	float X = FVector::DotProduct(Local, WallPatch->Right) + Move.Y;
+	float Y = FVector::DotProduct(Local, ClimbCrowd::GetUp(*WallPatch)) + Move.X;
+
+	//Top of the wall, over the ledge if there is one
+	if (Y > WallPatch->Extent.Y)
+	{
+		const int32 Ledge = Graph.GetPatchLedge(Patch);
+		if (Ledge != INDEX_NONE)
+		{
+			const FClimbLedge& TopLedge = Graph.Ledges[Ledge];
+			Positions[Index] = FMath::ClosestPointOnSegment(Positions[Index], TopLedge.Start, TopLedge.End) + TopLedge.MantleOffset;
+			Patches[Index] = INDEX_NONE;
+			ClimberFlags &= ~EClimbCrowdFlags::Latched;
+			ClimberFlags |= EClimbCrowdFlags::Mantled;
+			return;
+		}
+
+		Y = WallPatch->Extent.Y;
+		if (bWander)
+		{
+			Input.X = -FMath::Abs(Input.X);
+		}
+	}
+	else if (Y < -WallPatch->Extent.Y)
+	{
+		Y = -WallPatch->Extent.Y;
+		if (bWander)
+		{
+			Input.X = FMath::Abs(Input.X);
+		}
+	}
+
+	//Side of the wall, around the corner if there is one
+	if (FMath::Abs(X) > WallPatch->Extent.X)
+	{
+		const float Side = FMath::Sign(X);
+		const int32 Corner = Graph.GetPatchCorner(Patch, Side);
+		if (Corner != INDEX_NONE)
+		{
+			const FClimbCorner& PatchCorner = Graph.Corners[Corner];
+			const int32 NextPatch = (PatchCorner.PatchA == Patch) ? PatchCorner.PatchB : PatchCorner.PatchA;
+			const FClimbWallPatch& Next = Graph.Patches[NextPatch];
+
+			//Come in on the edge of the next patch that touches the pivot, keep the height
+			const float WorldZ = (WallPatch->Center + ClimbCrowd::GetUp(*WallPatch) * Y).Z;
+			const float NextSide = FMath::Sign(FVector::DotProduct(PatchCorner.Pivot - Next.Center, Next.Right));
+
+			Patch = NextPatch;
+			WallPatch = &Next;
+			X = NextSide * Next.Extent.X;
+			Y = FMath::Clamp(WorldZ - Next.Center.Z, -Next.Extent.Y, Next.Extent.Y);
+
+			//Keep heading away from the corner
+			Input.Y = -NextSide * FMath::Abs(Input.Y);
+		}
+		else
+		{
+			X = Side * WallPatch->Extent.X;
+			if (bWander)
+			{
+				Input.Y = -Side * FMath::Abs(Input.Y);
+			}
+		}
+	}
+
+	Patches[Index] = Patch;
+	WallNormals[Index] = WallPatch->Normal;
+	Positions[Index] = ClimbCrowd::GetPoint(*WallPatch, WallOffset, X, Y);
+}
@@ -0,0 +1,244 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ClimbDecisionBenchCommandlet.h"
+#include "FPSClimbCPPTest.h"
+#include "ClimbDecisions.h"
+#include "Tests/ClimbMockScene.h"
+#include "Math/RotationMatrix.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonWriter.h"
+#include "Serialization/JsonSerializer.h"
+
+namespace ClimbDecisionBench
+{
+	//Box field
+	const int32 NumBoxes = 64;
+	const float FieldSize = 6000.0f;
+	const float MinBoxSize = 200.0f;
+	const float MaxBoxSize = 800.0f;
+
+	//Climber, matching the defaults of UClimbingMovementComponent
+	const float ReleaseTilt = 35.0f;
+	const float StepTime = 1.0f / 60.0f;
+	const int32 NumClimbers = 32;
+
+	//Steps a climber keeps its input for
+	const int32 InputSteps = 30;
+
+	struct FClimber
+	{
+		FVector Location;
+		FRotator Rotation;
+		FVector WallNormal;
+		FClimbSurface WallSurface;
+		FVector2D Input;
+		int32 StepsLeft;
+		bool bLatched;
+	};
+
+	FClimbSnapshot TakeSnapshot(const FClimber& Climber)
+	{
+		return FClimbMockScene::TakeSnapshot(Climber.Location, Climber.Rotation);
+	}
+
+	//Stands the climber in front of a random box side and grabs it, false if the probes found nothing to hold
+	bool Spawn(FClimber& Climber, FClimbMockScene& Traces, const FClimbStepSettings& Settings, FRandomStream& Stream)
+	{
+		const TArray<FBox>& Boxes = Traces.GetBoxes();
+		const FBox& Box = Boxes[Stream.RandHelper(Boxes.Num())];
+		const FVector Extent = Box.GetExtent();
+		const int32 Side = Stream.RandHelper(4);
+		const FVector Normal = (Side == 0) ? FVector::ForwardVector : (Side == 1) ? -FVector::ForwardVector : (Side == 2) ? FVector::RightVector : -FVector::RightVector;
+		const FVector Along = FVector(-Normal.Y, Normal.X, 0.0f);
+
+		FVector Location = Box.GetCenter() + Normal * (FMath::Abs(FVector::DotProduct(Extent, Normal)) + 50.0f);
+		Location += Along * Stream.FRandRange(-0.8f, 0.8f) * FMath::Abs(FVector::DotProduct(Extent, Along));
+		Location.Z = Box.Min.Z + Settings.CapsuleHalfHeight + Stream.FRandRange(0.0f, Extent.Z);
+
+		Climber.Location = Location;
+		Climber.Rotation = FRotationMatrix::MakeFromX(Normal * -1).Rotator();
+		Climber.bLatched = false;
+
+		Traces.Reset();
+		const FClimbSnapshot Snapshot = TakeSnapshot(Climber);
+		FClimbDecisions::AddGrabProbes(Traces, Snapshot);
+
+		FClimbGrab Grab;
+		if (!FClimbDecisions::ResolveGrab(Traces, Grab))
+		{
+			return false;
+		}
+
+		//Where the attach move would end
+		Climber.Location = Grab.WallPoint + Grab.WallNormal * Settings.WallOffset;
+		Climber.Rotation = FRotationMatrix::MakeFromX(Grab.WallNormal * -1).Rotator();
+		Climber.WallNormal = Grab.WallNormal;
+		Climber.WallSurface = Grab.Surface;
+		Climber.StepsLeft = 0;
+		Climber.bLatched = true;
+		return true;
+	}
+
+	double ToNanoseconds(double Seconds, uint64 Count)
+	{
+		return (Count > 0) ? Seconds * 1.0e9 / Count : 0.0;
+	}
+}
+
+UClimbDecisionBenchCommandlet::UClimbDecisionBenchCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UClimbDecisionBenchCommandlet::Main(const FString& Params)
+{
+	int32 NumDecisions = 200000;
+	int32 Seed = 0;
+	float MinRate = 0.0f;
+	FParse::Value(*Params, TEXT("Decisions="), NumDecisions);
+	FParse::Value(*Params, TEXT("Seed="), Seed);
+	FParse::Value(*Params, TEXT("MinRate="), MinRate);
+	NumDecisions = FMath::Max(NumDecisions, 1);
+
+	FString OutputFilename = FPaths::ProjectSavedDir() / TEXT("ClimbDecisionBench.json");
+	FParse::Value(*Params, TEXT("Output="), OutputFilename);
+
+	//Boxes on a flat field, tall enough to climb and far enough apart to have corners all round
+	FRandomStream Stream(Seed);
+	FClimbMockScene Traces;
+	for (int32 Index = 0; Index < ClimbDecisionBench::NumBoxes; Index++)
+	{
+		const FVector Size(Stream.FRandRange(ClimbDecisionBench::MinBoxSize, ClimbDecisionBench::MaxBoxSize), Stream.FRandRange(ClimbDecisionBench::MinBoxSize, ClimbDecisionBench::MaxBoxSize),
+			Stream.FRandRange(ClimbDecisionBench::MinBoxSize, ClimbDecisionBench::MaxBoxSize));
+		const FVector Min(Stream.FRandRange(0.0f, ClimbDecisionBench::FieldSize), Stream.FRandRange(0.0f, ClimbDecisionBench::FieldSize), 0.0f);
+		Traces.AddBox(FBox(Min, Min + Size));
+	}
+	Traces.Build();
+
+	FClimbStepSettings Settings;
+
+	TArray<ClimbDecisionBench::FClimber> Climbers;
+	Climbers.SetNumZeroed(ClimbDecisionBench::NumClimbers);
+
+	int32 NumGrabs = 0;
+	int32 NumFailedGrabs = 0;
+	int32 NumMantles = 0;
+	int32 NumCorners = 0;
+	int32 NumReleases = 0;
+	uint64 NumStepTraces = 0;
+	double DecisionSeconds = 0.0;
+
+	for (int32 Decision = 0; Decision < NumDecisions; Decision++)
+	{
+		ClimbDecisionBench::FClimber& Climber = Climbers[Decision % Climbers.Num()];
+
+		//Grabs are timed apart, they are not what is being measured
+		while (!Climber.bLatched)
+		{
+			if (ClimbDecisionBench::Spawn(Climber, Traces, Settings, Stream))
+			{
+				NumGrabs++;
+			}
+			else
+			{
+				NumFailedGrabs++;
+			}
+		}
+
+		if (Climber.StepsLeft-- <= 0)
+		{
+			Climber.Input = FVector2D((float)(Stream.RandHelper(3) - 1), (float)(Stream.RandHelper(3) - 1));
+			Climber.StepsLeft = ClimbDecisionBench::InputSteps;
+		}
+
+		const FClimbSnapshot Snapshot = ClimbDecisionBench::TakeSnapshot(Climber);
+		Traces.Reset();
+		const uint64 TracesBefore = Traces.GetNumTraces();
+
+		FClimbStepPlan Plan;
+		const double StartTime = FPlatformTime::Seconds();
+		FClimbDecisions::EvaluateStep(Traces, Snapshot, Climber.Input, ClimbDecisionBench::StepTime, Settings, Climber.WallNormal, Climber.WallSurface, Plan);
+		DecisionSeconds += FPlatformTime::Seconds() - StartTime;
+		NumStepTraces += Traces.GetNumTraces() - TracesBefore;
+
+		//Applied the way UClimbingMovementComponent::ApplyClimbStep does, minus the collision of the move itself
+		Climber.WallNormal = Plan.WallNormal;
+		Climber.WallSurface = Plan.WallSurface;
+		if (Plan.bMantle)
+		{
+			NumMantles++;
+			Climber.bLatched = false;
+			continue;
+		}
+
+		//The wrap itself probes nothing, only where it ends matters to the next decision
+		if (Plan.bCorner)
+		{
+			NumCorners++;
+			Climber.Location = Plan.CornerTarget;
+			Climber.Rotation = Plan.CornerRotation;
+			continue;
+		}
+
+		Climber.Location += Plan.Delta.GetClampedToMaxSize(Plan.GetClimbSpeed(Settings) * ClimbDecisionBench::StepTime);
+		Climber.Rotation = Plan.Rotation;
+
+		const float MaxTilt = ClimbDecisionBench::ReleaseTilt * Climber.WallSurface.Grip;
+		if (Climber.Rotation.Pitch >= MaxTilt || Climber.Rotation.Pitch <= -MaxTilt)
+		{
+			NumReleases++;
+			Climber.bLatched = false;
+		}
+	}
+
+	//Same seed, same scene, same decisions: anything that changes this changed what the climbers decided
+	double Checksum = 0.0;
+	for (const ClimbDecisionBench::FClimber& Climber : Climbers)
+	{
+		Checksum += Climber.Location.X + Climber.Location.Y + Climber.Location.Z;
+	}
+
+	const double DecisionsPerSecond = (DecisionSeconds > 0.0) ? NumDecisions / DecisionSeconds : 0.0;
+
+	TSharedRef<FJsonObject> Report = MakeShared<FJsonObject>();
+	Report->SetNumberField(TEXT("seed"), Seed);
+	Report->SetNumberField(TEXT("boxes"), Traces.GetBoxes().Num());
+	Report->SetNumberField(TEXT("triangles"), Traces.NumTriangles());
+	Report->SetNumberField(TEXT("climbers"), Climbers.Num());
+	Report->SetNumberField(TEXT("decisions"), NumDecisions);
+	Report->SetNumberField(TEXT("decisionsPerSecond"), DecisionsPerSecond);
+	Report->SetNumberField(TEXT("nsPerDecision"), ClimbDecisionBench::ToNanoseconds(DecisionSeconds, NumDecisions));
+	Report->SetNumberField(TEXT("tracesPerDecision"), (double)NumStepTraces / NumDecisions);
+	Report->SetNumberField(TEXT("grabs"), NumGrabs);
+	Report->SetNumberField(TEXT("failedGrabs"), NumFailedGrabs);
+	Report->SetNumberField(TEXT("mantles"), NumMantles);
+	Report->SetNumberField(TEXT("corners"), NumCorners);
+	Report->SetNumberField(TEXT("releases"), NumReleases);
+	Report->SetNumberField(TEXT("checksum"), Checksum);
+
+	FString Json;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Json);
+	FJsonSerializer::Serialize(Report, Writer);
+
+	UE_LOG(LogClimb, Display, TEXT("ClimbDecisionBench: %s"), *Json);
+
+	if (!FFileHelper::SaveStringToFile(Json, *OutputFilename))
+	{
+		UE_LOG(LogClimb, Error, TEXT("ClimbDecisionBench: could not write %s"), *OutputFilename);
+		return 1;
+	}
+
+	if (DecisionsPerSecond < MinRate)
+	{
+		UE_LOG(LogClimb, Error, TEXT("ClimbDecisionBench: %.0f decisions/s is below the minimum of %.0f"), DecisionsPerSecond, MinRate);
+		return 1;
+	}
+
+	return 0;
+}
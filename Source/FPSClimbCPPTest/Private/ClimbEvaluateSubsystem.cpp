@@ -0,0 +1,140 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ClimbEvaluateSubsystem.h"
+#include "FPSClimbCPPTest.h"
+#include "ClimbingMovementComponent.h"
+#include "ClimbMemory.h"
+#include "Engine/World.h"
+#include "Engine/Level.h"
+#include "GameFramework/Actor.h"
+#include "HAL/IConsoleManager.h"
+#include "Async/ParallelFor.h"
+
+DECLARE_CYCLE_STAT(TEXT("Evaluate Phase"), STAT_ClimbEvaluatePhase, STATGROUP_Climbing);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Climbers evaluated"), STAT_ClimbEvaluated, STATGROUP_Climbing);
+
+static TAutoConsoleVariable<int32> CVarClimbParallelEvaluate(
+	TEXT("climb.ParallelEvaluate"),
+	1,
+	TEXT("0: every climbing step is probed and applied in its character's movement tick.\n")
+	TEXT("1: the first step of every latched climber is probed across worker threads ahead of the movement ticks."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarClimbParallelEvaluateMinBatch(
+	TEXT("climb.ParallelEvaluateMinBatch"),
+	4,
+	TEXT("Fewer climbers than this to evaluate are done on the game thread, the tasks would cost more than they save."),
+	ECVF_Default);
+
+void FClimbEvaluateTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (Target && TickType != LEVELTICK_ViewportsOnly)
+	{
+		Target->Evaluate();
+	}
+}
+
+FString FClimbEvaluateTickFunction::DiagnosticMessage()
+{
+	return TEXT("FClimbEvaluateTickFunction");
+}
+
+bool UClimbEvaluateSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld();
+}
+
+void UClimbEvaluateSubsystem::Deinitialize()
+{
+	if (EvaluateTick.IsTickFunctionRegistered())
+	{
+		EvaluateTick.UnRegisterTickFunction();
+	}
+
+	Climbers.Reset();
+
+	Super::Deinitialize();
+}
+
+void UClimbEvaluateSubsystem::RegisterEvaluateTick()
+{
+	//Levels exist by the time the first climber begins play, not when the subsystem is created
+	if (!EvaluateTick.IsTickFunctionRegistered())
+	{
+		EvaluateTick.Target = this;
+		EvaluateTick.TickGroup = TG_PrePhysics;
+		EvaluateTick.bCanEverTick = true;
+		EvaluateTick.bStartWithTickEnabled = true;
+		EvaluateTick.RegisterTickFunction(GetWorld()->PersistentLevel);
+	}
+}
+
+void UClimbEvaluateSubsystem::RegisterClimber(UClimbingMovementComponent* Climber)
+{
+	RegisterEvaluateTick();
+
+	Climbers.AddUnique(Climber);
+	Climber->PrimaryComponentTick.AddPrerequisite(this, EvaluateTick);
+}
+
+void UClimbEvaluateSubsystem::UnregisterClimber(UClimbingMovementComponent* Climber)
+{
+	Climbers.RemoveSwap(Climber);
+	Climber->PrimaryComponentTick.RemovePrerequisite(this, EvaluateTick);
+}
+
+void UClimbEvaluateSubsystem::AddInputSource(AActor* Source)
+{
+	if (Source)
+	{
+		RegisterEvaluateTick();
+		EvaluateTick.AddPrerequisite(Source, Source->PrimaryActorTick);
+	}
+}
+
+void UClimbEvaluateSubsystem::Evaluate()
+{
+	if (CVarClimbParallelEvaluate.GetValueOnGameThread() == 0)
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_ClimbEvaluatePhase);
+	TRACE_CPUPROFILER_EVENT_SCOPE(UClimbEvaluateSubsystem::Evaluate);
+	CSV_SCOPED_TIMING_STAT(Climbing, EvaluatePhase);
+
+	//Everything that has to happen on the game thread: picking climbers, latching their probe mode for the frame
+	//and copying what the tasks would otherwise read from the characters and the walls they hold
+	{
+		CLIMB_MEMORY_SCOPE();
+		Candidates.Reset();
+		for (UClimbingMovementComponent* Climber : Climbers)
+		{
+			if (Climber && Climber->CanPrepareClimbStep())
+			{
+				Climber->GetClimbProbes().BeginFrame();
+				if (Climber->CanPrepareClimbStep())
+				{
+					Climber->BeginPrepareClimbStep();
+					Candidates.Add(Climber);
+				}
+			}
+		}
+	}
+
+	INC_DWORD_STAT_BY(STAT_ClimbEvaluated, Candidates.Num());
+
+	//The task graph's own allocations for the tasks are not climbing's, each task counts from inside PrepareClimbStep
+	const bool bSingleThread = Candidates.Num() < CVarClimbParallelEvaluateMinBatch.GetValueOnGameThread();
+	ParallelFor(Candidates.Num(), [this](int32 Index)
+		{
+			Candidates[Index]->PrepareClimbStep();
+		}, bSingleThread);
+
+	for (UClimbingMovementComponent* Climber : Candidates)
+	{
+		Climber->EndPrepareClimbStep();
+	}
+}
@@ -0,0 +1,352 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ClimbGraphBakeCommandlet.h"
+#include "FPSClimbCPPTest.h"
+#include "ClimbSurfaceGraph.h"
+#include "ClimbProxyUserData.h"
+#include "EngineUtils.h"
+#include "Engine/World.h"
+#include "Engine/StaticMesh.h"
+#include "Components/StaticMeshComponent.h"
+#include "PhysicsEngine/BodySetup.h"
+#include "Misc/PackageName.h"
+#include "UObject/Package.h"
+
+namespace ClimbGraphBake
+{
+	//Capsule the mantle end point has to fit, matches AEngiPC
+	const float StandRadius = 25.0f;
+	const float StandHalfHeight = 55.0f;
+
+	//How close two vertical edges have to be to count as one corner
+	const float CornerTolerance = 5.0f;
+
+	bool IsClimbable(const UStaticMeshComponent* Component)
+	{
+		return Component->GetStaticMesh()
+			&& Component->IsCollisionEnabled()
+			&& Component->GetCollisionResponseToChannel(ECC_Climbable) == ECR_Block;
+	}
+
+	//Channels a static component's triangles are baked for, movable ones are left to the physics scene
+	EClimbTriangleChannel GetTriangleChannels(const UStaticMeshComponent* Component)
+	{
+		EClimbTriangleChannel Channels = EClimbTriangleChannel::None;
+		if (!Component->GetStaticMesh() || !Component->IsCollisionEnabled() || Component->Mobility != EComponentMobility::Static)
+		{
+			return Channels;
+		}
+
+		if (Component->GetCollisionResponseToChannel(ECC_Climbable) == ECR_Block)
+		{
+			Channels |= EClimbTriangleChannel::Climbable;
+		}
+		if (Component->GetCollisionResponseToChannel(ECC_Visibility) == ECR_Block)
+		{
+			Channels |= EClimbTriangleChannel::Visibility;
+		}
+		return Channels;
+	}
+
+	void AddBoxTriangles(const FTransform& BoxTransform, const FVector& HalfExtent, TArray<FVector>& OutVertices)
+	{
+		FVector Corners[8];
+		for (int32 Corner = 0; Corner < 8; Corner++)
+		{
+			const FVector Local((Corner & 1) ? HalfExtent.X : -HalfExtent.X, (Corner & 2) ? HalfExtent.Y : -HalfExtent.Y, (Corner & 4) ? HalfExtent.Z : -HalfExtent.Z);
+			Corners[Corner] = BoxTransform.TransformPosition(Local);
+		}
+
+		//Two triangles per face, corners numbered by their bits (X = 1, Y = 2, Z = 4)
+		static const int32 Faces[6][4] = { { 0, 2, 6, 4 }, { 1, 5, 7, 3 }, { 0, 4, 5, 1 }, { 2, 3, 7, 6 }, { 0, 1, 3, 2 }, { 4, 6, 7, 5 } };
+		for (const int32* Face : Faces)
+		{
+			OutVertices.Append({ Corners[Face[0]], Corners[Face[1]], Corners[Face[2]] });
+			OutVertices.Append({ Corners[Face[0]], Corners[Face[2]], Corners[Face[3]] });
+		}
+	}
+
+	//Simple collision as triangles. Boxes and convex hulls are exact, anything else is approximated by the mesh bounds
+	void GatherTriangles(const UStaticMeshComponent* Component, TArray<FVector>& OutVertices)
+	{
+		const FTransform ComponentTransform = Component->GetComponentTransform();
+		const UBodySetup* BodySetup = Component->GetStaticMesh()->GetBodySetup();
+		const int32 FirstVertex = OutVertices.Num();
+
+		if (BodySetup)
+		{
+			for (const FKBoxElem& Box : BodySetup->AggGeom.BoxElems)
+			{
+				AddBoxTriangles(Box.GetTransform() * ComponentTransform, FVector(Box.X, Box.Y, Box.Z) * 0.5f, OutVertices);
+			}
+
+			for (const FKConvexElem& Convex : BodySetup->AggGeom.ConvexElems)
+			{
+				const FTransform ConvexTransform = Convex.GetTransform() * ComponentTransform;
+				for (int32 Index = 0; Index + 2 < Convex.IndexData.Num(); Index += 3)
+				{
+					OutVertices.Append({
+						ConvexTransform.TransformPosition(Convex.VertexData[Convex.IndexData[Index]]),
+						ConvexTransform.TransformPosition(Convex.VertexData[Convex.IndexData[Index + 1]]),
+						ConvexTransform.TransformPosition(Convex.VertexData[Convex.IndexData[Index + 2]]) });
+				}
+			}
+		}
+
+		if (OutVertices.Num() == FirstVertex)
+		{
+			const FBox LocalBounds = Component->GetStaticMesh()->GetBoundingBox();
+			AddBoxTriangles(FTransform(LocalBounds.GetCenter()) * ComponentTransform, LocalBounds.GetExtent(), OutVertices);
+		}
+	}
+
+	//Climb proxy in world space, three vertices per triangle
+	void GatherProxyTriangles(const UClimbProxyUserData* Proxy, const FTransform& ComponentTransform, TArray<FVector>& OutVertices)
+	{
+		OutVertices.Reserve(OutVertices.Num() + Proxy->Vertices.Num());
+		for (const FVector& Vertex : Proxy->Vertices)
+		{
+			OutVertices.Add(ComponentTransform.TransformPosition(Vertex));
+		}
+	}
+
+	//Anything that changes what the bake would produce for this actor
+	uint32 HashActor(const AActor* Actor, const TArray<UStaticMeshComponent*>& Components)
+	{
+		uint32 Hash = GetTypeHash(Actor->GetPathName());
+		for (const UStaticMeshComponent* Component : Components)
+		{
+			const FTransform Transform = Component->GetComponentTransform();
+			Hash = HashCombine(Hash, GetTypeHash(Transform.GetLocation()));
+			Hash = HashCombine(Hash, GetTypeHash(Transform.GetRotation().Euler()));
+			Hash = HashCombine(Hash, GetTypeHash(Transform.GetScale3D()));
+			Hash = HashCombine(Hash, GetTypeHash(Component->GetStaticMesh()->GetPathName()));
+			Hash = HashCombine(Hash, GetTypeHash((int32)Component->GetCollisionResponseToChannel(ECC_Climbable)));
+			Hash = HashCombine(Hash, GetTypeHash((int32)Component->GetCollisionResponseToChannel(ECC_Visibility)));
+			Hash = HashCombine(Hash, GetTypeHash((int32)Component->Mobility));
+
+			const UClimbProxyUserData* Proxy = UClimbProxyUserData::FindForComponent(Component);
+			Hash = HashCombine(Hash, Proxy ? Proxy->SourceHash : 0);
+		}
+		return Hash;
+	}
+}
+
+UClimbGraphBakeCommandlet::UClimbGraphBakeCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UClimbGraphBakeCommandlet::Main(const FString& Params)
+{
+#if WITH_EDITOR
+	FString MapName;
+	if (!FParse::Value(*Params, TEXT("Map="), MapName))
+	{
+		MapName = TEXT("/Game/TestLevel");
+	}
+	const bool bFull = FParse::Param(*Params, TEXT("Full"));
+
+	UPackage* MapPackage = LoadPackage(nullptr, *MapName, LOAD_None);
+	UWorld* World = MapPackage ? UWorld::FindWorldInPackage(MapPackage) : nullptr;
+	if (!World)
+	{
+		UE_LOG(LogClimb, Error, TEXT("ClimbGraphBake: could not load map %s"), *MapName);
+		return 1;
+	}
+
+	//Components need to be registered for their world transforms and the physics scene for the clearance tests
+	World->WorldType = EWorldType::Editor;
+	World->AddToRoot();
+	if (!World->bIsWorldInitialized)
+	{
+		UWorld::InitializationValues IVS;
+		IVS.RequiresHitProxies(false).ShouldSimulatePhysics(false).EnableTraceCollision(true).CreateNavigation(false).CreateAISystem(false).AllowAudioPlayback(false).CreatePhysicsScene(true);
+		World->InitWorld(IVS);
+		World->PersistentLevel->UpdateModelComponents();
+		World->UpdateWorldComponents(true, false);
+	}
+
+	//Re-bake on top of the last graph unless asked not to
+	const FString GraphPackageName = UClimbSurfaceGraph::GetGraphPackageName(MapName);
+	const FString GraphAssetName = FPackageName::GetLongPackageAssetName(GraphPackageName);
+
+	UPackage* GraphPackage = FPackageName::DoesPackageExist(GraphPackageName) ? LoadPackage(nullptr, *GraphPackageName, LOAD_None) : nullptr;
+	if (!GraphPackage)
+	{
+		GraphPackage = CreatePackage(nullptr, *GraphPackageName);
+	}
+
+	UClimbSurfaceGraph* Graph = FindObject<UClimbSurfaceGraph>(GraphPackage, *GraphAssetName);
+	if (!Graph)
+	{
+		Graph = NewObject<UClimbSurfaceGraph>(GraphPackage, *GraphAssetName, RF_Public | RF_Standalone);
+	}
+	else if (bFull)
+	{
+		Graph->Patches.Reset();
+		Graph->Ledges.Reset();
+		Graph->Corners.Reset();
+		Graph->BakedActors.Reset();
+		Graph->Triangles.Reset();
+		Graph->TriangleMaterials.Reset();
+	}
+
+	float CellSize = Graph->CellSize;
+	if (FParse::Value(*Params, TEXT("CellSize="), CellSize))
+	{
+		Graph->CellSize = FMath::Max(CellSize, 50.0f);
+	}
+
+	const FCollisionShape StandShape = FCollisionShape::MakeCapsule(ClimbGraphBake::StandRadius, ClimbGraphBake::StandHalfHeight);
+
+	TSet<int32> SeenSources;
+	int32 NumBaked = 0;
+	int32 NumSkipped = 0;
+
+	for (TActorIterator<AActor> It(World); It; ++It)
+	{
+		AActor* Actor = *It;
+
+		TArray<UStaticMeshComponent*> Components;
+		Actor->GetComponents<UStaticMeshComponent>(Components);
+		Components.RemoveAll([](const UStaticMeshComponent* Component)
+			{
+				return !ClimbGraphBake::IsClimbable(Component) && ClimbGraphBake::GetTriangleChannels(Component) == EClimbTriangleChannel::None;
+			});
+		if (Components.Num() == 0)
+		{
+			continue;
+		}
+
+		const FString ActorPath = Actor->GetPathName();
+		const uint32 Hash = ClimbGraphBake::HashActor(Actor, Components);
+
+		int32 Source = Graph->BakedActors.IndexOfByPredicate([&ActorPath](const FClimbBakedActor& Baked) { return Baked.ActorPath == ActorPath; });
+
+		if (Source != INDEX_NONE && Graph->BakedActors[Source].Hash == Hash)
+		{
+			SeenSources.Add(Source);
+			NumSkipped++;
+			continue;
+		}
+
+		if (Source != INDEX_NONE)
+		{
+			Graph->RemoveSource(Source);
+		}
+		else
+		{
+			//Reuse the slot of an actor that is gone
+			Source = Graph->BakedActors.IndexOfByPredicate([](const FClimbBakedActor& Baked) { return Baked.ActorPath.IsEmpty(); });
+			if (Source == INDEX_NONE)
+			{
+				Source = Graph->BakedActors.AddDefaulted();
+			}
+		}
+		SeenSources.Add(Source);
+
+		Graph->BakedActors[Source].ActorPath = ActorPath;
+		Graph->BakedActors[Source].Hash = Hash;
+
+		for (const UStaticMeshComponent* Component : Components)
+		{
+			EClimbTriangleChannel Channels = ClimbGraphBake::GetTriangleChannels(Component);
+
+			//Wall probes get the climb proxy, everything else keeps the simple collision
+			const UClimbProxyUserData* Proxy = UClimbProxyUserData::FindForComponent(Component);
+			if (Proxy && EnumHasAnyFlags(Channels, EClimbTriangleChannel::Climbable))
+			{
+				TArray<FVector> Vertices;
+				ClimbGraphBake::GatherProxyTriangles(Proxy, Component->GetComponentTransform(), Vertices);
+				Graph->AddTriangles(Source, Vertices, Component->BodyInstance.GetSimplePhysicalMaterial(), EClimbTriangleChannel::Climbable, true);
+				Channels &= ~EClimbTriangleChannel::Climbable;
+			}
+
+			if (Channels != EClimbTriangleChannel::None)
+			{
+				TArray<FVector> Vertices;
+				ClimbGraphBake::GatherTriangles(Component, Vertices);
+				Graph->AddTriangles(Source, Vertices, Component->BodyInstance.GetSimplePhysicalMaterial(), Channels);
+			}
+
+			//Only climbable components have walls and ledges
+			if (!ClimbGraphBake::IsClimbable(Component))
+			{
+				continue;
+			}
+
+			const FTransform ComponentTransform = Component->GetComponentTransform();
+			const UBodySetup* BodySetup = Component->GetStaticMesh()->GetBodySetup();
+
+			//Box collision is exact, anything else is approximated by the mesh bounds
+			if (BodySetup && BodySetup->AggGeom.BoxElems.Num() > 0)
+			{
+				for (const FKBoxElem& Box : BodySetup->AggGeom.BoxElems)
+				{
+					const FTransform BoxTransform = Box.GetTransform() * ComponentTransform;
+					Graph->AddBox(Source, BoxTransform, FVector(Box.X, Box.Y, Box.Z) * 0.5f, ClimbGraphBake::StandHalfHeight, ClimbGraphBake::StandRadius);
+				}
+			}
+			else
+			{
+				const FBox LocalBounds = Component->GetStaticMesh()->GetBoundingBox();
+				const FTransform BoxTransform = FTransform(LocalBounds.GetCenter()) * ComponentTransform;
+				Graph->AddBox(Source, BoxTransform, LocalBounds.GetExtent(), ClimbGraphBake::StandHalfHeight, ClimbGraphBake::StandRadius);
+			}
+		}
+
+		NumBaked++;
+	}
+
+	//Actors deleted since the last bake
+	int32 NumRemoved = 0;
+	for (int32 Source = 0; Source < Graph->BakedActors.Num(); Source++)
+	{
+		if (!SeenSources.Contains(Source) && !Graph->BakedActors[Source].ActorPath.IsEmpty())
+		{
+			Graph->RemoveSource(Source);
+			Graph->BakedActors[Source] = FClimbBakedActor();
+			NumRemoved++;
+		}
+	}
+
+	//Ledges with no room to stand on top are not ledges. Every ledge is checked again, kept actors included,
+	//what blocks or frees the top of one may be an actor that changed or is gone, or one that is not baked at all
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(ClimbGraphBake), false);
+	int32 NumBlockedLedges = 0;
+	for (FClimbLedge& Ledge : Graph->Ledges)
+	{
+		const FVector MantlePoint = (Ledge.Start + Ledge.End) * 0.5f + Ledge.MantleOffset;
+		Ledge.bBlocked = World->OverlapBlockingTestByChannel(MantlePoint, FQuat::Identity, ECC_Pawn, StandShape, QueryParams);
+		NumBlockedLedges += Ledge.bBlocked ? 1 : 0;
+	}
+
+	Graph->BuildSpatialHash();
+	Graph->BuildCorners(ClimbGraphBake::CornerTolerance);
+
+	UE_LOG(LogClimb, Display, TEXT("ClimbGraphBake: %s baked %d actors, kept %d, removed %d -> %d patches, %d ledges (%d blocked), %d corners, %d triangles (%d KB tree)"),
+		*MapName, NumBaked, NumSkipped, NumRemoved, Graph->Patches.Num(), Graph->Ledges.Num() - NumBlockedLedges, NumBlockedLedges, Graph->Corners.Num(), Graph->Triangles.Num(),
+		(int32)(Graph->GetTriangleBVH().GetAllocatedSize() / 1024));
+
+	GraphPackage->MarkPackageDirty();
+	const FString Filename = FPackageName::LongPackageNameToFilename(GraphPackageName, FPackageName::GetAssetPackageExtension());
+	const bool bSaved = UPackage::SavePackage(GraphPackage, Graph, RF_Public | RF_Standalone, *Filename);
+
+	World->RemoveFromRoot();
+
+	if (!bSaved)
+	{
+		UE_LOG(LogClimb, Error, TEXT("ClimbGraphBake: could not save %s"), *Filename);
+		return 1;
+	}
+
+	return 0;
+#else
+	return 1;
+#endif
+}
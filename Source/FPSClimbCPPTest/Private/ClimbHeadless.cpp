@@ -0,0 +1,88 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ClimbHeadless.h"
+#include "Components/InputComponent.h"
+#include "GameFramework/WorldSettings.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+
+UWorld* ClimbHeadless::LoadGameWorld(const FString& MapName)
+{
+	UPackage* MapPackage = LoadPackage(nullptr, *MapName, LOAD_None);
+	UWorld* World = MapPackage ? UWorld::FindWorldInPackage(MapPackage) : nullptr;
+	if (!World)
+	{
+		return nullptr;
+	}
+
+	World->WorldType = EWorldType::Game;
+	World->AddToRoot();
+
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+
+	if (!World->bIsWorldInitialized)
+	{
+		UWorld::InitializationValues IVS;
+		IVS.RequiresHitProxies(false).ShouldSimulatePhysics(true).EnableTraceCollision(true).CreateNavigation(false).CreateAISystem(false).AllowAudioPlayback(false).CreatePhysicsScene(true);
+		World->InitWorld(IVS);
+	}
+
+	const FURL URL;
+	World->InitializeActorsForPlay(URL);
+	World->GetWorldSettings()->NotifyBeginPlay();
+	return World;
+}
+
+void ClimbHeadless::DestroyGameWorld(UWorld* World)
+{
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+	World->RemoveFromRoot();
+}
+
+void ClimbHeadless::SetAxis(UInputComponent* Input, FName Axis, float Value)
+{
+	for (FInputAxisBinding& Binding : Input->AxisBindings)
+	{
+		if (Binding.AxisName == Axis)
+		{
+			Binding.AxisDelegate.Execute(Value);
+		}
+	}
+}
+
+void ClimbHeadless::SetAction(UInputComponent* Input, FName Action, bool bPressed)
+{
+	const EInputEvent KeyEvent = bPressed ? IE_Pressed : IE_Released;
+	for (int32 Index = 0; Index < Input->GetNumActionBindings(); Index++)
+	{
+		FInputActionBinding& Binding = Input->GetActionBinding(Index);
+		if (Binding.GetActionName() == Action && Binding.KeyEvent == KeyEvent)
+		{
+			Binding.ActionDelegate.Execute(EKeys::Invalid);
+		}
+	}
+}
+
+bool ClimbHeadless::IsAction(UInputComponent* Input, FName Action)
+{
+	for (int32 Index = 0; Index < Input->GetNumActionBindings(); Index++)
+	{
+		if (Input->GetActionBinding(Index).GetActionName() == Action)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+float ClimbHeadless::Percentile(const TArray<double>& Sorted, float Fraction)
+{
+	if (Sorted.Num() == 0)
+	{
+		return 0.0f;
+	}
+	return (float)Sorted[FMath::Clamp(FMath::FloorToInt(Sorted.Num() * Fraction), 0, Sorted.Num() - 1)];
+}
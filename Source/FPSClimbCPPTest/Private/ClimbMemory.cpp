@@ -0,0 +1,150 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ClimbMemory.h"
+#include "FPSClimbCPPTest.h"
+#include "HAL/MemoryBase.h"
+#include "Templates/Atomic.h"
+#include "Misc/CommandLine.h"
+
+namespace ClimbMemory
+{
+	thread_local bool bInCountedScope = false;
+	TAtomic<bool> bCounting(false);
+	TAtomic<uint64> NumAllocs(0);
+
+	FORCEINLINE void CountAlloc()
+	{
+		if (bInCountedScope && bCounting.Load(EMemoryOrder::Relaxed))
+		{
+			NumAllocs++;
+		}
+	}
+
+	//Forwards everything to the allocator it wraps, counting the calls that hand out memory
+	class FCountingMalloc final : public FMalloc
+	{
+	public:
+		explicit FCountingMalloc(FMalloc* InInner)
+			: Inner(InInner)
+		{
+		}
+
+		virtual void* Malloc(SIZE_T Count, uint32 Alignment) override
+		{
+			CountAlloc();
+			return Inner->Malloc(Count, Alignment);
+		}
+
+		virtual void* TryMalloc(SIZE_T Count, uint32 Alignment) override
+		{
+			CountAlloc();
+			return Inner->TryMalloc(Count, Alignment);
+		}
+
+		virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			if (Count > 0)
+			{
+				CountAlloc();
+			}
+			return Inner->Realloc(Original, Count, Alignment);
+		}
+
+		virtual void* TryRealloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			if (Count > 0)
+			{
+				CountAlloc();
+			}
+			return Inner->TryRealloc(Original, Count, Alignment);
+		}
+
+		virtual void Free(void* Original) override { Inner->Free(Original); }
+		virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override { return Inner->QuantizeSize(Count, Alignment); }
+		virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override { return Inner->GetAllocationSize(Original, SizeOut); }
+		virtual void Trim(bool bTrimThreadCaches) override { Inner->Trim(bTrimThreadCaches); }
+		virtual void SetupTLSCachesOnCurrentThread() override { Inner->SetupTLSCachesOnCurrentThread(); }
+		virtual void ClearAndDisableTLSCachesOnCurrentThread() override { Inner->ClearAndDisableTLSCachesOnCurrentThread(); }
+		virtual void InitializeStatsMetadata() override { Inner->InitializeStatsMetadata(); }
+		virtual void UpdateStats() override { Inner->UpdateStats(); }
+		virtual void GetAllocatorStats(FGenericMemoryStats& OutStats) override { Inner->GetAllocatorStats(OutStats); }
+		virtual void DumpAllocatorStats(FOutputDevice& Ar) override { Inner->DumpAllocatorStats(Ar); }
+		virtual bool IsInternallyThreadSafe() const override { return Inner->IsInternallyThreadSafe(); }
+		virtual bool ValidateHeap() override { return Inner->ValidateHeap(); }
+		virtual const TCHAR* GetDescriptiveName() override { return Inner->GetDescriptiveName(); }
+
+	private:
+		FMalloc* Inner;
+	};
+
+	TAtomic<FCountingMalloc*> CountingMalloc(nullptr);
+	TAtomic<bool> bInstallStarted(false);
+}
+
+void FClimbAllocCounter::InstallIfRequested()
+{
+	if (!FParse::Param(FCommandLine::Get(), TEXT("ClimbCountAllocs")) || ClimbMemory::bInstallStarted.Exchange(true))
+	{
+		return;
+	}
+
+	//Other threads are already allocating, swap only if GMalloc is still what the proxy was made to wrap
+	ClimbMemory::FCountingMalloc* Proxy = nullptr;
+	for (;;)
+	{
+		FMalloc* Original = GMalloc;
+		delete Proxy;
+		Proxy = new ClimbMemory::FCountingMalloc(Original);
+		if (FPlatformAtomics::InterlockedCompareExchangePointer((void**)&GMalloc, Proxy, Original) == Original)
+		{
+			break;
+		}
+	}
+
+	ClimbMemory::CountingMalloc = Proxy;
+	UE_LOG(LogClimb, Log, TEXT("Counting climbing allocations through %s"), Proxy->GetDescriptiveName());
+}
+
+bool FClimbAllocCounter::IsInstalled()
+{
+	return ClimbMemory::CountingMalloc.Load() != nullptr;
+}
+
+bool FClimbAllocCounter::Start()
+{
+	if (!IsInstalled())
+	{
+		return false;
+	}
+
+	ClimbMemory::NumAllocs = 0;
+	ClimbMemory::bCounting = true;
+	return true;
+}
+
+void FClimbAllocCounter::Stop()
+{
+	ClimbMemory::bCounting = false;
+}
+
+bool FClimbAllocCounter::IsCounting()
+{
+	return ClimbMemory::bCounting.Load(EMemoryOrder::Relaxed);
+}
+
+uint64 FClimbAllocCounter::GetCount()
+{
+	return ClimbMemory::NumAllocs.Load();
+}
+
+FClimbAllocScope::FClimbAllocScope(bool bCount)
+	: bWasCounted(ClimbMemory::bInCountedScope)
+{
+	ClimbMemory::bInCountedScope = bCount;
+}
+
+FClimbAllocScope::~FClimbAllocScope()
+{
+	ClimbMemory::bInCountedScope = bWasCounted;
+}
@@ -0,0 +1,27 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ClimbPhysicalMaterial.h"
+
+UClimbPhysicalMaterial::UClimbPhysicalMaterial()
+{
+	bClimbable = true;
+	ClimbSpeedScale = 1.0f;
+	Grip = 1.0f;
+	bTraceComplex = false;
+}
+
+FClimbSurface UClimbPhysicalMaterial::GetSurface(const FHitResult& Hit)
+{
+	FClimbSurface Surface;
+
+	if (const UClimbPhysicalMaterial* Material = Cast<UClimbPhysicalMaterial>(Hit.PhysMaterial.Get()))
+	{
+		Surface.bClimbable = Material->bClimbable;
+		Surface.bTraceComplex = Material->bTraceComplex;
+		Surface.ClimbSpeedScale = Material->ClimbSpeedScale;
+		Surface.Grip = Material->Grip;
+	}
+
+	return Surface;
+}
@@ -0,0 +1,817 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ClimbProbeBatch.h"
+#include "FPSClimbCPPTest.h"
+#include "ClimbPhysicalMaterial.h"
+#include "ClimbProxyUserData.h"
+#include "ClimbSurfaceGraph.h"
+#include "ClimbTriangleBVH.h"
+#include "ClimbQuerySchedulerSubsystem.h"
+#include "ClimbMemory.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "Components/PrimitiveComponent.h"
+#include "HAL/IConsoleManager.h"
+#include "DrawDebugHelpers.h"
+
+DECLARE_CYCLE_STAT(TEXT("Probe BeginFrame"), STAT_ClimbProbeBeginFrame, STATGROUP_Climbing);
+DECLARE_CYCLE_STAT(TEXT("Probe Flush"), STAT_ClimbProbeFlush, STATGROUP_Climbing);
+DECLARE_CYCLE_STAT(TEXT("Probe Trace"), STAT_ClimbProbeTrace, STATGROUP_Climbing);
+DECLARE_CYCLE_STAT(TEXT("Probe Triangles"), STAT_ClimbProbeTriangles, STATGROUP_Climbing);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Line traces"), STAT_ClimbLineTraces, STATGROUP_Climbing);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Sweeps"), STAT_ClimbSweeps, STATGROUP_Climbing);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Triangle queries"), STAT_ClimbTriangleQueries, STATGROUP_Climbing);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Proxy queries"), STAT_ClimbProxyQueries, STATGROUP_Climbing);
+
+static TAutoConsoleVariable<int32> CVarClimbAsyncProbes(
+	TEXT("climb.AsyncProbes"),
+	0,
+	TEXT("0: climb probes are traced synchronously on the game thread when needed.\n")
+	TEXT("1: climb probes are batched per frame and traced asynchronously, results are used on the next frame."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarClimbDebugDraw(
+	TEXT("climb.DebugDraw"),
+	0,
+	TEXT("Draws every climb probe when it resolves, green where it hit and red where it missed."),
+	ECVF_Cheat);
+
+static TAutoConsoleVariable<int32> CVarClimbRecordProbes(
+	TEXT("climb.RecordProbes"),
+	0,
+	TEXT("Probes each climber keeps in its ring of recent probes, 0 records nothing.\n")
+	TEXT("See climb.DrawProbes, climb.DumpProbes and climb.DrawProbeDump."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarClimbTriangleProbes(
+	TEXT("climb.TriangleProbes"),
+	0,
+	TEXT("Answer climb probes from the static collision triangles baked into the level's climb graph instead of the physics scene.\n")
+	TEXT("Movable actors and other characters are not in the bake. Surfaces that trace complex still go to the physics scene, unless their mesh was baked from its climb proxy."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarClimbProxies(
+	TEXT("climb.Proxies"),
+	1,
+	TEXT("Wall probes that hit a mesh with a climb proxy are answered from the proxy instead of tracing complex, see UClimbProxyCommandlet."),
+	ECVF_Default);
+
+namespace ClimbProbe
+{
+	//Counts one physics query in the stats and csv captures
+	void CountQuery(const FCollisionShape& Shape)
+	{
+		if (Shape.IsLine())
+		{
+			INC_DWORD_STAT(STAT_ClimbLineTraces);
+			CSV_CUSTOM_STAT(Climbing, LineTraces, 1, ECsvCustomStatOp::Accumulate);
+		}
+		else
+		{
+			INC_DWORD_STAT(STAT_ClimbSweeps);
+			CSV_CUSTOM_STAT(Climbing, Sweeps, 1, ECsvCustomStatOp::Accumulate);
+		}
+	}
+
+	//Counts queries answered from the baked triangles
+	void CountTriangleQueries(int32 Count)
+	{
+		INC_DWORD_STAT_BY(STAT_ClimbTriangleQueries, Count);
+		CSV_CUSTOM_STAT(Climbing, TriangleQueries, Count, ECsvCustomStatOp::Accumulate);
+	}
+
+	uint8 GetTriangleChannels(EClimbProbe Probe)
+	{
+		return (uint8)(FClimbProbeBatch::IsWallProbe(Probe) ? EClimbTriangleChannel::Climbable : EClimbTriangleChannel::Visibility);
+	}
+}
+
+TAtomic<uint64> FClimbProbeBatch::NumTraces(0);
+
+FClimbProbeBatch::FClimbProbeBatch()
+	: QueryParams(SCENE_QUERY_STAT(ClimbProbe), false)
+	, ComplexQueryParams(SCENE_QUERY_STAT(ClimbProbeComplex), true)
+	, WorkerWorld(nullptr)
+	, WorkerGraph(nullptr)
+	, bWorkerFrame(false)
+	, bMissedWorkerSnapshot(false)
+	, FrameNumber(0)
+	, bAsync(false)
+{
+	Reset();
+}
+
+void FClimbProbeBatch::Init(AActor* InOwner)
+{
+	Owner = InOwner;
+	World = InOwner->GetWorld();
+
+	QueryParams.ClearIgnoredActors();
+	QueryParams.AddIgnoredActor(InOwner);
+	QueryParams.bTraceComplex = false;
+	QueryParams.bReturnPhysicalMaterial = true;
+
+	ComplexQueryParams.ClearIgnoredActors();
+	ComplexQueryParams.AddIgnoredActor(InOwner);
+	ComplexQueryParams.bTraceComplex = true;
+	ComplexQueryParams.bReturnPhysicalMaterial = true;
+
+	IgnoredActors.Reset();
+
+	Reset();
+}
+
+void FClimbProbeBatch::SetIgnoredActors(TArrayView<AActor* const> Actors)
+{
+	bool bChanged = Actors.Num() != IgnoredActors.Num();
+	for (int32 Index = 0; !bChanged && Index < Actors.Num(); Index++)
+	{
+		bChanged = Actors[Index] != IgnoredActors[Index];
+	}
+
+	if (!bChanged)
+	{
+		return;
+	}
+
+	//Reset keeps the lists' memory, a crowd coming and going settles on the biggest it has seen
+	IgnoredActors.Reset();
+	QueryParams.ClearIgnoredActors();
+	ComplexQueryParams.ClearIgnoredActors();
+
+	QueryParams.AddIgnoredActor(Owner.Get());
+	ComplexQueryParams.AddIgnoredActor(Owner.Get());
+	for (AActor* Actor : Actors)
+	{
+		IgnoredActors.Add(Actor);
+		QueryParams.AddIgnoredActor(Actor);
+		ComplexQueryParams.AddIgnoredActor(Actor);
+	}
+}
+
+void FClimbProbeBatch::Reset()
+{
+	for (FSlot& Slot : Slots)
+	{
+		Slot.Start = FVector::ZeroVector;
+		Slot.End = FVector::ZeroVector;
+		Slot.Shape = FCollisionShape();
+		Slot.Intent = 0;
+		Slot.bAdded = false;
+		Slot.Handle = FTraceHandle();
+		Slot.HandleTransform = FTransform::Identity;
+		Slot.HandleIntent = 0;
+		Slot.bHandleAnswered = false;
+		Slot.Hit = FHitResult();
+		Slot.ResultIntent = 0;
+		Slot.bResolved = false;
+		Slot.bHit = false;
+		Slot.bComplex = false;
+		Slot.bTracedComplex = false;
+		Slot.bProxy = false;
+	}
+
+	ContactCache.Invalidate();
+}
+
+void FClimbProbeBatch::BeginFrame()
+{
+	if (FrameNumber == GFrameCounter)
+	{
+		return;
+	}
+	FrameNumber = GFrameCounter;
+
+	SCOPE_CYCLE_COUNTER(STAT_ClimbProbeBeginFrame);
+	CLIMB_MEMORY_SCOPE();
+
+	// Recording is latched here too, and is a null check while off
+	const int32 RecordSize = CVarClimbRecordProbes.GetValueOnGameThread();
+	if (RecordSize <= 0)
+	{
+		Recorder.Reset();
+	}
+	else if (!Recorder || Recorder->GetCapacity() != RecordSize)
+	{
+		Recorder = MakeUnique<FClimbProbeRecorder>(RecordSize);
+	}
+
+	// Mode is latched once per frame so a batch is never half sync and half async
+	const bool bWantAsync = CVarClimbAsyncProbes.GetValueOnGameThread() != 0 || UClimbQuerySchedulerSubsystem::IsBudgeted();
+	if (bWantAsync != bAsync)
+	{
+		bAsync = bWantAsync;
+		Reset();
+		return;
+	}
+
+	UWorld* OwningWorld = World.Get();
+
+	for (FSlot& Slot : Slots)
+	{
+		Slot.bAdded = false;
+
+		if (!bAsync)
+		{
+			Slot.bResolved = false;
+			continue;
+		}
+
+		// Whatever was in flight last frame becomes this frame's result
+		Slot.bResolved = false;
+		if (Slot.bHandleAnswered)
+		{
+			// Flush already answered it from the cache or the baked triangles, Hit and bHit hold it
+			Slot.bResolved = true;
+			Slot.ResultIntent = Slot.HandleIntent;
+		}
+		else if (Slot.Handle.IsValid() && OwningWorld)
+		{
+			FTraceDatum Datum;
+			if (OwningWorld->QueryTraceData(Slot.Handle, Datum))
+			{
+				const EClimbProbe Probe = (EClimbProbe)(&Slot - Slots);
+
+				Slot.bResolved = true;
+				Slot.bHit = Datum.OutHits.Num() > 0 && Datum.OutHits[0].bBlockingHit;
+				Slot.Hit = Slot.bHit ? Datum.OutHits[0] : FHitResult();
+				Slot.ResultIntent = Slot.HandleIntent;
+
+				//A surface that wants complex tracing gets it from the next batch on, this answer stands
+				Slot.bComplex = ApplySurface(Probe, Slot);
+
+				FTransform ComponentTransform;
+				GetComponentTransform(Slot.Hit, ComponentTransform);
+				ContactCache.Store(Probe, Slot.HandleIntent, Slot.Start, Slot.End, Slot.HandleTransform, Slot.bHit, Slot.Hit, ComponentTransform);
+				Record(Probe, Slot, EClimbProbeSource::Scene, true);
+			}
+		}
+		Slot.Handle = FTraceHandle();
+		Slot.bHandleAnswered = false;
+	}
+}
+
+void FClimbProbeBatch::AddLine(EClimbProbe Probe, const FVector& Start, const FVector& End, int8 Intent)
+{
+	AddSweep(Probe, Start, End, FCollisionShape(), Intent);
+}
+
+void FClimbProbeBatch::AddSweep(EClimbProbe Probe, const FVector& Start, const FVector& End, const FCollisionShape& Shape, int8 Intent)
+{
+	FSlot& Slot = Slots[(int32)Probe];
+	Slot.Start = Start;
+	Slot.End = End;
+	Slot.Shape = Shape;
+	Slot.Intent = Intent;
+	Slot.bAdded = true;
+
+	// In sync mode new geometry means the old answer no longer applies
+	if (!bAsync)
+	{
+		Slot.bResolved = false;
+	}
+}
+
+bool FClimbProbeBatch::HasResult(EClimbProbe Probe, int8 Intent) const
+{
+	if (!bAsync)
+	{
+		return true;
+	}
+
+	const FSlot& Slot = Slots[(int32)Probe];
+	return Slot.bResolved && Slot.ResultIntent == Intent;
+}
+
+bool FClimbProbeBatch::HasResults(std::initializer_list<EClimbProbe> Probes, int8 Intent) const
+{
+	for (EClimbProbe Probe : Probes)
+	{
+		if (!HasResult(Probe, Intent))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool FClimbProbeBatch::IsHit(EClimbProbe Probe)
+{
+	FSlot& Slot = Slots[(int32)Probe];
+
+	if (!bAsync && !Slot.bResolved && Slot.bAdded)
+	{
+		const FTransform OwnerTransform = GetOwnerTransform();
+		if (ContactCache.Find(Probe, Slot.Intent, Slot.Start, Slot.End, OwnerTransform, Slot.Hit))
+		{
+			Slot.bHit = true;
+			Slot.ResultIntent = Slot.Intent;
+			Slot.bResolved = true;
+			Record(Probe, Slot, EClimbProbeSource::Cache, false);
+		}
+		else
+		{
+			Trace(Probe, Slot);
+
+			FTransform ComponentTransform;
+			const bool bKnown = GetComponentTransform(Slot.Hit, ComponentTransform);
+			ContactCache.Store(Probe, Slot.Intent, Slot.Start, Slot.End, OwnerTransform, Slot.bHit && bKnown, Slot.Hit, ComponentTransform);
+		}
+	}
+
+	return Slot.bResolved && Slot.bHit;
+}
+
+const FHitResult& FClimbProbeBatch::GetHit(EClimbProbe Probe) const
+{
+	return Slots[(int32)Probe].Hit;
+}
+
+FClimbSurface FClimbProbeBatch::GetSurface(EClimbProbe Probe) const
+{
+	return FindSurface(Slots[(int32)Probe].Hit);
+}
+
+void FClimbProbeBatch::BeginWorkerFrame()
+{
+	check(IsInGameThread());
+
+	//Reset keeps the memory, after warmup this allocates nothing
+	WorkerComponents.Reset();
+	WorkerSurfaces.Reset();
+
+	//A climber holds on to the same few walls step after step, what it hit last is what it will hit next
+	for (const FSlot& Slot : Slots)
+	{
+		if (!Slot.bHit)
+		{
+			continue;
+		}
+
+		UPrimitiveComponent* Component = Slot.Hit.GetComponent();
+		if (Component && !WorkerComponents.ContainsByPredicate([Component](const FWorkerComponent& Entry) { return Entry.Component == Component; }))
+		{
+			WorkerComponents.Add({ Component, Component->GetComponentTransform(), UClimbProxyUserData::FindForComponent(Component) });
+		}
+
+		UPhysicalMaterial* Material = Slot.Hit.PhysMaterial.Get();
+		if (Material && !WorkerSurfaces.ContainsByPredicate([Material](const FWorkerSurface& Entry) { return Entry.Material == Material; }))
+		{
+			WorkerSurfaces.Add({ Material, UClimbPhysicalMaterial::GetSurface(Slot.Hit) });
+		}
+	}
+
+	//Cached contacts on walls that moved since are dropped here, the rest are taken as they are
+	ContactCache.CheckComponents();
+
+	WorkerOwnerTransform = GetOwnerTransform();
+	WorkerWorld = World.Get();
+	WorkerGraph = SurfaceGraph.Get();
+	bMissedWorkerSnapshot = false;
+	bWorkerFrame = true;
+}
+
+void FClimbProbeBatch::EndWorkerFrame()
+{
+	check(IsInGameThread());
+
+	bWorkerFrame = false;
+	ContactCache.EndComponentCheck();
+}
+
+int32 FClimbProbeBatch::NumPending() const
+{
+	int32 Num = 0;
+	for (const FSlot& Slot : Slots)
+	{
+		Num += Slot.bAdded ? 1 : 0;
+	}
+	return Num;
+}
+
+int32 FClimbProbeBatch::Flush()
+{
+	UWorld* OwningWorld = World.Get();
+	if (!bAsync || !OwningWorld)
+	{
+		return 0;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_ClimbProbeFlush);
+	TRACE_CPUPROFILER_EVENT_SCOPE(FClimbProbeBatch::Flush);
+	CLIMB_MEMORY_SCOPE();
+
+	const FTransform OwnerTransform = GetOwnerTransform();
+
+	//Line probes the baked triangles can answer go through the tree together
+	TArray<FClimbRay, TInlineAllocator<(int32)EClimbProbe::Count>> Rays;
+	TArray<int32, TInlineAllocator<(int32)EClimbProbe::Count>> RaySlots;
+	int32 NumQueries = 0;
+
+	for (int32 Index = 0; Index < (int32)EClimbProbe::Count; Index++)
+	{
+		FSlot& Slot = Slots[Index];
+		if (!Slot.bAdded)
+		{
+			continue;
+		}
+
+		Slot.HandleIntent = Slot.Intent;
+		Slot.HandleTransform = OwnerTransform;
+		Slot.bAdded = false;
+
+		//Nothing to send if the wall is still where we left it
+		if (ContactCache.Find((EClimbProbe)Index, Slot.Intent, Slot.Start, Slot.End, OwnerTransform, Slot.Hit))
+		{
+			Slot.bHandleAnswered = true;
+			Slot.bHit = true;
+			Record((EClimbProbe)Index, Slot, EClimbProbeSource::Cache, true);
+			continue;
+		}
+
+		if (CanQueryTriangles(Slot))
+		{
+			Slot.bHandleAnswered = true;
+			if (Slot.Shape.IsLine())
+			{
+				Rays.Emplace(Slot.Start, Slot.End, ClimbProbe::GetTriangleChannels((EClimbProbe)Index));
+				RaySlots.Add(Index);
+			}
+			else
+			{
+				QueryTriangles((EClimbProbe)Index, Slot);
+				Slot.bComplex = ApplySurface((EClimbProbe)Index, Slot);
+				Record((EClimbProbe)Index, Slot, EClimbProbeSource::Triangles, true);
+			}
+			continue;
+		}
+
+		const ECollisionChannel TraceChannel = IsWallProbe((EClimbProbe)Index) ? ECC_Climbable : ECC_Visibility;
+		const FCollisionQueryParams& Params = Slot.bComplex ? ComplexQueryParams : QueryParams;
+		Slot.bTracedComplex = Slot.bComplex;
+		ClimbProbe::CountQuery(Slot.Shape);
+		NumTraces++;
+		NumQueries++;
+
+		if (Slot.Shape.IsLine())
+		{
+			Slot.Handle = OwningWorld->AsyncLineTraceByChannel(EAsyncTraceType::Single, Slot.Start, Slot.End, TraceChannel, Params);
+		}
+		else
+		{
+			Slot.Handle = OwningWorld->AsyncSweepByChannel(EAsyncTraceType::Single, Slot.Start, Slot.End, FQuat::Identity, TraceChannel, Slot.Shape, Params);
+		}
+	}
+
+	if (Rays.Num() > 0)
+	{
+		SCOPE_CYCLE_COUNTER(STAT_ClimbProbeTriangles);
+		ClimbProbe::CountTriangleQueries(Rays.Num());
+
+		TArray<FClimbQueryHit, TInlineAllocator<(int32)EClimbProbe::Count>> Hits;
+		Hits.SetNum(Rays.Num());
+		SurfaceGraph->GetTriangleBVH().RaycastBatch(Rays, Hits);
+
+		for (int32 Ray = 0; Ray < Rays.Num(); Ray++)
+		{
+			FSlot& Slot = Slots[RaySlots[Ray]];
+			SetTriangleHit(Hits[Ray], Slot);
+			ContactCache.Store((EClimbProbe)RaySlots[Ray], Slot.HandleIntent, Slot.Start, Slot.End, OwnerTransform, Slot.bHit, Slot.Hit, FTransform::Identity);
+
+			//A surface that wants complex tracing gets it from the physics scene from the next batch on, this answer stands
+			Slot.bComplex = ApplySurface((EClimbProbe)RaySlots[Ray], Slot);
+			Record((EClimbProbe)RaySlots[Ray], Slot, EClimbProbeSource::Triangles, true);
+		}
+	}
+
+	return NumQueries;
+}
+
+void FClimbProbeBatch::Trace(EClimbProbe Probe, FSlot& Slot)
+{
+	UWorld* OwningWorld = GetProbeWorld();
+	if (!OwningWorld)
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_ClimbProbeTrace);
+
+	const ECollisionChannel TraceChannel = IsWallProbe(Probe) ? ECC_Climbable : ECC_Visibility;
+
+	//Simple collision first, the surface decides if it needs a second look at its triangles
+	const FCollisionQueryParams* Passes[] = { &QueryParams, &ComplexQueryParams };
+	const int32 NumPasses = UE_ARRAY_COUNT(Passes);
+	int32 FirstPass = 0;
+	EClimbProbeSource Source = EClimbProbeSource::Scene;
+	Slot.bTracedComplex = false;
+
+	//The baked triangles are simple collision, only the complex pass is left for them
+	if (CanQueryTriangles(Slot))
+	{
+		QueryTriangles(Probe, Slot);
+		FirstPass = ApplySurface(Probe, Slot) ? 1 : NumPasses;
+		Source = FirstPass < NumPasses ? EClimbProbeSource::Scene : EClimbProbeSource::Triangles;
+	}
+
+	for (int32 Pass = FirstPass; Pass < NumPasses; Pass++)
+	{
+		const FCollisionQueryParams* Params = Passes[Pass];
+		Slot.bTracedComplex = Params->bTraceComplex;
+
+		ClimbProbe::CountQuery(Slot.Shape);
+		NumTraces++;
+		if (Slot.Shape.IsLine())
+		{
+			Slot.bHit = OwningWorld->LineTraceSingleByChannel(Slot.Hit, Slot.Start, Slot.End, TraceChannel, *Params);
+		}
+		else
+		{
+			Slot.bHit = OwningWorld->SweepSingleByChannel(Slot.Hit, Slot.Start, Slot.End, FQuat::Identity, TraceChannel, Slot.Shape, *Params);
+		}
+
+		if (!ApplySurface(Probe, Slot))
+		{
+			break;
+		}
+	}
+
+	Slot.ResultIntent = Slot.Intent;
+	Slot.bResolved = true;
+
+	DrawDebug(Slot);
+	Record(Probe, Slot, Source, false);
+}
+
+bool FClimbProbeBatch::CanQueryTriangles(const FSlot& Slot) const
+{
+	const UClimbSurfaceGraph* Graph = GetProbeGraph();
+
+	return CVarClimbTriangleProbes.GetValueOnAnyThread() != 0
+		&& Graph && !Graph->GetTriangleBVH().IsEmpty()
+		&& !Slot.bComplex
+		&& (Slot.Shape.IsLine() || Slot.Shape.IsCapsule());
+}
+
+void FClimbProbeBatch::QueryTriangles(EClimbProbe Probe, FSlot& Slot)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ClimbProbeTriangles);
+	ClimbProbe::CountTriangleQueries(1);
+
+	const FClimbTriangleBVH& TriangleBVH = GetProbeGraph()->GetTriangleBVH();
+	const uint8 Channels = ClimbProbe::GetTriangleChannels(Probe);
+
+	FClimbQueryHit QueryHit;
+	if (Slot.Shape.IsLine())
+	{
+		TriangleBVH.Raycast(Slot.Start, Slot.End, Channels, QueryHit);
+	}
+	else
+	{
+		TriangleBVH.SweepCapsule(Slot.Start, Slot.End, Slot.Shape.GetCapsuleRadius(), Slot.Shape.GetCapsuleHalfHeight(), Channels, QueryHit);
+	}
+
+	SetTriangleHit(QueryHit, Slot);
+}
+
+void FClimbProbeBatch::SetTriangleHit(const FClimbQueryHit& QueryHit, FSlot& Slot) const
+{
+	Slot.Hit = FHitResult(Slot.Start, Slot.End);
+	Slot.bHit = QueryHit.IsHit();
+	if (!Slot.bHit)
+	{
+		return;
+	}
+
+	Slot.Hit.bBlockingHit = true;
+	Slot.Hit.bStartPenetrating = QueryHit.bStartPenetrating;
+	Slot.Hit.Time = QueryHit.Time;
+	Slot.Hit.Distance = (Slot.End - Slot.Start).Size() * QueryHit.Time;
+	Slot.Hit.Location = QueryHit.Location;
+	Slot.Hit.ImpactPoint = QueryHit.ImpactPoint;
+	Slot.Hit.Normal = QueryHit.Normal;
+	Slot.Hit.ImpactNormal = QueryHit.ImpactNormal;
+	Slot.Hit.PhysMaterial = GetProbeGraph()->GetTriangleMaterial(QueryHit.Triangle);
+	Slot.Hit.FaceIndex = QueryHit.Triangle;
+}
+
+void FClimbProbeBatch::DrawDebug(const FSlot& Slot) const
+{
+#if ENABLE_DRAW_DEBUG
+	UWorld* OwningWorld = World.Get();
+	//Sync probes resolved by the climb evaluate phase run on worker threads, and can't draw
+	if (!OwningWorld || !IsInGameThread() || CVarClimbDebugDraw.GetValueOnGameThread() == 0)
+	{
+		return;
+	}
+
+	const FColor Color = Slot.bHit ? FColor::Green : FColor::Red;
+	const FVector End = Slot.bHit ? Slot.Hit.Location : Slot.End;
+
+	DrawDebugLine(OwningWorld, Slot.Start, End, Color);
+	if (!Slot.Shape.IsLine())
+	{
+		DrawDebugCapsule(OwningWorld, End, Slot.Shape.GetCapsuleHalfHeight(), Slot.Shape.GetCapsuleRadius(), FQuat::Identity, Color);
+	}
+#endif
+}
+
+void FClimbProbeBatch::Record(EClimbProbe Probe, const FSlot& Slot, EClimbProbeSource Source, bool bAsyncResult)
+{
+	if (!Recorder)
+	{
+		return;
+	}
+
+	FClimbProbeRecord ProbeRecord;
+	ProbeRecord.Start = Slot.Start;
+	ProbeRecord.End = Slot.End;
+	ProbeRecord.Extent = Slot.Shape.GetExtent();
+	ProbeRecord.HitLocation = Slot.Hit.Location;
+	ProbeRecord.HitNormal = Slot.Hit.ImpactNormal;
+	ProbeRecord.Frame = (uint32)GFrameCounter;
+	ProbeRecord.Probe = Probe;
+	ProbeRecord.ShapeType = (uint8)Slot.Shape.ShapeType;
+	ProbeRecord.Source = Source;
+	ProbeRecord.Intent = bAsyncResult ? Slot.HandleIntent : Slot.Intent;
+
+	ProbeRecord.Flags = EClimbProbeRecordFlags::None;
+	ProbeRecord.Flags |= Slot.bHit ? EClimbProbeRecordFlags::Hit : EClimbProbeRecordFlags::None;
+	ProbeRecord.Flags |= Slot.bHit && Slot.Hit.bStartPenetrating ? EClimbProbeRecordFlags::StartPenetrating : EClimbProbeRecordFlags::None;
+	ProbeRecord.Flags |= bAsyncResult ? EClimbProbeRecordFlags::Async : EClimbProbeRecordFlags::None;
+	ProbeRecord.Flags |= Source == EClimbProbeSource::Scene && Slot.bTracedComplex ? EClimbProbeRecordFlags::Complex : EClimbProbeRecordFlags::None;
+	ProbeRecord.Flags |= Source != EClimbProbeSource::Cache && Slot.bProxy ? EClimbProbeRecordFlags::Proxy : EClimbProbeRecordFlags::None;
+
+	Recorder->Record(ProbeRecord);
+}
+
+bool FClimbProbeBatch::ApplySurface(EClimbProbe Probe, FSlot& Slot)
+{
+	Slot.bProxy = false;
+	if (!Slot.bHit || !IsWallProbe(Probe))
+	{
+		return false;
+	}
+
+	//A proxy is as close as the render triangles already, the surface's complex trace is not needed on top
+	const bool bProxy = ApplyProxy(Slot);
+	Slot.bProxy = bProxy;
+	if (!Slot.bHit)
+	{
+		return false;
+	}
+
+	const FClimbSurface Surface = FindSurface(Slot.Hit);
+
+	//Nothing to hold on to
+	if (!Surface.bClimbable)
+	{
+		Slot.bHit = false;
+		return false;
+	}
+
+	return Surface.bTraceComplex && !bProxy;
+}
+
+bool FClimbProbeBatch::ApplyProxy(FSlot& Slot) const
+{
+	//Baked triangles have no component, the bake put the proxy in place of the simple collision
+	if (Slot.Hit.Component.IsExplicitlyNull())
+	{
+		const UClimbSurfaceGraph* Graph = GetProbeGraph();
+		return Graph && Graph->IsProxyTriangle(Slot.Hit.FaceIndex);
+	}
+
+	//Only dereferenced on the game thread
+	UPrimitiveComponent* Component = bWorkerFrame ? nullptr : Slot.Hit.GetComponent();
+	if (!bWorkerFrame && !Component)
+	{
+		return false;
+	}
+
+	if (CVarClimbProxies.GetValueOnAnyThread() == 0)
+	{
+		return false;
+	}
+
+	//A proxy's triangles don't change once it is loaded, only finding it and where its mesh is go through the snapshot
+	const UClimbProxyUserData* Proxy = nullptr;
+	FTransform ComponentTransform;
+	if (bWorkerFrame)
+	{
+		const FWorkerComponent* Entry = WorkerComponents.FindByPredicate([&Slot](const FWorkerComponent& Candidate) { return Candidate.Component.HasSameIndexAndSerialNumber(Slot.Hit.Component); });
+		if (!Entry)
+		{
+			bMissedWorkerSnapshot = true;
+			return false;
+		}
+		Proxy = Entry->Proxy;
+		ComponentTransform = Entry->Transform;
+	}
+	else
+	{
+		Proxy = UClimbProxyUserData::FindForComponent(Component);
+		ComponentTransform = Component->GetComponentTransform();
+	}
+
+	if (!Proxy || !Proxy->Query(ComponentTransform, Slot.Start, Slot.End, Slot.Shape, Slot.Hit))
+	{
+		return false;
+	}
+
+	INC_DWORD_STAT(STAT_ClimbProxyQueries);
+	CSV_CUSTOM_STAT(Climbing, ProxyQueries, 1, ECsvCustomStatOp::Accumulate);
+
+	//Simple collision wraps the proxy, a ray can graze one and pass the other by
+	Slot.bHit = Slot.Hit.bBlockingHit;
+	return true;
+}
+
+bool FClimbProbeBatch::IsWallProbe(EClimbProbe Probe)
+{
+	switch (Probe)
+	{
+	case EClimbProbe::VerticalStep:
+	case EClimbProbe::LedgeRise:
+	case EClimbProbe::LedgeFree:
+	case EClimbProbe::ShimmyStep:
+	case EClimbProbe::DiagonalStep:
+		return false;
+	default:
+		return true;
+	}
+}
+
+FTransform FClimbProbeBatch::GetOwnerTransform() const
+{
+	if (bWorkerFrame)
+	{
+		return WorkerOwnerTransform;
+	}
+
+	const AActor* OwningActor = Owner.Get();
+	return OwningActor ? OwningActor->GetActorTransform() : FTransform::Identity;
+}
+
+bool FClimbProbeBatch::GetComponentTransform(const FHitResult& Hit, FTransform& OutTransform) const
+{
+	OutTransform = FTransform::Identity;
+	if (Hit.Component.IsExplicitlyNull())
+	{
+		return true;
+	}
+
+	if (!bWorkerFrame)
+	{
+		const UPrimitiveComponent* Component = Hit.GetComponent();
+		OutTransform = Component ? Component->GetComponentTransform() : FTransform::Identity;
+		return true;
+	}
+
+	const FWorkerComponent* Entry = WorkerComponents.FindByPredicate([&Hit](const FWorkerComponent& Candidate) { return Candidate.Component.HasSameIndexAndSerialNumber(Hit.Component); });
+	if (!Entry)
+	{
+		bMissedWorkerSnapshot = true;
+		return false;
+	}
+
+	OutTransform = Entry->Transform;
+	return true;
+}
+
+FClimbSurface FClimbProbeBatch::FindSurface(const FHitResult& Hit) const
+{
+	if (!bWorkerFrame)
+	{
+		return UClimbPhysicalMaterial::GetSurface(Hit);
+	}
+
+	//No material climbs with the defaults, same as a plain UPhysicalMaterial
+	if (Hit.PhysMaterial.IsExplicitlyNull())
+	{
+		return FClimbSurface();
+	}
+
+	const FWorkerSurface* Entry = WorkerSurfaces.FindByPredicate([&Hit](const FWorkerSurface& Candidate) { return Candidate.Material.HasSameIndexAndSerialNumber(Hit.PhysMaterial); });
+	if (!Entry)
+	{
+		//Nothing to hold on to as far as this frame knows, the serial step looks again
+		bMissedWorkerSnapshot = true;
+		FClimbSurface Unknown;
+		Unknown.bClimbable = false;
+		return Unknown;
+	}
+
+	return Entry->Surface;
+}
+
+UWorld* FClimbProbeBatch::GetProbeWorld() const
+{
+	return bWorkerFrame ? WorkerWorld : World.Get();
+}
+
+const UClimbSurfaceGraph* FClimbProbeBatch::GetProbeGraph() const
+{
+	return bWorkerFrame ? WorkerGraph : SurfaceGraph.Get();
+}
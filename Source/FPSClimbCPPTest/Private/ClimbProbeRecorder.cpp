@@ -0,0 +1,273 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ClimbProbeRecorder.h"
+#include "FPSClimbCPPTest.h"
+#include "ClimbProbeBatch.h"
+#include "ClimbingMovementComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/Paths.h"
+#include "UObject/UObjectIterator.h"
+#include "DrawDebugHelpers.h"
+
+namespace ClimbProbeRecorder
+{
+	const uint32 DumpMagic = 0x42505243;
+	const uint32 DumpVersion = 1;
+
+	const float NormalLength = 20.0f;
+
+	//Drops every record older than the last NumFrames frames, records are in frame order
+	void KeepLastFrames(TArray<FClimbProbeRecord>& Records, uint32 NumFrames)
+	{
+		if (Records.Num() == 0 || NumFrames == MAX_uint32)
+		{
+			return;
+		}
+
+		const uint32 LastFrame = Records.Last().Frame;
+		int32 First = Records.Num();
+		while (First > 0 && LastFrame - Records[First - 1].Frame < NumFrames)
+		{
+			First--;
+		}
+		Records.RemoveAt(0, First, false);
+	}
+}
+
+//Draws the last frames every climber recorded
+static FAutoConsoleCommandWithWorldAndArgs CmdClimbDrawProbes(
+	TEXT("climb.DrawProbes"),
+	TEXT("climb.DrawProbes [Frames=60] [Seconds=5]: draws the probes every climber recorded over its last Frames frames, for Seconds. Needs climb.RecordProbes."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			const uint32 NumFrames = Args.Num() > 0 ? (uint32)FMath::Max(FCString::Atoi(*Args[0]), 1) : 60;
+			const float Seconds = Args.Num() > 1 ? FCString::Atof(*Args[1]) : 5.0f;
+
+			TArray<FClimbProbeRecord> Records;
+			for (TObjectIterator<UClimbingMovementComponent> It; It; ++It)
+			{
+				const FClimbProbeRecorder* Recorder = It->GetWorld() == World ? It->GetClimbProbes().GetRecorder() : nullptr;
+				if (Recorder)
+				{
+					Recorder->GetRecords(Records, NumFrames);
+					FClimbProbeRecorder::Draw(World, Records, Seconds);
+				}
+			}
+		}));
+
+//Writes what every climber recorded to disk
+static FAutoConsoleCommandWithWorldAndArgs CmdClimbDumpProbes(
+	TEXT("climb.DumpProbes"),
+	TEXT("climb.DumpProbes [Filename]: writes the probes every climber recorded to Saved/ClimbProbes, or Filename. Needs climb.RecordProbes."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			if (!World)
+			{
+				return;
+			}
+
+			FClimbProbeDump Dump;
+			Dump.MapName = World->GetMapName();
+			Dump.Time = World->GetTimeSeconds();
+
+			int32 NumRecords = 0;
+			for (TObjectIterator<UClimbingMovementComponent> It; It; ++It)
+			{
+				const FClimbProbeRecorder* Recorder = It->GetWorld() == World ? It->GetClimbProbes().GetRecorder() : nullptr;
+				if (Recorder)
+				{
+					FClimbProbeDump::FClimber& Climber = Dump.Climbers.AddDefaulted_GetRef();
+					Climber.Name = GetNameSafe(It->GetOwner());
+					Recorder->GetRecords(Climber.Records);
+					NumRecords += Climber.Records.Num();
+				}
+			}
+
+			const FString Filename = Args.Num() > 0 ? Args[0]
+				: FPaths::ProjectSavedDir() / TEXT("ClimbProbes") / FString::Printf(TEXT("%s-%s.climbprobes"), *Dump.MapName, *FDateTime::Now().ToString());
+
+			if (Dump.Save(Filename))
+			{
+				UE_LOG(LogClimb, Log, TEXT("Wrote %d probes of %d climbers to %s"), NumRecords, Dump.Climbers.Num(), *Filename);
+			}
+			else
+			{
+				UE_LOG(LogClimb, Error, TEXT("Could not write %s"), *Filename);
+			}
+		}));
+
+//Draws a dump, from a server say, in whatever world is running
+static FAutoConsoleCommandWithWorldAndArgs CmdClimbDrawProbeDump(
+	TEXT("climb.DrawProbeDump"),
+	TEXT("climb.DrawProbeDump Filename [Frames=60] [Seconds=30]: draws the last Frames frames of a climb.DumpProbes file, for Seconds."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			FClimbProbeDump Dump;
+			if (Args.Num() == 0 || !Dump.Load(Args[0]))
+			{
+				UE_LOG(LogClimb, Error, TEXT("Could not read climb probe dump %s"), Args.Num() > 0 ? *Args[0] : TEXT(""));
+				return;
+			}
+
+			const uint32 NumFrames = Args.Num() > 1 ? (uint32)FMath::Max(FCString::Atoi(*Args[1]), 1) : 60;
+			const float Seconds = Args.Num() > 2 ? FCString::Atof(*Args[2]) : 30.0f;
+
+			for (FClimbProbeDump::FClimber& Climber : Dump.Climbers)
+			{
+				ClimbProbeRecorder::KeepLastFrames(Climber.Records, NumFrames);
+				FClimbProbeRecorder::Draw(World, Climber.Records, Seconds);
+			}
+
+			UE_LOG(LogClimb, Log, TEXT("Drawing %d climbers from %s at %.2fs"), Dump.Climbers.Num(), *Dump.MapName, Dump.Time);
+		}));
+
+FArchive& operator<<(FArchive& Ar, FClimbProbeRecord& Record)
+{
+	uint8 Probe = (uint8)Record.Probe;
+	uint8 Source = (uint8)Record.Source;
+	uint8 Flags = (uint8)Record.Flags;
+
+	Ar << Record.Start << Record.End << Record.Extent << Record.HitLocation << Record.HitNormal;
+	Ar << Record.Frame << Probe << Record.ShapeType << Source << Flags << Record.Intent;
+
+	if (Ar.IsLoading())
+	{
+		Record.Probe = (EClimbProbe)Probe;
+		Record.Source = (EClimbProbeSource)Source;
+		Record.Flags = (EClimbProbeRecordFlags)Flags;
+	}
+	return Ar;
+}
+
+FClimbProbeRecorder::FClimbProbeRecorder(int32 InCapacity)
+	: Head(0)
+{
+	Records.SetNumZeroed(FMath::Max(InCapacity, 1));
+}
+
+void FClimbProbeRecorder::Record(const FClimbProbeRecord& InRecord)
+{
+	const uint64 Index = Head.Load(EMemoryOrder::Relaxed);
+	Records[Index % Records.Num()] = InRecord;
+	Head.Store(Index + 1);
+}
+
+void FClimbProbeRecorder::GetRecords(TArray<FClimbProbeRecord>& OutRecords, uint32 NumFrames) const
+{
+	const uint64 Capacity = Records.Num();
+	const uint64 End = Head.Load();
+	const uint64 Begin = End > Capacity ? End - Capacity : 0;
+
+	OutRecords.Reset((int32)(End - Begin));
+	for (uint64 Index = Begin; Index < End; Index++)
+	{
+		OutRecords.Add(Records[Index % Capacity]);
+	}
+
+	//The writer may have lapped what was copied, and may be halfway through the slot after the last one it published
+	const uint64 After = Head.Load();
+	const uint64 FirstIntact = After + 1 > Capacity ? After + 1 - Capacity : 0;
+	if (FirstIntact > Begin)
+	{
+		OutRecords.RemoveAt(0, (int32)FMath::Min(FirstIntact - Begin, (uint64)OutRecords.Num()), false);
+	}
+
+	ClimbProbeRecorder::KeepLastFrames(OutRecords, NumFrames);
+}
+
+void FClimbProbeRecorder::Draw(UWorld* World, TArrayView<const FClimbProbeRecord> InRecords, float Seconds)
+{
+#if ENABLE_DRAW_DEBUG
+	if (!World)
+	{
+		return;
+	}
+
+	for (const FClimbProbeRecord& Record : InRecords)
+	{
+		const bool bScene = Record.Source == EClimbProbeSource::Scene;
+		const FColor Color = Record.IsHit() ? (bScene ? FColor::Green : FColor(160, 255, 160)) : (bScene ? FColor::Red : FColor(255, 160, 160));
+		const FVector End = Record.IsHit() ? Record.HitLocation : Record.End;
+
+		DrawDebugLine(World, Record.Start, End, Color, false, Seconds);
+		switch ((ECollisionShape::Type)Record.ShapeType)
+		{
+		case ECollisionShape::Capsule:
+			DrawDebugCapsule(World, End, Record.Extent.Z, Record.Extent.X, FQuat::Identity, Color, false, Seconds);
+			break;
+		case ECollisionShape::Sphere:
+			DrawDebugSphere(World, End, Record.Extent.X, 12, Color, false, Seconds);
+			break;
+		case ECollisionShape::Box:
+			DrawDebugBox(World, End, Record.Extent, Color, false, Seconds);
+			break;
+		default:
+			break;
+		}
+
+		if (Record.IsHit())
+		{
+			DrawDebugLine(World, Record.HitLocation, Record.HitLocation + Record.HitNormal * ClimbProbeRecorder::NormalLength, FColor::Blue, false, Seconds);
+		}
+	}
+#endif
+}
+
+FClimbProbeDump::FClimbProbeDump()
+	: Time(0.0)
+{
+}
+
+bool FClimbProbeDump::Save(const FString& Filename)
+{
+	TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*Filename));
+	if (!Writer)
+	{
+		return false;
+	}
+
+	Serialize(*Writer);
+	return Writer->Close();
+}
+
+bool FClimbProbeDump::Load(const FString& Filename)
+{
+	TUniquePtr<FArchive> Reader(IFileManager::Get().CreateFileReader(*Filename));
+	if (!Reader)
+	{
+		return false;
+	}
+
+	Serialize(*Reader);
+	return !Reader->IsError();
+}
+
+void FClimbProbeDump::Serialize(FArchive& Ar)
+{
+	uint32 Magic = ClimbProbeRecorder::DumpMagic;
+	uint32 Version = ClimbProbeRecorder::DumpVersion;
+	Ar << Magic << Version;
+	if (Magic != ClimbProbeRecorder::DumpMagic || Version != ClimbProbeRecorder::DumpVersion)
+	{
+		Ar.SetError();
+		return;
+	}
+
+	Ar << MapName << Time;
+
+	int32 NumClimbers = Climbers.Num();
+	Ar << NumClimbers;
+	if (Ar.IsLoading())
+	{
+		Climbers.SetNum(FMath::Max(NumClimbers, 0));
+	}
+
+	for (FClimber& Climber : Climbers)
+	{
+		Ar << Climber.Name << Climber.Records;
+	}
+}
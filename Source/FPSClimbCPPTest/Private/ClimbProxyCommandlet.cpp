@@ -0,0 +1,250 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ClimbProxyCommandlet.h"
+#include "FPSClimbCPPTest.h"
+#include "ClimbProxyUserData.h"
+#include "ClimbMeshSimplifier.h"
+#include "ClimbTriangleBVH.h"
+#include "Engine/StaticMesh.h"
+#include "Components/StaticMeshComponent.h"
+#include "Interfaces/Interface_CollisionDataProvider.h"
+#include "Misc/FileHelper.h"
+#include "Misc/PackageName.h"
+#include "Misc/Paths.h"
+#include "UObject/Package.h"
+#include "UObject/UObjectHash.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonWriter.h"
+#include "Serialization/JsonSerializer.h"
+
+namespace ClimbProxy
+{
+	//Tighter quadric bounds tried before a mesh is reported over its MaxError
+	const int32 MaxAttempts = 4;
+
+	//How far either surface is searched for the other, in MaxErrors
+	const float SearchScale = 4.0f;
+
+	bool IsClimbable(const UStaticMeshComponent* Component)
+	{
+		return Component->GetStaticMesh()
+			&& Component->IsCollisionEnabled()
+			&& Component->GetCollisionResponseToChannel(ECC_Climbable) == ECR_Block;
+	}
+
+	//Triangles complex traces hit, three vertices each in mesh space
+	bool GatherSourceTriangles(UStaticMesh* Mesh, TArray<FVector>& OutVertices)
+	{
+		FTriMeshCollisionData CollisionData;
+		if (!Mesh->GetPhysicsTriMeshData(&CollisionData, true))
+		{
+			return false;
+		}
+
+		OutVertices.Reset(CollisionData.Indices.Num() * 3);
+		for (const FTriIndices& Triangle : CollisionData.Indices)
+		{
+			OutVertices.Append({ CollisionData.Vertices[Triangle.v0], CollisionData.Vertices[Triangle.v1], CollisionData.Vertices[Triangle.v2] });
+		}
+		return OutVertices.Num() > 0;
+	}
+
+	FClimbTriangleBVH BuildTree(TArrayView<const FVector> Vertices)
+	{
+		TArray<uint8> Channels;
+		Channels.Init(0xFF, Vertices.Num() / 3);
+
+		FClimbTriangleBVH TriangleBVH;
+		TriangleBVH.Build(Vertices, Channels);
+		return TriangleBVH;
+	}
+}
+
+UClimbProxyCommandlet::UClimbProxyCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UClimbProxyCommandlet::Main(const FString& Params)
+{
+#if WITH_EDITOR
+	FString MapName;
+	if (!FParse::Value(*Params, TEXT("Map="), MapName))
+	{
+		MapName = TEXT("/Game/TestLevel");
+	}
+
+	float MaxErrorOverride = 0.0f;
+	const bool bOverrideMaxError = FParse::Value(*Params, TEXT("MaxError="), MaxErrorOverride);
+	const bool bForce = FParse::Param(*Params, TEXT("Force"));
+
+	FString OutputFilename = FPaths::ProjectSavedDir() / TEXT("ClimbProxy.json");
+	FParse::Value(*Params, TEXT("Output="), OutputFilename);
+
+	//Meshes placed as climbable in the map
+	TArray<UStaticMesh*> Meshes;
+	UPackage* MapPackage = LoadPackage(nullptr, *MapName, LOAD_None);
+	if (!MapPackage)
+	{
+		UE_LOG(LogClimb, Error, TEXT("ClimbProxy: could not load map %s"), *MapName);
+		return 1;
+	}
+
+	TArray<UObject*> MapObjects;
+	GetObjectsWithOuter(MapPackage, MapObjects, true);
+	for (UObject* Object : MapObjects)
+	{
+		const UStaticMeshComponent* Component = Cast<UStaticMeshComponent>(Object);
+		if (Component && !Component->IsTemplate() && ClimbProxy::IsClimbable(Component))
+		{
+			Meshes.AddUnique(Component->GetStaticMesh());
+		}
+	}
+
+	//And any asked for by name
+	FString MeshList;
+	if (FParse::Value(*Params, TEXT("Meshes="), MeshList, false))
+	{
+		TArray<FString> MeshNames;
+		MeshList.ParseIntoArray(MeshNames, TEXT(","));
+		for (const FString& MeshName : MeshNames)
+		{
+			const FString ObjectPath = MeshName.Contains(TEXT(".")) ? MeshName : MeshName + TEXT(".") + FPackageName::GetLongPackageAssetName(MeshName);
+			if (UStaticMesh* Mesh = LoadObject<UStaticMesh>(nullptr, *ObjectPath))
+			{
+				Meshes.AddUnique(Mesh);
+			}
+			else
+			{
+				UE_LOG(LogClimb, Error, TEXT("ClimbProxy: could not load mesh %s"), *MeshName);
+			}
+		}
+	}
+
+	TArray<TSharedPtr<FJsonValue>> MeshReports;
+	int64 TotalSource = 0;
+	int64 TotalProxy = 0;
+	float WorstDeviation = 0.0f;
+	int32 NumGenerated = 0;
+	int32 NumFailed = 0;
+
+	for (UStaticMesh* Mesh : Meshes)
+	{
+		UClimbProxyUserData* Proxy = Cast<UClimbProxyUserData>(Mesh->GetAssetUserDataOfClass(UClimbProxyUserData::StaticClass()));
+		if (!Proxy)
+		{
+			Proxy = NewObject<UClimbProxyUserData>(Mesh, NAME_None, RF_Public | RF_Transactional);
+			Mesh->AddAssetUserData(Proxy);
+		}
+
+		if (bOverrideMaxError)
+		{
+			Proxy->MaxError = FMath::Max(MaxErrorOverride, 0.1f);
+		}
+
+		TArray<FVector> SourceVertices;
+		if (!ClimbProxy::GatherSourceTriangles(Mesh, SourceVertices))
+		{
+			UE_LOG(LogClimb, Warning, TEXT("ClimbProxy: %s has no collision triangles"), *Mesh->GetPathName());
+			continue;
+		}
+
+		uint32 SourceHash = FCrc::MemCrc32(SourceVertices.GetData(), SourceVertices.Num() * sizeof(FVector));
+		SourceHash = HashCombine(SourceHash, GetTypeHash(Proxy->MaxError));
+
+		const bool bRegenerate = bForce || Proxy->SourceHash != SourceHash || Proxy->IsEmpty();
+		if (bRegenerate)
+		{
+			const FClimbTriangleBVH SourceTree = ClimbProxy::BuildTree(SourceVertices);
+			const float SearchDistance = Proxy->MaxError * ClimbProxy::SearchScale;
+
+			//Quadrics bound the distance to the source planes, not triangles, so the result is measured and the bound tightened until it fits
+			TArray<FVector> ProxyVertices;
+			float Deviation = MAX_flt;
+			float Bound = Proxy->MaxError;
+			for (int32 Attempt = 0; Attempt < ClimbProxy::MaxAttempts && Deviation > Proxy->MaxError; Attempt++, Bound *= 0.5f)
+			{
+				FClimbMeshSimplifier Simplifier(SourceVertices);
+				Simplifier.Simplify(Bound);
+				Simplifier.GetTriangles(ProxyVertices);
+
+				const FClimbTriangleBVH ProxyTree = ClimbProxy::BuildTree(ProxyVertices);
+				Deviation = FMath::Max(
+					FClimbMeshSimplifier::MeasureDeviation(SourceVertices, ProxyTree, SearchDistance),
+					FClimbMeshSimplifier::MeasureDeviation(ProxyVertices, SourceTree, SearchDistance));
+			}
+
+			if (Deviation > Proxy->MaxError)
+			{
+				UE_LOG(LogClimb, Warning, TEXT("ClimbProxy: %s is %.2f cm off its render triangles, over its MaxError of %.2f"), *Mesh->GetPathName(), Deviation, Proxy->MaxError);
+				NumFailed++;
+			}
+
+			Proxy->SetTriangles(MoveTemp(ProxyVertices));
+			Proxy->SourceTriangles = SourceVertices.Num() / 3;
+			Proxy->MaxDeviation = Deviation;
+			Proxy->SourceHash = SourceHash;
+
+			UPackage* MeshPackage = Mesh->GetOutermost();
+			MeshPackage->MarkPackageDirty();
+			const FString Filename = FPackageName::LongPackageNameToFilename(MeshPackage->GetName(), FPackageName::GetAssetPackageExtension());
+			if (!UPackage::SavePackage(MeshPackage, Mesh, RF_Standalone, *Filename))
+			{
+				UE_LOG(LogClimb, Error, TEXT("ClimbProxy: could not save %s"), *Filename);
+				NumFailed++;
+			}
+
+			NumGenerated++;
+		}
+
+		TotalSource += Proxy->SourceTriangles;
+		TotalProxy += Proxy->NumTriangles();
+		WorstDeviation = FMath::Max(WorstDeviation, Proxy->MaxDeviation);
+
+		TSharedRef<FJsonObject> MeshReport = MakeShared<FJsonObject>();
+		MeshReport->SetStringField(TEXT("mesh"), Mesh->GetPathName());
+		MeshReport->SetBoolField(TEXT("regenerated"), bRegenerate);
+		MeshReport->SetNumberField(TEXT("sourceTriangles"), Proxy->SourceTriangles);
+		MeshReport->SetNumberField(TEXT("proxyTriangles"), Proxy->NumTriangles());
+		MeshReport->SetNumberField(TEXT("reduction"), Proxy->SourceTriangles > 0 ? 1.0 - (double)Proxy->NumTriangles() / Proxy->SourceTriangles : 0.0);
+		MeshReport->SetNumberField(TEXT("maxError"), Proxy->MaxError);
+		MeshReport->SetNumberField(TEXT("maxDeviation"), Proxy->MaxDeviation);
+		MeshReports.Add(MakeShared<FJsonValueObject>(MeshReport));
+
+		UE_LOG(LogClimb, Display, TEXT("ClimbProxy: %s %d -> %d triangles, %.2f cm deviation%s"),
+			*Mesh->GetPathName(), Proxy->SourceTriangles, Proxy->NumTriangles(), Proxy->MaxDeviation, bRegenerate ? TEXT("") : TEXT(" (unchanged)"));
+	}
+
+	TSharedRef<FJsonObject> Report = MakeShared<FJsonObject>();
+	Report->SetStringField(TEXT("map"), MapName);
+	Report->SetNumberField(TEXT("meshes"), MeshReports.Num());
+	Report->SetNumberField(TEXT("generated"), NumGenerated);
+	Report->SetNumberField(TEXT("failed"), NumFailed);
+	Report->SetNumberField(TEXT("sourceTriangles"), (double)TotalSource);
+	Report->SetNumberField(TEXT("proxyTriangles"), (double)TotalProxy);
+	Report->SetNumberField(TEXT("reduction"), TotalSource > 0 ? 1.0 - (double)TotalProxy / TotalSource : 0.0);
+	Report->SetNumberField(TEXT("worstDeviation"), WorstDeviation);
+	Report->SetArrayField(TEXT("results"), MeshReports);
+
+	FString Json;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Json);
+	FJsonSerializer::Serialize(Report, Writer);
+
+	if (!FFileHelper::SaveStringToFile(Json, *OutputFilename))
+	{
+		UE_LOG(LogClimb, Error, TEXT("ClimbProxy: could not write %s"), *OutputFilename);
+		return 1;
+	}
+
+	UE_LOG(LogClimb, Display, TEXT("ClimbProxy: %d meshes, %d regenerated, %lld -> %lld triangles, worst deviation %.2f cm, report in %s"),
+		MeshReports.Num(), NumGenerated, TotalSource, TotalProxy, WorstDeviation, *OutputFilename);
+
+	return NumFailed > 0 ? 1 : 0;
+#else
+	return 1;
+#endif
+}
@@ -0,0 +1,109 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ClimbProxyUserData.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/EngineTypes.h"
+#include "Components/StaticMeshComponent.h"
+
+UClimbProxyUserData::UClimbProxyUserData()
+{
+	MaxError = 2.0f;
+	SourceTriangles = 0;
+	MaxDeviation = 0.0f;
+	SourceHash = 0;
+}
+
+void UClimbProxyUserData::PostLoad()
+{
+	Super::PostLoad();
+
+	BuildTree();
+}
+
+const UClimbProxyUserData* UClimbProxyUserData::FindForComponent(const UPrimitiveComponent* Component)
+{
+	const UStaticMeshComponent* MeshComponent = Cast<UStaticMeshComponent>(Component);
+	UStaticMesh* Mesh = MeshComponent ? MeshComponent->GetStaticMesh() : nullptr;
+	if (!Mesh)
+	{
+		return nullptr;
+	}
+
+	const UClimbProxyUserData* Proxy = Cast<UClimbProxyUserData>(Mesh->GetAssetUserDataOfClass(UClimbProxyUserData::StaticClass()));
+
+	//Tagged but never generated
+	return (Proxy && !Proxy->IsEmpty()) ? Proxy : nullptr;
+}
+
+void UClimbProxyUserData::SetTriangles(TArray<FVector>&& InVertices)
+{
+	Vertices = MoveTemp(InVertices);
+	BuildTree();
+}
+
+void UClimbProxyUserData::BuildTree()
+{
+	//The proxy only ever answers wall probes, one channel is enough
+	TArray<uint8> Channels;
+	Channels.Init(0xFF, NumTriangles());
+	TriangleBVH.Build(Vertices, Channels);
+}
+
+bool UClimbProxyUserData::Query(const FTransform& ComponentTransform, const FVector& Start, const FVector& End, const FCollisionShape& Shape, FHitResult& InOutHit) const
+{
+	if (TriangleBVH.IsEmpty())
+	{
+		return false;
+	}
+
+	//Lines stay lines under any transform, and keep their fraction
+	const FVector LocalStart = ComponentTransform.InverseTransformPosition(Start);
+	const FVector LocalEnd = ComponentTransform.InverseTransformPosition(End);
+	const FVector Scale = ComponentTransform.GetScale3D();
+
+	FClimbQueryHit QueryHit;
+	if (Shape.IsLine())
+	{
+		TriangleBVH.Raycast(LocalStart, LocalEnd, 0xFF, QueryHit);
+	}
+	else if (Shape.IsCapsule())
+	{
+		//The tree only sweeps upright capsules, and a capsule only stays one under uniform scale
+		if (!Scale.GetAbs().AllComponentsEqual(KINDA_SMALL_NUMBER) || FMath::Abs(ComponentTransform.GetRotation().GetAxisZ().Z) < 1.0f - KINDA_SMALL_NUMBER)
+		{
+			return false;
+		}
+
+		const float InvScale = 1.0f / FMath::Max(FMath::Abs(Scale.X), KINDA_SMALL_NUMBER);
+		TriangleBVH.SweepCapsule(LocalStart, LocalEnd, Shape.GetCapsuleRadius() * InvScale, Shape.GetCapsuleHalfHeight() * InvScale, 0xFF, QueryHit);
+	}
+	else
+	{
+		return false;
+	}
+
+	//Same actor, component and material as the simple collision hit that led here
+	FHitResult Hit(Start, End);
+	Hit.Actor = InOutHit.Actor;
+	Hit.Component = InOutHit.Component;
+	Hit.PhysMaterial = InOutHit.PhysMaterial;
+
+	if (QueryHit.IsHit())
+	{
+		//Normals take the inverse scale
+		const FVector NormalScale = FTransform::GetSafeScaleReciprocal(Scale);
+
+		Hit.bBlockingHit = true;
+		Hit.bStartPenetrating = QueryHit.bStartPenetrating;
+		Hit.Time = QueryHit.Time;
+		Hit.Distance = (End - Start).Size() * QueryHit.Time;
+		Hit.Location = ComponentTransform.TransformPosition(QueryHit.Location);
+		Hit.ImpactPoint = ComponentTransform.TransformPosition(QueryHit.ImpactPoint);
+		Hit.Normal = ComponentTransform.TransformVectorNoScale(QueryHit.Normal * NormalScale).GetSafeNormal();
+		Hit.ImpactNormal = ComponentTransform.TransformVectorNoScale(QueryHit.ImpactNormal * NormalScale).GetSafeNormal();
+	}
+
+	InOutHit = Hit;
+	return true;
+}
@@ -0,0 +1,142 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ClimbQueryBenchCommandlet.h"
+#include "FPSClimbCPPTest.h"
+#include "ClimbSurfaceGraph.h"
+#include "ClimbTriangleBVH.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonWriter.h"
+#include "Serialization/JsonSerializer.h"
+
+namespace ClimbQueryBench
+{
+	//Longest climb probe, the body and head wall probes
+	const float RayLength = 110.0f;
+
+	//VerticalStep sweep
+	const float CapsuleRadius = 12.0f;
+	const float CapsuleHalfHeight = 27.0f;
+
+	double ToNanoseconds(double Seconds, int32 Count)
+	{
+		return (Count > 0) ? Seconds * 1.0e9 / Count : 0.0;
+	}
+}
+
+UClimbQueryBenchCommandlet::UClimbQueryBenchCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UClimbQueryBenchCommandlet::Main(const FString& Params)
+{
+	FString MapName;
+	if (!FParse::Value(*Params, TEXT("Map="), MapName))
+	{
+		MapName = TEXT("/Game/TestLevel");
+	}
+
+	int32 NumRays = 65536;
+	int32 Seed = 0;
+	FParse::Value(*Params, TEXT("Rays="), NumRays);
+	FParse::Value(*Params, TEXT("Seed="), Seed);
+	NumRays = FMath::Max(NumRays, 1);
+
+	FString OutputFilename = FPaths::ProjectSavedDir() / TEXT("ClimbQueryBench.json");
+	FParse::Value(*Params, TEXT("Output="), OutputFilename);
+
+	const UClimbSurfaceGraph* Graph = UClimbSurfaceGraph::FindForMap(MapName);
+	if (!Graph || Graph->GetTriangleBVH().IsEmpty())
+	{
+		UE_LOG(LogClimb, Error, TEXT("ClimbQueryBench: no baked triangles for %s, run the ClimbGraphBake commandlet"), *MapName);
+		return 1;
+	}
+
+	const FClimbTriangleBVH& TriangleBVH = Graph->GetTriangleBVH();
+	const FBox Bounds = TriangleBVH.GetBounds();
+	const uint8 AllChannels = (uint8)(EClimbTriangleChannel::Climbable | EClimbTriangleChannel::Visibility);
+
+	//Probe-length rays from anywhere in the level, in every direction
+	FRandomStream Stream(Seed);
+	TArray<FClimbRay> Rays;
+	Rays.Reserve(NumRays);
+	for (int32 Index = 0; Index < NumRays; Index++)
+	{
+		const FVector Start = Stream.RandPointInBox(Bounds);
+		Rays.Emplace(Start, Start + Stream.GetUnitVector() * ClimbQueryBench::RayLength, AllChannels);
+	}
+
+	TArray<FClimbQueryHit> ScalarHits;
+	ScalarHits.SetNum(NumRays);
+	TArray<FClimbQueryHit> PacketHits;
+	PacketHits.SetNum(NumRays);
+
+	double StartTime = FPlatformTime::Seconds();
+	for (int32 Index = 0; Index < NumRays; Index++)
+	{
+		TriangleBVH.Raycast(Rays[Index].Start, Rays[Index].End, Rays[Index].Channels, ScalarHits[Index]);
+	}
+	const double ScalarSeconds = FPlatformTime::Seconds() - StartTime;
+
+	StartTime = FPlatformTime::Seconds();
+	TriangleBVH.RaycastBatch(Rays, PacketHits);
+	const double PacketSeconds = FPlatformTime::Seconds() - StartTime;
+
+	int32 NumHits = 0;
+	int32 NumMismatches = 0;
+	for (int32 Index = 0; Index < NumRays; Index++)
+	{
+		NumHits += ScalarHits[Index].IsHit() ? 1 : 0;
+
+		//Lanes share no state, a packet has to give the same answer as the ray on its own
+		if (ScalarHits[Index].Triangle != PacketHits[Index].Triangle || !FMath::IsNearlyEqual(ScalarHits[Index].Time, PacketHits[Index].Time, KINDA_SMALL_NUMBER))
+		{
+			NumMismatches++;
+		}
+	}
+
+	const int32 NumSweeps = FMath::Max(NumRays / 8, 1);
+	int32 NumSweepHits = 0;
+	StartTime = FPlatformTime::Seconds();
+	for (int32 Index = 0; Index < NumSweeps; Index++)
+	{
+		FClimbQueryHit Hit;
+		NumSweepHits += TriangleBVH.SweepCapsule(Rays[Index].Start, Rays[Index].End, ClimbQueryBench::CapsuleRadius, ClimbQueryBench::CapsuleHalfHeight, AllChannels, Hit) ? 1 : 0;
+	}
+	const double SweepSeconds = FPlatformTime::Seconds() - StartTime;
+
+	TSharedRef<FJsonObject> Report = MakeShared<FJsonObject>();
+	Report->SetStringField(TEXT("map"), MapName);
+	Report->SetNumberField(TEXT("triangles"), TriangleBVH.NumTriangles());
+	Report->SetNumberField(TEXT("treeBytes"), (double)TriangleBVH.GetAllocatedSize());
+	Report->SetNumberField(TEXT("packetWidth"), FClimbTriangleBVH::PacketWidth);
+	Report->SetNumberField(TEXT("seed"), Seed);
+	Report->SetNumberField(TEXT("rays"), NumRays);
+	Report->SetNumberField(TEXT("rayHits"), NumHits);
+	Report->SetNumberField(TEXT("scalarNsPerRay"), ClimbQueryBench::ToNanoseconds(ScalarSeconds, NumRays));
+	Report->SetNumberField(TEXT("packetNsPerRay"), ClimbQueryBench::ToNanoseconds(PacketSeconds, NumRays));
+	Report->SetNumberField(TEXT("packetMismatches"), NumMismatches);
+	Report->SetNumberField(TEXT("sweeps"), NumSweeps);
+	Report->SetNumberField(TEXT("sweepHits"), NumSweepHits);
+	Report->SetNumberField(TEXT("nsPerSweep"), ClimbQueryBench::ToNanoseconds(SweepSeconds, NumSweeps));
+
+	FString Json;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Json);
+	FJsonSerializer::Serialize(Report, Writer);
+
+	UE_LOG(LogClimb, Display, TEXT("ClimbQueryBench: %s"), *Json);
+
+	if (!FFileHelper::SaveStringToFile(Json, *OutputFilename))
+	{
+		UE_LOG(LogClimb, Error, TEXT("ClimbQueryBench: could not write %s"), *OutputFilename);
+		return 1;
+	}
+
+	return NumMismatches > 0 ? 1 : 0;
+}
@@ -0,0 +1,204 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ClimbQuerySchedulerSubsystem.h"
+#include "FPSClimbCPPTest.h"
+#include "ClimbingMovementComponent.h"
+#include "ClimbMemory.h"
+#include "GameFramework/Character.h"
+#include "GameFramework/PlayerController.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("Query Scheduler"), STAT_ClimbQueryScheduler, STATGROUP_Climbing);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Scheduled batches"), STAT_ClimbScheduledBatches, STATGROUP_Climbing);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Deferred batches"), STAT_ClimbDeferredBatches, STATGROUP_Climbing);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Scheduled queries"), STAT_ClimbScheduledQueries, STATGROUP_Climbing);
+
+static TAutoConsoleVariable<int32> CVarClimbQueryBudget(
+	TEXT("climb.QueryBudget"),
+	0,
+	TEXT("Most climb probes sent to the physics scene per frame, 0 for no limit.\n")
+	TEXT("Above 0 every climb probe batch runs async and is flushed by the query scheduler."),
+	ECVF_Scalability);
+
+//Prints how often the query budget held climbers back, then starts counting again
+static FAutoConsoleCommandWithWorld CmdClimbQueryBudgetReport(
+	TEXT("climb.QueryBudgetReport"),
+	TEXT("Logs deferred climb probe batches and the longest wait since the last report, and resets the counters."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+		{
+			if (UClimbQuerySchedulerSubsystem* Scheduler = World ? World->GetSubsystem<UClimbQuerySchedulerSubsystem>() : nullptr)
+			{
+				UE_LOG(LogClimb, Log, TEXT("Query budget: %u batches deferred over %u frames, longest wait %u frames"),
+					Scheduler->GetNumDeferred(), Scheduler->GetNumOverBudgetFrames(), Scheduler->GetMaxWait());
+
+				Scheduler->ResetReport();
+			}
+		}));
+
+UClimbQuerySchedulerSubsystem::UClimbQuerySchedulerSubsystem()
+{
+	NumDeferred = 0;
+	NumOverBudgetFrames = 0;
+	MaxWait = 0;
+	bInitialized = false;
+}
+
+bool UClimbQuerySchedulerSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld();
+}
+
+void UClimbQuerySchedulerSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	bInitialized = true;
+}
+
+void UClimbQuerySchedulerSubsystem::Deinitialize()
+{
+	bInitialized = false;
+	Queue.Reset();
+
+	Super::Deinitialize();
+}
+
+bool UClimbQuerySchedulerSubsystem::IsTickable() const
+{
+	return bInitialized && !IsTemplate();
+}
+
+TStatId UClimbQuerySchedulerSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UClimbQuerySchedulerSubsystem, STATGROUP_Tickables);
+}
+
+bool UClimbQuerySchedulerSubsystem::IsBudgeted()
+{
+	return CVarClimbQueryBudget.GetValueOnGameThread() > 0;
+}
+
+void UClimbQuerySchedulerSubsystem::Submit(UClimbingMovementComponent* Climber)
+{
+	for (const FRequest& Request : Queue)
+	{
+		if (Request.Climber == Climber)
+		{
+			return;
+		}
+	}
+
+	FRequest& Request = Queue.AddDefaulted_GetRef();
+	Request.Climber = Climber;
+	Request.FramesWaited = 0;
+	Request.Priority = 0.0f;
+	Request.bLocal = false;
+}
+
+void UClimbQuerySchedulerSubsystem::Cancel(UClimbingMovementComponent* Climber)
+{
+	Queue.RemoveAllSwap([Climber](const FRequest& Request) { return Request.Climber == Climber; });
+}
+
+void UClimbQuerySchedulerSubsystem::ResetReport()
+{
+	NumDeferred = 0;
+	NumOverBudgetFrames = 0;
+	MaxWait = 0;
+}
+
+void UClimbQuerySchedulerSubsystem::Tick(float DeltaTime)
+{
+	if (Queue.Num() == 0)
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_ClimbQueryScheduler);
+	TRACE_CPUPROFILER_EVENT_SCOPE(UClimbQuerySchedulerSubsystem::Tick);
+	CLIMB_MEMORY_SCOPE();
+
+	Viewers.Reset();
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		if (const APlayerController* PlayerController = It->Get())
+		{
+			FVector Location;
+			FRotator Rotation;
+			PlayerController->GetPlayerViewPoint(Location, Rotation);
+			Viewers.Add(Location);
+		}
+	}
+
+	Queue.RemoveAllSwap([](const FRequest& Request) { return !Request.Climber.IsValid(); });
+
+	for (FRequest& Request : Queue)
+	{
+		const ACharacter* Character = Request.Climber->GetCharacterOwner();
+		const FVector Location = Character ? Character->GetActorLocation() : FVector::ZeroVector;
+
+		float ClosestSq = Viewers.Num() > 0 ? MAX_flt : 0.0f;
+		for (const FVector& Viewer : Viewers)
+		{
+			ClosestSq = FMath::Min(ClosestSq, FVector::DistSquared(Viewer, Location));
+		}
+
+		//Every frame waited counts like being that much closer, nobody waits forever
+		Request.bLocal = Character && Character->IsLocallyControlled() && Character->IsPlayerControlled();
+		Request.Priority = FMath::Sqrt(ClosestSq) / (1.0f + Request.FramesWaited);
+	}
+
+	Queue.Sort([](const FRequest& A, const FRequest& B)
+		{
+			if (A.bLocal != B.bLocal)
+			{
+				return A.bLocal;
+			}
+			return A.Priority < B.Priority;
+		});
+
+	const int32 QueryBudget = CVarClimbQueryBudget.GetValueOnGameThread();
+
+	int32 NumQueries = 0;
+	int32 NumFlushed = 0;
+	int32 NumKept = 0;
+
+	for (int32 Index = 0; Index < Queue.Num(); Index++)
+	{
+		FRequest& Request = Queue[Index];
+		FClimbProbeBatch& Batch = Request.Climber->GetClimbProbes();
+
+		//Pending probes are the most the batch can send, the contact cache and baked triangles answer some without a trace
+		const bool bOverBudget = QueryBudget > 0 && NumQueries + Batch.NumPending() > QueryBudget;
+
+		if (!Request.bLocal && NumFlushed > 0 && bOverBudget)
+		{
+			//Dropped for this frame, the climber asks again and moves up the queue for every frame it waits
+			Request.FramesWaited++;
+			MaxWait = FMath::Max(MaxWait, (uint32)Request.FramesWaited);
+			Queue[NumKept++] = Request;
+			continue;
+		}
+
+		NumQueries += Batch.Flush();
+		NumFlushed++;
+	}
+
+	const int32 NumHeld = NumKept;
+	Queue.SetNum(NumKept, false);
+
+	INC_DWORD_STAT_BY(STAT_ClimbScheduledBatches, NumFlushed);
+	INC_DWORD_STAT_BY(STAT_ClimbScheduledQueries, NumQueries);
+	INC_DWORD_STAT_BY(STAT_ClimbDeferredBatches, NumHeld);
+	CSV_CUSTOM_STAT(Climbing, DeferredBatches, NumHeld, ECsvCustomStatOp::Set);
+
+	if (NumHeld > 0)
+	{
+		NumDeferred += NumHeld;
+		NumOverBudgetFrames++;
+		UE_LOG(LogClimb, Verbose, TEXT("Query budget spent after %d batches (%d queries), %d deferred"), NumFlushed, NumQueries, NumHeld);
+	}
+}
@@ -0,0 +1,208 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ClimbRecorderSubsystem.h"
+#include "FPSClimbCPPTest.h"
+#include "EngiPC.h"
+#include "ClimbingMovementComponent.h"
+#include "Camera/CameraComponent.h"
+#include "Components/InputComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/InputSettings.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/Paths.h"
+
+DECLARE_CYCLE_STAT(TEXT("Record Frame"), STAT_ClimbRecordFrame, STATGROUP_Climbing);
+
+static FAutoConsoleCommandWithWorldAndArgs CmdClimbRecord(
+	TEXT("climb.Record"),
+	TEXT("climb.Record [Filename]: records the local player's input and climb state to Saved/ClimbRecordings, or Filename, from the next frame the player stands on the ground until climb.StopRecording. Play it back with the ClimbReplay commandlet."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			if (UClimbRecorderSubsystem* Recorder = World ? World->GetSubsystem<UClimbRecorderSubsystem>() : nullptr)
+			{
+				Recorder->StartRecording(Args.Num() > 0 ? Args[0] : FString());
+			}
+		}));
+
+static FAutoConsoleCommandWithWorld CmdClimbStopRecording(
+	TEXT("climb.StopRecording"),
+	TEXT("Stops climb.Record and closes its file."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+		{
+			if (UClimbRecorderSubsystem* Recorder = World ? World->GetSubsystem<UClimbRecorderSubsystem>() : nullptr)
+			{
+				Recorder->StopRecording();
+			}
+		}));
+
+UClimbRecorderSubsystem::UClimbRecorderSubsystem()
+{
+	bInitialized = false;
+}
+
+bool UClimbRecorderSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld();
+}
+
+void UClimbRecorderSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	//Any key mapped to an action counts, the bindings do not care which one it was
+	for (int32 Index = 0; Index < FClimbRecordedFrame::NumActions; Index++)
+	{
+		TArray<FInputActionKeyMapping> Mappings;
+		UInputSettings::GetInputSettings()->GetActionMappingByName(FClimbRecordedFrame::GetActionName(Index), Mappings);
+		for (const FInputActionKeyMapping& Mapping : Mappings)
+		{
+			ActionKeys[Index].Add(Mapping.Key);
+		}
+	}
+
+	FString CommandLineFilename;
+	if (FParse::Value(FCommandLine::Get(), TEXT("ClimbRecord="), CommandLineFilename))
+	{
+		StartRecording(CommandLineFilename);
+	}
+
+	bInitialized = true;
+}
+
+void UClimbRecorderSubsystem::Deinitialize()
+{
+	StopRecording();
+
+	bInitialized = false;
+
+	Super::Deinitialize();
+}
+
+bool UClimbRecorderSubsystem::IsTickable() const
+{
+	return bInitialized && IsRecording() && !IsTemplate();
+}
+
+TStatId UClimbRecorderSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UClimbRecorderSubsystem, STATGROUP_Tickables);
+}
+
+void UClimbRecorderSubsystem::StartRecording(const FString& InFilename)
+{
+	StopRecording();
+
+	const FString MapName = FPaths::GetBaseFilename(UWorld::RemovePIEPrefix(GetWorld()->GetOutermost()->GetName()));
+	PendingFilename = !InFilename.IsEmpty() ? InFilename
+		: FPaths::ProjectSavedDir() / TEXT("ClimbRecordings") / FString::Printf(TEXT("%s-%s.climbrec"), *MapName, *FDateTime::Now().ToString());
+}
+
+void UClimbRecorderSubsystem::StopRecording()
+{
+	PendingFilename.Empty();
+	if (!Writer.IsOpen())
+	{
+		return;
+	}
+
+	const int32 NumFrames = Writer.GetNumFrames();
+	const int64 NumBytes = Writer.GetNumBytes();
+	if (Writer.Close())
+	{
+		UE_LOG(LogClimb, Log, TEXT("Recorded %d frames in %lld bytes to %s"), NumFrames, NumBytes, *Filename);
+	}
+	else
+	{
+		UE_LOG(LogClimb, Error, TEXT("Could not write %s"), *Filename);
+	}
+}
+
+AEngiPC* UClimbRecorderSubsystem::GetRecordedCharacter() const
+{
+	const APlayerController* Controller = GetWorld()->GetFirstPlayerController();
+	return (Controller && Controller->IsLocalController()) ? Cast<AEngiPC>(Controller->GetPawn()) : nullptr;
+}
+
+bool UClimbRecorderSubsystem::CanBeginRecording(const AEngiPC* Character) const
+{
+	//ClimbReplay spawns the character standing, a recording started on a wall or in the air could not be played back
+	const UClimbingMovementComponent* Movement = Character->GetClimbingMovement();
+	return Movement->GetClimbState() == EClimbState::Grounded && Movement->IsMovingOnGround();
+}
+
+bool UClimbRecorderSubsystem::BeginRecording(AEngiPC* Character)
+{
+	FClimbRecordingHeader Header;
+	Header.MapName = UWorld::RemovePIEPrefix(GetWorld()->GetOutermost()->GetName());
+	Header.StartLocation = Character->GetActorLocation();
+	Header.StartRotation = Character->GetActorRotation();
+	Header.StartControlRotation = Character->GetControlRotation();
+	Header.StartClimbState = (uint8)Character->GetClimbingMovement()->GetClimbState();
+
+	Filename = PendingFilename;
+	PendingFilename.Empty();
+	if (!Writer.Open(Filename, Header))
+	{
+		UE_LOG(LogClimb, Error, TEXT("Could not write %s"), *Filename);
+		return false;
+	}
+
+	UE_LOG(LogClimb, Log, TEXT("Recording climbing to %s"), *Filename);
+	return true;
+}
+
+void UClimbRecorderSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ClimbRecordFrame);
+
+	//Tickables go after the world's tick groups, the input and the move it made are both in
+	AEngiPC* Character = GetRecordedCharacter();
+	if (!Writer.IsOpen())
+	{
+		if (!Character || !CanBeginRecording(Character) || !BeginRecording(Character))
+		{
+			return;
+		}
+	}
+	else if (!Character)
+	{
+		StopRecording();
+		return;
+	}
+
+	const APlayerController* Controller = CastChecked<APlayerController>(Character->GetController());
+	const UClimbingMovementComponent* Movement = Character->GetClimbingMovement();
+
+	FClimbRecordedFrame Frame;
+	Frame.DeltaTime = DeltaTime;
+	if (const UInputComponent* Input = Character->InputComponent)
+	{
+		Frame.Forward = Input->GetAxisValue(TEXT("MoveForward"));
+		Frame.Right = Input->GetAxisValue(TEXT("MoveRight"));
+	}
+
+	for (int32 Index = 0; Index < FClimbRecordedFrame::NumActions; Index++)
+	{
+		for (const FKey& Key : ActionKeys[Index])
+		{
+			if (Controller->IsInputKeyDown(Key))
+			{
+				Frame.Actions |= (EClimbRecordedAction)(1 << Index);
+				break;
+			}
+		}
+	}
+
+	Frame.ControlRotation = Controller->GetControlRotation();
+	Frame.Location = Character->GetActorLocation();
+	Frame.Rotation = Character->GetActorRotation();
+	Frame.CameraRotation = Character->GetFirstPersonCameraComponent()->GetRelativeRotation();
+	Frame.ClimbState = (uint8)Movement->GetClimbState();
+	Frame.MovementMode = (uint8)Movement->MovementMode;
+	Frame.CustomMode = Movement->CustomMovementMode;
+
+	Writer.AddFrame(Frame);
+}
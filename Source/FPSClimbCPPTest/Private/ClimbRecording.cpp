@@ -0,0 +1,364 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ClimbRecording.h"
+#include "FPSClimbCPPTest.h"
+#include "HAL/FileManager.h"
+
+namespace ClimbRecording
+{
+	const uint32 Magic = 0x43524C43;
+	const uint32 Version = 1;
+
+	//Frame fields as quantized integers, in the order the groups below cover them
+	enum EField
+	{
+		DeltaTime,
+		Forward,
+		Right,
+		Actions,
+		ControlPitch, ControlYaw, ControlRoll,
+		LocationX, LocationY, LocationZ,
+		Pitch, Yaw, Roll,
+		CameraPitch, CameraYaw, CameraRoll,
+		ClimbState,
+		MovementMode,
+		CustomMode,
+		NumFields
+	};
+
+	//Fields that change together, one bit each in the byte in front of every frame
+	struct FGroup
+	{
+		int32 First;
+		int32 Num;
+		//Rotation axes wrap, deltas are taken the short way round
+		bool bWrap;
+	};
+
+	const FGroup Groups[] =
+	{
+		{ DeltaTime, 1, false },
+		{ Forward, 3, false },
+		{ ControlPitch, 3, true },
+		{ LocationX, 3, false },
+		{ Pitch, 3, true },
+		{ CameraPitch, 3, true },
+		{ ClimbState, 3, false },
+	};
+
+	const float DeltaTimeUnit = 1.0e-5f;
+	const float AxisUnit = 127.0f;
+	const float LocationUnit = 10.0f;
+
+	void QuantizeRotator(const FRotator& Rotator, int32* Out)
+	{
+		Out[0] = FRotator::CompressAxisToShort(Rotator.Pitch);
+		Out[1] = FRotator::CompressAxisToShort(Rotator.Yaw);
+		Out[2] = FRotator::CompressAxisToShort(Rotator.Roll);
+	}
+
+	FRotator DequantizeRotator(const int32* In)
+	{
+		return FRotator(FRotator::DecompressAxisFromShort((uint16)In[0]), FRotator::DecompressAxisFromShort((uint16)In[1]), FRotator::DecompressAxisFromShort((uint16)In[2]));
+	}
+
+	void Quantize(const FClimbRecordedFrame& Frame, int32* Out)
+	{
+		Out[DeltaTime] = FMath::Clamp(FMath::RoundToInt(Frame.DeltaTime / DeltaTimeUnit), 0, MAX_int32);
+		Out[Forward] = FMath::Clamp(FMath::RoundToInt(Frame.Forward * AxisUnit), -127, 127);
+		Out[Right] = FMath::Clamp(FMath::RoundToInt(Frame.Right * AxisUnit), -127, 127);
+		Out[Actions] = (int32)Frame.Actions;
+		QuantizeRotator(Frame.ControlRotation, Out + ControlPitch);
+		Out[LocationX] = FMath::RoundToInt(Frame.Location.X * LocationUnit);
+		Out[LocationY] = FMath::RoundToInt(Frame.Location.Y * LocationUnit);
+		Out[LocationZ] = FMath::RoundToInt(Frame.Location.Z * LocationUnit);
+		QuantizeRotator(Frame.Rotation, Out + Pitch);
+		QuantizeRotator(Frame.CameraRotation, Out + CameraPitch);
+		Out[ClimbState] = Frame.ClimbState;
+		Out[MovementMode] = Frame.MovementMode;
+		Out[CustomMode] = Frame.CustomMode;
+	}
+
+	void Dequantize(const int32* In, FClimbRecordedFrame& Frame)
+	{
+		Frame.DeltaTime = In[DeltaTime] * DeltaTimeUnit;
+		Frame.Forward = In[Forward] / AxisUnit;
+		Frame.Right = In[Right] / AxisUnit;
+		Frame.Actions = (EClimbRecordedAction)In[Actions];
+		Frame.ControlRotation = DequantizeRotator(In + ControlPitch);
+		Frame.Location = FVector(In[LocationX], In[LocationY], In[LocationZ]) / LocationUnit;
+		Frame.Rotation = DequantizeRotator(In + Pitch);
+		Frame.CameraRotation = DequantizeRotator(In + CameraPitch);
+		Frame.ClimbState = (uint8)In[ClimbState];
+		Frame.MovementMode = (uint8)In[MovementMode];
+		Frame.CustomMode = (uint8)In[CustomMode];
+	}
+
+	//Zigzag varint, small deltas either way take a byte
+	void WriteVarInt(TArray<uint8>& Out, int32 Value)
+	{
+		uint32 Bits = ((uint32)Value << 1) ^ (uint32)(Value >> 31);
+		while (Bits >= 0x80)
+		{
+			Out.Add((uint8)(Bits | 0x80));
+			Bits >>= 7;
+		}
+		Out.Add((uint8)Bits);
+	}
+
+	bool ReadVarInt(const TArray<uint8>& In, int32& Offset, int32& OutValue)
+	{
+		uint32 Bits = 0;
+		for (int32 Shift = 0; Shift < 35; Shift += 7)
+		{
+			if (Offset >= In.Num())
+			{
+				return false;
+			}
+
+			const uint8 Byte = In[Offset++];
+			Bits |= (uint32)(Byte & 0x7F) << Shift;
+			if ((Byte & 0x80) == 0)
+			{
+				OutValue = (int32)(Bits >> 1) ^ -(int32)(Bits & 1);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	int32 GetDelta(const FGroup& Group, int32 Current, int32 Previous)
+	{
+		return Group.bWrap ? (int32)(int16)(uint16)(Current - Previous) : Current - Previous;
+	}
+
+	int32 ApplyDelta(const FGroup& Group, int32 Previous, int32 Delta)
+	{
+		return Group.bWrap ? (int32)(uint16)(Previous + Delta) : Previous + Delta;
+	}
+
+	void SerializeHeader(FArchive& Ar, FClimbRecordingHeader& Header)
+	{
+		uint32 FileMagic = Magic;
+		uint32 FileVersion = Version;
+		Ar << FileMagic << FileVersion;
+		if (FileMagic != Magic || FileVersion != Version)
+		{
+			Ar.SetError();
+			return;
+		}
+
+		Ar << Header.MapName << Header.StartLocation << Header.StartRotation << Header.StartControlRotation << Header.StartClimbState;
+	}
+}
+
+FClimbRecordedFrame::FClimbRecordedFrame()
+	: DeltaTime(0.0f), Forward(0.0f), Right(0.0f), Actions(EClimbRecordedAction::None)
+	, ControlRotation(ForceInitToZero), Location(ForceInitToZero), Rotation(ForceInitToZero), CameraRotation(ForceInitToZero)
+	, ClimbState(0), MovementMode(0), CustomMode(0)
+{
+}
+
+FName FClimbRecordedFrame::GetActionName(int32 Index)
+{
+	static const FName Names[NumActions] = { TEXT("Jump"), TEXT("SpecialAction") };
+	return Names[Index];
+}
+
+FClimbRecordingHeader::FClimbRecordingHeader()
+	: StartLocation(ForceInitToZero), StartRotation(ForceInitToZero), StartControlRotation(ForceInitToZero), StartClimbState(0)
+{
+}
+
+FClimbRecordingWriter::FClimbRecordingWriter()
+	: ChunkFrames(0), NumFrames(0)
+{
+}
+
+FClimbRecordingWriter::~FClimbRecordingWriter()
+{
+	Close();
+}
+
+bool FClimbRecordingWriter::Open(const FString& Filename, const FClimbRecordingHeader& Header)
+{
+	Close();
+
+	Writer.Reset(IFileManager::Get().CreateFileWriter(*Filename));
+	if (!Writer)
+	{
+		return false;
+	}
+
+	FClimbRecordingHeader Copy = Header;
+	ClimbRecording::SerializeHeader(*Writer, Copy);
+
+	//A chunk's worth is rarely more than a few bytes a frame
+	Chunk.Reset(FramesPerChunk * 8);
+	Previous.Init(0, ClimbRecording::NumFields);
+	ChunkFrames = 0;
+	NumFrames = 0;
+	return !Writer->IsError();
+}
+
+void FClimbRecordingWriter::AddFrame(const FClimbRecordedFrame& Frame)
+{
+	if (!Writer)
+	{
+		return;
+	}
+
+	int32 Current[ClimbRecording::NumFields];
+	ClimbRecording::Quantize(Frame, Current);
+
+	const int32 MaskOffset = Chunk.Add(0);
+	uint8 Mask = 0;
+	for (int32 Index = 0; Index < UE_ARRAY_COUNT(ClimbRecording::Groups); Index++)
+	{
+		const ClimbRecording::FGroup& Group = ClimbRecording::Groups[Index];
+		bool bChanged = false;
+		for (int32 Field = Group.First; Field < Group.First + Group.Num; Field++)
+		{
+			bChanged |= Current[Field] != Previous[Field];
+		}
+
+		if (bChanged)
+		{
+			Mask |= 1 << Index;
+			for (int32 Field = Group.First; Field < Group.First + Group.Num; Field++)
+			{
+				ClimbRecording::WriteVarInt(Chunk, ClimbRecording::GetDelta(Group, Current[Field], Previous[Field]));
+				Previous[Field] = Current[Field];
+			}
+		}
+	}
+	Chunk[MaskOffset] = Mask;
+
+	NumFrames++;
+	if (++ChunkFrames >= FramesPerChunk)
+	{
+		FlushChunk();
+	}
+}
+
+bool FClimbRecordingWriter::Close()
+{
+	if (!Writer)
+	{
+		return false;
+	}
+
+	FlushChunk();
+
+	const bool bOk = Writer->Close();
+	Writer.Reset();
+	return bOk;
+}
+
+int64 FClimbRecordingWriter::GetNumBytes() const
+{
+	return Writer ? Writer->Tell() + Chunk.Num() : 0;
+}
+
+void FClimbRecordingWriter::FlushChunk()
+{
+	if (ChunkFrames > 0)
+	{
+		int32 NumBytes = Chunk.Num();
+		*Writer << ChunkFrames << NumBytes;
+		Writer->Serialize(Chunk.GetData(), NumBytes);
+
+		//On disk a chunk at a time, a session that crashes or is killed keeps everything up to the last one
+		Writer->Flush();
+	}
+
+	//Every chunk codes from zero, so it can be read without the ones before it
+	Chunk.Reset();
+	Previous.Init(0, ClimbRecording::NumFields);
+	ChunkFrames = 0;
+}
+
+FClimbRecordingReader::FClimbRecordingReader()
+	: ChunkOffset(0), ChunkFrames(0)
+{
+}
+
+FClimbRecordingReader::~FClimbRecordingReader()
+{
+}
+
+bool FClimbRecordingReader::Open(const FString& Filename)
+{
+	Reader.Reset(IFileManager::Get().CreateFileReader(*Filename));
+	if (!Reader)
+	{
+		return false;
+	}
+
+	ClimbRecording::SerializeHeader(*Reader, Header);
+	Chunk.Reset();
+	ChunkOffset = 0;
+	ChunkFrames = 0;
+	return !Reader->IsError();
+}
+
+bool FClimbRecordingReader::Next(FClimbRecordedFrame& OutFrame)
+{
+	if (ChunkFrames == 0 && !ReadChunk())
+	{
+		return false;
+	}
+
+	if (ChunkOffset >= Chunk.Num())
+	{
+		return false;
+	}
+
+	const uint8 Mask = Chunk[ChunkOffset++];
+	for (int32 Index = 0; Index < UE_ARRAY_COUNT(ClimbRecording::Groups); Index++)
+	{
+		if ((Mask & (1 << Index)) == 0)
+		{
+			continue;
+		}
+
+		const ClimbRecording::FGroup& Group = ClimbRecording::Groups[Index];
+		for (int32 Field = Group.First; Field < Group.First + Group.Num; Field++)
+		{
+			int32 Delta = 0;
+			if (!ClimbRecording::ReadVarInt(Chunk, ChunkOffset, Delta))
+			{
+				return false;
+			}
+			Previous[Field] = ClimbRecording::ApplyDelta(Group, Previous[Field], Delta);
+		}
+	}
+
+	ClimbRecording::Dequantize(Previous.GetData(), OutFrame);
+	ChunkFrames--;
+	return true;
+}
+
+bool FClimbRecordingReader::ReadChunk()
+{
+	if (!Reader || Reader->AtEnd())
+	{
+		return false;
+	}
+
+	int32 NumBytes = 0;
+	*Reader << ChunkFrames << NumBytes;
+	if (Reader->IsError() || ChunkFrames <= 0 || NumBytes <= 0 || NumBytes > Reader->TotalSize() - Reader->Tell())
+	{
+		//Cut short, the session ended without closing the file
+		ChunkFrames = 0;
+		return false;
+	}
+
+	Chunk.SetNumUninitialized(NumBytes);
+	Reader->Serialize(Chunk.GetData(), NumBytes);
+	ChunkOffset = 0;
+	Previous.Init(0, ClimbRecording::NumFields);
+	return !Reader->IsError();
+}
@@ -0,0 +1,255 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ClimbReplayCommandlet.h"
+#include "FPSClimbCPPTest.h"
+#include "EngiPC.h"
+#include "ClimbingMovementComponent.h"
+#include "ClimbRecording.h"
+#include "ClimbHeadless.h"
+#include "Camera/CameraComponent.h"
+#include "Components/InputComponent.h"
+#include "GameFramework/Controller.h"
+#include "Engine/World.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonWriter.h"
+#include "Serialization/JsonSerializer.h"
+
+namespace ClimbReplay
+{
+	//Slowest frames listed in the report
+	const int32 NumSlowest = 10;
+
+	//Divergent frames listed in the report, the first ones are the ones that explain the rest
+	const int32 NumDivergences = 20;
+
+	//Degrees between two rotations, summed over the axes the short way round
+	float AngleError(const FRotator& A, const FRotator& B)
+	{
+		const FRotator Delta = (A - B).GetNormalized();
+		return FMath::Abs(Delta.Pitch) + FMath::Abs(Delta.Yaw) + FMath::Abs(Delta.Roll);
+	}
+}
+
+UClimbReplayCommandlet::UClimbReplayCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UClimbReplayCommandlet::Main(const FString& Params)
+{
+	FString RecordingFilename;
+	FParse::Value(*Params, TEXT("Recording="), RecordingFilename);
+
+	FClimbRecordingReader Reader;
+	if (RecordingFilename.IsEmpty() || !Reader.Open(RecordingFilename))
+	{
+		UE_LOG(LogClimb, Error, TEXT("ClimbReplay: could not read recording %s"), *RecordingFilename);
+		return 1;
+	}
+	const FClimbRecordingHeader& Header = Reader.GetHeader();
+
+	FString MapName = Header.MapName;
+	FParse::Value(*Params, TEXT("Map="), MapName);
+
+	float Tolerance = 1.0f;
+	float RotationTolerance = 1.0f;
+	int32 MaxDivergentFrames = 0;
+	float MaxFrameMs = 0.0f;
+	FParse::Value(*Params, TEXT("Tolerance="), Tolerance);
+	FParse::Value(*Params, TEXT("RotationTolerance="), RotationTolerance);
+	FParse::Value(*Params, TEXT("MaxDivergentFrames="), MaxDivergentFrames);
+	FParse::Value(*Params, TEXT("MaxFrameMs="), MaxFrameMs);
+
+	FString OutputFilename = FPaths::ProjectSavedDir() / TEXT("ClimbReplay.json");
+	FParse::Value(*Params, TEXT("Output="), OutputFilename);
+
+	UWorld* World = ClimbHeadless::LoadGameWorld(MapName);
+	if (!World)
+	{
+		UE_LOG(LogClimb, Error, TEXT("ClimbReplay: could not load map %s"), *MapName);
+		return 1;
+	}
+
+	if (Header.StartClimbState != (uint8)EClimbState::Grounded)
+	{
+		UE_LOG(LogClimb, Warning, TEXT("ClimbReplay: the recording started off the ground, the replay starts on it and will not match until it lands"));
+	}
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	AEngiPC* Character = World->SpawnActor<AEngiPC>(AEngiPC::StaticClass(), Header.StartLocation, Header.StartRotation, SpawnParams);
+	if (!Character)
+	{
+		UE_LOG(LogClimb, Error, TEXT("ClimbReplay: could not spawn a character at %s"), *Header.StartLocation.ToString());
+		ClimbHeadless::DestroyGameWorld(World);
+		return 1;
+	}
+	Character->SpawnDefaultController();
+	AController* Controller = Character->GetController();
+	Controller->SetControlRotation(Header.StartControlRotation);
+
+	//Same bindings a player gets, fed from the recording instead of a player controller
+	UInputComponent* Input = NewObject<UInputComponent>(Character, TEXT("ClimbReplayInput"));
+	Character->SetupPlayerInputComponent(Input);
+	UClimbingMovementComponent* Movement = Character->GetClimbingMovement();
+
+	TArray<double> FrameTimes;
+	TArray<float> RecordedTimes;
+	TArray<TSharedPtr<FJsonValue>> Divergences;
+	int32 NumDivergent = 0;
+	int32 FirstDivergent = INDEX_NONE;
+	float MaxLocationError = 0.0f;
+	float MaxCameraError = 0.0f;
+	double RecordedSeconds = 0.0;
+
+	FClimbRecordedFrame Frame;
+	EClimbRecordedAction HeldActions = EClimbRecordedAction::None;
+	while (Reader.Next(Frame))
+	{
+		//The look first, the axes turn into movement input along it
+		Controller->SetControlRotation(Frame.ControlRotation);
+
+		for (int32 Index = 0; Index < FClimbRecordedFrame::NumActions; Index++)
+		{
+			const EClimbRecordedAction Action = (EClimbRecordedAction)(1 << Index);
+			const bool bHeld = EnumHasAnyFlags(Frame.Actions, Action);
+			if (bHeld != EnumHasAnyFlags(HeldActions, Action))
+			{
+				ClimbHeadless::SetAction(Input, FClimbRecordedFrame::GetActionName(Index), bHeld);
+			}
+		}
+		HeldActions = Frame.Actions;
+
+		ClimbHeadless::SetAxis(Input, TEXT("MoveForward"), Frame.Forward);
+		ClimbHeadless::SetAxis(Input, TEXT("MoveRight"), Frame.Right);
+
+		const double StartTime = FPlatformTime::Seconds();
+
+		GFrameCounter++;
+		World->Tick(LEVELTICK_All, Frame.DeltaTime);
+
+		FrameTimes.Add((FPlatformTime::Seconds() - StartTime) * 1000.0);
+		RecordedTimes.Add(Frame.DeltaTime * 1000.0f);
+		RecordedSeconds += Frame.DeltaTime;
+
+		//The camera follows the look axes, which are not replayed, so it is only reported
+		const float LocationError = FVector::Dist(Character->GetActorLocation(), Frame.Location);
+		const float RotationError = ClimbReplay::AngleError(Character->GetActorRotation(), Frame.Rotation);
+		const float CameraError = ClimbReplay::AngleError(Character->GetFirstPersonCameraComponent()->GetRelativeRotation(), Frame.CameraRotation);
+		MaxLocationError = FMath::Max(MaxLocationError, LocationError);
+		MaxCameraError = FMath::Max(MaxCameraError, CameraError);
+
+		const bool bStateDiverged = (uint8)Movement->GetClimbState() != Frame.ClimbState
+			|| (uint8)Movement->MovementMode != Frame.MovementMode || Movement->CustomMovementMode != Frame.CustomMode;
+		if (LocationError <= Tolerance && RotationError <= RotationTolerance && !bStateDiverged)
+		{
+			continue;
+		}
+
+		const int32 FrameIndex = FrameTimes.Num() - 1;
+		NumDivergent++;
+		if (FirstDivergent == INDEX_NONE)
+		{
+			FirstDivergent = FrameIndex;
+		}
+
+		if (Divergences.Num() < ClimbReplay::NumDivergences)
+		{
+			TSharedRef<FJsonObject> Divergence = MakeShared<FJsonObject>();
+			Divergence->SetNumberField(TEXT("frame"), FrameIndex);
+			Divergence->SetNumberField(TEXT("locationError"), LocationError);
+			Divergence->SetNumberField(TEXT("rotationError"), RotationError);
+			Divergence->SetNumberField(TEXT("climbState"), (uint8)Movement->GetClimbState());
+			Divergence->SetNumberField(TEXT("recordedClimbState"), Frame.ClimbState);
+			Divergence->SetNumberField(TEXT("movementMode"), (uint8)Movement->MovementMode);
+			Divergence->SetNumberField(TEXT("recordedMovementMode"), Frame.MovementMode);
+			Divergences.Add(MakeShared<FJsonValueObject>(Divergence));
+		}
+	}
+
+	double TotalMs = 0.0;
+	for (double FrameMs : FrameTimes)
+	{
+		TotalMs += FrameMs;
+	}
+
+	TArray<double> SortedTimes = FrameTimes;
+	SortedTimes.Sort();
+	const float P99 = ClimbHeadless::Percentile(SortedTimes, 0.99f);
+
+	//Slowest frames, next to how long the same frame took where it was recorded
+	TArray<int32> Slowest;
+	for (int32 Index = 0; Index < FrameTimes.Num(); Index++)
+	{
+		Slowest.Add(Index);
+	}
+	Slowest.Sort([&FrameTimes](int32 A, int32 B) { return FrameTimes[A] > FrameTimes[B]; });
+	Slowest.SetNum(FMath::Min(Slowest.Num(), ClimbReplay::NumSlowest));
+
+	TArray<TSharedPtr<FJsonValue>> SlowestFrames;
+	for (int32 Index : Slowest)
+	{
+		TSharedRef<FJsonObject> Slow = MakeShared<FJsonObject>();
+		Slow->SetNumberField(TEXT("frame"), Index);
+		Slow->SetNumberField(TEXT("ms"), FrameTimes[Index]);
+		Slow->SetNumberField(TEXT("recordedMs"), RecordedTimes[Index]);
+		SlowestFrames.Add(MakeShared<FJsonValueObject>(Slow));
+	}
+
+	const int32 MeasuredFrames = FMath::Max(FrameTimes.Num(), 1);
+
+	TSharedRef<FJsonObject> GameThread = MakeShared<FJsonObject>();
+	GameThread->SetNumberField(TEXT("mean"), TotalMs / MeasuredFrames);
+	GameThread->SetNumberField(TEXT("p50"), ClimbHeadless::Percentile(SortedTimes, 0.5f));
+	GameThread->SetNumberField(TEXT("p99"), P99);
+	GameThread->SetNumberField(TEXT("max"), SortedTimes.Num() > 0 ? SortedTimes.Last() : 0.0);
+
+	TSharedRef<FJsonObject> Divergence = MakeShared<FJsonObject>();
+	Divergence->SetNumberField(TEXT("frames"), NumDivergent);
+	Divergence->SetNumberField(TEXT("firstFrame"), FirstDivergent);
+	Divergence->SetNumberField(TEXT("maxLocationError"), MaxLocationError);
+	Divergence->SetNumberField(TEXT("maxCameraError"), MaxCameraError);
+	Divergence->SetArrayField(TEXT("first"), Divergences);
+
+	const bool bPassed = FrameTimes.Num() > 0
+		&& (MaxDivergentFrames < 0 || NumDivergent <= MaxDivergentFrames)
+		&& (MaxFrameMs <= 0.0f || P99 <= MaxFrameMs);
+
+	TSharedRef<FJsonObject> Report = MakeShared<FJsonObject>();
+	Report->SetStringField(TEXT("recording"), RecordingFilename);
+	Report->SetStringField(TEXT("map"), MapName);
+	Report->SetNumberField(TEXT("frames"), FrameTimes.Num());
+	Report->SetNumberField(TEXT("recordedSeconds"), RecordedSeconds);
+	Report->SetObjectField(TEXT("gameThreadMs"), GameThread);
+	Report->SetArrayField(TEXT("slowestFrames"), SlowestFrames);
+	Report->SetObjectField(TEXT("divergence"), Divergence);
+	Report->SetBoolField(TEXT("passed"), bPassed);
+
+	FString Json;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Json);
+	FJsonSerializer::Serialize(Report, Writer);
+
+	UE_LOG(LogClimb, Display, TEXT("ClimbReplay: %s"), *Json);
+
+	ClimbHeadless::DestroyGameWorld(World);
+
+	if (!FFileHelper::SaveStringToFile(Json, *OutputFilename))
+	{
+		UE_LOG(LogClimb, Error, TEXT("ClimbReplay: could not write %s"), *OutputFilename);
+		return 1;
+	}
+
+	if (!bPassed)
+	{
+		UE_LOG(LogClimb, Error, TEXT("ClimbReplay: %d of %d frames diverged (first at %d), p99 %.2fms"), NumDivergent, FrameTimes.Num(), FirstDivergent, P99);
+		return 1;
+	}
+
+	return 0;
+}
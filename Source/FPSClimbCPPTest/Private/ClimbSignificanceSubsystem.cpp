@@ -0,0 +1,237 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ClimbSignificanceSubsystem.h"
+#include "FPSClimbCPPTest.h"
+#include "ClimbMemory.h"
+#include "SignificanceManager.h"
+#include "GameFramework/Character.h"
+#include "GameFramework/PlayerController.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("Significance Update"), STAT_ClimbSignificanceUpdate, STATGROUP_Climbing);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Climbers at full detail"), STAT_ClimbLODFull, STATGROUP_Climbing);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Climbers at reduced detail"), STAT_ClimbLODReduced, STATGROUP_Climbing);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Climbers at minimal detail"), STAT_ClimbLODMinimal, STATGROUP_Climbing);
+
+static TAutoConsoleVariable<int32> CVarClimbSignificance(
+	TEXT("climb.Significance"),
+	1,
+	TEXT("Lower probe and tick rates of climbers far from every player. 0 keeps every climber at full detail."),
+	ECVF_Scalability);
+
+static TAutoConsoleVariable<float> CVarClimbSignificanceReducedDistance(
+	TEXT("climb.SignificanceReducedDistance"),
+	3000.0f,
+	TEXT("Climbers farther than this from every player drop to reduced detail."),
+	ECVF_Scalability);
+
+static TAutoConsoleVariable<float> CVarClimbSignificanceMinimalDistance(
+	TEXT("climb.SignificanceMinimalDistance"),
+	8000.0f,
+	TEXT("Climbers farther than this from every player drop to minimal detail."),
+	ECVF_Scalability);
+
+namespace ClimbSignificance
+{
+	const FName Tag(TEXT("Climber"));
+
+	//Fraction of a tier distance a climber has to move past it before it changes tier
+	const float Hysteresis = 0.1f;
+}
+
+UClimbSignificanceSubsystem::UClimbSignificanceSubsystem()
+{
+	ReducedDistance = 0.0f;
+	MinimalDistance = 0.0f;
+	bEnabled = false;
+	bInitialized = false;
+
+	for (int32& Num : NumClimbers)
+	{
+		Num = 0;
+	}
+}
+
+bool UClimbSignificanceSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld();
+}
+
+void UClimbSignificanceSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	bInitialized = true;
+}
+
+void UClimbSignificanceSubsystem::Deinitialize()
+{
+	bInitialized = false;
+
+	Super::Deinitialize();
+}
+
+bool UClimbSignificanceSubsystem::IsTickable() const
+{
+	return bInitialized && !IsTemplate();
+}
+
+TStatId UClimbSignificanceSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UClimbSignificanceSubsystem, STATGROUP_Tickables);
+}
+
+void UClimbSignificanceSubsystem::RegisterClimber(UClimbingMovementComponent* Climber)
+{
+	USignificanceManager* Manager = USignificanceManager::Get(GetWorld());
+	if (!Manager || !Climber)
+	{
+		return;
+	}
+
+	NumClimbers[(int32)Climber->GetClimbLOD()]++;
+	Views.Add(Climber, FClimberView{ FVector::ZeroVector, Climber->GetClimbLOD(), true });
+
+	//The manager may run this on worker threads
+	Manager->RegisterObject(Climber, ClimbSignificance::Tag,
+		[this](USignificanceManager::FManagedObjectInfo* Info, const FTransform& Viewpoint)
+		{
+			return ToSignificance(GetLOD(static_cast<const UClimbingMovementComponent*>(Info->GetObject()), Viewpoint));
+		},
+		USignificanceManager::EPostSignificanceType::Sequential,
+		[this](USignificanceManager::FManagedObjectInfo* Info, float OldSignificance, float NewSignificance, bool bFinal)
+		{
+			//Final is the manager letting go of it, UnregisterClimber does the counting
+			if (!bFinal)
+			{
+				OnSignificanceChanged(CastChecked<UClimbingMovementComponent>(Info->GetObject()), NewSignificance);
+			}
+		});
+}
+
+void UClimbSignificanceSubsystem::UnregisterClimber(UClimbingMovementComponent* Climber)
+{
+	USignificanceManager* Manager = USignificanceManager::Get(GetWorld());
+	if (!Manager || !Climber || !Manager->GetManagedObject(Climber))
+	{
+		return;
+	}
+
+	NumClimbers[(int32)Climber->GetClimbLOD()]--;
+	Views.Remove(Climber);
+	Manager->UnregisterObject(Climber);
+}
+
+EClimbLOD UClimbSignificanceSubsystem::GetLOD(EClimbLOD Current, float Distance, float ReducedDistance, float MinimalDistance)
+{
+	//Leaving a tier takes a little more distance than entering it
+	const float ToReduced = ReducedDistance * ((Current == EClimbLOD::Full) ? 1.0f + ClimbSignificance::Hysteresis : 1.0f - ClimbSignificance::Hysteresis);
+	const float ToMinimal = MinimalDistance * ((Current == EClimbLOD::Minimal) ? 1.0f - ClimbSignificance::Hysteresis : 1.0f + ClimbSignificance::Hysteresis);
+
+	if (Distance > ToMinimal)
+	{
+		return EClimbLOD::Minimal;
+	}
+
+	if (Distance > ToReduced)
+	{
+		return EClimbLOD::Reduced;
+	}
+
+	return EClimbLOD::Full;
+}
+
+float UClimbSignificanceSubsystem::ToSignificance(EClimbLOD LOD)
+{
+	return (float)((int32)EClimbLOD::Minimal - (int32)LOD);
+}
+
+EClimbLOD UClimbSignificanceSubsystem::FromSignificance(float Significance)
+{
+	return (EClimbLOD)FMath::Clamp((int32)EClimbLOD::Minimal - FMath::RoundToInt(Significance), 0, (int32)EClimbLOD::Minimal);
+}
+
+EClimbLOD UClimbSignificanceSubsystem::GetLOD(const UClimbingMovementComponent* Climber, const FTransform& Viewpoint) const
+{
+	const FClimberView* View = Views.Find(Climber);
+	if (!bEnabled || !View || View->bPlayerControlled)
+	{
+		return EClimbLOD::Full;
+	}
+
+	return GetLOD(View->LOD, FVector::Dist(View->Location, Viewpoint.GetLocation()), ReducedDistance, MinimalDistance);
+}
+
+void UClimbSignificanceSubsystem::OnSignificanceChanged(UClimbingMovementComponent* Climber, float NewSignificance)
+{
+	const EClimbLOD OldLOD = Climber->GetClimbLOD();
+	const EClimbLOD NewLOD = FromSignificance(NewSignificance);
+	if (NewLOD == OldLOD)
+	{
+		return;
+	}
+
+	NumClimbers[(int32)OldLOD]--;
+	NumClimbers[(int32)NewLOD]++;
+	Climber->SetClimbLOD(NewLOD);
+}
+
+void UClimbSignificanceSubsystem::UpdateViews()
+{
+	for (TPair<const UClimbingMovementComponent*, FClimberView>& Pair : Views)
+	{
+		//Player-controlled or not yet possessed, either way full detail
+		const ACharacter* Character = Pair.Key->GetCharacterOwner();
+		Pair.Value.bPlayerControlled = !Character || Character->IsPlayerControlled();
+		Pair.Value.Location = Character ? Character->GetActorLocation() : FVector::ZeroVector;
+		Pair.Value.LOD = Pair.Key->GetClimbLOD();
+	}
+}
+
+void UClimbSignificanceSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ClimbSignificanceUpdate);
+	//Only tagged, the significance manager's update is engine code
+	LLM_SCOPE(LLM_TAG_CLIMBING);
+
+	UWorld* World = GetWorld();
+	USignificanceManager* Manager = USignificanceManager::Get(World);
+	if (!Manager)
+	{
+		return;
+	}
+
+	bEnabled = CVarClimbSignificance.GetValueOnGameThread() != 0;
+	ReducedDistance = CVarClimbSignificanceReducedDistance.GetValueOnGameThread();
+	MinimalDistance = FMath::Max(CVarClimbSignificanceMinimalDistance.GetValueOnGameThread(), ReducedDistance);
+
+	//Every local player on a client, every connected player on a server
+	Viewpoints.Reset();
+	for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+	{
+		if (const APlayerController* PlayerController = It->Get())
+		{
+			FVector Location;
+			FRotator Rotation;
+			PlayerController->GetPlayerViewPoint(Location, Rotation);
+			Viewpoints.Emplace(Rotation, Location);
+		}
+	}
+
+	//Nobody watching, leave every climber where it is rather than dropping them all
+	if (Viewpoints.Num() > 0)
+	{
+		UpdateViews();
+		Manager->Update(Viewpoints);
+	}
+
+	SET_DWORD_STAT(STAT_ClimbLODFull, NumClimbers[(int32)EClimbLOD::Full]);
+	SET_DWORD_STAT(STAT_ClimbLODReduced, NumClimbers[(int32)EClimbLOD::Reduced]);
+	SET_DWORD_STAT(STAT_ClimbLODMinimal, NumClimbers[(int32)EClimbLOD::Minimal]);
+	CSV_CUSTOM_STAT(Climbing, LODFull, NumClimbers[(int32)EClimbLOD::Full], ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(Climbing, LODReduced, NumClimbers[(int32)EClimbLOD::Reduced], ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(Climbing, LODMinimal, NumClimbers[(int32)EClimbLOD::Minimal], ECsvCustomStatOp::Set);
+}
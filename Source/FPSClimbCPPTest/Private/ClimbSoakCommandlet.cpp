@@ -0,0 +1,197 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ClimbSoakCommandlet.h"
+#include "FPSClimbCPPTest.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+
+namespace ClimbSoak
+{
+	//Time the server gets to load the map and listen before the clients connect
+	const float ServerStartSeconds = 20.0f;
+
+	//Past the run's length before the server is taken as hung, and for clients to notice the server went
+	const float ServerGraceSeconds = 600.0f;
+	const float ClientGraceSeconds = 30.0f;
+
+	FProcHandle Launch(const FString& Executable, const FString& Args)
+	{
+		UE_LOG(LogClimb, Display, TEXT("ClimbSoak: %s %s"), *Executable, *Args);
+		return FPlatformProcess::CreateProc(*Executable, *Args, true, false, false, nullptr, 0, nullptr, nullptr);
+	}
+
+	void Stop(FProcHandle& Process)
+	{
+		if (Process.IsValid())
+		{
+			if (FPlatformProcess::IsProcRunning(Process))
+			{
+				FPlatformProcess::TerminateProc(Process, true);
+			}
+			FPlatformProcess::CloseProc(Process);
+		}
+	}
+}
+
+UClimbSoakCommandlet::UClimbSoakCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UClimbSoakCommandlet::Main(const FString& Params)
+{
+	FString MapName;
+	if (!FParse::Value(*Params, TEXT("Map="), MapName))
+	{
+		MapName = TEXT("/Game/TestLevel");
+	}
+
+	int32 NumClients = 4;
+	float Minutes = 120.0f;
+	float SampleSeconds = 10.0f;
+	int32 PktLag = 100;
+	int32 PktLagVariance = 20;
+	int32 PktLoss = 1;
+	int32 Port = 17777;
+	int32 Seed = 0;
+	float MaxMemoryGrowth = 0.0f;
+	float MaxCorrections = 0.0f;
+	FParse::Value(*Params, TEXT("Clients="), NumClients);
+	FParse::Value(*Params, TEXT("Minutes="), Minutes);
+	FParse::Value(*Params, TEXT("SampleSeconds="), SampleSeconds);
+	FParse::Value(*Params, TEXT("PktLag="), PktLag);
+	FParse::Value(*Params, TEXT("PktLagVariance="), PktLagVariance);
+	FParse::Value(*Params, TEXT("PktLoss="), PktLoss);
+	FParse::Value(*Params, TEXT("Port="), Port);
+	FParse::Value(*Params, TEXT("Seed="), Seed);
+	FParse::Value(*Params, TEXT("MaxMemoryGrowth="), MaxMemoryGrowth);
+	FParse::Value(*Params, TEXT("MaxCorrections="), MaxCorrections);
+	NumClients = FMath::Max(NumClients, 1);
+
+	FString OutputDir = FPaths::ProjectSavedDir() / TEXT("ClimbSoak");
+	FParse::Value(*Params, TEXT("Output="), OutputDir);
+	OutputDir = FPaths::ConvertRelativePathToFull(OutputDir);
+	IFileManager::Get().MakeDirectory(*OutputDir, true);
+
+	const FString SummaryFilename = OutputDir / TEXT("Summary.json");
+	IFileManager::Get().Delete(*SummaryFilename);
+
+	//This executable runs the project as either side, a packaged build does not need it named
+	const FString ProjectArg = FString::Printf(TEXT("\"%s\" "), *FPaths::ConvertRelativePathToFull(FPaths::GetProjectFilePath()));
+	FString ServerExe;
+	FString ClientExe;
+	const bool bServerPackaged = FParse::Value(*Params, TEXT("ServerExe="), ServerExe);
+	const bool bClientPackaged = FParse::Value(*Params, TEXT("ClientExe="), ClientExe);
+	if (!bServerPackaged)
+	{
+		ServerExe = FPlatformProcess::ExecutablePath();
+	}
+	if (!bClientPackaged)
+	{
+		ClientExe = FPlatformProcess::ExecutablePath();
+	}
+
+	const FString SoakArgs = FString::Printf(TEXT("-ClimbSoak -ClimbSoakMinutes=%g -ClimbSoakSampleSeconds=%g -ClimbSoakOutput=\"%s\" -PktLag=%d -PktLagVariance=%d -PktLoss=%d -unattended -nullrhi -nosound"),
+		Minutes, SampleSeconds, *OutputDir, PktLag, PktLagVariance, PktLoss);
+
+	const FString ServerArgs = FString::Printf(TEXT("%s%s -server -Port=%d %s -ClimbSoakMaxMemoryGrowth=%g -ClimbSoakMaxCorrections=%g -abslog=\"%s\""),
+		bServerPackaged ? TEXT("") : *ProjectArg, *MapName, Port, *SoakArgs, MaxMemoryGrowth, MaxCorrections, *(OutputDir / TEXT("Server.log")));
+	FProcHandle Server = ClimbSoak::Launch(ServerExe, ServerArgs);
+	if (!Server.IsValid())
+	{
+		UE_LOG(LogClimb, Error, TEXT("ClimbSoak: could not start the server %s"), *ServerExe);
+		return 1;
+	}
+
+	FPlatformProcess::Sleep(ClimbSoak::ServerStartSeconds);
+
+	//Each client plays its own keys
+	TArray<FProcHandle> Clients;
+	for (int32 Index = 0; Index < NumClients; Index++)
+	{
+		const FString ClientArgs = FString::Printf(TEXT("%s127.0.0.1:%d -game %s -ClimbSoakSeed=%d -abslog=\"%s\""),
+			bClientPackaged ? TEXT("") : *ProjectArg, Port, *SoakArgs, Seed + Index, *(OutputDir / FString::Printf(TEXT("Client%d.log"), Index)));
+		FProcHandle Client = ClimbSoak::Launch(ClientExe, ClientArgs);
+		if (!Client.IsValid())
+		{
+			UE_LOG(LogClimb, Warning, TEXT("ClimbSoak: could not start client %d"), Index);
+			continue;
+		}
+		Clients.Add(Client);
+	}
+
+	//The server ends the run, it exits once the summary is written
+	const double StartTime = FPlatformTime::Seconds();
+	const double Deadline = StartTime + Minutes * 60.0 + ClimbSoak::ServerGraceSeconds;
+	double NextProgressTime = StartTime + 60.0;
+	bool bServerHung = false;
+	while (FPlatformProcess::IsProcRunning(Server))
+	{
+		FPlatformProcess::Sleep(1.0f);
+
+		const double Now = FPlatformTime::Seconds();
+		if (Now >= NextProgressTime)
+		{
+			int32 NumRunning = 0;
+			for (FProcHandle& Client : Clients)
+			{
+				NumRunning += FPlatformProcess::IsProcRunning(Client) ? 1 : 0;
+			}
+			UE_LOG(LogClimb, Display, TEXT("ClimbSoak: %.0f of %.0f minutes, %d of %d clients running"), (Now - StartTime) / 60.0, Minutes, NumRunning, Clients.Num());
+			NextProgressTime += 60.0;
+		}
+
+		if (Now >= Deadline)
+		{
+			bServerHung = true;
+			break;
+		}
+	}
+
+	const double ClientDeadline = FPlatformTime::Seconds() + ClimbSoak::ClientGraceSeconds;
+	for (FProcHandle& Client : Clients)
+	{
+		while (FPlatformProcess::IsProcRunning(Client) && FPlatformTime::Seconds() < ClientDeadline)
+		{
+			FPlatformProcess::Sleep(0.5f);
+		}
+		ClimbSoak::Stop(Client);
+	}
+	ClimbSoak::Stop(Server);
+
+	if (bServerHung)
+	{
+		UE_LOG(LogClimb, Error, TEXT("ClimbSoak: the server was still running %.0f seconds after the run, see %s"), ClimbSoak::ServerGraceSeconds, *(OutputDir / TEXT("Server.log")));
+		return 1;
+	}
+
+	FString Json;
+	TSharedPtr<FJsonObject> Summary;
+	if (!FFileHelper::LoadFileToString(Json, *SummaryFilename)
+		|| !FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(Json), Summary) || !Summary.IsValid())
+	{
+		UE_LOG(LogClimb, Error, TEXT("ClimbSoak: the server wrote no summary, see %s"), *(OutputDir / TEXT("Server.log")));
+		return 1;
+	}
+
+	UE_LOG(LogClimb, Display, TEXT("ClimbSoak: %s"), *Json);
+
+	bool bPassed = false;
+	Summary->TryGetBoolField(TEXT("passed"), bPassed);
+	if (!bPassed)
+	{
+		UE_LOG(LogClimb, Error, TEXT("ClimbSoak: failed, see %s and %s"), *SummaryFilename, *(OutputDir / TEXT("Server.csv")));
+		return 1;
+	}
+
+	return 0;
+}
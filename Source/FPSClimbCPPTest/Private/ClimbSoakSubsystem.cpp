@@ -0,0 +1,509 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ClimbSoakSubsystem.h"
+#include "FPSClimbCPPTest.h"
+#include "ClimbingMovementComponent.h"
+#include "ClimbMemory.h"
+#include "GameFramework/Character.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/InputSettings.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "Engine/NetDriver.h"
+#include "Engine/NetConnection.h"
+#include "HAL/PlatformMemory.h"
+#include "HAL/FileManager.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonWriter.h"
+#include "Serialization/JsonSerializer.h"
+
+namespace ClimbSoak
+{
+	const double MB = 1024.0 * 1024.0;
+
+	//Tick histogram, 0.1ms buckets up to a second, the last one takes everything slower
+	const float HistogramMs = 0.1f;
+	const int32 HistogramBuckets = 10000;
+
+	//Memory settles after the map loads and the first clients join, growth is fitted from here on
+	const float WarmupFraction = 0.1f;
+
+	float Percentile(const TArray<uint32>& Histogram, uint64 Total, float Fraction)
+	{
+		const uint64 Target = (uint64)(Total * Fraction);
+		uint64 Count = 0;
+		for (int32 Bucket = 0; Bucket < Histogram.Num(); Bucket++)
+		{
+			Count += Histogram[Bucket];
+			if (Count > Target)
+			{
+				return (Bucket + 1) * HistogramMs;
+			}
+		}
+		return Histogram.Num() * HistogramMs;
+	}
+
+	//Least squares slope of used memory against time, in MB per hour
+	double GrowthPerHour(const TArray<double>& Hours, const TArray<double>& MBs)
+	{
+		const int32 Num = Hours.Num();
+		if (Num < 2)
+		{
+			return 0.0;
+		}
+
+		double MeanX = 0.0;
+		double MeanY = 0.0;
+		for (int32 Index = 0; Index < Num; Index++)
+		{
+			MeanX += Hours[Index];
+			MeanY += MBs[Index];
+		}
+		MeanX /= Num;
+		MeanY /= Num;
+
+		double Covariance = 0.0;
+		double Variance = 0.0;
+		for (int32 Index = 0; Index < Num; Index++)
+		{
+			Covariance += (Hours[Index] - MeanX) * (MBs[Index] - MeanY);
+			Variance += FMath::Square(Hours[Index] - MeanX);
+		}
+		return (Variance > 0.0) ? Covariance / Variance : 0.0;
+	}
+}
+
+UClimbSoakSubsystem::UClimbSoakSubsystem()
+{
+	StartTime = 0.0;
+	Duration = 0.0;
+	SampleSeconds = 0.0;
+	NextSampleTime = 0.0;
+	MaxMemoryGrowth = 0.0f;
+	MaxCorrections = 0.0f;
+	TickStartTime = 0.0;
+	TickMsTotal = 0.0;
+	TickMsMax = 0.0f;
+	TickCount = 0;
+	NextChangeTime = 0.0;
+	bJumpHeld = false;
+	bSprintHeld = false;
+	bInitialized = false;
+	bFinished = false;
+}
+
+bool UClimbSoakSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld() && FParse::Param(FCommandLine::Get(), TEXT("ClimbSoak"));
+}
+
+void UClimbSoakSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	const TCHAR* CommandLine = FCommandLine::Get();
+
+	float Minutes = 120.0f;
+	float Seconds = 10.0f;
+	int32 Seed = 0;
+	FParse::Value(CommandLine, TEXT("ClimbSoakMinutes="), Minutes);
+	FParse::Value(CommandLine, TEXT("ClimbSoakSampleSeconds="), Seconds);
+	FParse::Value(CommandLine, TEXT("ClimbSoakSeed="), Seed);
+	FParse::Value(CommandLine, TEXT("ClimbSoakMaxMemoryGrowth="), MaxMemoryGrowth);
+	FParse::Value(CommandLine, TEXT("ClimbSoakMaxCorrections="), MaxCorrections);
+
+	OutputDir = FPaths::ProjectSavedDir() / TEXT("ClimbSoak");
+	FParse::Value(CommandLine, TEXT("ClimbSoakOutput="), OutputDir);
+
+	StartTime = FPlatformTime::Seconds();
+	Duration = FMath::Max(Minutes, 0.0f) * 60.0;
+	SampleSeconds = FMath::Max(Seconds, 1.0f);
+	NextSampleTime = StartTime + SampleSeconds;
+
+	TickHistogram.SetNumZeroed(ClimbSoak::HistogramBuckets);
+
+	//Every client process gets its own seed from the commandlet, the same seed plays the same keys
+	Stream.Initialize(Seed);
+	ForwardKey = EKeys::Invalid;
+	RightKey = EKeys::Invalid;
+	JumpKey = FindActionKey(TEXT("Jump"));
+	SprintKey = FindActionKey(TEXT("SpecialAction"));
+
+	TickStartHandle = FWorldDelegates::OnWorldTickStart.AddUObject(this, &UClimbSoakSubsystem::OnWorldTickStart);
+	EndFrameHandle = FCoreDelegates::OnEndFrame.AddUObject(this, &UClimbSoakSubsystem::OnEndFrame);
+	if (GEngine)
+	{
+		NetworkFailureHandle = GEngine->OnNetworkFailure().AddUObject(this, &UClimbSoakSubsystem::OnNetworkFailure);
+	}
+
+	bInitialized = true;
+}
+
+void UClimbSoakSubsystem::Deinitialize()
+{
+	FWorldDelegates::OnWorldTickStart.Remove(TickStartHandle);
+	FCoreDelegates::OnEndFrame.Remove(EndFrameHandle);
+	if (GEngine)
+	{
+		GEngine->OnNetworkFailure().Remove(NetworkFailureHandle);
+	}
+
+	bInitialized = false;
+
+	Super::Deinitialize();
+}
+
+bool UClimbSoakSubsystem::IsTickable() const
+{
+	return bInitialized && !bFinished && !IsTemplate();
+}
+
+TStatId UClimbSoakSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UClimbSoakSubsystem, STATGROUP_Tickables);
+}
+
+void UClimbSoakSubsystem::Tick(float DeltaTime)
+{
+	switch (GetWorld()->GetNetMode())
+	{
+	case NM_Client:
+		TickBot();
+		break;
+	case NM_DedicatedServer:
+		TickServer();
+		break;
+	default:
+		//The client's entry map before it connects
+		break;
+	}
+}
+
+void UClimbSoakSubsystem::TickBot()
+{
+	APlayerController* Controller = GetWorld()->GetFirstPlayerController();
+	if (!Controller || !Controller->GetPawn())
+	{
+		return;
+	}
+
+	if (bJumpHeld)
+	{
+		Controller->InputKey(JumpKey, IE_Released, 0.0f, false);
+		bJumpHeld = false;
+	}
+
+	const double Now = FPlatformTime::Seconds();
+	if (Now < NextChangeTime)
+	{
+		return;
+	}
+	NextChangeTime = Now + Stream.FRandRange(0.5f, 3.0f);
+
+	//The same odds as the ClimbBench bots
+	const float ForwardChoices[] = { 1.0f, 1.0f, 0.0f, -1.0f };
+	PressKey(Controller, ForwardKey, FindAxisKey(TEXT("MoveForward"), ForwardChoices[Stream.RandRange(0, 3)]));
+	PressKey(Controller, RightKey, FindAxisKey(TEXT("MoveRight"), (float)Stream.RandRange(-1, 1)));
+
+	if (Stream.FRand() < 0.4f && JumpKey.IsValid())
+	{
+		Controller->InputKey(JumpKey, IE_Pressed, 1.0f, false);
+		bJumpHeld = true;
+	}
+
+	if (Stream.FRand() < 0.1f && SprintKey.IsValid())
+	{
+		bSprintHeld = !bSprintHeld;
+		Controller->InputKey(SprintKey, bSprintHeld ? IE_Pressed : IE_Released, bSprintHeld ? 1.0f : 0.0f, false);
+	}
+
+	//Look somewhere else now and then so the bot runs into more than one wall, not while the climb owns the camera
+	const ACharacter* Character = Cast<ACharacter>(Controller->GetPawn());
+	const UClimbingMovementComponent* Climber = Character ? Cast<UClimbingMovementComponent>(Character->GetCharacterMovement()) : nullptr;
+	if ((!Climber || !Climber->IsClimbing()) && Stream.FRand() < 0.3f)
+	{
+		Controller->SetControlRotation(FRotator(0.0f, Stream.FRandRange(0.0f, 360.0f), 0.0f));
+	}
+}
+
+void UClimbSoakSubsystem::PressKey(APlayerController* Controller, FKey& Held, const FKey& Key)
+{
+	if (Held == Key)
+	{
+		return;
+	}
+
+	if (Held.IsValid())
+	{
+		Controller->InputKey(Held, IE_Released, 0.0f, false);
+	}
+
+	Held = Key;
+	if (Held.IsValid())
+	{
+		Controller->InputKey(Held, IE_Pressed, 1.0f, false);
+	}
+}
+
+void UClimbSoakSubsystem::TickServer()
+{
+	const double Now = FPlatformTime::Seconds();
+	if (Now < NextSampleTime)
+	{
+		return;
+	}
+	NextSampleTime += SampleSeconds;
+
+	FSample Sample;
+	Sample.Time = Now - StartTime;
+	Sample.TickMsMean = (TickCount > 0) ? (float)(TickMsTotal / TickCount) : 0.0f;
+	Sample.TickMsMax = TickMsMax;
+	Sample.TickCount = TickCount;
+	Sample.Connections = 0;
+	Sample.InBytesPerConnection = 0.0f;
+	Sample.OutBytesPerConnection = 0.0f;
+	Sample.MaxOutBytes = 0.0f;
+
+	//Bytes per second over the connection's last stat period
+	if (const UNetDriver* NetDriver = GetWorld()->GetNetDriver())
+	{
+		for (const UNetConnection* Connection : NetDriver->ClientConnections)
+		{
+			if (Connection)
+			{
+				Sample.Connections++;
+				Sample.InBytesPerConnection += Connection->InBytesPerSecond;
+				Sample.OutBytesPerConnection += Connection->OutBytesPerSecond;
+				Sample.MaxOutBytes = FMath::Max(Sample.MaxOutBytes, (float)Connection->OutBytesPerSecond);
+			}
+		}
+	}
+	if (Sample.Connections > 0)
+	{
+		Sample.InBytesPerConnection /= Sample.Connections;
+		Sample.OutBytesPerConnection /= Sample.Connections;
+	}
+
+	Sample.Corrections = UClimbingMovementComponent::GetNumNetCorrections();
+	Sample.TransitionCorrections = UClimbingMovementComponent::GetNumNetTransitionCorrections();
+
+	Sample.UsedMB = FPlatformMemory::GetStats().UsedPhysical / ClimbSoak::MB;
+	Sample.ClimbingMB = 0.0;
+#if ENABLE_LOW_LEVEL_MEM_TRACKER
+	if (FLowLevelMemTracker::IsEnabled())
+	{
+		Sample.ClimbingMB = FLowLevelMemTracker::Get().GetTagAmountForTracker(ELLMTracker::Default, LLM_TAG_CLIMBING) / ClimbSoak::MB;
+	}
+#endif
+	Sample.Objects = GUObjectArray.GetObjectArrayNumMinusAvailable();
+
+	Samples.Add(Sample);
+	WriteSample(Sample);
+
+	TickMsTotal = 0.0;
+	TickMsMax = 0.0f;
+	TickCount = 0;
+
+	if (Sample.Time >= Duration)
+	{
+		Finish();
+	}
+}
+
+void UClimbSoakSubsystem::OnWorldTickStart(UWorld* InWorld, ELevelTick TickType, float DeltaSeconds)
+{
+	if (InWorld == GetWorld())
+	{
+		TickStartTime = FPlatformTime::Seconds();
+	}
+}
+
+void UClimbSoakSubsystem::OnEndFrame()
+{
+	if (TickStartTime <= 0.0 || bFinished)
+	{
+		return;
+	}
+
+	const float TickMs = (float)((FPlatformTime::Seconds() - TickStartTime) * 1000.0);
+	TickStartTime = 0.0;
+
+	TickMsTotal += TickMs;
+	TickMsMax = FMath::Max(TickMsMax, TickMs);
+	TickCount++;
+	TickHistogram[FMath::Clamp(FMath::FloorToInt(TickMs / ClimbSoak::HistogramMs), 0, ClimbSoak::HistogramBuckets - 1)]++;
+}
+
+void UClimbSoakSubsystem::OnNetworkFailure(UWorld* InWorld, UNetDriver* NetDriver, ENetworkFailure::Type FailureType, const FString& ErrorString)
+{
+	if (InWorld == GetWorld() && InWorld->GetNetMode() == NM_Client)
+	{
+		UE_LOG(LogClimb, Display, TEXT("ClimbSoak: lost the server (%s), exiting"), *ErrorString);
+		bFinished = true;
+		FPlatformMisc::RequestExit(false);
+	}
+}
+
+void UClimbSoakSubsystem::WriteSample(const FSample& Sample)
+{
+	const FString Filename = OutputDir / TEXT("Server.csv");
+
+	FString Line;
+	if (Samples.Num() == 1)
+	{
+		Line = TEXT("Seconds,TickMsMean,TickMsMax,Ticks,Connections,InBytesPerConnection,OutBytesPerConnection,MaxOutBytes,Corrections,TransitionCorrections,UsedMB,ClimbingMB,Objects\n");
+	}
+
+	Line += FString::Printf(TEXT("%.1f,%.3f,%.3f,%d,%d,%.0f,%.0f,%.0f,%llu,%llu,%.2f,%.2f,%d\n"),
+		Sample.Time, Sample.TickMsMean, Sample.TickMsMax, Sample.TickCount, Sample.Connections,
+		Sample.InBytesPerConnection, Sample.OutBytesPerConnection, Sample.MaxOutBytes,
+		Sample.Corrections, Sample.TransitionCorrections, Sample.UsedMB, Sample.ClimbingMB, Sample.Objects);
+
+	//The first row truncates what an earlier run left behind
+	const uint32 WriteFlags = (Samples.Num() == 1) ? FILEWRITE_None : FILEWRITE_Append;
+	if (!FFileHelper::SaveStringToFile(Line, *Filename, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), WriteFlags))
+	{
+		UE_LOG(LogClimb, Warning, TEXT("ClimbSoak: could not write %s"), *Filename);
+	}
+}
+
+void UClimbSoakSubsystem::Finish()
+{
+	bFinished = true;
+
+	//Growth after warmup, the last sample's counters are totals over the run
+	const int32 FirstFitted = FMath::Min(FMath::FloorToInt(Samples.Num() * ClimbSoak::WarmupFraction), FMath::Max(Samples.Num() - 2, 0));
+	TArray<double> Hours;
+	TArray<double> UsedMBs;
+	TArray<double> ClimbingMBs;
+	double ClientMinutes = 0.0;
+	double OutBytesTotal = 0.0;
+	float OutBytesMax = 0.0f;
+	int32 MaxConnections = 0;
+	uint64 NumTicks = 0;
+	for (int32 Index = 0; Index < Samples.Num(); Index++)
+	{
+		const FSample& Sample = Samples[Index];
+		if (Index >= FirstFitted)
+		{
+			Hours.Add(Sample.Time / 3600.0);
+			UsedMBs.Add(Sample.UsedMB);
+			ClimbingMBs.Add(Sample.ClimbingMB);
+		}
+		ClientMinutes += Sample.Connections * SampleSeconds / 60.0;
+		OutBytesTotal += Sample.OutBytesPerConnection;
+		OutBytesMax = FMath::Max(OutBytesMax, Sample.MaxOutBytes);
+		MaxConnections = FMath::Max(MaxConnections, Sample.Connections);
+	}
+	for (uint32 Count : TickHistogram)
+	{
+		NumTicks += Count;
+	}
+
+	const uint64 Corrections = UClimbingMovementComponent::GetNumNetCorrections();
+	const uint64 TransitionCorrections = UClimbingMovementComponent::GetNumNetTransitionCorrections();
+	const double CorrectionsPerClientMinute = (ClientMinutes > 0.0) ? Corrections / ClientMinutes : 0.0;
+	const double Growth = ClimbSoak::GrowthPerHour(Hours, UsedMBs);
+
+	bool bPassed = MaxConnections > 0;
+	if (MaxMemoryGrowth > 0.0f && Growth > MaxMemoryGrowth)
+	{
+		bPassed = false;
+	}
+	if (MaxCorrections > 0.0f && CorrectionsPerClientMinute > MaxCorrections)
+	{
+		bPassed = false;
+	}
+
+	TSharedRef<FJsonObject> Report = MakeShared<FJsonObject>();
+	Report->SetStringField(TEXT("map"), GetWorld()->GetMapName());
+	Report->SetNumberField(TEXT("minutes"), Samples.Num() > 0 ? Samples.Last().Time / 60.0 : 0.0);
+	Report->SetNumberField(TEXT("samples"), Samples.Num());
+	Report->SetNumberField(TEXT("maxClients"), MaxConnections);
+
+	TSharedRef<FJsonObject> Tick = MakeShared<FJsonObject>();
+	Tick->SetNumberField(TEXT("ticks"), (double)NumTicks);
+	Tick->SetNumberField(TEXT("p50"), ClimbSoak::Percentile(TickHistogram, NumTicks, 0.5f));
+	Tick->SetNumberField(TEXT("p99"), ClimbSoak::Percentile(TickHistogram, NumTicks, 0.99f));
+	float TickMax = 0.0f;
+	for (const FSample& Sample : Samples)
+	{
+		TickMax = FMath::Max(TickMax, Sample.TickMsMax);
+	}
+	Tick->SetNumberField(TEXT("max"), TickMax);
+	Report->SetObjectField(TEXT("serverTickMs"), Tick);
+
+	TSharedRef<FJsonObject> Bandwidth = MakeShared<FJsonObject>();
+	Bandwidth->SetNumberField(TEXT("meanOutBytesPerClient"), Samples.Num() > 0 ? OutBytesTotal / Samples.Num() : 0.0);
+	Bandwidth->SetNumberField(TEXT("maxOutBytes"), OutBytesMax);
+	Report->SetObjectField(TEXT("bandwidth"), Bandwidth);
+
+	TSharedRef<FJsonObject> Memory = MakeShared<FJsonObject>();
+	Memory->SetNumberField(TEXT("startMB"), UsedMBs.Num() > 0 ? UsedMBs[0] : 0.0);
+	Memory->SetNumberField(TEXT("endMB"), UsedMBs.Num() > 0 ? UsedMBs.Last() : 0.0);
+	Memory->SetNumberField(TEXT("growthMBPerHour"), Growth);
+	Memory->SetNumberField(TEXT("climbingGrowthMBPerHour"), ClimbSoak::GrowthPerHour(Hours, ClimbingMBs));
+	Memory->SetNumberField(TEXT("maxGrowthMBPerHour"), MaxMemoryGrowth);
+	Report->SetObjectField(TEXT("memory"), Memory);
+
+	TSharedRef<FJsonObject> Net = MakeShared<FJsonObject>();
+	Net->SetNumberField(TEXT("corrections"), (double)Corrections);
+	Net->SetNumberField(TEXT("transitionCorrections"), (double)TransitionCorrections);
+	Net->SetNumberField(TEXT("correctionsPerClientMinute"), CorrectionsPerClientMinute);
+	Net->SetNumberField(TEXT("maxCorrectionsPerClientMinute"), MaxCorrections);
+	Report->SetObjectField(TEXT("corrections"), Net);
+
+	Report->SetBoolField(TEXT("passed"), bPassed);
+
+	FString Json;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Json);
+	FJsonSerializer::Serialize(Report, Writer);
+
+	UE_LOG(LogClimb, Display, TEXT("ClimbSoak: %s"), *Json);
+
+	const FString Filename = OutputDir / TEXT("Summary.json");
+	if (!FFileHelper::SaveStringToFile(Json, *Filename))
+	{
+		UE_LOG(LogClimb, Error, TEXT("ClimbSoak: could not write %s"), *Filename);
+	}
+
+	FPlatformMisc::RequestExit(false);
+}
+
+FKey UClimbSoakSubsystem::FindAxisKey(FName Axis, float Scale)
+{
+	if (Scale == 0.0f)
+	{
+		return EKeys::Invalid;
+	}
+
+	TArray<FInputAxisKeyMapping> Mappings;
+	UInputSettings::GetInputSettings()->GetAxisMappingByName(Axis, Mappings);
+	for (const FInputAxisKeyMapping& Mapping : Mappings)
+	{
+		if (Mapping.Scale == Scale && !Mapping.Key.IsGamepadKey())
+		{
+			return Mapping.Key;
+		}
+	}
+	return EKeys::Invalid;
+}
+
+FKey UClimbSoakSubsystem::FindActionKey(FName Action)
+{
+	TArray<FInputActionKeyMapping> Mappings;
+	UInputSettings::GetInputSettings()->GetActionMappingByName(Action, Mappings);
+	for (const FInputActionKeyMapping& Mapping : Mappings)
+	{
+		if (!Mapping.Key.IsGamepadKey())
+		{
+			return Mapping.Key;
+		}
+	}
+	return EKeys::Invalid;
+}
@@ -0,0 +1,203 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ClimbSpatialHashSubsystem.h"
+#include "FPSClimbCPPTest.h"
+#include "ClimbingMovementComponent.h"
+#include "Engine/World.h"
+
+DECLARE_CYCLE_STAT(TEXT("Spatial Hash Query"), STAT_ClimbSpatialHashQuery, STATGROUP_Climbing);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Spatial hash cell changes"), STAT_ClimbSpatialHashCellChanges, STATGROUP_Climbing);
+
+namespace ClimbSpatialHash
+{
+	//About a climber and the reach of its probes, a neighbour query rarely needs more than the 2x2x2 cells around it
+	const float CellSize = 200.0f;
+
+	//Power of two, more than enough for every climber of a crowded level to have its own
+	const int32 NumBuckets = 1024;
+}
+
+FClimbSpatialHash::FClimbSpatialHash()
+{
+	Reset();
+}
+
+int32 FClimbSpatialHash::Add(const UClimbingMovementComponent* Climber, AActor* Owner, const FVector& Location, const FVector& WallNormal)
+{
+	int32 Index = FreeList;
+	if (Index != INDEX_NONE)
+	{
+		FreeList = Entries[Index].Next;
+	}
+	else
+	{
+		Index = Entries.AddUninitialized();
+	}
+
+	FEntry& Entry = Entries[Index];
+	Entry.Neighbour.Climber = Climber;
+	Entry.Neighbour.Owner = Owner;
+	Entry.Neighbour.Location = Location;
+	Entry.Neighbour.WallNormal = WallNormal;
+	Entry.Cell = GetCell(Location);
+	Entry.bUsed = true;
+	Link(Index);
+
+	NumClimbers++;
+	return Index;
+}
+
+void FClimbSpatialHash::Move(int32 Index, const FVector& Location, const FVector& WallNormal)
+{
+	if (!Entries.IsValidIndex(Index) || !Entries[Index].bUsed)
+	{
+		return;
+	}
+
+	FEntry& Entry = Entries[Index];
+	Entry.Neighbour.Location = Location;
+	Entry.Neighbour.WallNormal = WallNormal;
+
+	const FIntVector Cell = GetCell(Location);
+	if (Cell != Entry.Cell)
+	{
+		INC_DWORD_STAT(STAT_ClimbSpatialHashCellChanges);
+		Unlink(Index);
+		Entry.Cell = Cell;
+		Link(Index);
+	}
+}
+
+void FClimbSpatialHash::Remove(int32 Index)
+{
+	if (!Entries.IsValidIndex(Index) || !Entries[Index].bUsed)
+	{
+		return;
+	}
+
+	Unlink(Index);
+
+	FEntry& Entry = Entries[Index];
+	Entry.Neighbour.Climber = nullptr;
+	Entry.Neighbour.Owner = nullptr;
+	Entry.bUsed = false;
+	Entry.Prev = INDEX_NONE;
+	Entry.Next = FreeList;
+	FreeList = Index;
+
+	NumClimbers--;
+}
+
+void FClimbSpatialHash::FindNeighbours(const FVector& Location, float Radius, int32 IgnoreIndex, FClimbNeighbours& OutNeighbours) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_ClimbSpatialHashQuery);
+
+	OutNeighbours.Reset();
+	if (NumClimbers == 0 || Buckets.Num() == 0)
+	{
+		return;
+	}
+
+	const float RadiusSq = FMath::Square(Radius);
+	const FIntVector Min = GetCell(Location - FVector(Radius));
+	const FIntVector Max = GetCell(Location + FVector(Radius));
+
+	for (int32 Z = Min.Z; Z <= Max.Z; Z++)
+	{
+		for (int32 Y = Min.Y; Y <= Max.Y; Y++)
+		{
+			for (int32 X = Min.X; X <= Max.X; X++)
+			{
+				//Cells share buckets, only the entries of this one count so none is found twice
+				const FIntVector Cell(X, Y, Z);
+				for (int32 Index = Buckets[GetBucket(Cell)]; Index != INDEX_NONE; Index = Entries[Index].Next)
+				{
+					const FEntry& Entry = Entries[Index];
+					if (Index != IgnoreIndex && Entry.Cell == Cell
+						&& FVector::DistSquared(Entry.Neighbour.Location, Location) <= RadiusSq)
+					{
+						OutNeighbours.Add(Entry.Neighbour);
+					}
+				}
+			}
+		}
+	}
+}
+
+void FClimbSpatialHash::Reset()
+{
+	Entries.Empty();
+	Buckets.Init(INDEX_NONE, ClimbSpatialHash::NumBuckets);
+	FreeList = INDEX_NONE;
+	NumClimbers = 0;
+}
+
+FIntVector FClimbSpatialHash::GetCell(const FVector& Location)
+{
+	return FIntVector(
+		FMath::FloorToInt(Location.X / ClimbSpatialHash::CellSize),
+		FMath::FloorToInt(Location.Y / ClimbSpatialHash::CellSize),
+		FMath::FloorToInt(Location.Z / ClimbSpatialHash::CellSize));
+}
+
+int32 FClimbSpatialHash::GetBucket(const FIntVector& Cell)
+{
+	//The usual large primes, cells next to each other land in unrelated buckets
+	const uint32 Hash = ((uint32)Cell.X * 73856093u) ^ ((uint32)Cell.Y * 19349663u) ^ ((uint32)Cell.Z * 83492791u);
+	return (int32)(Hash & (uint32)(ClimbSpatialHash::NumBuckets - 1));
+}
+
+void FClimbSpatialHash::Link(int32 Index)
+{
+	FEntry& Entry = Entries[Index];
+	int32& Head = Buckets[GetBucket(Entry.Cell)];
+
+	Entry.Prev = INDEX_NONE;
+	Entry.Next = Head;
+	if (Head != INDEX_NONE)
+	{
+		Entries[Head].Prev = Index;
+	}
+	Head = Index;
+}
+
+void FClimbSpatialHash::Unlink(int32 Index)
+{
+	FEntry& Entry = Entries[Index];
+
+	if (Entry.Prev != INDEX_NONE)
+	{
+		Entries[Entry.Prev].Next = Entry.Next;
+	}
+	else
+	{
+		Buckets[GetBucket(Entry.Cell)] = Entry.Next;
+	}
+
+	if (Entry.Next != INDEX_NONE)
+	{
+		Entries[Entry.Next].Prev = Entry.Prev;
+	}
+
+	Entry.Prev = INDEX_NONE;
+	Entry.Next = INDEX_NONE;
+}
+
+bool UClimbSpatialHashSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld();
+}
+
+void UClimbSpatialHashSubsystem::Deinitialize()
+{
+	Hash.Reset();
+
+	Super::Deinitialize();
+}
+
+int32 UClimbSpatialHashSubsystem::Add(UClimbingMovementComponent* Climber, const FVector& Location, const FVector& WallNormal)
+{
+	return Hash.Add(Climber, Climber->GetOwner(), Location, WallNormal);
+}
@@ -0,0 +1,458 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ClimbStressMapCommandlet.h"
+#include "FPSClimbCPPTest.h"
+#include "EngiPC.h"
+#include "ClimbingMovementComponent.h"
+#include "ClimbPhysicalMaterial.h"
+#include "Engine/World.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshActor.h"
+#include "Engine/DirectionalLight.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/CollisionProfile.h"
+#include "GameFramework/PlayerStart.h"
+#include "Materials/MaterialInterface.h"
+#include "PhysicsEngine/BodySetup.h"
+#include "Misc/FileHelper.h"
+#include "Misc/PackageName.h"
+#include "Misc/Paths.h"
+#include "UObject/Package.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonWriter.h"
+#include "Serialization/JsonSerializer.h"
+#if WITH_EDITOR
+#include "MeshDescription.h"
+#include "StaticMeshAttributes.h"
+#endif
+
+namespace ClimbStressMap
+{
+	const float WallThickness = 50.0f;
+	const float FloorThickness = 100.0f;
+	const float MinWallWidth = 300.0f;
+	const float MinWallHeight = 400.0f;
+	const float MaxWallHeight = 1500.0f;
+	const float LedgeThickness = 20.0f;
+
+	//Two walls of 0.4 Spacing side by side plus their thickness have to fit a cell
+	const float MinSpacing = 20.0f * WallThickness;
+
+	//Ledges stay above a climber standing at a start, starts stay clear of the wall and its ends
+	const float MinLedgeHeight = 300.0f;
+	const float StartDistance = 120.0f;
+	const float StartHeight = 100.0f;
+	const float StartEndClearance = 60.0f;
+
+	//A single wall of a structure. Base is the foot of its climbable face, which faces the rotation's X
+	struct FSegment
+	{
+		FVector Base;
+		FRotator Rotation;
+		float Width;
+		float Height;
+	};
+
+#if WITH_EDITOR
+	//Adds a Cells by Cells grid spanning U and V from Corner, facing U x V. Interior points move up to Roughness along the face
+	void AddFace(FMeshDescription& Description, FPolygonGroupID Group, const FVector& Corner, const FVector& U, const FVector& V, int32 Cells, float Roughness, FRandomStream& Stream)
+	{
+		FStaticMeshAttributes Attributes(Description);
+		TVertexAttributesRef<FVector> Positions = Attributes.GetVertexPositions();
+		TVertexInstanceAttributesRef<FVector2D> UVs = Attributes.GetVertexInstanceUVs();
+		const FVector Normal = FVector::CrossProduct(U, V).GetSafeNormal();
+
+		TArray<FVertexInstanceID> Instances;
+		Instances.Reserve((Cells + 1) * (Cells + 1));
+		for (int32 Row = 0; Row <= Cells; Row++)
+		{
+			for (int32 Column = 0; Column <= Cells; Column++)
+			{
+				const bool bBorder = Row == 0 || Column == 0 || Row == Cells || Column == Cells;
+				const float Offset = (bBorder || Roughness <= 0.0f) ? 0.0f : Stream.FRandRange(-Roughness, Roughness);
+
+				const FVertexID Vertex = Description.CreateVertex();
+				Positions[Vertex] = Corner + U * ((float)Column / Cells) + V * ((float)Row / Cells) + Normal * Offset;
+
+				const FVertexInstanceID Instance = Description.CreateVertexInstance(Vertex);
+				UVs.Set(Instance, 0, FVector2D((float)Column / Cells, (float)Row / Cells));
+				Instances.Add(Instance);
+			}
+		}
+
+		//(C - A) x (B - A) faces out, as in ClimbGraphBake
+		for (int32 Row = 0; Row < Cells; Row++)
+		{
+			for (int32 Column = 0; Column < Cells; Column++)
+			{
+				const FVertexInstanceID P00 = Instances[Row * (Cells + 1) + Column];
+				const FVertexInstanceID P10 = Instances[Row * (Cells + 1) + Column + 1];
+				const FVertexInstanceID P01 = Instances[(Row + 1) * (Cells + 1) + Column];
+				const FVertexInstanceID P11 = Instances[(Row + 1) * (Cells + 1) + Column + 1];
+				Description.CreateTriangle(Group, { P00, P01, P10 });
+				Description.CreateTriangle(Group, { P10, P01, P11 });
+			}
+		}
+	}
+
+	//Unit cube, 100 cm a side like the engine's, whose +X face is a rough Density grid and the only part traced complex
+	UStaticMesh* CreatePanelMesh(const FString& PackageName, UMaterialInterface* Material, UPhysicalMaterial* Surface, int32 Density, float Roughness, FRandomStream& Stream)
+	{
+		UPackage* Package = CreatePackage(*PackageName);
+		UStaticMesh* Mesh = NewObject<UStaticMesh>(Package, *FPackageName::GetLongPackageAssetName(PackageName), RF_Public | RF_Standalone);
+
+		FStaticMeshSourceModel& SourceModel = Mesh->AddSourceModel();
+		SourceModel.BuildSettings.bRecomputeNormals = true;
+		SourceModel.BuildSettings.bRecomputeTangents = true;
+
+		FMeshDescription* Description = Mesh->CreateMeshDescription(0);
+		FStaticMeshAttributes Attributes(*Description);
+		Attributes.Register();
+
+		const FName SlotName = TEXT("Wall");
+		const FPolygonGroupID Group = Description->CreatePolygonGroup();
+		Attributes.GetPolygonGroupMaterialSlotNames()[Group] = SlotName;
+		Mesh->StaticMaterials.Add(FStaticMaterial(Material, SlotName));
+
+		//Roughness is in cm, the panel is scaled to the wall's thickness along X
+		const float MeshRoughness = Roughness * 100.0f / WallThickness;
+
+		AddFace(*Description, Group, FVector(50.0f, -50.0f, -50.0f), FVector(0.0f, 100.0f, 0.0f), FVector(0.0f, 0.0f, 100.0f), Density, MeshRoughness, Stream);
+		AddFace(*Description, Group, FVector(-50.0f, -50.0f, -50.0f), FVector(0.0f, 0.0f, 100.0f), FVector(0.0f, 100.0f, 0.0f), 1, 0.0f, Stream);
+		AddFace(*Description, Group, FVector(-50.0f, 50.0f, -50.0f), FVector(0.0f, 0.0f, 100.0f), FVector(100.0f, 0.0f, 0.0f), 1, 0.0f, Stream);
+		AddFace(*Description, Group, FVector(-50.0f, -50.0f, -50.0f), FVector(100.0f, 0.0f, 0.0f), FVector(0.0f, 0.0f, 100.0f), 1, 0.0f, Stream);
+		AddFace(*Description, Group, FVector(-50.0f, -50.0f, 50.0f), FVector(100.0f, 0.0f, 0.0f), FVector(0.0f, 100.0f, 0.0f), 1, 0.0f, Stream);
+		AddFace(*Description, Group, FVector(-50.0f, -50.0f, -50.0f), FVector(0.0f, 100.0f, 0.0f), FVector(100.0f, 0.0f, 0.0f), 1, 0.0f, Stream);
+
+		Mesh->CommitMeshDescription(0);
+
+		//Probes hit the box first, its surface sends wall probes on to the rough triangles
+		Mesh->CreateBodySetup();
+		UBodySetup* BodySetup = Mesh->GetBodySetup();
+		BodySetup->AggGeom.BoxElems.Add(FKBoxElem(100.0f, 100.0f, 100.0f));
+		BodySetup->PhysMaterial = Surface;
+
+		Mesh->Build(true);
+		BodySetup->InvalidatePhysicsData();
+		BodySetup->CreatePhysicsMeshes();
+		Mesh->MarkPackageDirty();
+
+		return Mesh;
+	}
+
+	AStaticMeshActor* SpawnBlock(UWorld* World, UStaticMesh* Mesh, const FTransform& Transform, ECollisionResponse ClimbResponse, const FString& Label)
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.bDeferConstruction = true;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+		AStaticMeshActor* Actor = World->SpawnActor<AStaticMeshActor>(AStaticMeshActor::StaticClass(), Transform, SpawnParams);
+		if (!Actor)
+		{
+			return nullptr;
+		}
+
+		UStaticMeshComponent* Component = Actor->GetStaticMeshComponent();
+		Component->SetMobility(EComponentMobility::Static);
+		Component->SetStaticMesh(Mesh);
+		Component->SetCollisionProfileName(UCollisionProfile::BlockAll_ProfileName);
+		Component->SetCollisionResponseToChannel(ECC_Climbable, ClimbResponse);
+
+		Actor->FinishSpawning(Transform);
+		Actor->SetActorLabel(Label);
+		return Actor;
+	}
+
+	bool SavePackage(UPackage* Package, UObject* Asset, const FString& Extension)
+	{
+		const FString Filename = FPackageName::LongPackageNameToFilename(Package->GetName(), Extension);
+		if (!UPackage::SavePackage(Package, Asset, RF_Public | RF_Standalone, *Filename))
+		{
+			UE_LOG(LogClimb, Error, TEXT("ClimbStressMap: could not save %s"), *Filename);
+			return false;
+		}
+		return true;
+	}
+#endif
+}
+
+UClimbStressMapCommandlet::UClimbStressMapCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UClimbStressMapCommandlet::Main(const FString& Params)
+{
+#if WITH_EDITOR
+	FString MapName;
+	if (!FParse::Value(*Params, TEXT("Map="), MapName))
+	{
+		MapName = TEXT("/Game/Stress/StressLevel");
+	}
+
+	int32 Seed = 0;
+	int32 NumWalls = 100;
+	float CornerDensity = 0.3f;
+	int32 NumLedges = 50;
+	float Overhangs = 0.25f;
+	float OverhangSpread = 10.0f;
+	int32 Density = 16;
+	float Roughness = 1.0f;
+	int32 NumClimbers = 32;
+	float Spacing = 1500.0f;
+	FParse::Value(*Params, TEXT("Seed="), Seed);
+	FParse::Value(*Params, TEXT("Walls="), NumWalls);
+	FParse::Value(*Params, TEXT("CornerDensity="), CornerDensity);
+	FParse::Value(*Params, TEXT("Ledges="), NumLedges);
+	FParse::Value(*Params, TEXT("Overhangs="), Overhangs);
+	FParse::Value(*Params, TEXT("OverhangSpread="), OverhangSpread);
+	FParse::Value(*Params, TEXT("Density="), Density);
+	FParse::Value(*Params, TEXT("Roughness="), Roughness);
+	FParse::Value(*Params, TEXT("Climbers="), NumClimbers);
+	FParse::Value(*Params, TEXT("Spacing="), Spacing);
+
+	NumWalls = FMath::Max(NumWalls, 1);
+	CornerDensity = FMath::Clamp(CornerDensity, 0.0f, 1.0f);
+	Overhangs = FMath::Clamp(Overhangs, 0.0f, 1.0f);
+	Density = FMath::Clamp(Density, 1, 256);
+	Spacing = FMath::Max(Spacing, ClimbStressMap::MinSpacing);
+
+	FString OutputFilename = FPaths::ProjectSavedDir() / TEXT("ClimbStressMap.json");
+	FParse::Value(*Params, TEXT("Output="), OutputFilename);
+
+	if (!FPackageName::IsValidLongPackageName(MapName))
+	{
+		UE_LOG(LogClimb, Error, TEXT("ClimbStressMap: %s is not a package name"), *MapName);
+		return 1;
+	}
+
+	//Overhangs are placed around whatever tilt the climber lets go at
+	const float ReleaseTilt = GetDefault<AEngiPC>()->GetClimbingMovement()->ReleaseTilt;
+
+	UMaterialInterface* Material = LoadObject<UMaterialInterface>(nullptr, TEXT("/Engine/BasicShapes/BasicShapeMaterial.BasicShapeMaterial"));
+	UStaticMesh* Cube = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+	if (!Cube)
+	{
+		UE_LOG(LogClimb, Error, TEXT("ClimbStressMap: could not load /Engine/BasicShapes/Cube"));
+		return 1;
+	}
+
+	//Each part draws from its own stream, so changing one parameter leaves the rest of the map where it was
+	FRandomStream MeshStream(Seed);
+	FRandomStream LayoutStream(Seed + 1);
+	FRandomStream LedgeStream(Seed + 2);
+	FRandomStream StartStream(Seed + 3);
+
+	const FString SurfacePackageName = MapName + TEXT("_Surface");
+	UPackage* SurfacePackage = CreatePackage(*SurfacePackageName);
+	UClimbPhysicalMaterial* Surface = NewObject<UClimbPhysicalMaterial>(SurfacePackage, *FPackageName::GetLongPackageAssetName(SurfacePackageName), RF_Public | RF_Standalone);
+	Surface->bTraceComplex = true;
+	Surface->MarkPackageDirty();
+
+	UStaticMesh* Panel = ClimbStressMap::CreatePanelMesh(MapName + TEXT("_Panel"), Material, Surface, Density, Roughness, MeshStream);
+
+	//Lay the walls out before touching the world, one structure to a grid cell
+	TArray<ClimbStressMap::FSegment> Segments;
+	TArray<float> Tilts;
+	int32 NumCorners = 0;
+
+	const int32 GridSide = FMath::CeilToInt(FMath::Sqrt((float)NumWalls));
+	const float MaxWallWidth = Spacing * 0.4f;
+
+	for (int32 Wall = 0; Wall < NumWalls; Wall++)
+	{
+		const FVector CellCenter(((Wall % GridSide) - (GridSide - 1) * 0.5f) * Spacing, ((Wall / GridSide) - (GridSide - 1) * 0.5f) * Spacing, 0.0f);
+		const float Height = LayoutStream.FRandRange(ClimbStressMap::MinWallHeight, ClimbStressMap::MaxWallHeight);
+
+		//Walk the face along each wall's right, turning out (convex corner) or in (concave) at its end
+		const int32 FirstSegment = Segments.Num();
+		FVector Cursor = FVector::ZeroVector;
+		float Yaw = LayoutStream.FRandRange(0.0f, 360.0f);
+		FBox Bounds(ForceInit);
+		for (int32 Turn = 0; Turn < 4; Turn++)
+		{
+			if (Turn > 0)
+			{
+				if (LayoutStream.FRand() >= CornerDensity)
+				{
+					break;
+				}
+				Yaw += LayoutStream.FRand() < 0.5f ? 90.0f : -90.0f;
+				NumCorners++;
+			}
+
+			ClimbStressMap::FSegment& Segment = Segments.AddDefaulted_GetRef();
+			Segment.Rotation = FRotator(0.0f, Yaw, 0.0f);
+			Segment.Width = LayoutStream.FRandRange(ClimbStressMap::MinWallWidth, MaxWallWidth);
+			Segment.Height = Height;
+
+			const FVector Right = Segment.Rotation.Quaternion().GetRightVector();
+			Segment.Base = Cursor + Right * (Segment.Width * 0.5f);
+			Bounds += Cursor;
+			Cursor += Right * Segment.Width;
+			Bounds += Cursor;
+		}
+
+		//At most two walls run along each axis, so the structure fits its cell once centred
+		const FVector Slack = FVector(Spacing, Spacing, 0.0f) - Bounds.GetSize() - FVector(4.0f * ClimbStressMap::WallThickness);
+		const FVector Jitter(LayoutStream.FRandRange(-0.5f, 0.5f) * FMath::Max(Slack.X, 0.0f), LayoutStream.FRandRange(-0.5f, 0.5f) * FMath::Max(Slack.Y, 0.0f), 0.0f);
+		const FVector Shift = CellCenter + Jitter - FVector(Bounds.GetCenter().X, Bounds.GetCenter().Y, 0.0f);
+		for (int32 Index = FirstSegment; Index < Segments.Num(); Index++)
+		{
+			Segments[Index].Base += Shift;
+		}
+
+		//Only straight walls lean, a lean at a corner would leave a gap. Negative pitch hangs over the climber
+		if (Segments.Num() == FirstSegment + 1 && LayoutStream.FRand() < Overhangs)
+		{
+			const float Tilt = FMath::Clamp(ReleaseTilt + LayoutStream.FRandRange(-OverhangSpread, OverhangSpread), 0.0f, 89.0f);
+			const float Pitch = LayoutStream.FRand() < 0.5f ? -Tilt : Tilt;
+
+			//Pivot on the face's foot and sink the wall so neither edge lifts off the floor
+			ClimbStressMap::FSegment& Segment = Segments.Last();
+			Segment.Rotation.Pitch = Pitch;
+			Segment.Base.Z -= ClimbStressMap::WallThickness * FMath::Sin(FMath::DegreesToRadians(Tilt));
+			Tilts.Add(Pitch);
+		}
+	}
+
+	//Build the world
+	const FString AssetName = FPackageName::GetLongPackageAssetName(MapName);
+	UPackage* MapPackage = CreatePackage(*MapName);
+	UWorld* World = UWorld::CreateWorld(EWorldType::Editor, false, FName(*AssetName), MapPackage);
+	World->SetFlags(RF_Public | RF_Standalone);
+
+	int32 NumBlocks = 0;
+	int64 NumTriangles = 0;
+	const int32 PanelTriangles = Density * Density * 2 + 10;
+
+	const float FloorSide = (GridSide + 1) * Spacing;
+	const FTransform FloorTransform(FRotator::ZeroRotator, FVector(0.0f, 0.0f, -ClimbStressMap::FloorThickness * 0.5f), FVector(FloorSide, FloorSide, ClimbStressMap::FloorThickness) / 100.0f);
+	if (ClimbStressMap::SpawnBlock(World, Cube, FloorTransform, ECR_Ignore, TEXT("Floor")))
+	{
+		NumBlocks++;
+		NumTriangles += 12;
+	}
+
+	for (int32 Index = 0; Index < Segments.Num(); Index++)
+	{
+		const ClimbStressMap::FSegment& Segment = Segments[Index];
+		const FVector Center = Segment.Base + Segment.Rotation.RotateVector(FVector(-ClimbStressMap::WallThickness * 0.5f, 0.0f, Segment.Height * 0.5f));
+		const FTransform Transform(Segment.Rotation, Center, FVector(ClimbStressMap::WallThickness, Segment.Width, Segment.Height) / 100.0f);
+		if (ClimbStressMap::SpawnBlock(World, Panel, Transform, ECR_Block, FString::Printf(TEXT("Wall_%d"), Index)))
+		{
+			NumBlocks++;
+			NumTriangles += PanelTriangles;
+		}
+	}
+
+	//Shelves sticking out of the faces, deep enough to stand on
+	int32 NumLedgesPlaced = 0;
+	for (int32 Ledge = 0; Ledge < NumLedges; Ledge++)
+	{
+		const ClimbStressMap::FSegment& Segment = Segments[LedgeStream.RandRange(0, Segments.Num() - 1)];
+		const float Width = Segment.Width * LedgeStream.FRandRange(0.3f, 0.9f);
+		const float Depth = LedgeStream.FRandRange(60.0f, 100.0f);
+		const float Along = LedgeStream.FRandRange(-0.5f, 0.5f) * (Segment.Width - Width);
+		const float Up = LedgeStream.FRandRange(FMath::Max(Segment.Height * 0.3f, ClimbStressMap::MinLedgeHeight), FMath::Max(Segment.Height * 0.8f, ClimbStressMap::MinLedgeHeight));
+
+		const FVector Center = Segment.Base + Segment.Rotation.RotateVector(FVector(Depth * 0.5f, Along, Up));
+		const FTransform Transform(Segment.Rotation, Center, FVector(Depth, Width, ClimbStressMap::LedgeThickness) / 100.0f);
+		if (ClimbStressMap::SpawnBlock(World, Cube, Transform, ECR_Block, FString::Printf(TEXT("Ledge_%d"), Ledge)))
+		{
+			NumBlocks++;
+			NumLedgesPlaced++;
+			NumTriangles += 12;
+		}
+	}
+
+	//Starts face the foot of a wall, far enough out for a capsule
+	int32 NumStarts = 0;
+	for (int32 Climber = 0; Climber < NumClimbers; Climber++)
+	{
+		const ClimbStressMap::FSegment& Segment = Segments[StartStream.RandRange(0, Segments.Num() - 1)];
+		const FVector Forward = FRotator(0.0f, Segment.Rotation.Yaw, 0.0f).Vector();
+		const FVector Right = Segment.Rotation.Quaternion().GetRightVector();
+		const float Along = StartStream.FRandRange(-0.5f, 0.5f) * FMath::Max(Segment.Width - 2.0f * ClimbStressMap::StartEndClearance, 0.0f);
+
+		//Under an overhang the face comes out to meet the top of the capsule
+		float Distance = ClimbStressMap::StartDistance;
+		if (Segment.Rotation.Pitch < 0.0f)
+		{
+			Distance += 2.0f * ClimbStressMap::StartHeight * FMath::Tan(FMath::DegreesToRadians(-Segment.Rotation.Pitch));
+		}
+
+		const FVector Location = FVector(Segment.Base.X, Segment.Base.Y, 0.0f) + Right * Along + Forward * Distance + FVector(0.0f, 0.0f, ClimbStressMap::StartHeight);
+		APlayerStart* Start = World->SpawnActor<APlayerStart>(APlayerStart::StaticClass(), Location, FRotator(0.0f, Segment.Rotation.Yaw + 180.0f, 0.0f));
+		if (Start)
+		{
+			Start->SetActorLabel(FString::Printf(TEXT("ClimberStart_%d"), Climber));
+			NumStarts++;
+		}
+	}
+
+	World->SpawnActor<ADirectionalLight>(ADirectionalLight::StaticClass(), FVector(0.0f, 0.0f, ClimbStressMap::MaxWallHeight * 2.0f), FRotator(-50.0f, 30.0f, 0.0f));
+
+	const bool bSaved = ClimbStressMap::SavePackage(SurfacePackage, Surface, FPackageName::GetAssetPackageExtension())
+		&& ClimbStressMap::SavePackage(Panel->GetOutermost(), Panel, FPackageName::GetAssetPackageExtension())
+		&& ClimbStressMap::SavePackage(MapPackage, World, FPackageName::GetMapPackageExtension());
+
+	World->DestroyWorld(false);
+	World->RemoveFromRoot();
+
+	if (!bSaved)
+	{
+		return 1;
+	}
+
+	float MinTilt = 0.0f;
+	float MaxTilt = 0.0f;
+	int32 NumPastRelease = 0;
+	for (int32 Index = 0; Index < Tilts.Num(); Index++)
+	{
+		const float Tilt = FMath::Abs(Tilts[Index]);
+		MinTilt = Index == 0 ? Tilt : FMath::Min(MinTilt, Tilt);
+		MaxTilt = FMath::Max(MaxTilt, Tilt);
+		NumPastRelease += Tilt >= ReleaseTilt ? 1 : 0;
+	}
+
+	TSharedRef<FJsonObject> Report = MakeShared<FJsonObject>();
+	Report->SetStringField(TEXT("map"), MapName);
+	Report->SetNumberField(TEXT("seed"), Seed);
+	Report->SetNumberField(TEXT("walls"), NumWalls);
+	Report->SetNumberField(TEXT("segments"), Segments.Num());
+	Report->SetNumberField(TEXT("corners"), NumCorners);
+	Report->SetNumberField(TEXT("ledges"), NumLedgesPlaced);
+	Report->SetNumberField(TEXT("tilted"), Tilts.Num());
+	Report->SetNumberField(TEXT("releaseTilt"), ReleaseTilt);
+	Report->SetNumberField(TEXT("minTilt"), MinTilt);
+	Report->SetNumberField(TEXT("maxTilt"), MaxTilt);
+	Report->SetNumberField(TEXT("pastRelease"), NumPastRelease);
+	Report->SetNumberField(TEXT("climberStarts"), NumStarts);
+	Report->SetNumberField(TEXT("blocks"), NumBlocks);
+	Report->SetNumberField(TEXT("panelTriangles"), PanelTriangles);
+	Report->SetNumberField(TEXT("triangles"), (double)NumTriangles);
+	Report->SetNumberField(TEXT("size"), FloorSide);
+
+	FString Json;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Json);
+	FJsonSerializer::Serialize(Report, Writer);
+
+	if (!FFileHelper::SaveStringToFile(Json, *OutputFilename))
+	{
+		UE_LOG(LogClimb, Error, TEXT("ClimbStressMap: could not write %s"), *OutputFilename);
+		return 1;
+	}
+
+	UE_LOG(LogClimb, Display, TEXT("ClimbStressMap: %s seed %d, %d walls in %d segments, %d corners, %d ledges, %d tilted (%.1f-%.1f, %d past %.0f), %d starts, %d blocks, %lld triangles"),
+		*MapName, Seed, NumWalls, Segments.Num(), NumCorners, NumLedgesPlaced, Tilts.Num(), MinTilt, MaxTilt, NumPastRelease, ReleaseTilt, NumStarts, NumBlocks, NumTriangles);
+
+	return 0;
+#else
+	return 1;
+#endif
+}
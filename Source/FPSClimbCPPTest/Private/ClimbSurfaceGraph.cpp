@@ -0,0 +1,465 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ClimbSurfaceGraph.h"
+#include "Engine/World.h"
+#include "Misc/PackageName.h"
+#include "PhysicalMaterials/PhysicalMaterial.h"
+
+UClimbSurfaceGraph::UClimbSurfaceGraph()
+{
+	CellSize = 200.0f;
+}
+
+void UClimbSurfaceGraph::PostLoad()
+{
+	Super::PostLoad();
+
+	BuildSpatialHash();
+}
+
+FString UClimbSurfaceGraph::GetGraphPackageName(const FString& MapPackageName)
+{
+	return MapPackageName + TEXT("_ClimbGraph");
+}
+
+UClimbSurfaceGraph* UClimbSurfaceGraph::FindForWorld(UWorld* World)
+{
+	if (!World)
+	{
+		return nullptr;
+	}
+
+	//PIE worlds live in a prefixed copy of the map package
+	return FindForMap(UWorld::RemovePIEPrefix(World->GetOutermost()->GetName()));
+}
+
+UClimbSurfaceGraph* UClimbSurfaceGraph::FindForMap(const FString& MapPackageName)
+{
+	const FString GraphPackageName = GetGraphPackageName(MapPackageName);
+
+	if (!FPackageName::DoesPackageExist(GraphPackageName))
+	{
+		return nullptr;
+	}
+
+	const FString ObjectPath = GraphPackageName + TEXT(".") + FPackageName::GetLongPackageAssetName(GraphPackageName);
+	return LoadObject<UClimbSurfaceGraph>(nullptr, *ObjectPath, nullptr, LOAD_NoWarn | LOAD_Quiet);
+}
+
+FIntVector UClimbSurfaceGraph::GetCell(const FVector& Location) const
+{
+	return FIntVector(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize), FMath::FloorToInt(Location.Z / CellSize));
+}
+
+namespace ClimbSurfaceGraph
+{
+	//Unique entries of every cell the box touches
+	void Gather(const TMultiMap<FIntVector, int32>& SpatialHash, const FIntVector& MinCell, const FIntVector& MaxCell, TArray<int32, TInlineAllocator<32>>& OutEntries)
+	{
+		for (int32 X = MinCell.X; X <= MaxCell.X; X++)
+		{
+			for (int32 Y = MinCell.Y; Y <= MaxCell.Y; Y++)
+			{
+				for (int32 Z = MinCell.Z; Z <= MaxCell.Z; Z++)
+				{
+					for (auto It = SpatialHash.CreateConstKeyIterator(FIntVector(X, Y, Z)); It; ++It)
+					{
+						OutEntries.AddUnique(It.Value());
+					}
+				}
+			}
+		}
+	}
+
+	FVector GetUp(const FClimbWallPatch& Patch)
+	{
+		return FVector::CrossProduct(Patch.Normal, Patch.Right);
+	}
+
+	//Is Point on the rectangle of the patch (ignoring how far in front of it)
+	bool IsInside(const FClimbWallPatch& Patch, const FVector& Point)
+	{
+		const FVector Local = Point - Patch.Center;
+		return FMath::Abs(FVector::DotProduct(Local, Patch.Right)) <= Patch.Extent.X
+			&& FMath::Abs(FVector::DotProduct(Local, GetUp(Patch))) <= Patch.Extent.Y;
+	}
+}
+
+int32 UClimbSurfaceGraph::FindWall(const FVector& Start, const FVector& Direction, float MaxDistance, FVector& OutPoint, FVector& OutNormal) const
+{
+	const FVector End = Start + Direction * MaxDistance;
+
+	TArray<int32, TInlineAllocator<32>> Entries;
+	ClimbSurfaceGraph::Gather(SpatialHash, GetCell(Start.ComponentMin(End)), GetCell(Start.ComponentMax(End)), Entries);
+
+	int32 Best = INDEX_NONE;
+	float BestDistance = MaxDistance;
+
+	for (int32 Entry : Entries)
+	{
+		if (Entry < 0)
+		{
+			continue;
+		}
+
+		const FClimbWallPatch& Patch = Patches[Entry];
+
+		//Only walls facing the ray
+		const float Facing = FVector::DotProduct(Direction, Patch.Normal);
+		if (Facing >= -KINDA_SMALL_NUMBER)
+		{
+			continue;
+		}
+
+		const float Distance = FVector::DotProduct(Patch.Center - Start, Patch.Normal) / Facing;
+		if (Distance < 0.0f || Distance > BestDistance)
+		{
+			continue;
+		}
+
+		const FVector Point = Start + Direction * Distance;
+		if (ClimbSurfaceGraph::IsInside(Patch, Point))
+		{
+			Best = Entry;
+			BestDistance = Distance;
+			OutPoint = Point;
+			OutNormal = Patch.Normal;
+		}
+	}
+
+	return Best;
+}
+
+int32 UClimbSurfaceGraph::FindLedge(const FVector& Location, float Radius, FVector& OutMantlePoint) const
+{
+	const FVector Reach(Radius);
+
+	TArray<int32, TInlineAllocator<32>> Entries;
+	ClimbSurfaceGraph::Gather(SpatialHash, GetCell(Location - Reach), GetCell(Location + Reach), Entries);
+
+	int32 Best = INDEX_NONE;
+	float BestDistanceSq = FMath::Square(Radius);
+
+	for (int32 Entry : Entries)
+	{
+		if (Entry >= 0)
+		{
+			continue;
+		}
+
+		const int32 LedgeIndex = -1 - Entry;
+		const FClimbLedge& Ledge = Ledges[LedgeIndex];
+
+		const FVector Closest = FMath::ClosestPointOnSegment(Location, Ledge.Start, Ledge.End);
+		const float DistanceSq = FVector::DistSquared(Closest, Location);
+		if (DistanceSq <= BestDistanceSq)
+		{
+			Best = LedgeIndex;
+			BestDistanceSq = DistanceSq;
+			OutMantlePoint = Closest + Ledge.MantleOffset;
+		}
+	}
+
+	return Best;
+}
+
+bool UClimbSurfaceGraph::IsCovered(const FVector& Location, float MaxDistance) const
+{
+	const FVector Reach(MaxDistance);
+
+	TArray<int32, TInlineAllocator<32>> Entries;
+	ClimbSurfaceGraph::Gather(SpatialHash, GetCell(Location - Reach), GetCell(Location + Reach), Entries);
+
+	for (int32 Entry : Entries)
+	{
+		if (Entry < 0)
+		{
+			continue;
+		}
+
+		const FClimbWallPatch& Patch = Patches[Entry];
+		const float Distance = FVector::DotProduct(Location - Patch.Center, Patch.Normal);
+		if (Distance >= 0.0f && Distance <= MaxDistance && ClimbSurfaceGraph::IsInside(Patch, Location))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void UClimbSurfaceGraph::RemoveSource(int32 Source)
+{
+	TArray<int32> Remap;
+	Remap.SetNumUninitialized(Patches.Num());
+
+	TArray<FClimbWallPatch> Kept;
+	Kept.Reserve(Patches.Num());
+
+	for (int32 Index = 0; Index < Patches.Num(); Index++)
+	{
+		if (Patches[Index].Source == Source)
+		{
+			Remap[Index] = INDEX_NONE;
+		}
+		else
+		{
+			Remap[Index] = Kept.Add(Patches[Index]);
+		}
+	}
+	Patches = MoveTemp(Kept);
+
+	for (int32 Index = Ledges.Num() - 1; Index >= 0; Index--)
+	{
+		const int32 NewPatch = Remap[Ledges[Index].Patch];
+		if (NewPatch == INDEX_NONE)
+		{
+			Ledges.RemoveAt(Index);
+		}
+		else
+		{
+			Ledges[Index].Patch = NewPatch;
+		}
+	}
+
+	Triangles.RemoveAll([Source](const FClimbTriangle& Triangle) { return Triangle.Source == Source; });
+
+	//Corner indices are stale now, BuildCorners puts them back
+	Corners.Reset();
+}
+
+void UClimbSurfaceGraph::AddTriangles(int32 Source, TArrayView<const FVector> Vertices, UPhysicalMaterial* Material, EClimbTriangleChannel Channels, bool bClimbProxy)
+{
+	const int32 MaterialIndex = Material ? TriangleMaterials.AddUnique(Material) : INDEX_NONE;
+
+	Triangles.Reserve(Triangles.Num() + Vertices.Num() / 3);
+	for (int32 Index = 0; Index + 2 < Vertices.Num(); Index += 3)
+	{
+		FClimbTriangle& Triangle = Triangles.AddDefaulted_GetRef();
+		Triangle.A = Vertices[Index];
+		Triangle.B = Vertices[Index + 1];
+		Triangle.C = Vertices[Index + 2];
+		Triangle.Source = Source;
+		Triangle.Material = MaterialIndex;
+		Triangle.Channels = (uint8)Channels;
+		Triangle.bClimbProxy = bClimbProxy;
+	}
+}
+
+UPhysicalMaterial* UClimbSurfaceGraph::GetTriangleMaterial(int32 Triangle) const
+{
+	const int32 Material = Triangles.IsValidIndex(Triangle) ? Triangles[Triangle].Material : INDEX_NONE;
+	return TriangleMaterials.IsValidIndex(Material) ? TriangleMaterials[Material] : nullptr;
+}
+
+void UClimbSurfaceGraph::AddBox(int32 Source, const FTransform& BoxTransform, const FVector& HalfExtent, float StandHalfHeight, float StandRadius)
+{
+	const FVector Extent = HalfExtent * BoxTransform.GetScale3D().GetAbs();
+	const FQuat Rotation = BoxTransform.GetRotation();
+	const FVector Center = BoxTransform.GetLocation();
+
+	const FVector Axes[3] = { Rotation.GetAxisX(), Rotation.GetAxisY(), Rotation.GetAxisZ() };
+
+	//A ledge needs a flat top to stand on
+	bool bFlatTop = false;
+	for (int32 Axis = 0; Axis < 3; Axis++)
+	{
+		bFlatTop |= FMath::Abs(Axes[Axis].Z) > 0.9f;
+	}
+
+	for (int32 Axis = 0; Axis < 3; Axis++)
+	{
+		for (float Sign : { 1.0f, -1.0f })
+		{
+			const FVector Normal = Axes[Axis] * Sign;
+
+			//Floors and ceilings are not walls
+			if (FMath::Abs(Normal.Z) > 0.3f)
+			{
+				continue;
+			}
+
+			FClimbWallPatch Patch;
+			Patch.Source = Source;
+			Patch.Normal = Normal;
+			Patch.Center = Center + Normal * Extent[Axis];
+			Patch.Right = FVector::CrossProduct(FVector::UpVector, -Normal).GetSafeNormal();
+
+			//Extent of the face along the wall, from its four corners
+			const int32 AxisB = (Axis + 1) % 3;
+			const int32 AxisC = (Axis + 2) % 3;
+			const FVector Up = ClimbSurfaceGraph::GetUp(Patch);
+			for (float SignB : { 1.0f, -1.0f })
+			{
+				for (float SignC : { 1.0f, -1.0f })
+				{
+					const FVector Corner = Axes[AxisB] * (SignB * Extent[AxisB]) + Axes[AxisC] * (SignC * Extent[AxisC]);
+					Patch.Extent.X = FMath::Max(Patch.Extent.X, FMath::Abs(FVector::DotProduct(Corner, Patch.Right)));
+					Patch.Extent.Y = FMath::Max(Patch.Extent.Y, FMath::Abs(FVector::DotProduct(Corner, Up)));
+				}
+			}
+
+			const int32 PatchIndex = Patches.Add(Patch);
+
+			//Top edge becomes a ledge if the box is deep enough to stand on
+			if (bFlatTop && Extent[Axis] * 2.0f >= StandRadius * 2.0f)
+			{
+				const FVector TopCenter = Patch.Center + Up * Patch.Extent.Y;
+
+				FClimbLedge Ledge;
+				Ledge.Patch = PatchIndex;
+				Ledge.Start = TopCenter - Patch.Right * Patch.Extent.X;
+				Ledge.End = TopCenter + Patch.Right * Patch.Extent.X;
+				Ledge.MantleOffset = (-Normal * (StandRadius * 2.0f)) + (FVector::UpVector * StandHalfHeight);
+				Ledges.Add(Ledge);
+			}
+		}
+	}
+}
+
+void UClimbSurfaceGraph::BuildCorners(float Tolerance)
+{
+	Corners.Reset();
+
+	for (int32 IndexA = 0; IndexA < Patches.Num(); IndexA++)
+	{
+		const FClimbWallPatch& PatchA = Patches[IndexA];
+
+		//Only patches whose vertical edges can reach each other
+		TArray<int32, TInlineAllocator<32>> Entries;
+		const FVector Reach(PatchA.Extent.X + Tolerance, PatchA.Extent.X + Tolerance, PatchA.Extent.Y + Tolerance);
+		ClimbSurfaceGraph::Gather(SpatialHash, GetCell(PatchA.Center - Reach), GetCell(PatchA.Center + Reach), Entries);
+
+		for (int32 IndexB : Entries)
+		{
+			if (IndexB <= IndexA)
+			{
+				continue;
+			}
+
+			const FClimbWallPatch& PatchB = Patches[IndexB];
+
+			//Same plane is a seam, not a corner
+			if (FVector::DotProduct(PatchA.Normal, PatchB.Normal) > 0.95f)
+			{
+				continue;
+			}
+
+			for (float SignA : { 1.0f, -1.0f })
+			{
+				for (float SignB : { 1.0f, -1.0f })
+				{
+					const FVector EdgeA = PatchA.Center + PatchA.Right * (SignA * PatchA.Extent.X);
+					const FVector EdgeB = PatchB.Center + PatchB.Right * (SignB * PatchB.Extent.X);
+
+					if (FVector::DistSquared2D(EdgeA, EdgeB) > FMath::Square(Tolerance))
+					{
+						continue;
+					}
+
+					FClimbCorner Corner;
+					Corner.PatchA = IndexA;
+					Corner.PatchB = IndexB;
+					Corner.Pivot = (EdgeA + EdgeB) * 0.5f;
+					Corner.bInside = FVector::DotProduct(PatchA.Normal, PatchB.Center - PatchA.Center) > 0.0f;
+					Corners.Add(Corner);
+				}
+			}
+		}
+	}
+
+	BuildAdjacency();
+}
+
+void UClimbSurfaceGraph::BuildSpatialHash()
+{
+	SpatialHash.Reset();
+
+	auto AddBounds = [this](const FBox& Bounds, int32 Entry)
+	{
+		const FIntVector MinCell = GetCell(Bounds.Min);
+		const FIntVector MaxCell = GetCell(Bounds.Max);
+
+		for (int32 X = MinCell.X; X <= MaxCell.X; X++)
+		{
+			for (int32 Y = MinCell.Y; Y <= MaxCell.Y; Y++)
+			{
+				for (int32 Z = MinCell.Z; Z <= MaxCell.Z; Z++)
+				{
+					SpatialHash.Add(FIntVector(X, Y, Z), Entry);
+				}
+			}
+		}
+	};
+
+	for (int32 Index = 0; Index < Patches.Num(); Index++)
+	{
+		const FClimbWallPatch& Patch = Patches[Index];
+		const FVector Up = ClimbSurfaceGraph::GetUp(Patch);
+
+		FBox Bounds(ForceInit);
+		Bounds += Patch.Center + Patch.Right * Patch.Extent.X + Up * Patch.Extent.Y;
+		Bounds += Patch.Center + Patch.Right * Patch.Extent.X - Up * Patch.Extent.Y;
+		Bounds += Patch.Center - Patch.Right * Patch.Extent.X + Up * Patch.Extent.Y;
+		Bounds += Patch.Center - Patch.Right * Patch.Extent.X - Up * Patch.Extent.Y;
+		AddBounds(Bounds, Index);
+	}
+
+	for (int32 Index = 0; Index < Ledges.Num(); Index++)
+	{
+		if (Ledges[Index].bBlocked)
+		{
+			continue;
+		}
+
+		FBox Bounds(ForceInit);
+		Bounds += Ledges[Index].Start;
+		Bounds += Ledges[Index].End;
+		AddBounds(Bounds, -1 - Index);
+	}
+
+	BuildAdjacency();
+
+	TArray<FVector> Vertices;
+	TArray<uint8> Channels;
+	Vertices.Reserve(Triangles.Num() * 3);
+	Channels.Reserve(Triangles.Num());
+	for (const FClimbTriangle& Triangle : Triangles)
+	{
+		Vertices.Add(Triangle.A);
+		Vertices.Add(Triangle.B);
+		Vertices.Add(Triangle.C);
+		Channels.Add(Triangle.Channels);
+	}
+	TriangleBVH.Build(Vertices, Channels);
+}
+
+void UClimbSurfaceGraph::BuildAdjacency()
+{
+	PatchLedges.Init(INDEX_NONE, Patches.Num());
+	for (int32 Index = 0; Index < Ledges.Num(); Index++)
+	{
+		if (PatchLedges.IsValidIndex(Ledges[Index].Patch) && !Ledges[Index].bBlocked)
+		{
+			PatchLedges[Ledges[Index].Patch] = Index;
+		}
+	}
+
+	PatchCorners.Init(INDEX_NONE, Patches.Num() * 2);
+	for (int32 Index = 0; Index < Corners.Num(); Index++)
+	{
+		for (int32 PatchIndex : { Corners[Index].PatchA, Corners[Index].PatchB })
+		{
+			if (!Patches.IsValidIndex(PatchIndex))
+			{
+				continue;
+			}
+
+			//Which edge of the patch the pivot sits on
+			const FClimbWallPatch& Patch = Patches[PatchIndex];
+			const float Side = FVector::DotProduct(Corners[Index].Pivot - Patch.Center, Patch.Right);
+			PatchCorners[PatchIndex * 2 + (Side > 0.0f ? 1 : 0)] = Index;
+		}
+	}
+}
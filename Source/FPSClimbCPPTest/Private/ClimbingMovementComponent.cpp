@@ -0,0 +1,1595 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ClimbingMovementComponent.h"
+#include "FPSClimbCPPTest.h"
+#include "ClimbSurfaceGraph.h"
+#include "ClimbSignificanceSubsystem.h"
+#include "ClimbQuerySchedulerSubsystem.h"
+#include "ClimbEvaluateSubsystem.h"
+#include "ClimbMemory.h"
+#include "GameFramework/Character.h"
+#include "GameFramework/Controller.h"
+#include "Components/CapsuleComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/RootMotionSource.h"
+#include "Curves/CurveFloat.h"
+#include "Curves/CurveVector.h"
+#include "HAL/IConsoleManager.h"
+#include "Net/UnrealNetwork.h"
+#include "UObject/UObjectIterator.h"
+#include "Runtime/Engine/Classes/Kismet/KismetMathLibrary.h"
+
+DECLARE_CYCLE_STAT(TEXT("TryGrabWall"), STAT_ClimbTryGrabWall, STATGROUP_Climbing);
+DECLARE_CYCLE_STAT(TEXT("ReleaseWall"), STAT_ClimbReleaseWall, STATGROUP_Climbing);
+DECLARE_CYCLE_STAT(TEXT("PhysClimbing"), STAT_ClimbPhysClimbing, STATGROUP_Climbing);
+DECLARE_CYCLE_STAT(TEXT("ClimbStep"), STAT_ClimbStep, STATGROUP_Climbing);
+DECLARE_CYCLE_STAT(TEXT("PrepareClimbStep"), STAT_ClimbPrepareStep, STATGROUP_Climbing);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Climbers"), STAT_ClimbClimbers, STATGROUP_Climbing);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Climb steps"), STAT_ClimbSteps, STATGROUP_Climbing);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Prepared steps used"), STAT_ClimbPreparedStepsUsed, STATGROUP_Climbing);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Prepared steps discarded"), STAT_ClimbPreparedStepsDiscarded, STATGROUP_Climbing);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Climb steps extrapolated"), STAT_ClimbExtrapolatedSteps, STATGROUP_Climbing);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Climb corners"), STAT_ClimbCorners, STATGROUP_Climbing);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Climb net state bits"), STAT_ClimbNetStateBits, STATGROUP_Climbing);
+
+static TAutoConsoleVariable<float> CVarClimbSimulationRate(
+	TEXT("climb.SimulationRate"),
+	0.0f,
+	TEXT("Overrides ClimbSimulationRate (steps per second) on every climber when above 0.\n")
+	TEXT("Lower values are cheaper, each step costs one set of climb probes."),
+	ECVF_Scalability);
+
+static TAutoConsoleVariable<int32> CVarClimbSmoothSteps(
+	TEXT("climb.SmoothSteps"),
+	1,
+	TEXT("Draw the mesh and camera between the last two climbing steps by how far into the next one the frame is, instead of where the last step left the capsule."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarClimbUseSurfaceGraph(
+	TEXT("climb.UseSurfaceGraph"),
+	1,
+	TEXT("Grab walls and find ledges from the level's baked climb graph where it has one, instead of tracing."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarClimbNeighbourRadius(
+	TEXT("climb.NeighbourRadius"),
+	300.0f,
+	TEXT("Climbers this close to each other are ignored by each other's probes and keep ClimberSpacing apart on a shared wall, found through the spatial hash.\n")
+	TEXT("0 leaves other climbers to the probes and the capsule sweeps."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarClimbNetTransitionWindow(
+	TEXT("climb.NetTransitionWindow"),
+	0.5f,
+	TEXT("Seconds after a climb state change (grab, latch, mantle, release) in which a server correction is counted against the transition."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarClimbNetNormalTolerance(
+	TEXT("climb.NetNormalTolerance"),
+	2.0f,
+	TEXT("Degrees the wall normal has to turn before simulated proxies are sent the new one."),
+	ECVF_Default);
+
+//Prints what climbing costs on the wire for every climber, then starts counting again
+static FAutoConsoleCommandWithWorld CmdClimbNetReport(
+	TEXT("climb.NetReport"),
+	TEXT("Logs net state updates, climb move data and corrections for every climber and resets the counters. Counted on the server."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+		{
+			for (TObjectIterator<UClimbingMovementComponent> It; It; ++It)
+			{
+				if (It->GetWorld() != World)
+				{
+					continue;
+				}
+
+				const float Seconds = FMath::Max(It->GetNetReportSeconds(), KINDA_SMALL_NUMBER);
+
+				UE_LOG(LogClimb, Log, TEXT("%s: %u state updates, %u state bits (%.1f bytes/s), %u move bits (%.1f bytes/s), %u corrections (%u at transitions) over %.1fs"), *GetNameSafe(It->GetOwner()),
+					It->GetNetStateUpdates(), It->GetNetStateBits(), It->GetNetStateBits() / (8.0f * Seconds), It->GetNetMoveBits(), It->GetNetMoveBits() / (8.0f * Seconds),
+					It->GetNetCorrections(), It->GetNetTransitionCorrections(), Seconds);
+
+				It->ResetNetReport();
+			}
+		}));
+
+//Prints how often each climber's wall contacts were reused instead of traced, then starts counting again
+static FAutoConsoleCommandWithWorld CmdClimbContactCacheStats(
+	TEXT("climb.ContactCacheStats"),
+	TEXT("Logs contact cache hits/misses for every climber and resets the counters."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+		{
+			for (TObjectIterator<UClimbingMovementComponent> It; It; ++It)
+			{
+				if (It->GetWorld() != World)
+				{
+					continue;
+				}
+
+				FClimbContactCache& Cache = It->GetClimbProbes().GetContactCache();
+				const uint32 Total = Cache.GetHitCount() + Cache.GetMissCount();
+
+				UE_LOG(LogClimb, Log, TEXT("%s: %u hits, %u misses (%.1f%% reused)"), *GetNameSafe(It->GetOwner()), Cache.GetHitCount(), Cache.GetMissCount(),
+					Total > 0 ? (100.0f * Cache.GetHitCount()) / Total : 0.0f);
+
+				Cache.ResetCounters();
+			}
+		}));
+
+namespace ClimbingMovementComponent
+{
+	//Neighbours whose walls face within about 45 degrees of ours are on the same wall for spacing
+	const float SameWallCos = 0.7f;
+
+	//What FClimbDecisions sees of a climber's world: its probe batch and the level's baked graph
+	class FClimbComponentTraces : public IClimbTraceProvider
+	{
+	public:
+		FClimbComponentTraces(FClimbProbeBatch& InProbes, const UClimbSurfaceGraph* InGraph)
+			: Probes(InProbes), Graph(InGraph)
+		{
+		}
+
+		virtual void AddLine(EClimbProbe Probe, const FVector& Start, const FVector& End, int8 Intent) override
+		{
+			Probes.AddLine(Probe, Start, End, Intent);
+		}
+
+		virtual void AddCapsule(EClimbProbe Probe, const FVector& Start, const FVector& End, float Radius, float HalfHeight, int8 Intent) override
+		{
+			Probes.AddSweep(Probe, Start, End, FCollisionShape::MakeCapsule(Radius, HalfHeight), Intent);
+		}
+
+		virtual bool HasResult(EClimbProbe Probe, int8 Intent) const override { return Probes.HasResult(Probe, Intent); }
+		virtual bool IsHit(EClimbProbe Probe) override { return Probes.IsHit(Probe); }
+		virtual bool IsAsync() const override { return Probes.IsAsync(); }
+
+		virtual FClimbTraceHit GetHit(EClimbProbe Probe) const override
+		{
+			const FHitResult& Hit = Probes.GetHit(Probe);
+
+			FClimbTraceHit TraceHit;
+			TraceHit.Location = Hit.Location;
+			TraceHit.Normal = Hit.Normal;
+			TraceHit.Surface = Probes.GetSurface(Probe);
+			return TraceHit;
+		}
+
+		virtual bool FindBakedWall(const FVector& Start, const FVector& Direction, float MaxDistance, FVector& OutPoint, FVector& OutNormal) const override
+		{
+			return Graph && Graph->FindWall(Start, Direction, MaxDistance, OutPoint, OutNormal) != INDEX_NONE;
+		}
+
+		virtual bool FindBakedLedge(const FVector& Location, float Radius, FVector& OutMantlePoint) const override
+		{
+			return Graph && Graph->FindLedge(Location, Radius, OutMantlePoint) != INDEX_NONE;
+		}
+
+		virtual bool IsBakedWall(const FVector& Location, float MaxDistance) const override
+		{
+			return Graph && Graph->IsCovered(Location, MaxDistance);
+		}
+
+	private:
+		FClimbProbeBatch& Probes;
+		const UClimbSurfaceGraph* Graph;
+	};
+}
+
+TAtomic<uint64> UClimbingMovementComponent::NumNetCorrections(0);
+TAtomic<uint64> UClimbingMovementComponent::NumNetTransitionCorrections(0);
+
+UClimbingMovementComponent::UClimbingMovementComponent()
+{
+	ClimbSimulationRate = 60.0f;
+	MaxClimbSubsteps = 8;
+	MaxClimbSpeed = 150.0f;
+	WallOffset = 25.0f;
+	ReleaseTilt = 35.0f;
+	AttachDuration = 0.3f;
+	MantleDuration = 0.75f;
+	CornerDuration = 0.4f;
+	ClimberSpacing = 60.0f;
+	JumpOffAngle = 55.0f;
+	JumpOffSpeed = 500.0f;
+	JumpOffZVelocity = 350.0f;
+	ReducedProbeInterval = 3;
+	MinimalProbeInterval = 8;
+	ReducedTickInterval = 1.0f / 30.0f;
+	MinimalTickInterval = 0.1f;
+
+	ClimbInput = FVector2D::ZeroVector;
+	ClimbTimeAccumulator = 0.0f;
+	PreviousStepLocation = FVector::ZeroVector;
+	ClimbVisualOffset = FVector::ZeroVector;
+	SmoothedComponent = nullptr;
+	SmoothedComponentLocation = FVector::ZeroVector;
+	ClimbState = EClimbState::Grounded;
+	AttachLocation = FVector::ZeroVector;
+	AttachRotation = FRotator::ZeroRotator;
+	MantleTarget = FVector::ZeroVector;
+	CornerStart = FVector::ZeroVector;
+	CornerPivot = FVector::ZeroVector;
+	CornerTarget = FVector::ZeroVector;
+	CornerStartRotation = FRotator::ZeroRotator;
+	CornerRotation = FRotator::ZeroRotator;
+	CornerTime = -1.0f;
+	AttachRootMotionID = 0;
+	MantleRootMotionID = 0;
+	bGrabPending = false;
+	bWantsToClimb = false;
+	PackedClimbLook = 0;
+	WallNormal = FVector::ZeroVector;
+	NetStateUpdates = 0;
+	NetStateBits = 0;
+	NetMoveBits = 0;
+	NetCorrections = 0;
+	NetTransitionCorrections = 0;
+	NetReportStartTime = 0.0f;
+	LastClimbStateTime = 0.0f;
+	ClimbLOD = EClimbLOD::Full;
+	StepsSinceProbe = 0;
+	SpatialHashIndex = INDEX_NONE;
+	FullActorTickInterval = 0.0f;
+	FullComponentTickInterval = 0.0f;
+	PreparedLocation = FVector::ZeroVector;
+	PreparedRotation = FRotator::ZeroRotator;
+	PreparedInput = FVector2D::ZeroVector;
+	PreparedStepTime = 0.0f;
+	PreparedFrame = 0;
+	bPreparedAhead = false;
+
+	//Only ClimbNetState is replicated, everything else goes through the moves
+	SetIsReplicatedByDefault(true);
+	SetNetworkMoveDataContainer(ClimbMoveDataContainer);
+}
+
+void UClimbingMovementComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	//The owning client predicts its own climb, only proxies are told about it
+	DOREPLIFETIME_CONDITION(UClimbingMovementComponent, ClimbNetState, COND_SimulatedOnly);
+}
+
+void UClimbingMovementComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	ClimbProbes.Init(GetOwner());
+	SurfaceGraph = UClimbSurfaceGraph::FindForWorld(GetWorld());
+	ClimbProbes.SetSurfaceGraph(SurfaceGraph);
+
+	FullActorTickInterval = GetOwner()->PrimaryActorTick.TickInterval;
+	FullComponentTickInterval = PrimaryComponentTick.TickInterval;
+
+	if (UClimbSignificanceSubsystem* Significance = GetWorld()->GetSubsystem<UClimbSignificanceSubsystem>())
+	{
+		Significance->RegisterClimber(this);
+	}
+
+	if (UClimbEvaluateSubsystem* Evaluate = GetWorld()->GetSubsystem<UClimbEvaluateSubsystem>())
+	{
+		Evaluate->RegisterClimber(this);
+	}
+}
+
+void UClimbingMovementComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UClimbSignificanceSubsystem* Significance = GetWorld()->GetSubsystem<UClimbSignificanceSubsystem>())
+	{
+		Significance->UnregisterClimber(this);
+	}
+
+	if (UClimbEvaluateSubsystem* Evaluate = GetWorld()->GetSubsystem<UClimbEvaluateSubsystem>())
+	{
+		Evaluate->UnregisterClimber(this);
+	}
+
+	if (UClimbQuerySchedulerSubsystem* Scheduler = GetWorld()->GetSubsystem<UClimbQuerySchedulerSubsystem>())
+	{
+		Scheduler->Cancel(this);
+	}
+
+	RemoveFromSpatialHash();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void UClimbingMovementComponent::SetClimbLOD(EClimbLOD NewLOD)
+{
+	if (ClimbLOD == NewLOD)
+	{
+		return;
+	}
+
+	ClimbLOD = NewLOD;
+
+	//Next step probes, whatever tier it came from
+	StepsSinceProbe = 0;
+
+	float TickInterval = 0.0f;
+	switch (NewLOD)
+	{
+	case EClimbLOD::Reduced:
+		TickInterval = ReducedTickInterval;
+		break;
+
+	case EClimbLOD::Minimal:
+		TickInterval = MinimalTickInterval;
+		break;
+
+	default:
+		break;
+	}
+
+	//Never faster than the character was set up to tick
+	GetOwner()->SetActorTickInterval(FMath::Max(TickInterval, FullActorTickInterval));
+	SetComponentTickInterval(FMath::Max(TickInterval, FullComponentTickInterval));
+}
+
+int32 UClimbingMovementComponent::GetProbeInterval() const
+{
+	switch (ClimbLOD)
+	{
+	case EClimbLOD::Reduced:
+		return FMath::Max(ReducedProbeInterval, 1);
+
+	case EClimbLOD::Minimal:
+		return FMath::Max(MinimalProbeInterval, 1);
+
+	default:
+		return 1;
+	}
+}
+
+const UClimbSurfaceGraph* UClimbingMovementComponent::GetSurfaceGraph() const
+{
+	//Read from the evaluate phase's worker threads too
+	return (CVarClimbUseSurfaceGraph.GetValueOnAnyThread() != 0) ? SurfaceGraph : nullptr;
+}
+
+void UClimbingMovementComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	//Characters on the ground skip the probe batch entirely
+	if (NeedsClimbProbes())
+	{
+		CLIMB_MEMORY_SCOPE();
+		ClimbProbes.BeginFrame();
+
+		//An async grab fires its probes one frame and attaches the next
+		if (bGrabPending && ClimbProbes.HasResults({ EClimbProbe::GrabBody, EClimbProbe::GrabHead }))
+		{
+			ResolveGrab();
+		}
+	}
+
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	//Everything the climbing steps asked for this frame goes out together, when the query budget has room for it
+	if (NeedsClimbProbes())
+	{
+		CLIMB_MEMORY_SCOPE();
+		UClimbQuerySchedulerSubsystem* Scheduler = GetWorld()->GetSubsystem<UClimbQuerySchedulerSubsystem>();
+		if (Scheduler && UClimbQuerySchedulerSubsystem::IsBudgeted())
+		{
+			Scheduler->Submit(this);
+		}
+		else
+		{
+			ClimbProbes.Flush();
+		}
+	}
+
+	if (GetOwnerRole() == ROLE_Authority)
+	{
+		CLIMB_MEMORY_SCOPE();
+		UpdateClimbNetState();
+	}
+}
+
+bool UClimbingMovementComponent::NeedsClimbProbes() const
+{
+	//Proxies are only shown the climb, they never probe for it
+	if (CharacterOwner && CharacterOwner->GetLocalRole() == ROLE_SimulatedProxy)
+	{
+		return false;
+	}
+
+	return bGrabPending || ClimbState == EClimbState::Attaching || ClimbState == EClimbState::Latched;
+}
+
+float UClimbingMovementComponent::GetMaxSpeed() const
+{
+	if (IsClimbing())
+	{
+		return GetClimbSpeed();
+	}
+
+	return Super::GetMaxSpeed();
+}
+
+bool UClimbingMovementComponent::IsClimbing() const
+{
+	return MovementMode == EMovementMode::MOVE_Custom && CustomMovementMode == CMOVE_Climbing;
+}
+
+void UClimbingMovementComponent::OnMovementModeChanged(EMovementMode PreviousMovementMode, uint8 PreviousCustomMode)
+{
+	Super::OnMovementModeChanged(PreviousMovementMode, PreviousCustomMode);
+
+	//Proxies follow ClimbNetState, a replicated movement mode is not a reason to leave the wall
+	if (CharacterOwner && CharacterOwner->GetLocalRole() == ROLE_SimulatedProxy)
+	{
+		return;
+	}
+
+	if (IsClimbing() && ClimbState != EClimbState::Attaching && ClimbState != EClimbState::Latched && ClimbState != EClimbState::Mantling)
+	{
+		//A correction put us on a wall we never grabbed here, fall until the server says otherwise
+		SetMovementMode(EMovementMode::MOVE_Falling);
+	}
+	else if ((ClimbState == EClimbState::Attaching || ClimbState == EClimbState::Latched) && !IsClimbing())
+	{
+		//Something else took us off the wall
+		SetClimbState(EClimbState::Releasing);
+	}
+	else if (ClimbState == EClimbState::Releasing && IsMovingOnGround())
+	{
+		SetClimbState(EClimbState::Grounded);
+	}
+}
+
+FVector UClimbingMovementComponent::GetHeadLocation() const
+{
+	//The view is drawn between steps, the probes go from where the capsule is
+	return CharacterOwner->GetPawnViewLocation() - ClimbVisualOffset;
+}
+
+float UClimbingMovementComponent::GetClimbSpeed() const
+{
+	return MaxClimbSpeed * WallSurface.ClimbSpeedScale;
+}
+
+void UClimbingMovementComponent::TryGrabWall()
+{
+	//Can grab from the ground or while falling, not while already on a wall or going over a ledge
+	if ((ClimbState != EClimbState::Grounded && ClimbState != EClimbState::Releasing) || !CharacterOwner)
+	{
+		return;
+	}
+
+	bWantsToClimb = true;
+
+	SCOPE_CYCLE_COUNTER(STAT_ClimbTryGrabWall);
+	TRACE_CPUPROFILER_EVENT_SCOPE(UClimbingMovementComponent::TryGrabWall);
+
+	const FClimbSnapshot Snapshot = TakeClimbSnapshot();
+	ClimbingMovementComponent::FClimbComponentTraces Traces(ClimbProbes, GetSurfaceGraph());
+
+	//Climbers already on the wall are not the wall
+	UpdateNeighbours();
+
+	//Baked walls answer straight away
+	FClimbGrab Grab;
+	if (FClimbDecisions::FindBakedGrab(Traces, Snapshot, Grab))
+	{
+		AttachToWall(Grab.WallPoint, Grab.WallNormal, Grab.Surface);
+		return;
+	}
+
+	ClimbProbes.BeginFrame();
+	FClimbDecisions::AddGrabProbes(Traces, Snapshot);
+
+	if (ClimbProbes.IsAsync())
+	{
+		//Probes go out with this frame's batch, TickComponent picks the answer up next frame
+		bGrabPending = true;
+	}
+	else
+	{
+		ResolveGrab();
+	}
+}
+
+void UClimbingMovementComponent::ResolveGrab()
+{
+	bGrabPending = false;
+
+	if ((ClimbState != EClimbState::Grounded && ClimbState != EClimbState::Releasing) || !CharacterOwner)
+	{
+		return;
+	}
+
+	ClimbingMovementComponent::FClimbComponentTraces Traces(ClimbProbes, GetSurfaceGraph());
+
+	FClimbGrab Grab;
+	if (FClimbDecisions::ResolveGrab(Traces, Grab))
+	{
+		AttachToWall(Grab.WallPoint, Grab.WallNormal, Grab.Surface);
+	}
+	else
+	{
+		//Nothing to hold on to, the next move must not try again
+		bWantsToClimb = false;
+	}
+}
+
+void UClimbingMovementComponent::AttachToWall(const FVector& WallPoint, const FVector& InWallNormal, const FClimbSurface& Surface)
+{
+	WallSurface = Surface;
+	WallNormal = InWallNormal;
+
+	//Get the Normal of the Impact and make a Rotation from it off the X Axis
+	AttachRotation = UKismetMathLibrary::MakeRotFromX(InWallNormal * -1);
+	AttachLocation = WallPoint + (InWallNormal * WallOffset);
+
+	SetClimbState(EClimbState::Attaching);
+}
+
+void UClimbingMovementComponent::StartMantle(const FVector& Target)
+{
+	MantleTarget = Target;
+
+	SetClimbState(EClimbState::Mantling);
+}
+
+void UClimbingMovementComponent::ReleaseWall()
+{
+	SCOPE_CYCLE_COUNTER(STAT_ClimbReleaseWall);
+
+	bWantsToClimb = false;
+
+	if (ClimbState == EClimbState::Attaching || ClimbState == EClimbState::Latched || ClimbState == EClimbState::Mantling)
+	{
+		SetClimbState(EClimbState::Releasing);
+	}
+}
+
+void UClimbingMovementComponent::SetClimbState(EClimbState NewState)
+{
+	if (ClimbState == NewState)
+	{
+		return;
+	}
+
+	//A change of state happens once per grab, mantle or release, its root motion sources and callbacks are not per-frame cost
+	FClimbAllocScope AllocScope(false);
+
+	//State is switched first so anything the callbacks set off (movement mode changes) sees where we are going
+	const EClimbState OldState = ClimbState;
+	ClimbState = NewState;
+
+	if (const UWorld* World = GetWorld())
+	{
+		LastClimbStateTime = World->GetTimeSeconds();
+	}
+
+	OnExitState(OldState, NewState);
+	OnEnterState(NewState, OldState);
+
+	OnClimbStateChanged.Broadcast(OldState, NewState);
+}
+
+void UClimbingMovementComponent::OnExitState(EClimbState OldState, EClimbState NewState)
+{
+	switch (OldState)
+	{
+	case EClimbState::Attaching:
+		if (NewState != EClimbState::Latched)
+		{
+			//Cancelled, stop the pull onto the wall where it is
+			RemoveRootMotionSourceByID(AttachRootMotionID);
+			LeaveWall(true);
+		}
+		AttachRootMotionID = 0;
+		break;
+
+	case EClimbState::Latched:
+		RemoveFromSpatialHash();
+
+		//Owner puts the camera and controller back first, it needs the rotation we had on the wall
+		OnLatchChanged.Broadcast(false);
+		LeaveWall(NewState != EClimbState::Mantling);
+		break;
+
+	case EClimbState::Mantling:
+		//Cancelled or done, either way the move is over
+		RemoveRootMotionSourceByID(MantleRootMotionID);
+		MantleRootMotionID = 0;
+		SetMovementMode(EMovementMode::MOVE_Falling);
+		break;
+
+	default:
+		break;
+	}
+}
+
+void UClimbingMovementComponent::OnEnterState(EClimbState NewState, EClimbState OldState)
+{
+	switch (NewState)
+	{
+	case EClimbState::Attaching:
+		//Swap to the climbing mode, gravity no longer applies
+		SetMovementMode(EMovementMode::MOVE_Custom, CMOVE_Climbing);
+		StopMovementImmediately();
+
+		//Move the Actor to the location, gives a feel of flow to attaching to the wall instead of a flat teleport
+		AttachRootMotionID = ApplyClimbMove(TEXT("ClimbAttach"), AttachLocation, AttachDuration, AttachCurve, nullptr);
+		break;
+
+	case EClimbState::Latched:
+		if (AController* Controller = CharacterOwner->GetController())
+		{
+			const FRotator ControlRotation = Controller->GetControlRotation();
+			Controller->SetControlRotation(FRotator(ControlRotation.Pitch, AttachRotation.Yaw, ControlRotation.Roll));
+		}
+
+		if (UClimbSpatialHashSubsystem* SpatialHash = GetWorld()->GetSubsystem<UClimbSpatialHashSubsystem>())
+		{
+			SpatialHashIndex = SpatialHash->Add(this, UpdatedComponent->GetComponentLocation(), WallNormal);
+		}
+
+		//Client and server latch on the same move, both start stepping from nothing there
+		ClimbTimeAccumulator = 0.0f;
+		PreviousStepLocation = UpdatedComponent->GetComponentLocation();
+
+		OnLatchChanged.Broadcast(true);
+		break;
+
+	case EClimbState::Mantling:
+		//Stays in the climbing mode so the move goes over the lip without gravity or floor checks
+		MantleRootMotionID = ApplyClimbMove(TEXT("ClimbMantle"), MantleTarget, MantleDuration, MantleCurve, MantlePathCurve);
+		break;
+
+	case EClimbState::Releasing:
+		//However we came off, the player has to grab again to get back on
+		bWantsToClimb = false;
+		break;
+
+	default:
+		break;
+	}
+}
+
+uint16 UClimbingMovementComponent::ApplyClimbMove(FName InstanceName, const FVector& Target, float Duration, UCurveFloat* TimeCurve, UCurveVector* PathCurve)
+{
+	TSharedPtr<FRootMotionSource_MoveToDynamicForce> Move = MakeShared<FRootMotionSource_MoveToDynamicForce>();
+	Move->InstanceName = InstanceName;
+	Move->AccumulateMode = ERootMotionAccumulateMode::Override;
+	Move->Priority = 500;
+	Move->StartLocation = UpdatedComponent->GetComponentLocation();
+	Move->InitialTargetLocation = Target;
+	Move->TargetLocation = Target;
+	Move->Duration = FMath::Max(Duration, KINDA_SMALL_NUMBER);
+	Move->bRestrictSpeedToExpected = true;
+	Move->TimeMappingCurve = TimeCurve;
+	Move->PathOffsetCurve = PathCurve;
+
+	//Arrive and stop, nothing carries over into the next state
+	Move->FinishVelocityParams.Mode = ERootMotionFinishVelocityMode::SetVelocity;
+	Move->FinishVelocityParams.SetVelocity = FVector::ZeroVector;
+
+	return ApplyRootMotionSource(Move);
+}
+
+void UClimbingMovementComponent::LeaveWall(bool bFall)
+{
+	if (bFall)
+	{
+		SetMovementMode(EMovementMode::MOVE_Falling);
+	}
+
+	UpdatedComponent->SetRelativeRotation(FRotator(0, 0, 0));
+
+	ClimbInput = FVector2D::ZeroVector;
+	ClimbTimeAccumulator = 0.0f;
+	SetClimbVisualOffset(FVector::ZeroVector);
+	WallSurface = FClimbSurface();
+	WallNormal = FVector::ZeroVector;
+	CornerTime = -1.0f;
+
+	//Anything still in flight was aimed at the wall we just left
+	ClimbProbes.Reset();
+}
+
+void UClimbingMovementComponent::PhysClimbMove(float deltaTime)
+{
+	ApplyRootMotionToVelocity(deltaTime);
+
+	if (CurrentRootMotion.HasOverrideVelocity())
+	{
+		FRotator Rotation = UpdatedComponent->GetComponentRotation();
+		if (ClimbState == EClimbState::Attaching)
+		{
+			Rotation = FMath::RInterpTo(Rotation, FRotator(0, AttachRotation.Yaw, 0), deltaTime, 20.0f);
+		}
+
+		//Not swept, like the latent moves before it. Both ends were cleared by probes or the bake
+		MoveUpdatedComponent(Velocity * deltaTime, Rotation.Quaternion(), false);
+	}
+	else
+	{
+		Velocity = FVector::ZeroVector;
+	}
+
+	//The movement component drops a source once its duration is up
+	const uint16 MoveID = (ClimbState == EClimbState::Attaching) ? AttachRootMotionID : MantleRootMotionID;
+	if (!CurrentRootMotion.GetRootMotionSourceByID(MoveID))
+	{
+		SetClimbState((ClimbState == EClimbState::Attaching) ? EClimbState::Latched : EClimbState::Releasing);
+	}
+}
+
+void UClimbingMovementComponent::PhysCustom(float deltaTime, int32 Iterations)
+{
+	if (CustomMovementMode == CMOVE_Climbing)
+	{
+		PhysClimbing(deltaTime, Iterations);
+	}
+
+	Super::PhysCustom(deltaTime, Iterations);
+}
+
+void UClimbingMovementComponent::PhysClimbing(float deltaTime, int32 Iterations)
+{
+	if (deltaTime < MIN_TICK_TIME)
+	{
+		return;
+	}
+
+	//Attach and mantle are root motion moves, the climbing steps wait until they are done
+	if (ClimbState == EClimbState::Attaching || ClimbState == EClimbState::Mantling)
+	{
+		PhysClimbMove(deltaTime);
+		return;
+	}
+
+	if (ClimbState != EClimbState::Latched)
+	{
+		Velocity = FVector::ZeroVector;
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_ClimbPhysClimbing);
+	TRACE_CPUPROFILER_EVENT_SCOPE(UClimbingMovementComponent::PhysClimbing);
+	CSV_SCOPED_TIMING_STAT(Climbing, PhysClimbing);
+	CLIMB_MEMORY_SCOPE();
+	INC_DWORD_STAT(STAT_ClimbClimbers);
+
+	ClimbProbes.BeginFrame();
+
+	//Where the others stood at the start of the frame is near enough for spacing and for what the probes ignore
+	UpdateNeighbours();
+
+	const float StepTime = GetClimbStepTime();
+
+	//Only whole steps are simulated, the remainder carries over to the next frame
+	ClimbTimeAccumulator += deltaTime;
+	int32 Steps = FMath::FloorToInt(ClimbTimeAccumulator / StepTime);
+	if (Steps > MaxClimbSubsteps)
+	{
+		//Hitch, drop the time we can't afford instead of spiralling
+		Steps = MaxClimbSubsteps;
+		ClimbTimeAccumulator = Steps * StepTime;
+	}
+	ClimbTimeAccumulator -= Steps * StepTime;
+	INC_DWORD_STAT_BY(STAT_ClimbSteps, Steps);
+	CSV_CUSTOM_STAT(Climbing, Steps, Steps, ECsvCustomStatOp::Accumulate);
+
+	//The move's acceleration is the climb input, the same on the owning client, the server and in replays
+	const float MaxAccel = GetMaxAcceleration();
+	if (MaxAccel > 0.0f)
+	{
+		const FQuat Rotation = UpdatedComponent->GetComponentQuat();
+		ClimbInput = FVector2D(Acceleration | Rotation.GetUpVector(), Acceleration | Rotation.GetRightVector()) / MaxAccel;
+	}
+
+	const FVector OldLocation = UpdatedComponent->GetComponentLocation();
+
+	for (int32 Step = 0; Step < Steps; Step++)
+	{
+		PreviousStepLocation = UpdatedComponent->GetComponentLocation();
+		if (!ClimbStep(StepTime))
+		{
+			return;
+		}
+	}
+
+	//Speed of the steps this frame ran, a frame between steps keeps the last one for animation and replication
+	if (Steps > 0)
+	{
+		Velocity = (UpdatedComponent->GetComponentLocation() - OldLocation) / (Steps * StepTime);
+	}
+
+	UpdateClimbVisualOffset(StepTime);
+}
+
+void UClimbingMovementComponent::UpdateClimbVisualOffset(float StepTime)
+{
+	//Nothing is drawn on a dedicated server, and replayed moves are followed by the one that is
+	if (CVarClimbSmoothSteps.GetValueOnGameThread() == 0 || IsNetMode(NM_DedicatedServer) || (CharacterOwner && CharacterOwner->bClientUpdating))
+	{
+		SetClimbVisualOffset(FVector::ZeroVector);
+		return;
+	}
+
+	//Like mesh smoothing the visuals run up to one step behind the capsule, lerp(Previous, Current, Alpha) - Current
+	const FVector Location = UpdatedComponent->GetComponentLocation();
+	const float Alpha = FMath::Clamp(ClimbTimeAccumulator / StepTime, 0.0f, 1.0f);
+	FVector Offset = (PreviousStepLocation - Location) * (1.0f - Alpha);
+
+	//Further than a step could have gone the capsule was corrected or teleported, snap to it
+	if (Offset.SizeSquared() > FMath::Square(2.0f * GetClimbSpeed() * StepTime))
+	{
+		PreviousStepLocation = Location;
+		Offset = FVector::ZeroVector;
+	}
+
+	SetClimbVisualOffset(Offset);
+}
+
+void UClimbingMovementComponent::SetClimbVisualOffset(const FVector& Offset)
+{
+	if (Offset.Equals(ClimbVisualOffset) || !CharacterOwner)
+	{
+		ClimbVisualOffset = Offset;
+		return;
+	}
+	ClimbVisualOffset = Offset;
+
+	//Same place mesh smoothing puts its offset, relative to the capsule
+	const FVector RelativeOffset = UpdatedComponent->GetComponentQuat().UnrotateVector(Offset);
+	if (USkeletalMeshComponent* Mesh = CharacterOwner->GetMesh())
+	{
+		Mesh->SetRelativeLocation(CharacterOwner->GetBaseTranslationOffset() + RelativeOffset);
+	}
+
+	if (SmoothedComponent)
+	{
+		SmoothedComponent->SetRelativeLocation(SmoothedComponentLocation + RelativeOffset);
+	}
+}
+
+void UClimbingMovementComponent::SetClimbSmoothedComponent(USceneComponent* Component)
+{
+	SetClimbVisualOffset(FVector::ZeroVector);
+
+	SmoothedComponent = Component;
+	SmoothedComponentLocation = Component ? Component->GetRelativeLocation() : FVector::ZeroVector;
+}
+
+FClimbSnapshot UClimbingMovementComponent::TakeClimbSnapshot() const
+{
+	const FTransform& Transform = UpdatedComponent->GetComponentTransform();
+
+	FClimbSnapshot Snapshot;
+	Snapshot.Location = Transform.GetLocation();
+	Snapshot.Rotation = Transform.Rotator();
+	Snapshot.Forward = Transform.GetUnitAxis(EAxis::X);
+	Snapshot.Right = Transform.GetUnitAxis(EAxis::Y);
+	Snapshot.Up = Transform.GetUnitAxis(EAxis::Z);
+	Snapshot.Head = GetHeadLocation();
+	Snapshot.Feet = Snapshot.Location - (Snapshot.Head - Snapshot.Location);
+	return Snapshot;
+}
+
+bool UClimbingMovementComponent::ClimbStep(float StepTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ClimbStep);
+
+	//A corner is one timed move, nothing is probed until it is round
+	if (IsCornering())
+	{
+		CornerStep(StepTime);
+		return true;
+	}
+
+	//Below full detail only every few steps probe, the ones between trust the wall the last probes found
+	if (!WallNormal.IsZero() && ++StepsSinceProbe < GetProbeInterval())
+	{
+		ExtrapolateStep(StepTime);
+		return true;
+	}
+	StepsSinceProbe = 0;
+
+	const FClimbSnapshot Snapshot = TakeClimbSnapshot();
+
+	//The evaluate phase may already have worked this step out on a worker thread
+	FClimbStepPlan Plan;
+	if (!ConsumePreparedStep(Snapshot, StepTime, Plan))
+	{
+		EvaluateClimbStep(Snapshot, GetClimbStepSettings(), ClimbInput, StepTime, Plan);
+	}
+
+	return ApplyClimbStep(Snapshot, Plan, StepTime);
+}
+
+void UClimbingMovementComponent::EvaluateClimbStep(const FClimbSnapshot& Snapshot, const FClimbStepSettings& Settings, const FVector2D& Input, float StepTime, FClimbStepPlan& OutPlan)
+{
+	ClimbingMovementComponent::FClimbComponentTraces Traces(ClimbProbes, GetSurfaceGraph());
+	FClimbDecisions::EvaluateStep(Traces, Snapshot, Input, StepTime, Settings, WallNormal, WallSurface, OutPlan);
+}
+
+FClimbStepSettings UClimbingMovementComponent::GetClimbStepSettings() const
+{
+	FClimbStepSettings Settings;
+	Settings.MaxClimbSpeed = MaxClimbSpeed;
+	Settings.WallOffset = WallOffset;
+	Settings.CapsuleHalfHeight = CharacterOwner->GetCapsuleComponent()->GetUnscaledCapsuleHalfHeight();
+	return Settings;
+}
+
+bool UClimbingMovementComponent::ApplyClimbStep(const FClimbSnapshot& Snapshot, const FClimbStepPlan& Plan, float StepTime)
+{
+	//Whatever wall the probes found is the one held from here on, even over a ledge
+	WallNormal = Plan.WallNormal;
+	WallSurface = Plan.WallSurface;
+
+	if (Plan.bMantle)
+	{
+		StartMantle(Plan.MantleTarget);
+		return false;
+	}
+
+	if (Plan.bCorner)
+	{
+		StartCorner(Plan);
+		return true;
+	}
+
+	if (Plan.Delta.IsNearlyZero() && Plan.Rotation.Equals(Snapshot.Rotation))
+	{
+		return true;
+	}
+
+	//Both axes together never go faster than one
+	const FVector Delta = AvoidNeighbours(Plan.Delta.GetClampedToMaxSize(GetClimbSpeed() * StepTime));
+
+	FHitResult Hit(1.f);
+	SafeMoveUpdatedComponent(Delta, Plan.Rotation.Quaternion(), true, Hit);
+	if (Hit.IsValidBlockingHit())
+	{
+		SlideAlongSurface(Delta, 1.f - Hit.Time, Hit.Normal, Hit, true);
+	}
+
+	if (AController* Controller = CharacterOwner->GetController())
+	{
+		Controller->SetControlRotation(Plan.Rotation);
+	}
+
+	//If player is latched and starts to over extend an angle, release them. Poor grip lets go sooner
+	const float Tilt = UpdatedComponent->GetComponentRotation().Pitch;
+	const float MaxTilt = ReleaseTilt * WallSurface.Grip;
+	if (Tilt >= MaxTilt || Tilt <= -MaxTilt)
+	{
+		ReleaseWall();
+		return false;
+	}
+
+	return true;
+}
+
+bool UClimbingMovementComponent::CanPrepareClimbStep() const
+{
+	//Characters moved by their own tick, and remote players on a server, whose next move is most likely their last one again
+	const bool bRemotePlayer = CharacterOwner && CharacterOwner->GetLocalRole() == ROLE_Authority && CharacterOwner->GetRemoteRole() == ROLE_AutonomousProxy;
+	return ClimbState == EClimbState::Latched && IsClimbing()
+		&& CharacterOwner && (CharacterOwner->IsLocallyControlled() || bRemotePlayer)
+		&& !ClimbInput.IsZero() && !IsCornering()
+		&& !ClimbProbes.IsAsync()
+		&& (WallNormal.IsZero() || StepsSinceProbe + 1 >= GetProbeInterval());
+}
+
+void UClimbingMovementComponent::BeginPrepareClimbStep()
+{
+	PrepareSnapshot = TakeClimbSnapshot();
+	PrepareSettings = GetClimbStepSettings();
+
+	//Their moves for this frame were run when the RPCs came in, before the evaluate phase
+	bPreparedAhead = !CharacterOwner->IsLocallyControlled();
+
+	ClimbProbes.BeginWorkerFrame();
+}
+
+void UClimbingMovementComponent::PrepareClimbStep()
+{
+	SCOPE_CYCLE_COUNTER(STAT_ClimbPrepareStep);
+	CLIMB_MEMORY_SCOPE();
+
+	//The input PhysClimbing will decode from the move's acceleration, clamped the same way
+	const float InputSize = ClimbInput.Size();
+	const FVector2D Input = (InputSize > 1.0f) ? ClimbInput / InputSize : ClimbInput;
+
+	const float StepTime = GetClimbStepTime();
+
+	EvaluateClimbStep(PrepareSnapshot, PrepareSettings, Input, StepTime, PreparedPlan);
+
+	PreparedLocation = PrepareSnapshot.Location;
+	PreparedRotation = PrepareSnapshot.Rotation;
+	PreparedInput = Input;
+	PreparedStepTime = StepTime;
+	PreparedFrame = GFrameCounter;
+}
+
+void UClimbingMovementComponent::EndPrepareClimbStep()
+{
+	//A probe landed on something new, the tick evaluates the step again where it can look at it
+	if (ClimbProbes.HasMissedWorkerSnapshot())
+	{
+		PreparedFrame = 0;
+		INC_DWORD_STAT(STAT_ClimbPreparedStepsDiscarded);
+	}
+
+	ClimbProbes.EndWorkerFrame();
+}
+
+bool UClimbingMovementComponent::ConsumePreparedStep(const FClimbSnapshot& Snapshot, float StepTime, FClimbStepPlan& OutPlan)
+{
+	//A remote player's plan waits for the move its owner sends next frame
+	if (PreparedFrame == 0 || GFrameCounter - PreparedFrame > (bPreparedAhead ? 1u : 0u))
+	{
+		return false;
+	}
+
+	//Only good for the first step of the frame, and only if nothing moved the character since
+	PreparedFrame = 0;
+	if (PreparedLocation != Snapshot.Location || !PreparedRotation.Equals(Snapshot.Rotation, 0.0f)
+		|| !PreparedInput.Equals(ClimbInput, 1.e-3f) || PreparedStepTime != StepTime)
+	{
+		INC_DWORD_STAT(STAT_ClimbPreparedStepsDiscarded);
+		return false;
+	}
+
+	INC_DWORD_STAT(STAT_ClimbPreparedStepsUsed);
+	OutPlan = PreparedPlan;
+	return true;
+}
+
+float UClimbingMovementComponent::GetClimbStepTime() const
+{
+	const float OverrideRate = CVarClimbSimulationRate.GetValueOnAnyThread();
+	return 1.0f / FMath::Max((OverrideRate > 0.0f) ? OverrideRate : ClimbSimulationRate, 10.0f);
+}
+
+void UClimbingMovementComponent::StartCorner(const FClimbStepPlan& Plan)
+{
+	INC_DWORD_STAT(STAT_ClimbCorners);
+
+	CornerStart = UpdatedComponent->GetComponentLocation();
+	CornerStartRotation = UpdatedComponent->GetComponentRotation();
+	CornerPivot = Plan.CornerPivot;
+	CornerTarget = Plan.CornerTarget;
+	CornerRotation = Plan.CornerRotation;
+	CornerTime = 0.0f;
+}
+
+void UClimbingMovementComponent::CornerStep(float StepTime)
+{
+	CornerTime += StepTime;
+	const float Time = FMath::Min(CornerTime / CornerDuration, 1.0f);
+	const float Alpha = CornerCurve ? CornerCurve->GetFloatValue(Time) : Time;
+
+	//Swings round the line the two walls meet on, so an outside corner is never cut through
+	const FVector2D StartOffset(CornerStart - CornerPivot);
+	const FVector2D TargetOffset(CornerTarget - CornerPivot);
+	const float StartAngle = FMath::Atan2(StartOffset.Y, StartOffset.X);
+	const float Angle = StartAngle + FMath::FindDeltaAngleRadians(StartAngle, FMath::Atan2(TargetOffset.Y, TargetOffset.X)) * Alpha;
+	const float Radius = FMath::Lerp(StartOffset.Size(), TargetOffset.Size(), Alpha);
+
+	FVector Location = CornerPivot + FVector(FMath::Cos(Angle), FMath::Sin(Angle), 0.0f) * Radius;
+	Location.Z = FMath::Lerp(CornerStart.Z, CornerTarget.Z, Alpha);
+	const FRotator Rotation = FMath::Lerp(CornerStartRotation, CornerRotation, Alpha);
+
+	//Not swept, like the attach and mantle moves. The probes found both walls and the arc stays off them
+	MoveUpdatedComponent(Location - UpdatedComponent->GetComponentLocation(), Rotation.Quaternion(), false);
+
+	if (AController* Controller = CharacterOwner->GetController())
+	{
+		Controller->SetControlRotation(Rotation);
+	}
+
+	if (Time >= 1.0f)
+	{
+		//Round, the next step probes the new wall whatever the LOD
+		CornerTime = -1.0f;
+		StepsSinceProbe = GetProbeInterval();
+	}
+}
+
+void UClimbingMovementComponent::ExtrapolateStep(float StepTime)
+{
+	INC_DWORD_STAT(STAT_ClimbExtrapolatedSteps);
+
+	const FQuat Rotation = UpdatedComponent->GetComponentQuat();
+	const FVector Input = (Rotation.GetUpVector() * ClimbInput.X) + (Rotation.GetRightVector() * ClimbInput.Y);
+
+	//Flat along the wall, ledges and corners wait for the next probed step
+	const FVector Delta = AvoidNeighbours(FVector::VectorPlaneProject(Input, WallNormal).GetClampedToMaxSize(1.0f) * (GetClimbSpeed() * StepTime));
+	if (Delta.IsNearlyZero())
+	{
+		return;
+	}
+
+	FHitResult Hit(1.f);
+	SafeMoveUpdatedComponent(Delta, Rotation, true, Hit);
+	if (Hit.IsValidBlockingHit())
+	{
+		SlideAlongSurface(Delta, 1.f - Hit.Time, Hit.Normal, Hit, true);
+	}
+}
+
+void UClimbingMovementComponent::UpdateNeighbours()
+{
+	UClimbSpatialHashSubsystem* SpatialHash = GetWorld()->GetSubsystem<UClimbSpatialHashSubsystem>();
+	const float Radius = CVarClimbNeighbourRadius.GetValueOnGameThread();
+	const FVector Location = UpdatedComponent->GetComponentLocation();
+
+	Neighbours.Reset();
+	if (SpatialHash)
+	{
+		SpatialHash->Move(SpatialHashIndex, Location, WallNormal);
+		if (Radius > 0.0f)
+		{
+			SpatialHash->FindNeighbours(Location, Radius, SpatialHashIndex, Neighbours);
+		}
+	}
+
+	TArray<AActor*, TInlineAllocator<16>> IgnoredActors;
+	for (const FClimbNeighbour& Neighbour : Neighbours)
+	{
+		IgnoredActors.Add(Neighbour.Owner);
+	}
+	ClimbProbes.SetIgnoredActors(IgnoredActors);
+}
+
+void UClimbingMovementComponent::RemoveFromSpatialHash()
+{
+	if (SpatialHashIndex == INDEX_NONE)
+	{
+		return;
+	}
+
+	if (UClimbSpatialHashSubsystem* SpatialHash = GetWorld()->GetSubsystem<UClimbSpatialHashSubsystem>())
+	{
+		SpatialHash->Remove(SpatialHashIndex);
+	}
+	SpatialHashIndex = INDEX_NONE;
+}
+
+FVector UClimbingMovementComponent::AvoidNeighbours(const FVector& Delta) const
+{
+	if (WallNormal.IsZero() || ClimberSpacing <= 0.0f)
+	{
+		return Delta;
+	}
+
+	const FVector Location = UpdatedComponent->GetComponentLocation();
+	FVector Result = Delta;
+	for (const FClimbNeighbour& Neighbour : Neighbours)
+	{
+		//Only climbers on the same face, one round a corner or on the back of a thin wall is not in the way
+		if ((Neighbour.WallNormal | WallNormal) < ClimbingMovementComponent::SameWallCos)
+		{
+			continue;
+		}
+
+		const FVector Offset = FVector::VectorPlaneProject(Neighbour.Location - Location, WallNormal);
+		const float Distance = Offset.Size();
+		if (Distance >= ClimberSpacing || Distance < KINDA_SMALL_NUMBER)
+		{
+			continue;
+		}
+
+		//Sliding past is fine, closing in is not
+		const FVector Direction = Offset / Distance;
+		const float Closing = Result | Direction;
+		if (Closing > 0.0f)
+		{
+			Result -= Direction * Closing;
+		}
+	}
+	return Result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Networking
+
+FNetworkPredictionData_Client* UClimbingMovementComponent::GetPredictionData_Client() const
+{
+	if (ClientPredictionData == nullptr)
+	{
+		UClimbingMovementComponent* MutableThis = const_cast<UClimbingMovementComponent*>(this);
+		MutableThis->ClientPredictionData = new FNetworkPredictionData_Client_Climbing(*this);
+	}
+
+	return ClientPredictionData;
+}
+
+void UClimbingMovementComponent::UpdateFromCompressedFlags(uint8 Flags)
+{
+	Super::UpdateFromCompressedFlags(Flags);
+
+	bWantsToClimb = (Flags & FSavedMove_Character::FLAG_Custom_0) != 0;
+}
+
+void UClimbingMovementComponent::MoveAutonomous(float ClientTimeStamp, float DeltaTime, uint8 CompressedFlags, const FVector& NewAccel)
+{
+	//Look and step carry only come along on moves made on a wall
+	if (const FClimbNetworkMoveData* MoveData = static_cast<const FClimbNetworkMoveData*>(GetCurrentNetworkMoveData()))
+	{
+		if (CompressedFlags & FSavedMove_Character::FLAG_Custom_0)
+		{
+			PackedClimbLook = MoveData->ClimbLook;
+			SetPackedClimbTimeAccumulator(MoveData->ClimbStepCarry);
+			NetMoveBits += 24;
+		}
+	}
+
+	Super::MoveAutonomous(ClientTimeStamp, DeltaTime, CompressedFlags, NewAccel);
+}
+
+void UClimbingMovementComponent::UpdateCharacterStateBeforeMovement(float DeltaSeconds)
+{
+	Super::UpdateCharacterStateBeforeMovement(DeltaSeconds);
+
+	//Runs on the owning client for its prediction and on the server for the same move, which has the last word
+	if (!CharacterOwner || CharacterOwner->GetLocalRole() == ROLE_SimulatedProxy)
+	{
+		return;
+	}
+
+	if (bWantsToClimb)
+	{
+		if ((ClimbState == EClimbState::Grounded || ClimbState == EClimbState::Releasing) && !bGrabPending)
+		{
+			TryGrabWall();
+		}
+	}
+	else if (ClimbState == EClimbState::Attaching || ClimbState == EClimbState::Latched)
+	{
+		JumpOffWall();
+	}
+}
+
+void UClimbingMovementComponent::JumpOffWall()
+{
+	//Camera forward on the wall, has to be read before letting go resets the rotation
+	const FRotator Look = GetClimbLook();
+	const bool bJumpOff = CharacterOwner->bPressedJump && FMath::Abs(Look.Yaw) > JumpOffAngle;
+	const FVector LaunchDir = (UpdatedComponent->GetComponentQuat() * Look.Quaternion()).GetForwardVector() * JumpOffSpeed;
+
+	ReleaseWall();
+
+	if (bJumpOff)
+	{
+		Launch(FVector(Velocity.X + LaunchDir.X, Velocity.Y + LaunchDir.Y, JumpOffZVelocity));
+	}
+}
+
+FVector UClimbingMovementComponent::ConstrainInputAcceleration(const FVector& InputVector) const
+{
+	//Climb input travels to the server as the move's acceleration, along the wall's up and right
+	if (IsClimbing())
+	{
+		const FQuat Rotation = UpdatedComponent->GetComponentQuat();
+		return (Rotation.GetUpVector() * ClimbInput.X) + (Rotation.GetRightVector() * ClimbInput.Y);
+	}
+
+	return Super::ConstrainInputAcceleration(InputVector);
+}
+
+void UClimbingMovementComponent::UpdateClimbNetState()
+{
+	FClimbNetState NewState = ClimbNetState;
+	NewState.State = (uint8)ClimbState;
+
+	if (NewState.IsOnWall())
+	{
+		NewState.PackedLook = PackedClimbLook;
+
+		//The normal wobbles a little every step, proxies only hear about it once it has really turned
+		const float MinDot = FMath::Cos(FMath::DegreesToRadians(CVarClimbNetNormalTolerance.GetValueOnGameThread()));
+		if (!ClimbNetState.IsOnWall() || (FClimbNetState::UnpackNormal(ClimbNetState.PackedNormal) | WallNormal) < MinDot)
+		{
+			NewState.PackedNormal = FClimbNetState::PackNormal(WallNormal);
+		}
+	}
+	else
+	{
+		//Not sent off the wall, cleared so it can't make two equal states look different
+		NewState.PackedNormal = 0;
+		NewState.PackedLook = 0;
+	}
+
+	if (NewState == ClimbNetState)
+	{
+		return;
+	}
+
+	ClimbNetState = NewState;
+
+	const int32 Bits = NewState.GetNetBits();
+	NetStateUpdates++;
+	NetStateBits += Bits;
+	INC_DWORD_STAT_BY(STAT_ClimbNetStateBits, Bits);
+	CSV_CUSTOM_STAT(Climbing, NetStateBits, Bits, ECsvCustomStatOp::Accumulate);
+}
+
+void UClimbingMovementComponent::OnRep_ClimbNetState()
+{
+	WallNormal = ClimbNetState.IsOnWall() ? FClimbNetState::UnpackNormal(ClimbNetState.PackedNormal) : FVector::ZeroVector;
+	PackedClimbLook = ClimbNetState.PackedLook;
+
+	const EClimbState NewState = (EClimbState)ClimbNetState.State;
+	if (NewState == ClimbState)
+	{
+		return;
+	}
+
+	//Location and rotation come with the replicated movement, the state only has to reach the listeners
+	const EClimbState OldState = ClimbState;
+	ClimbState = NewState;
+
+	if (const UWorld* World = GetWorld())
+	{
+		LastClimbStateTime = World->GetTimeSeconds();
+	}
+
+	if (OldState == EClimbState::Latched)
+	{
+		OnLatchChanged.Broadcast(false);
+	}
+	else if (NewState == EClimbState::Latched)
+	{
+		OnLatchChanged.Broadcast(true);
+	}
+
+	OnClimbStateChanged.Broadcast(OldState, NewState);
+}
+
+bool UClimbingMovementComponent::ServerCheckClientError(float ClientTimeStamp, float DeltaTime, const FVector& Accel, const FVector& ClientLoc, const FVector& RelativeClientLoc,
+	UPrimitiveComponent* ClientMovementBase, FName ClientBaseBoneName, uint8 ClientMovementMode)
+{
+	if (!Super::ServerCheckClientError(ClientTimeStamp, DeltaTime, Accel, ClientLoc, RelativeClientLoc, ClientMovementBase, ClientBaseBoneName, ClientMovementMode))
+	{
+		return false;
+	}
+
+	NetCorrections++;
+	NumNetCorrections++;
+
+	//Grabs and releases are where client and server are most likely to disagree, see climb.NetReport and the ClimbSoak commandlet
+	const UWorld* World = GetWorld();
+	if (World && World->GetTimeSeconds() - LastClimbStateTime <= CVarClimbNetTransitionWindow.GetValueOnGameThread())
+	{
+		NetTransitionCorrections++;
+		NumNetTransitionCorrections++;
+	}
+	return true;
+}
+
+float UClimbingMovementComponent::GetNetReportSeconds() const
+{
+	const UWorld* World = GetWorld();
+	return World ? World->GetTimeSeconds() - NetReportStartTime : 0.0f;
+}
+
+void UClimbingMovementComponent::ResetNetReport()
+{
+	NetStateUpdates = 0;
+	NetStateBits = 0;
+	NetMoveBits = 0;
+	NetCorrections = 0;
+	NetTransitionCorrections = 0;
+
+	const UWorld* World = GetWorld();
+	NetReportStartTime = World ? World->GetTimeSeconds() : 0.0f;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// FClimbNetState
+
+bool FClimbNetState::IsOnWall() const
+{
+	const EClimbState ClimbState = (EClimbState)State;
+	return ClimbState == EClimbState::Attaching || ClimbState == EClimbState::Latched || ClimbState == EClimbState::Mantling;
+}
+
+int32 FClimbNetState::GetNetBits() const
+{
+	return 3 + (IsOnWall() ? 32 : 0);
+}
+
+bool FClimbNetState::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	//Five states fit in three bits
+	Ar.SerializeBits(&State, 3);
+
+	if (IsOnWall())
+	{
+		Ar << PackedNormal;
+		Ar << PackedLook;
+	}
+
+	bOutSuccess = true;
+	return true;
+}
+
+uint16 FClimbNetState::PackNormal(const FVector& Normal)
+{
+	//Octahedral, the unit sphere folded onto a square. Errors stay under a degree at 8 bits per axis
+	const float L1 = FMath::Abs(Normal.X) + FMath::Abs(Normal.Y) + FMath::Abs(Normal.Z);
+	if (L1 <= KINDA_SMALL_NUMBER)
+	{
+		return 0;
+	}
+
+	float U = Normal.X / L1;
+	float V = Normal.Y / L1;
+	if (Normal.Z < 0.0f)
+	{
+		const float FoldedU = (1.0f - FMath::Abs(V)) * (U >= 0.0f ? 1.0f : -1.0f);
+		const float FoldedV = (1.0f - FMath::Abs(U)) * (V >= 0.0f ? 1.0f : -1.0f);
+		U = FoldedU;
+		V = FoldedV;
+	}
+
+	const uint16 PackedU = (uint16)FMath::RoundToInt((U * 0.5f + 0.5f) * 255.0f);
+	const uint16 PackedV = (uint16)FMath::RoundToInt((V * 0.5f + 0.5f) * 255.0f);
+	return (PackedU << 8) | PackedV;
+}
+
+FVector FClimbNetState::UnpackNormal(uint16 Packed)
+{
+	const float U = ((Packed >> 8) / 255.0f) * 2.0f - 1.0f;
+	const float V = ((Packed & 0xFF) / 255.0f) * 2.0f - 1.0f;
+
+	FVector Normal(U, V, 1.0f - FMath::Abs(U) - FMath::Abs(V));
+	if (Normal.Z < 0.0f)
+	{
+		Normal.X = (1.0f - FMath::Abs(V)) * (U >= 0.0f ? 1.0f : -1.0f);
+		Normal.Y = (1.0f - FMath::Abs(U)) * (V >= 0.0f ? 1.0f : -1.0f);
+	}
+
+	return Normal.GetSafeNormal();
+}
+
+uint16 FClimbNetState::PackLook(const FRotator& Look)
+{
+	return (FRotator::CompressAxisToByte(Look.Yaw) << 8) | FRotator::CompressAxisToByte(Look.Pitch);
+}
+
+FRotator FClimbNetState::UnpackLook(uint16 Packed)
+{
+	const float Yaw = FRotator::NormalizeAxis(FRotator::DecompressAxisFromByte(Packed >> 8));
+	const float Pitch = FRotator::NormalizeAxis(FRotator::DecompressAxisFromByte(Packed & 0xFF));
+	return FRotator(Pitch, Yaw, 0.0f);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Saved moves
+
+void FSavedMove_Climbing::Clear()
+{
+	Super::Clear();
+
+	bSavedWantsToClimb = false;
+	bSavedLatched = false;
+	SavedClimbLook = 0;
+	SavedClimbStepCarry = 0;
+}
+
+uint8 FSavedMove_Climbing::GetCompressedFlags() const
+{
+	uint8 Result = Super::GetCompressedFlags();
+
+	if (bSavedWantsToClimb)
+	{
+		Result |= FLAG_Custom_0;
+	}
+
+	return Result;
+}
+
+bool FSavedMove_Climbing::CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* InCharacter, float MaxDelta) const
+{
+	const FSavedMove_Climbing* ClimbMove = static_cast<const FSavedMove_Climbing*>(NewMove.Get());
+	if (bSavedWantsToClimb != ClimbMove->bSavedWantsToClimb || SavedClimbLook != ClimbMove->SavedClimbLook)
+	{
+		return false;
+	}
+
+	//A move that latches or lets go stays on its own. Latched moves combine, CombineWith keeps the first one's step carry
+	if (bSavedLatched != ClimbMove->bSavedLatched)
+	{
+		return false;
+	}
+
+	return Super::CanCombineWith(NewMove, InCharacter, MaxDelta);
+}
+
+void FSavedMove_Climbing::SetMoveFor(ACharacter* C, float InDeltaTime, FVector const& NewAccel, FNetworkPredictionData_Client_Character& ClientData)
+{
+	Super::SetMoveFor(C, InDeltaTime, NewAccel, ClientData);
+
+	if (UClimbingMovementComponent* Movement = Cast<UClimbingMovementComponent>(C->GetCharacterMovement()))
+	{
+		bSavedWantsToClimb = Movement->WantsToClimb();
+		bSavedLatched = Movement->IsLatched();
+		SavedClimbLook = FClimbNetState::PackLook(Movement->GetClimbLook());
+
+		//Start from the quantized carry the server will get, so both sides take their steps at the same times
+		SavedClimbStepCarry = Movement->GetPackedClimbTimeAccumulator();
+		Movement->SetPackedClimbTimeAccumulator(SavedClimbStepCarry);
+	}
+}
+
+void FSavedMove_Climbing::CombineWith(const FSavedMove_Character* OldMove, ACharacter* InCharacter, APlayerController* PC, const FVector& OldStartLocation)
+{
+	Super::CombineWith(OldMove, InCharacter, PC, OldStartLocation);
+
+	//The combined move is simulated again from where the old one started
+	SavedClimbStepCarry = static_cast<const FSavedMove_Climbing*>(OldMove)->SavedClimbStepCarry;
+	if (UClimbingMovementComponent* Movement = Cast<UClimbingMovementComponent>(InCharacter->GetCharacterMovement()))
+	{
+		Movement->SetPackedClimbTimeAccumulator(SavedClimbStepCarry);
+	}
+}
+
+void FSavedMove_Climbing::PrepMoveFor(ACharacter* C)
+{
+	Super::PrepMoveFor(C);
+
+	if (UClimbingMovementComponent* Movement = Cast<UClimbingMovementComponent>(C->GetCharacterMovement()))
+	{
+		Movement->SetWantsToClimb(bSavedWantsToClimb);
+		Movement->SetClimbLook(FClimbNetState::UnpackLook(SavedClimbLook));
+		Movement->SetPackedClimbTimeAccumulator(SavedClimbStepCarry);
+	}
+}
+
+FNetworkPredictionData_Client_Climbing::FNetworkPredictionData_Client_Climbing(const UCharacterMovementComponent& ClientMovement)
+	: Super(ClientMovement)
+{
+}
+
+FSavedMovePtr FNetworkPredictionData_Client_Climbing::AllocateNewMove()
+{
+	return FSavedMovePtr(new FSavedMove_Climbing());
+}
+
+void FClimbNetworkMoveData::ClientFillNetworkMoveData(const FSavedMove_Character& ClientMove, ENetworkMoveType MoveType)
+{
+	Super::ClientFillNetworkMoveData(ClientMove, MoveType);
+
+	const FSavedMove_Climbing& ClimbMove = static_cast<const FSavedMove_Climbing&>(ClientMove);
+	ClimbLook = ClimbMove.SavedClimbLook;
+	ClimbStepCarry = ClimbMove.SavedClimbStepCarry;
+}
+
+bool FClimbNetworkMoveData::Serialize(UCharacterMovementComponent& CharacterMovement, FArchive& Ar, UPackageMap* PackageMap, ENetworkMoveType MoveType)
+{
+	Super::Serialize(CharacterMovement, Ar, PackageMap, MoveType);
+
+	//Three bytes on a wall, nothing anywhere else
+	if (CompressedMoveFlags & FSavedMove_Character::FLAG_Custom_0)
+	{
+		Ar << ClimbLook;
+		Ar << ClimbStepCarry;
+	}
+
+	return !Ar.IsError();
+}
+
+uint8 FClimbNetworkMoveData::PackStepCarry(float Carry, float StepTime)
+{
+	return (uint8)FMath::Clamp(FMath::RoundToInt(Carry / StepTime * 255.0f), 0, 255);
+}
+
+float FClimbNetworkMoveData::UnpackStepCarry(uint8 Packed, float StepTime)
+{
+	return Packed * StepTime / 255.0f;
+}
@@ -0,0 +1,115 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ClimbBenchCommandlet.h"
+#include "ClimbMemory.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace ClimbAllocTest
+{
+	//Grab during warmup and climb up a little. ClimbBench script format
+	const TCHAR* const Start[] =
+	{
+		TEXT("0 MoveForward 1"),
+		TEXT("10 Jump 1"),
+		TEXT("12 Jump 0"),
+	};
+
+	//From here on the same round over and over: shimmy right and back, down and back up. Each leg undoes the one
+	//before it, so the bots stay on the wall however long the run is
+	struct FRoundEvent
+	{
+		int32 Frame;
+		const TCHAR* Binding;
+		int32 Value;
+	};
+
+	const int32 FirstRound = 180;
+	const int32 RoundFrames = 360;
+	const FRoundEvent Round[] =
+	{
+		{ 0, TEXT("MoveForward"), 0 },
+		{ 0, TEXT("MoveRight"), 1 },
+		{ 120, TEXT("MoveRight"), -1 },
+		{ 240, TEXT("MoveRight"), 0 },
+		{ 240, TEXT("MoveForward"), -1 },
+		{ 300, TEXT("MoveForward"), 1 },
+	};
+
+	const int32 NumWarmup = 60;
+	const int32 NumFrames = 10000;
+
+	//Rounds until the last few seconds, which go up over the top
+	void BuildScript(TArray<FString>& OutLines)
+	{
+		for (const TCHAR* Line : Start)
+		{
+			OutLines.Add(Line);
+		}
+
+		const int32 LastFrame = NumWarmup + NumFrames;
+		int32 RoundStart = FirstRound;
+		for (; RoundStart + RoundFrames <= LastFrame - RoundFrames; RoundStart += RoundFrames)
+		{
+			for (const FRoundEvent& Event : Round)
+			{
+				OutLines.Add(FString::Printf(TEXT("%d %s %d"), RoundStart + Event.Frame, Event.Binding, Event.Value));
+			}
+		}
+
+		OutLines.Add(FString::Printf(TEXT("%d MoveRight 0"), RoundStart));
+		OutLines.Add(FString::Printf(TEXT("%d MoveForward 1"), RoundStart));
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FClimbAllocTest, "Climb.Memory.ScriptedClimbDoesNotAllocate", EAutomationTestFlags::EditorContext | EAutomationTestFlags::CommandletContext | EAutomationTestFlags::ProductFilter)
+
+bool FClimbAllocTest::RunTest(const FString& Parameters)
+{
+	//The counting proxy can only go in at startup, without it there is nothing to check
+	if (!FClimbAllocCounter::IsInstalled())
+	{
+		AddWarning(TEXT("Skipped: run with -ClimbCountAllocs on the command line, the allocation counter is installed when the module starts"));
+		return true;
+	}
+
+	const FString Directory = FPaths::AutomationTransientDir() / TEXT("ClimbAlloc");
+	const FString ScriptFilename = Directory / TEXT("Script.txt");
+	const FString ReportFilename = Directory / TEXT("ClimbBench.json");
+
+	TArray<FString> Lines;
+	ClimbAllocTest::BuildScript(Lines);
+	if (!FFileHelper::SaveStringArrayToFile(Lines, *ScriptFilename))
+	{
+		AddError(FString::Printf(TEXT("Could not write %s"), *ScriptFilename));
+		return false;
+	}
+
+	//Warmup grows every array to what the climb needs, after it -MaxAllocs=0 fails the run on the first allocation
+	const FString Params = FString::Printf(TEXT("-Map=/Game/TestLevel -Climbers=4 -Warmup=%d -Frames=%d -Script=\"%s\" -Output=\"%s\" -MaxAllocs=0"),
+		ClimbAllocTest::NumWarmup, ClimbAllocTest::NumFrames, *ScriptFilename, *ReportFilename);
+	UClimbBenchCommandlet* Bench = NewObject<UClimbBenchCommandlet>();
+	TestEqual(TEXT("ClimbBench exit code"), Bench->Main(Params), 0);
+
+	FString Json;
+	TSharedPtr<FJsonObject> Report;
+	if (!FFileHelper::LoadFileToString(Json, *ReportFilename) || !FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(Json), Report) || !Report.IsValid())
+	{
+		AddError(FString::Printf(TEXT("No ClimbBench report in %s"), *ReportFilename));
+		return false;
+	}
+
+	//Zero allocations means nothing if nobody got onto the wall
+	TestTrue(TEXT("Bots climbed"), Report->GetNumberField(TEXT("climbingPerFrame")) > 0.0);
+	TestEqual(TEXT("Climbing allocations"), (int32)Report->GetNumberField(TEXT("climbingAllocs")), 0);
+	return true;
+}
+
+#endif //WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,59 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ClimbBenchCommandlet.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace ClimbBenchTest
+{
+	const int32 NumClimbers = 16;
+	const int32 NumWarmup = 60;
+	const int32 NumFrames = 1800;
+}
+
+/**
+ * Runs ClimbBench on TestLevel with random input, so the perf numbers come out of an automation run
+ * (-ExecCmds="Automation RunTests Climb.Bench" -nullrhi) as well as the commandlet. The report is logged
+ * and kept in the automation transient directory.
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FClimbBenchTest, "Climb.Bench.TestLevel", EAutomationTestFlags::EditorContext | EAutomationTestFlags::CommandletContext | EAutomationTestFlags::PerfFilter)
+
+bool FClimbBenchTest::RunTest(const FString& Parameters)
+{
+	const FString ReportFilename = FPaths::AutomationTransientDir() / TEXT("ClimbBench") / TEXT("ClimbBench.json");
+
+	const FString Params = FString::Printf(TEXT("-Map=/Game/TestLevel -Climbers=%d -Warmup=%d -Frames=%d -Output=\"%s\""),
+		ClimbBenchTest::NumClimbers, ClimbBenchTest::NumWarmup, ClimbBenchTest::NumFrames, *ReportFilename);
+	UClimbBenchCommandlet* Bench = NewObject<UClimbBenchCommandlet>();
+	TestEqual(TEXT("ClimbBench exit code"), Bench->Main(Params), 0);
+
+	FString Json;
+	TSharedPtr<FJsonObject> Report;
+	if (!FFileHelper::LoadFileToString(Json, *ReportFilename) || !FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(Json), Report) || !Report.IsValid())
+	{
+		AddError(FString::Printf(TEXT("No ClimbBench report in %s"), *ReportFilename));
+		return false;
+	}
+
+	AddInfo(FString::Printf(TEXT("ClimbBench: %s"), *Json));
+
+	const TSharedPtr<FJsonObject>* GameThread = nullptr;
+	TestEqual(TEXT("Frames measured"), (int32)Report->GetNumberField(TEXT("frames")), ClimbBenchTest::NumFrames);
+	TestEqual(TEXT("Climbers spawned"), (int32)Report->GetNumberField(TEXT("climbers")), ClimbBenchTest::NumClimbers);
+	if (TestTrue(TEXT("Game thread times"), Report->TryGetObjectField(TEXT("gameThreadMs"), GameThread)))
+	{
+		TestTrue(TEXT("p99 is at least p50"), (*GameThread)->GetNumberField(TEXT("p99")) >= (*GameThread)->GetNumberField(TEXT("p50")));
+	}
+	TestTrue(TEXT("Bots climbed"), Report->GetNumberField(TEXT("latches")) > 0.0);
+	TestTrue(TEXT("Climbing traced"), Report->GetNumberField(TEXT("tracesPerFrame")) > 0.0);
+	return true;
+}
+
+#endif //WITH_DEV_AUTOMATION_TESTS
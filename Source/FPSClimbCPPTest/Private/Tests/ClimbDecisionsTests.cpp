@@ -0,0 +1,168 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ClimbMockScene.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace ClimbDecisionsTests
+{
+	//A 300 high wall facing -X at X = 0, from Y = -200 to 200
+	const FBox Wall(FVector(0.0f, -200.0f, 0.0f), FVector(200.0f, 200.0f, 300.0f));
+
+	//Meets the wall's face at Y = 30, an inside corner to the right of a climber at Y = 0
+	const FBox SideWall(FVector(-200.0f, 30.0f, 0.0f), FVector(0.0f, 230.0f, 300.0f));
+
+	const float StepTime = 1.0f / 60.0f;
+	const float Tolerance = 0.1f;
+
+	//Latched on Wall, facing it at WallOffset
+	void EvaluateStep(FClimbMockScene& Scene, const FVector& Location, const FVector2D& Input, FClimbStepPlan& OutPlan)
+	{
+		Scene.Reset();
+		const FClimbSnapshot Snapshot = FClimbMockScene::TakeSnapshot(Location, FRotator::ZeroRotator);
+		FClimbDecisions::EvaluateStep(Scene, Snapshot, Input, StepTime, FClimbStepSettings(), -FVector::ForwardVector, FClimbSurface(), OutPlan);
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FClimbDecisionsGrabTest, "Climb.Decisions.Grab", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FClimbDecisionsGrabTest::RunTest(const FString& Parameters)
+{
+	FClimbMockScene Scene;
+	Scene.AddBox(ClimbDecisionsTests::Wall);
+	Scene.Build();
+
+	FClimbGrab Grab;
+	FClimbDecisions::AddGrabProbes(Scene, FClimbMockScene::TakeSnapshot(FVector(-50.0f, 0.0f, 100.0f), FRotator::ZeroRotator));
+	if (TestTrue(TEXT("Grabs the wall in front"), FClimbDecisions::ResolveGrab(Scene, Grab)))
+	{
+		TestEqual(TEXT("Wall normal"), Grab.WallNormal, -FVector::ForwardVector, ClimbDecisionsTests::Tolerance);
+		TestEqual(TEXT("Wall point is on the face"), Grab.WallPoint.X, 0.0f, ClimbDecisionsTests::Tolerance);
+	}
+
+	Scene.Reset();
+	FClimbDecisions::AddGrabProbes(Scene, FClimbMockScene::TakeSnapshot(FVector(-50.0f, 0.0f, 100.0f), FRotator(0.0f, 180.0f, 0.0f)));
+	TestFalse(TEXT("Nothing to grab facing away"), FClimbDecisions::ResolveGrab(Scene, Grab));
+
+	Scene.Reset();
+	FClimbDecisions::AddGrabProbes(Scene, FClimbMockScene::TakeSnapshot(FVector(-50.0f, 0.0f, 260.0f), FRotator::ZeroRotator));
+	TestFalse(TEXT("No grab with the head over the top"), FClimbDecisions::ResolveGrab(Scene, Grab));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FClimbDecisionsClimbUpTest, "Climb.Decisions.ClimbUp", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FClimbDecisionsClimbUpTest::RunTest(const FString& Parameters)
+{
+	FClimbMockScene Scene;
+	Scene.AddBox(ClimbDecisionsTests::Wall);
+	Scene.Build();
+
+	FClimbStepPlan Plan;
+	ClimbDecisionsTests::EvaluateStep(Scene, FVector(-25.0f, 0.0f, 150.0f), FVector2D(1.0f, 0.0f), Plan);
+
+	const float Step = FClimbStepSettings().MaxClimbSpeed * ClimbDecisionsTests::StepTime;
+	TestFalse(TEXT("No mantle mid wall"), Plan.bMantle);
+	TestFalse(TEXT("No corner mid wall"), Plan.bCorner);
+	TestEqual(TEXT("One step straight up"), Plan.Delta, FVector(0.0f, 0.0f, Step), ClimbDecisionsTests::Tolerance);
+	TestEqual(TEXT("Still on the wall"), Plan.WallNormal, -FVector::ForwardVector, ClimbDecisionsTests::Tolerance);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FClimbDecisionsMantleTest, "Climb.Decisions.Mantle", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FClimbDecisionsMantleTest::RunTest(const FString& Parameters)
+{
+	FClimbMockScene Scene;
+	Scene.AddBox(ClimbDecisionsTests::Wall);
+	Scene.Build();
+
+	//Head already over the top
+	FClimbStepPlan Plan;
+	ClimbDecisionsTests::EvaluateStep(Scene, FVector(-25.0f, 0.0f, 260.0f), FVector2D(1.0f, 0.0f), Plan);
+
+	if (TestTrue(TEXT("Mantles at the top"), Plan.bMantle))
+	{
+		TestTrue(TEXT("Lands past the edge"), Plan.MantleTarget.X > 0.0f);
+		TestTrue(TEXT("Lands above the top"), Plan.MantleTarget.Z > ClimbDecisionsTests::Wall.Max.Z);
+	}
+	TestEqual(TEXT("Does not move while mantling"), Plan.Delta, FVector::ZeroVector, ClimbDecisionsTests::Tolerance);
+
+	//A ceiling over the ledge leaves no room to stand
+	FClimbMockScene Covered;
+	Covered.AddBox(ClimbDecisionsTests::Wall);
+	Covered.AddBox(FBox(FVector(-100.0f, -200.0f, 340.0f), FVector(200.0f, 200.0f, 360.0f)));
+	Covered.Build();
+
+	ClimbDecisionsTests::EvaluateStep(Covered, FVector(-25.0f, 0.0f, 260.0f), FVector2D(1.0f, 0.0f), Plan);
+	TestFalse(TEXT("No mantle under a ceiling"), Plan.bMantle);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FClimbDecisionsShimmyTest, "Climb.Decisions.Shimmy", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FClimbDecisionsShimmyTest::RunTest(const FString& Parameters)
+{
+	FClimbMockScene Scene;
+	Scene.AddBox(ClimbDecisionsTests::Wall);
+	Scene.Build();
+
+	const float Step = FClimbStepSettings().MaxClimbSpeed * ClimbDecisionsTests::StepTime;
+
+	FClimbStepPlan Plan;
+	ClimbDecisionsTests::EvaluateStep(Scene, FVector(-25.0f, 0.0f, 150.0f), FVector2D(0.0f, 1.0f), Plan);
+	TestFalse(TEXT("No corner mid wall"), Plan.bCorner);
+	TestEqual(TEXT("One step right"), Plan.Delta, FVector(0.0f, Step, 0.0f), ClimbDecisionsTests::Tolerance);
+
+	ClimbDecisionsTests::EvaluateStep(Scene, FVector(-25.0f, 0.0f, 150.0f), FVector2D(0.0f, -1.0f), Plan);
+	TestEqual(TEXT("One step left"), Plan.Delta, FVector(0.0f, -Step, 0.0f), ClimbDecisionsTests::Tolerance);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FClimbDecisionsOutsideCornerTest, "Climb.Decisions.OutsideCorner", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FClimbDecisionsOutsideCornerTest::RunTest(const FString& Parameters)
+{
+	FClimbMockScene Scene;
+	Scene.AddBox(ClimbDecisionsTests::Wall);
+	Scene.Build();
+
+	//Hands past the right edge of the wall
+	FClimbStepPlan Plan;
+	ClimbDecisionsTests::EvaluateStep(Scene, FVector(-25.0f, 195.0f, 150.0f), FVector2D(0.0f, 1.0f), Plan);
+
+	if (TestTrue(TEXT("Wraps round the edge"), Plan.bCorner))
+	{
+		TestEqual(TEXT("Holds the side face"), Plan.WallNormal, FVector::RightVector, ClimbDecisionsTests::Tolerance);
+		TestEqual(TEXT("Pivots on the edge"), Plan.CornerPivot, FVector(0.0f, 200.0f, 150.0f), ClimbDecisionsTests::Tolerance);
+		TestEqual(TEXT("Ends WallOffset off the side face"), Plan.CornerTarget, FVector(30.0f, 225.0f, 150.0f), ClimbDecisionsTests::Tolerance);
+		TestEqual(TEXT("Ends facing the side face"), Plan.CornerRotation, FRotator(0.0f, -90.0f, 0.0f), ClimbDecisionsTests::Tolerance);
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FClimbDecisionsInsideCornerTest, "Climb.Decisions.InsideCorner", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FClimbDecisionsInsideCornerTest::RunTest(const FString& Parameters)
+{
+	FClimbMockScene Scene;
+	Scene.AddBox(ClimbDecisionsTests::Wall);
+	Scene.AddBox(ClimbDecisionsTests::SideWall);
+	Scene.Build();
+
+	FClimbStepPlan Plan;
+	ClimbDecisionsTests::EvaluateStep(Scene, FVector(-25.0f, 0.0f, 150.0f), FVector2D(0.0f, 1.0f), Plan);
+
+	if (TestTrue(TEXT("Wraps onto the wall to the right"), Plan.bCorner))
+	{
+		TestEqual(TEXT("Holds the side wall"), Plan.WallNormal, -FVector::RightVector, ClimbDecisionsTests::Tolerance);
+		TestEqual(TEXT("Pivots where the walls meet"), Plan.CornerPivot, FVector(0.0f, 30.0f, 150.0f), ClimbDecisionsTests::Tolerance);
+		TestEqual(TEXT("Ends WallOffset off the side wall"), Plan.CornerTarget, FVector(-35.0f, 5.0f, 150.0f), ClimbDecisionsTests::Tolerance);
+		TestEqual(TEXT("Ends facing the side wall"), Plan.CornerRotation, FRotator(0.0f, 90.0f, 0.0f), ClimbDecisionsTests::Tolerance);
+	}
+	return true;
+}
+
+#endif //WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,100 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ClimbMockScene.h"
+#include "Math/RotationMatrix.h"
+
+FClimbMockScene::FClimbMockScene()
+	: NumTraces(0)
+{
+}
+
+void FClimbMockScene::AddBox(const FBox& Box)
+{
+	Boxes.Add(Box);
+
+	FVector Corners[8];
+	for (int32 Index = 0; Index < 8; Index++)
+	{
+		Corners[Index] = FVector((Index & 1) ? Box.Max.X : Box.Min.X, (Index & 2) ? Box.Max.Y : Box.Min.Y, (Index & 4) ? Box.Max.Z : Box.Min.Z);
+	}
+
+	//Two triangles per face
+	static const int32 Faces[6][4] = { { 0, 2, 6, 4 }, { 1, 5, 7, 3 }, { 0, 4, 5, 1 }, { 2, 3, 7, 6 }, { 0, 1, 3, 2 }, { 4, 6, 7, 5 } };
+	for (const int32* Face : Faces)
+	{
+		Vertices.Append({ Corners[Face[0]], Corners[Face[1]], Corners[Face[2]] });
+		Vertices.Append({ Corners[Face[0]], Corners[Face[2]], Corners[Face[3]] });
+	}
+}
+
+void FClimbMockScene::Build()
+{
+	TArray<uint8> Channels;
+	Channels.Init(0xFF, Vertices.Num() / 3);
+	BVH.Build(Vertices, Channels);
+	Reset();
+}
+
+void FClimbMockScene::Reset()
+{
+	for (FSlot& Slot : Slots)
+	{
+		Slot.bResolved = false;
+	}
+}
+
+FClimbSnapshot FClimbMockScene::TakeSnapshot(const FVector& Location, const FRotator& Rotation)
+{
+	const FRotationMatrix Matrix(Rotation);
+
+	FClimbSnapshot Snapshot;
+	Snapshot.Location = Location;
+	Snapshot.Rotation = Rotation;
+	Snapshot.Forward = Matrix.GetScaledAxis(EAxis::X);
+	Snapshot.Right = Matrix.GetScaledAxis(EAxis::Y);
+	Snapshot.Up = Matrix.GetScaledAxis(EAxis::Z);
+	Snapshot.Head = Location + FVector(0.0f, 0.0f, EyeHeight);
+	Snapshot.Feet = Snapshot.Location - (Snapshot.Head - Snapshot.Location);
+	return Snapshot;
+}
+
+void FClimbMockScene::AddLine(EClimbProbe Probe, const FVector& Start, const FVector& End, int8 Intent)
+{
+	AddCapsule(Probe, Start, End, 0.0f, 0.0f, Intent);
+}
+
+void FClimbMockScene::AddCapsule(EClimbProbe Probe, const FVector& Start, const FVector& End, float Radius, float HalfHeight, int8 Intent)
+{
+	FSlot& Slot = Slots[(int32)Probe];
+	Slot.Start = Start;
+	Slot.End = End;
+	Slot.Radius = Radius;
+	Slot.HalfHeight = HalfHeight;
+	Slot.bResolved = false;
+}
+
+bool FClimbMockScene::IsHit(EClimbProbe Probe)
+{
+	FSlot& Slot = Slots[(int32)Probe];
+	if (!Slot.bResolved)
+	{
+		Slot.Hit = FClimbQueryHit();
+		Slot.bHit = (Slot.Radius > 0.0f)
+			? BVH.SweepCapsule(Slot.Start, Slot.End, Slot.Radius, Slot.HalfHeight, 0xFF, Slot.Hit)
+			: BVH.Raycast(Slot.Start, Slot.End, 0xFF, Slot.Hit);
+		Slot.bResolved = true;
+		NumTraces++;
+	}
+	return Slot.bHit;
+}
+
+FClimbTraceHit FClimbMockScene::GetHit(EClimbProbe Probe) const
+{
+	const FSlot& Slot = Slots[(int32)Probe];
+
+	FClimbTraceHit Hit;
+	Hit.Location = Slot.Hit.Location;
+	Hit.Normal = Slot.Hit.Normal;
+	return Hit;
+}
@@ -0,0 +1,67 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ClimbDecisions.h"
+#include "ClimbTriangleBVH.h"
+
+/**
+ * Boxes in a triangle BVH standing in for a level, for driving FClimbDecisions without a world or physics scene.
+ *
+ * Probes are answered the first time they are asked about, like FClimbProbeBatch in sync mode, and every box face
+ * is climbable. Used by the Climb.Decisions automation tests and the ClimbDecisionBench commandlet.
+ */
+class FClimbMockScene : public IClimbTraceProvider
+{
+public:
+	/** Head above the capsule centre, the template character's camera */
+	static constexpr float EyeHeight = 64.0f;
+
+	FClimbMockScene();
+
+	/** Adds twelve triangles, call Build once every box is in */
+	void AddBox(const FBox& Box);
+	void Build();
+
+	const TArray<FBox>& GetBoxes() const { return Boxes; }
+	int32 NumTriangles() const { return BVH.NumTriangles(); }
+
+	/** Forgets every answer, the next step probes again */
+	void Reset();
+
+	uint64 GetNumTraces() const { return NumTraces; }
+
+	/** A climber's snapshot the way UClimbingMovementComponent takes it, with the head EyeHeight above Location */
+	static FClimbSnapshot TakeSnapshot(const FVector& Location, const FRotator& Rotation);
+
+	virtual void AddLine(EClimbProbe Probe, const FVector& Start, const FVector& End, int8 Intent) override;
+	virtual void AddCapsule(EClimbProbe Probe, const FVector& Start, const FVector& End, float Radius, float HalfHeight, int8 Intent) override;
+	virtual bool HasResult(EClimbProbe Probe, int8 Intent) const override { return true; }
+	virtual bool IsHit(EClimbProbe Probe) override;
+	virtual FClimbTraceHit GetHit(EClimbProbe Probe) const override;
+	virtual bool IsAsync() const override { return false; }
+
+private:
+	struct FSlot
+	{
+		FVector Start;
+		FVector End;
+		float Radius;
+		float HalfHeight;
+		FClimbQueryHit Hit;
+		bool bResolved;
+		bool bHit;
+
+		FSlot()
+			: Start(ForceInitToZero), End(ForceInitToZero), Radius(0.0f), HalfHeight(0.0f), bResolved(false), bHit(false)
+		{
+		}
+	};
+
+	TArray<FBox> Boxes;
+	TArray<FVector> Vertices;
+	FClimbTriangleBVH BVH;
+	FSlot Slots[(int32)EClimbProbe::Count];
+	uint64 NumTraces;
+};
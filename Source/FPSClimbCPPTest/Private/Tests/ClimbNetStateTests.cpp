@@ -0,0 +1,137 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ClimbingMovementComponent.h"
+#include "Misc/AutomationTest.h"
+#include "Serialization/BitReader.h"
+#include "Serialization/BitWriter.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace ClimbNetStateTests
+{
+	//Octahedral 8+8 bits, worst case over the sphere is a little under a degree
+	const float MaxNormalErrorDegrees = 1.0f;
+
+	//Half of 360 / 256
+	const float MaxLookErrorDegrees = 0.71f;
+
+	const float StepTime = 1.0f / 60.0f;
+
+	FClimbNetState RoundTrip(FAutomationTestBase& Test, const FClimbNetState& State)
+	{
+		bool bSuccess = false;
+		FBitWriter Writer(64, true);
+		FClimbNetState(State).NetSerialize(Writer, nullptr, bSuccess);
+		Test.TestTrue(TEXT("Writes"), bSuccess && !Writer.IsError());
+		Test.TestEqual(TEXT("Bits written"), (int32)Writer.GetNumBits(), State.GetNetBits());
+
+		FClimbNetState Read;
+		FBitReader Reader(Writer.GetData(), Writer.GetNumBits());
+		Read.NetSerialize(Reader, nullptr, bSuccess);
+		Test.TestTrue(TEXT("Reads"), bSuccess && !Reader.IsError());
+		Test.TestTrue(TEXT("Reads every bit"), Reader.AtEnd());
+		return Read;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FClimbNetStateNormalTest, "Climb.NetState.PackNormal", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FClimbNetStateNormalTest::RunTest(const FString& Parameters)
+{
+	//The axes, the fold at Z = 0, both hemispheres and the random rest
+	TArray<FVector> Normals = {
+		FVector::ForwardVector, -FVector::ForwardVector, FVector::RightVector, -FVector::RightVector, FVector::UpVector, -FVector::UpVector,
+		FVector(1.0f, 1.0f, 0.0f), FVector(-1.0f, 1.0f, 0.0f), FVector(0.3f, -0.7f, 0.2f), FVector(-0.3f, 0.7f, -0.2f), FVector(0.1f, 0.1f, -1.0f),
+	};
+	FRandomStream Stream(0);
+	for (int32 Index = 0; Index < 500; ++Index)
+	{
+		Normals.Add(Stream.GetUnitVector());
+	}
+
+	float MaxError = 0.0f;
+	for (const FVector& Normal : Normals)
+	{
+		const FVector Unit = Normal.GetSafeNormal();
+		const FVector Unpacked = FClimbNetState::UnpackNormal(FClimbNetState::PackNormal(Unit));
+		TestTrue(TEXT("Unit length"), FMath::IsNearlyEqual(Unpacked.Size(), 1.0f, KINDA_SMALL_NUMBER));
+		MaxError = FMath::Max(MaxError, FMath::RadiansToDegrees(FMath::Acos(FMath::Clamp(Unit | Unpacked, -1.0f, 1.0f))));
+	}
+	TestTrue(FString::Printf(TEXT("Worst normal error %.3f degrees"), MaxError), MaxError < ClimbNetStateTests::MaxNormalErrorDegrees);
+
+	//Packing what came out of the wire again changes nothing
+	const uint16 Packed = FClimbNetState::PackNormal(FVector(0.3f, -0.7f, 0.2f).GetSafeNormal());
+	TestEqual(TEXT("Stable"), FClimbNetState::PackNormal(FClimbNetState::UnpackNormal(Packed)), Packed);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FClimbNetStateLookTest, "Climb.NetState.PackLook", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FClimbNetStateLookTest::RunTest(const FString& Parameters)
+{
+	//Either side of the wrap and angles given past it
+	const FRotator Looks[] = {
+		FRotator::ZeroRotator, FRotator(45.0f, 90.0f, 0.0f), FRotator(-89.0f, -90.0f, 0.0f), FRotator(10.0f, 179.9f, 0.0f),
+		FRotator(-10.0f, -179.9f, 0.0f), FRotator(30.0f, 540.0f, 0.0f), FRotator(350.0f, -450.0f, 0.0f),
+	};
+
+	for (const FRotator& Look : Looks)
+	{
+		const FRotator Unpacked = FClimbNetState::UnpackLook(FClimbNetState::PackLook(Look));
+		TestTrue(FString::Printf(TEXT("Yaw %.1f"), Look.Yaw), FMath::Abs(FRotator::NormalizeAxis(Unpacked.Yaw - Look.Yaw)) < ClimbNetStateTests::MaxLookErrorDegrees);
+		TestTrue(FString::Printf(TEXT("Pitch %.1f"), Look.Pitch), FMath::Abs(FRotator::NormalizeAxis(Unpacked.Pitch - Look.Pitch)) < ClimbNetStateTests::MaxLookErrorDegrees);
+		TestTrue(TEXT("Normalized"), Unpacked.Yaw >= -180.0f && Unpacked.Yaw <= 180.0f && Unpacked.Pitch >= -180.0f && Unpacked.Pitch <= 180.0f);
+		TestEqual(TEXT("No roll"), Unpacked.Roll, 0.0f);
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FClimbNetStateSerializeTest, "Climb.NetState.NetSerialize", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FClimbNetStateSerializeTest::RunTest(const FString& Parameters)
+{
+	FClimbNetState OnWall;
+	OnWall.State = (uint8)EClimbState::Latched;
+	OnWall.PackedNormal = FClimbNetState::PackNormal(-FVector::ForwardVector);
+	OnWall.PackedLook = FClimbNetState::PackLook(FRotator(20.0f, -170.0f, 0.0f));
+	TestEqual(TEXT("Bits on a wall"), OnWall.GetNetBits(), 35);
+	TestTrue(TEXT("On a wall survives the wire"), ClimbNetStateTests::RoundTrip(*this, OnWall) == OnWall);
+
+	FClimbNetState Mantling = OnWall;
+	Mantling.State = (uint8)EClimbState::Mantling;
+	TestTrue(TEXT("Mantling survives the wire"), ClimbNetStateTests::RoundTrip(*this, Mantling) == Mantling);
+
+	//Off the wall the normal and look stay home and come back as zero
+	FClimbNetState Releasing = OnWall;
+	Releasing.State = (uint8)EClimbState::Releasing;
+	TestEqual(TEXT("Bits off a wall"), Releasing.GetNetBits(), 3);
+	const FClimbNetState Read = ClimbNetStateTests::RoundTrip(*this, Releasing);
+	TestEqual(TEXT("State"), Read.State, Releasing.State);
+	TestEqual(TEXT("No normal"), Read.PackedNormal, (uint16)0);
+	TestEqual(TEXT("No look"), Read.PackedLook, (uint16)0);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FClimbNetStateStepCarryTest, "Climb.NetState.PackStepCarry", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FClimbNetStateStepCarryTest::RunTest(const FString& Parameters)
+{
+	const float StepTime = ClimbNetStateTests::StepTime;
+	for (int32 Index = 0; Index <= 20; ++Index)
+	{
+		const float Carry = StepTime * Index / 20.0f;
+		const uint8 Packed = FClimbNetworkMoveData::PackStepCarry(Carry, StepTime);
+		const float Unpacked = FClimbNetworkMoveData::UnpackStepCarry(Packed, StepTime);
+		TestTrue(FString::Printf(TEXT("Carry %.5f"), Carry), FMath::Abs(Unpacked - Carry) <= StepTime / 510.0f + KINDA_SMALL_NUMBER);
+
+		//Client and server both start from the unpacked carry, packing it again has to give the same byte
+		TestEqual(TEXT("Stable"), FClimbNetworkMoveData::PackStepCarry(Unpacked, StepTime), Packed);
+	}
+
+	TestEqual(TEXT("Clamps below"), FClimbNetworkMoveData::PackStepCarry(-StepTime, StepTime), (uint8)0);
+	TestEqual(TEXT("Clamps above"), FClimbNetworkMoveData::PackStepCarry(3.0f * StepTime, StepTime), (uint8)255);
+	return true;
+}
+
+#endif //WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,170 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ClimbProbeRecorder.h"
+#include "ClimbTraceProvider.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/Paths.h"
+#include "HAL/FileManager.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace ClimbProbeRecorderTests
+{
+	//Start and frame tell records apart, the rest makes sure every field is copied
+	FClimbProbeRecord MakeRecord(uint32 Frame, int32 Index)
+	{
+		FClimbProbeRecord Record;
+		Record.Start = FVector(Index, 0.0f, 0.0f);
+		Record.End = FVector(Index, 100.0f, 0.0f);
+		Record.Extent = FVector(0.0f, 0.0f, 0.0f);
+		Record.HitLocation = FVector(Index, 50.0f, 0.0f);
+		Record.HitNormal = FVector(0.0f, -1.0f, 0.0f);
+		Record.Frame = Frame;
+		Record.Probe = (Index & 1) ? EClimbProbe::VerticalHead : EClimbProbe::VerticalBody;
+		Record.ShapeType = 0;
+		Record.Source = EClimbProbeSource::Cache;
+		Record.Flags = EClimbProbeRecordFlags::Hit | EClimbProbeRecordFlags::Async;
+		Record.Intent = (Index & 1) ? -1 : 1;
+		return Record;
+	}
+
+	bool IsSame(const FClimbProbeRecord& A, const FClimbProbeRecord& B)
+	{
+		return A.Start == B.Start && A.End == B.End && A.Extent == B.Extent && A.HitLocation == B.HitLocation && A.HitNormal == B.HitNormal
+			&& A.Frame == B.Frame && A.Probe == B.Probe && A.ShapeType == B.ShapeType && A.Source == B.Source && A.Flags == B.Flags && A.Intent == B.Intent;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FClimbProbeRecorderFillTest, "Climb.ProbeRecorder.Fill", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FClimbProbeRecorderFillTest::RunTest(const FString& Parameters)
+{
+	FClimbProbeRecorder Recorder(8);
+	TestEqual(TEXT("Capacity"), Recorder.GetCapacity(), 8);
+
+	TArray<FClimbProbeRecord> Records;
+	Recorder.GetRecords(Records);
+	TestEqual(TEXT("Empty"), Records.Num(), 0);
+
+	for (int32 Index = 0; Index < 5; Index++)
+	{
+		Recorder.Record(ClimbProbeRecorderTests::MakeRecord(Index, Index));
+	}
+
+	Recorder.GetRecords(Records);
+	if (TestEqual(TEXT("Every record while there is room"), Records.Num(), 5))
+	{
+		for (int32 Index = 0; Index < 5; Index++)
+		{
+			TestTrue(FString::Printf(TEXT("Record %d, oldest first"), Index), ClimbProbeRecorderTests::IsSame(Records[Index], ClimbProbeRecorderTests::MakeRecord(Index, Index)));
+		}
+	}
+
+	//Never smaller than one
+	TestEqual(TEXT("Capacity of at least one"), FClimbProbeRecorder(0).GetCapacity(), 1);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FClimbProbeRecorderWrapTest, "Climb.ProbeRecorder.Wrap", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FClimbProbeRecorderWrapTest::RunTest(const FString& Parameters)
+{
+	const int32 Capacity = 8;
+	const int32 NumRecords = 29;
+
+	FClimbProbeRecorder Recorder(Capacity);
+	for (int32 Index = 0; Index < NumRecords; Index++)
+	{
+		Recorder.Record(ClimbProbeRecorderTests::MakeRecord(Index, Index));
+	}
+
+	//A full ring gives up its oldest slot, the one a writer would be halfway through next
+	TArray<FClimbProbeRecord> Records;
+	Recorder.GetRecords(Records);
+	if (TestEqual(TEXT("All but the slot being written"), Records.Num(), Capacity - 1))
+	{
+		const int32 First = NumRecords - (Capacity - 1);
+		for (int32 Index = 0; Index < Records.Num(); Index++)
+		{
+			TestTrue(FString::Printf(TEXT("Record %d, oldest first"), First + Index), ClimbProbeRecorderTests::IsSame(Records[Index], ClimbProbeRecorderTests::MakeRecord(First + Index, First + Index)));
+		}
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FClimbProbeRecorderFramesTest, "Climb.ProbeRecorder.LastFrames", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FClimbProbeRecorderFramesTest::RunTest(const FString& Parameters)
+{
+	//Three probes a frame over frames 100 to 104
+	FClimbProbeRecorder Recorder(64);
+	for (int32 Index = 0; Index < 15; Index++)
+	{
+		Recorder.Record(ClimbProbeRecorderTests::MakeRecord(100 + Index / 3, Index));
+	}
+
+	TArray<FClimbProbeRecord> Records;
+	Recorder.GetRecords(Records, 2);
+	if (TestEqual(TEXT("Last two frames"), Records.Num(), 6))
+	{
+		TestEqual(TEXT("From frame 103"), Records[0].Frame, 103u);
+		TestEqual(TEXT("To frame 104"), Records.Last().Frame, 104u);
+	}
+
+	Recorder.GetRecords(Records, 1000);
+	TestEqual(TEXT("More frames than recorded"), Records.Num(), 15);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FClimbProbeDumpTest, "Climb.ProbeRecorder.Dump", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FClimbProbeDumpTest::RunTest(const FString& Parameters)
+{
+	FClimbProbeDump Dump;
+	Dump.MapName = TEXT("TestLevel");
+	Dump.Time = 12.5;
+	for (int32 Climber = 0; Climber < 2; Climber++)
+	{
+		FClimbProbeDump::FClimber& Entry = Dump.Climbers.AddDefaulted_GetRef();
+		Entry.Name = FString::Printf(TEXT("Climber%d"), Climber);
+		for (int32 Index = 0; Index < 4 + Climber; Index++)
+		{
+			Entry.Records.Add(ClimbProbeRecorderTests::MakeRecord(Index, Climber * 10 + Index));
+		}
+	}
+
+	const FString Filename = FPaths::AutomationTransientDir() / TEXT("ClimbProbes") / TEXT("Dump.climbprobes");
+	if (!TestTrue(TEXT("Saved"), Dump.Save(Filename)))
+	{
+		return false;
+	}
+
+	FClimbProbeDump Loaded;
+	const bool bLoaded = Loaded.Load(Filename);
+	IFileManager::Get().Delete(*Filename);
+	if (!TestTrue(TEXT("Loaded"), bLoaded))
+	{
+		return false;
+	}
+
+	TestEqual(TEXT("Map"), Loaded.MapName, Dump.MapName);
+	TestEqual(TEXT("Time"), Loaded.Time, Dump.Time);
+	if (TestEqual(TEXT("Climbers"), Loaded.Climbers.Num(), Dump.Climbers.Num()))
+	{
+		for (int32 Climber = 0; Climber < Dump.Climbers.Num(); Climber++)
+		{
+			TestEqual(TEXT("Name"), Loaded.Climbers[Climber].Name, Dump.Climbers[Climber].Name);
+			if (TestEqual(TEXT("Records"), Loaded.Climbers[Climber].Records.Num(), Dump.Climbers[Climber].Records.Num()))
+			{
+				for (int32 Index = 0; Index < Dump.Climbers[Climber].Records.Num(); Index++)
+				{
+					TestTrue(TEXT("Record survives the file"), ClimbProbeRecorderTests::IsSame(Loaded.Climbers[Climber].Records[Index], Dump.Climbers[Climber].Records[Index]));
+				}
+			}
+		}
+	}
+	return true;
+}
+
+#endif //WITH_DEV_AUTOMATION_TESTS
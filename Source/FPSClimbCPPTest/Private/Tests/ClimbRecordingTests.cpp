@@ -0,0 +1,144 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ClimbRecording.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/Paths.h"
+#include "HAL/FileManager.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace ClimbRecordingTests
+{
+	//Past two full chunks into a third
+	const int32 NumFrames = FClimbRecordingWriter::FramesPerChunk * 2 + 100;
+
+	//Frames in this range repeat the first of them, a player standing still across a chunk boundary
+	const int32 IdleBegin = FClimbRecordingWriter::FramesPerChunk - 20;
+	const int32 IdleEnd = FClimbRecordingWriter::FramesPerChunk + 20;
+
+	//What the file keeps, with room for float rounding
+	const float DeltaTimeTolerance = 1.0e-5f;
+	const float AxisTolerance = 1.0f / 127.0f;
+	const float LocationTolerance = 0.06f;
+	const float AngleTolerance = 360.0f / 65536.0f;
+
+	FClimbRecordedFrame MakeFrame(int32 Index)
+	{
+		if (Index >= IdleBegin && Index < IdleEnd)
+		{
+			Index = IdleBegin;
+		}
+
+		FClimbRecordedFrame Frame;
+		Frame.DeltaTime = 1.0f / 60.0f + (Index % 7) * 0.001f;
+		Frame.Forward = ((Index % 5) - 2) * 0.5f;
+		Frame.Right = FMath::Sin(Index * 0.1f);
+		Frame.Actions = (EClimbRecordedAction)(Index % 3);
+
+		//Yaw turning through the wrap both ways and pitch sweeping, whole turns past 360 included
+		Frame.ControlRotation = FRotator(-80.0f + (Index % 160), 170.0f + Index * 3.7f, 0.0f);
+		Frame.Rotation = FRotator(0.0f, -Index * 11.0f, (Index % 2) ? 179.9f : -179.9f);
+		Frame.CameraRotation = FRotator(FMath::Sin(Index * 0.05f) * 89.0f, 0.0f, 0.0f);
+
+		//Teleports between far corners of the map every 50 frames, big steps between them
+		Frame.Location = FVector(((Index / 50) % 2) ? 200000.0f + Index : -150000.0f - Index, -Index * 1000.0f, Index * 2.5f);
+
+		Frame.ClimbState = (uint8)((Index / 40) % 5);
+		Frame.MovementMode = (uint8)((Index / 60) % 7);
+		Frame.CustomMode = (uint8)((Index / 90) % 2);
+		return Frame;
+	}
+
+	bool IsNearlyEqual(const FRotator& A, const FRotator& B)
+	{
+		return FMath::Abs(FRotator::NormalizeAxis(A.Pitch - B.Pitch)) <= AngleTolerance
+			&& FMath::Abs(FRotator::NormalizeAxis(A.Yaw - B.Yaw)) <= AngleTolerance
+			&& FMath::Abs(FRotator::NormalizeAxis(A.Roll - B.Roll)) <= AngleTolerance;
+	}
+
+	bool IsNearlyEqual(const FClimbRecordedFrame& A, const FClimbRecordedFrame& B)
+	{
+		return FMath::IsNearlyEqual(A.DeltaTime, B.DeltaTime, DeltaTimeTolerance)
+			&& FMath::IsNearlyEqual(A.Forward, B.Forward, AxisTolerance)
+			&& FMath::IsNearlyEqual(A.Right, B.Right, AxisTolerance)
+			&& A.Actions == B.Actions
+			&& IsNearlyEqual(A.ControlRotation, B.ControlRotation)
+			&& A.Location.Equals(B.Location, LocationTolerance)
+			&& IsNearlyEqual(A.Rotation, B.Rotation)
+			&& IsNearlyEqual(A.CameraRotation, B.CameraRotation)
+			&& A.ClimbState == B.ClimbState && A.MovementMode == B.MovementMode && A.CustomMode == B.CustomMode;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FClimbRecordingRoundTripTest, "Climb.Recording.RoundTrip", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FClimbRecordingRoundTripTest::RunTest(const FString& Parameters)
+{
+	using namespace ClimbRecordingTests;
+
+	const FString Filename = FPaths::AutomationTransientDir() / TEXT("ClimbRecordings") / TEXT("RoundTrip.climbrec");
+
+	FClimbRecordingHeader Header;
+	Header.MapName = TEXT("ClimbTestMap");
+	Header.StartLocation = FVector(100.0f, -200.0f, 300.0f);
+	Header.StartRotation = FRotator(0.0f, 90.0f, 0.0f);
+	Header.StartControlRotation = FRotator(-10.0f, 90.0f, 0.0f);
+	Header.StartClimbState = 2;
+
+	{
+		FClimbRecordingWriter Writer;
+		if (!TestTrue(TEXT("Opens for writing"), Writer.Open(Filename, Header)))
+		{
+			return false;
+		}
+
+		for (int32 Index = 0; Index < NumFrames; Index++)
+		{
+			const int64 Bytes = Writer.GetNumBytes();
+			Writer.AddFrame(MakeFrame(Index));
+
+			//Standing still costs the mask byte and nothing else, away from the frames that end a chunk or start one from zero
+			const int32 InChunk = Index % FClimbRecordingWriter::FramesPerChunk;
+			if (Index > IdleBegin && Index < IdleEnd && InChunk != 0 && InChunk != FClimbRecordingWriter::FramesPerChunk - 1)
+			{
+				TestEqual(FString::Printf(TEXT("Frame %d unchanged is one byte"), Index), Writer.GetNumBytes() - Bytes, (int64)1);
+			}
+		}
+
+		TestEqual(TEXT("Frames written"), Writer.GetNumFrames(), NumFrames);
+		TestTrue(TEXT("Closes"), Writer.Close());
+	}
+
+	FClimbRecordingReader Reader;
+	if (!TestTrue(TEXT("Opens for reading"), Reader.Open(Filename)))
+	{
+		IFileManager::Get().Delete(*Filename);
+		return false;
+	}
+
+	TestEqual(TEXT("Map"), Reader.GetHeader().MapName, Header.MapName);
+	TestEqual(TEXT("Start location"), Reader.GetHeader().StartLocation, Header.StartLocation);
+	TestEqual(TEXT("Start rotation"), Reader.GetHeader().StartRotation, Header.StartRotation);
+	TestEqual(TEXT("Start control rotation"), Reader.GetHeader().StartControlRotation, Header.StartControlRotation);
+	TestEqual(TEXT("Start climb state"), Reader.GetHeader().StartClimbState, Header.StartClimbState);
+
+	//Stop at the first mismatch, every frame after it would fail the same way
+	int32 NumRead = 0;
+	FClimbRecordedFrame Frame;
+	while (Reader.Next(Frame))
+	{
+		if (NumRead >= NumFrames || !TestTrue(FString::Printf(TEXT("Frame %d survives the file"), NumRead), IsNearlyEqual(Frame, MakeFrame(NumRead))))
+		{
+			break;
+		}
+		NumRead++;
+	}
+	TestEqual(TEXT("Frames read"), NumRead, NumFrames);
+	TestFalse(TEXT("Nothing after the last frame"), Reader.Next(Frame));
+
+	IFileManager::Get().Delete(*Filename);
+	return true;
+}
+
+#endif //WITH_DEV_AUTOMATION_TESTS
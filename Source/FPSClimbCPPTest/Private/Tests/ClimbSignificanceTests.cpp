@@ -0,0 +1,82 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ClimbSignificanceSubsystem.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace ClimbSignificanceTests
+{
+	//climb.SignificanceReducedDistance and climb.SignificanceMinimalDistance defaults
+	const float ReducedDistance = 3000.0f;
+	const float MinimalDistance = 8000.0f;
+
+	EClimbLOD GetLOD(EClimbLOD Current, float Distance)
+	{
+		return UClimbSignificanceSubsystem::GetLOD(Current, Distance, ReducedDistance, MinimalDistance);
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FClimbSignificanceRoundTripTest, "Climb.Significance.ToFromSignificance", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FClimbSignificanceRoundTripTest::RunTest(const FString& Parameters)
+{
+	for (int32 Index = 0; Index < (int32)EClimbLOD::Count; ++Index)
+	{
+		const EClimbLOD LOD = (EClimbLOD)Index;
+		TestEqual(FString::Printf(TEXT("LOD %d round trip"), Index), (int32)UClimbSignificanceSubsystem::FromSignificance(UClimbSignificanceSubsystem::ToSignificance(LOD)), Index);
+	}
+
+	//The manager keeps the highest significance over all views, which has to be the most detailed tier
+	TestTrue(TEXT("Full above reduced"), UClimbSignificanceSubsystem::ToSignificance(EClimbLOD::Full) > UClimbSignificanceSubsystem::ToSignificance(EClimbLOD::Reduced));
+	TestTrue(TEXT("Reduced above minimal"), UClimbSignificanceSubsystem::ToSignificance(EClimbLOD::Reduced) > UClimbSignificanceSubsystem::ToSignificance(EClimbLOD::Minimal));
+
+	//Whatever comes back from the manager lands in a tier
+	TestEqual(TEXT("Above full"), (int32)UClimbSignificanceSubsystem::FromSignificance(10.0f), (int32)EClimbLOD::Full);
+	TestEqual(TEXT("Below minimal"), (int32)UClimbSignificanceSubsystem::FromSignificance(-10.0f), (int32)EClimbLOD::Minimal);
+	TestEqual(TEXT("Nearest tier"), (int32)UClimbSignificanceSubsystem::FromSignificance(1.2f), (int32)EClimbLOD::Reduced);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FClimbSignificanceHysteresisTest, "Climb.Significance.Hysteresis", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FClimbSignificanceHysteresisTest::RunTest(const FString& Parameters)
+{
+	using namespace ClimbSignificanceTests;
+
+	//Well inside each band every tier agrees
+	for (int32 Index = 0; Index < (int32)EClimbLOD::Count; ++Index)
+	{
+		const EClimbLOD Current = (EClimbLOD)Index;
+		TestEqual(TEXT("Near is full"), (int32)GetLOD(Current, 1000.0f), (int32)EClimbLOD::Full);
+		TestEqual(TEXT("Middle is reduced"), (int32)GetLOD(Current, 5000.0f), (int32)EClimbLOD::Reduced);
+		TestEqual(TEXT("Far is minimal"), (int32)GetLOD(Current, 20000.0f), (int32)EClimbLOD::Minimal);
+	}
+
+	//Just past the reduced boundary: a full climber stays full, a reduced one stays reduced
+	TestEqual(TEXT("Full holds just past reduced"), (int32)GetLOD(EClimbLOD::Full, ReducedDistance * 1.05f), (int32)EClimbLOD::Full);
+	TestEqual(TEXT("Full drops well past reduced"), (int32)GetLOD(EClimbLOD::Full, ReducedDistance * 1.15f), (int32)EClimbLOD::Reduced);
+	TestEqual(TEXT("Reduced holds just inside reduced"), (int32)GetLOD(EClimbLOD::Reduced, ReducedDistance * 0.95f), (int32)EClimbLOD::Reduced);
+	TestEqual(TEXT("Reduced comes back well inside reduced"), (int32)GetLOD(EClimbLOD::Reduced, ReducedDistance * 0.85f), (int32)EClimbLOD::Full);
+
+	//The same around the minimal boundary
+	TestEqual(TEXT("Reduced holds just past minimal"), (int32)GetLOD(EClimbLOD::Reduced, MinimalDistance * 1.05f), (int32)EClimbLOD::Reduced);
+	TestEqual(TEXT("Reduced drops well past minimal"), (int32)GetLOD(EClimbLOD::Reduced, MinimalDistance * 1.15f), (int32)EClimbLOD::Minimal);
+	TestEqual(TEXT("Minimal holds just inside minimal"), (int32)GetLOD(EClimbLOD::Minimal, MinimalDistance * 0.95f), (int32)EClimbLOD::Minimal);
+	TestEqual(TEXT("Minimal comes back well inside minimal"), (int32)GetLOD(EClimbLOD::Minimal, MinimalDistance * 0.85f), (int32)EClimbLOD::Reduced);
+
+	//A climber walking back and forth across a boundary by less than the band never changes tier
+	EClimbLOD LOD = EClimbLOD::Full;
+	int32 Changes = 0;
+	for (int32 Step = 0; Step < 100; ++Step)
+	{
+		const EClimbLOD NewLOD = GetLOD(LOD, ReducedDistance * ((Step & 1) ? 1.05f : 0.95f));
+		Changes += (NewLOD != LOD) ? 1 : 0;
+		LOD = NewLOD;
+	}
+	TestEqual(TEXT("No flipping at the boundary"), Changes, 0);
+	return true;
+}
+
+#endif //WITH_DEV_AUTOMATION_TESTS
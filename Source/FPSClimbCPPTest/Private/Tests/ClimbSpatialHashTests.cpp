@@ -0,0 +1,194 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ClimbSpatialHashSubsystem.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace ClimbSpatialHashTests
+{
+	//ClimbSpatialHash::CellSize
+	const float CellSize = 200.0f;
+
+	const float Radius = 50.0f;
+
+	bool Finds(const FClimbSpatialHash& Hash, const FVector& Location, const FVector& Neighbour, int32 IgnoreIndex = INDEX_NONE)
+	{
+		FClimbNeighbours Neighbours;
+		Hash.FindNeighbours(Location, Radius, IgnoreIndex, Neighbours);
+		return Neighbours.ContainsByPredicate([&Neighbour](const FClimbNeighbour& Found) { return Found.Location == Neighbour; });
+	}
+
+	int32 CountFound(const FClimbSpatialHash& Hash, const FVector& Location, float InRadius)
+	{
+		FClimbNeighbours Neighbours;
+		Hash.FindNeighbours(Location, InRadius, INDEX_NONE, Neighbours);
+		return Neighbours.Num();
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FClimbSpatialHashMoveTest, "Climb.SpatialHash.Move", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FClimbSpatialHashMoveTest::RunTest(const FString& Parameters)
+{
+	using namespace ClimbSpatialHashTests;
+
+	FClimbSpatialHash Hash;
+	const FVector Wall = -FVector::ForwardVector;
+
+	//Either side of a cell boundary, and of the origin where the cells round down
+	const FVector A(CellSize - 10.0f, 0.0f, 100.0f);
+	const FVector B(CellSize + 10.0f, 0.0f, 100.0f);
+	const int32 IndexA = Hash.Add(nullptr, nullptr, A, Wall);
+	const int32 IndexB = Hash.Add(nullptr, nullptr, B, Wall);
+	TestEqual(TEXT("Two climbers"), Hash.GetNumClimbers(), 2);
+	TestNotEqual(TEXT("Cells differ"), FClimbSpatialHash::GetCell(A), FClimbSpatialHash::GetCell(B));
+	TestEqual(TEXT("Below zero rounds down"), FClimbSpatialHash::GetCell(FVector(-10.0f, 0.0f, 0.0f)).X, -1);
+
+	TestTrue(TEXT("Found across the cell boundary"), Finds(Hash, A, B));
+	TestTrue(TEXT("Found from the other side"), Finds(Hash, B, A));
+	TestFalse(TEXT("Ignores the one asking"), Finds(Hash, A, A, IndexA));
+	TestEqual(TEXT("Outside the radius"), CountFound(Hash, FVector(0.0f, 0.0f, 1000.0f), Radius), 0);
+
+	//Within the cell
+	const FVector A2 = A + FVector(0.0f, 20.0f, 0.0f);
+	Hash.Move(IndexA, A2, Wall);
+	TestTrue(TEXT("Moved within its cell"), Finds(Hash, A2, A2));
+	TestFalse(TEXT("Not where it was"), Finds(Hash, A2, A));
+
+	//Into another cell, several cells away, across the origin
+	const FVector A3(-3.5f * CellSize, -CellSize, -2.5f * CellSize);
+	Hash.Move(IndexA, A3, Wall);
+	TestTrue(TEXT("Moved to another cell"), Finds(Hash, A3, A3));
+	TestEqual(TEXT("Nothing left in the old cell"), CountFound(Hash, A2, 1.0f), 0);
+	TestTrue(TEXT("The neighbour it left is still linked"), Finds(Hash, B, B));
+	TestFalse(TEXT("No longer next to it"), Finds(Hash, B, A3));
+
+	//Back again, a climber shuffling over a boundary relinks every time
+	for (int32 Step = 0; Step < 10; Step++)
+	{
+		const FVector Location = (Step & 1) ? B - FVector(20.0f, 0.0f, 0.0f) : B + FVector(20.0f, 0.0f, 0.0f);
+		Hash.Move(IndexB, Location, Wall);
+		TestEqual(FString::Printf(TEXT("Step %d found once"), Step), CountFound(Hash, Location, 1.0f), 1);
+	}
+
+	TestEqual(TEXT("Moves never add"), Hash.GetNumClimbers(), 2);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FClimbSpatialHashFreeListTest, "Climb.SpatialHash.FreeList", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FClimbSpatialHashFreeListTest::RunTest(const FString& Parameters)
+{
+	using namespace ClimbSpatialHashTests;
+
+	FClimbSpatialHash Hash;
+	const FVector Wall = -FVector::ForwardVector;
+
+	//All in one cell, so they share a bucket list
+	TArray<int32> Indices;
+	for (int32 Index = 0; Index < 4; Index++)
+	{
+		Indices.Add(Hash.Add(nullptr, nullptr, FVector(10.0f * Index, 0.0f, 0.0f), Wall));
+	}
+	TestEqual(TEXT("Four climbers"), Hash.GetNumClimbers(), 4);
+	TestEqual(TEXT("All in one cell"), CountFound(Hash, FVector::ZeroVector, Radius), 4);
+
+	//The middle of the list, then its head
+	Hash.Remove(Indices[1]);
+	Hash.Remove(Indices[3]);
+	TestEqual(TEXT("Two left"), Hash.GetNumClimbers(), 2);
+	TestEqual(TEXT("Two found"), CountFound(Hash, FVector::ZeroVector, Radius), 2);
+	TestFalse(TEXT("Removed is gone"), Finds(Hash, FVector::ZeroVector, FVector(10.0f, 0.0f, 0.0f)));
+	TestTrue(TEXT("Kept is still there"), Finds(Hash, FVector::ZeroVector, FVector(20.0f, 0.0f, 0.0f)));
+
+	//Removing or moving a freed entry does nothing
+	Hash.Remove(Indices[1]);
+	Hash.Move(Indices[3], FVector::ZeroVector, Wall);
+	Hash.Remove(1000);
+	TestEqual(TEXT("Still two left"), Hash.GetNumClimbers(), 2);
+	TestEqual(TEXT("Still two found"), CountFound(Hash, FVector::ZeroVector, Radius), 2);
+
+	//Last freed is first reused, and nothing grows while there is a free entry
+	const int32 Reused = Hash.Add(nullptr, nullptr, FVector(0.0f, 30.0f, 0.0f), Wall);
+	TestEqual(TEXT("Reuses the last freed"), Reused, Indices[3]);
+	TestEqual(TEXT("Then the one before"), Hash.Add(nullptr, nullptr, FVector(0.0f, 40.0f, 0.0f), Wall), Indices[1]);
+	TestEqual(TEXT("Then grows"), Hash.Add(nullptr, nullptr, FVector(0.0f, -30.0f, 0.0f), Wall), 4);
+	TestEqual(TEXT("Five climbers"), Hash.GetNumClimbers(), 5);
+	TestEqual(TEXT("Five found"), CountFound(Hash, FVector::ZeroVector, Radius), 5);
+	TestTrue(TEXT("Reused entry is linked"), Finds(Hash, FVector::ZeroVector, FVector(0.0f, 30.0f, 0.0f)));
+
+	Hash.Reset();
+	TestEqual(TEXT("Reset empties"), Hash.GetNumClimbers(), 0);
+	TestEqual(TEXT("Reset finds nothing"), CountFound(Hash, FVector::ZeroVector, Radius), 0);
+	TestEqual(TEXT("Reset starts over"), Hash.Add(nullptr, nullptr, FVector::ZeroVector, Wall), 0);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FClimbSpatialHashCollisionTest, "Climb.SpatialHash.BucketCollision", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FClimbSpatialHashCollisionTest::RunTest(const FString& Parameters)
+{
+	using namespace ClimbSpatialHashTests;
+
+	//More cells in a 12x12x12 block than there are buckets, two of them have to share one
+	FIntVector CellA;
+	FIntVector CellB;
+	bool bFound = false;
+	TMap<int32, FIntVector> Seen;
+	for (int32 Index = 0; Index < 12 * 12 * 12 && !bFound; Index++)
+	{
+		const FIntVector Cell(Index % 12, (Index / 12) % 12, Index / 144);
+		const int32 Bucket = FClimbSpatialHash::GetBucket(Cell);
+		if (const FIntVector* Other = Seen.Find(Bucket))
+		{
+			CellA = *Other;
+			CellB = Cell;
+			bFound = true;
+		}
+		else
+		{
+			Seen.Add(Bucket, Cell);
+		}
+	}
+	if (!TestTrue(TEXT("Two cells share a bucket"), bFound))
+	{
+		return false;
+	}
+
+	FClimbSpatialHash Hash;
+	const FVector Wall = -FVector::ForwardVector;
+	const FVector A = (FVector(CellA) + 0.5f) * CellSize;
+	const FVector B = (FVector(CellB) + 0.5f) * CellSize;
+	const FVector C = A + FVector(0.0f, 0.0f, 20.0f);
+	const int32 IndexA = Hash.Add(nullptr, nullptr, A, Wall);
+	const int32 IndexB = Hash.Add(nullptr, nullptr, B, Wall);
+	const int32 IndexC = Hash.Add(nullptr, nullptr, C, Wall);
+
+	//A radius that reaches both cells only finds each climber once, the bucket is walked for each cell
+	const float AllRadius = FVector::Dist(A, B) * 0.5f + Radius;
+	TestEqual(TEXT("Each climber once"), CountFound(Hash, (A + B) * 0.5f, AllRadius), 3);
+
+	TestEqual(TEXT("Only A's cell near A"), CountFound(Hash, A, Radius), 2);
+	TestEqual(TEXT("Only B's cell near B"), CountFound(Hash, B, Radius), 1);
+
+	//Unlinking from a shared bucket leaves the other cell's climbers alone
+	Hash.Remove(IndexC);
+	TestTrue(TEXT("B after removing from the shared bucket"), Finds(Hash, B, B));
+	TestTrue(TEXT("A after removing from the shared bucket"), Finds(Hash, A, A));
+
+	//Moving between cells of the same bucket relinks into the same list
+	Hash.Move(IndexA, B + FVector(0.0f, 0.0f, 20.0f), Wall);
+	TestEqual(TEXT("Both near B"), CountFound(Hash, B, Radius), 2);
+	TestEqual(TEXT("None near A"), CountFound(Hash, A, Radius), 0);
+
+	Hash.Remove(IndexB);
+	TestEqual(TEXT("A alone near B"), CountFound(Hash, B, Radius), 1);
+	Hash.Remove(IndexA);
+	TestEqual(TEXT("Empty"), CountFound(Hash, B, Radius), 0);
+	TestEqual(TEXT("No climbers"), Hash.GetNumClimbers(), 0);
+	return true;
+}
+
+#endif //WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,37 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "ClimbBenchCommandlet.generated.h"
+
+/**
+ * Runs a map headless with a crowd of AEngiPC bots and reports what climbing costs.
+ *
+ * UE4Editor-Cmd FPSClimbCPPTest -run=ClimbBench -nullrhi -Map=/Game/TestLevel [-Climbers=32] [-Frames=1800]
+ *     [-Warmup=60] [-Seed=0] [-Script=Input.txt] [-Output=Saved/ClimbBench.json] [-CountAllocs] [-MaxAllocs=0]
+ *
+ * Bots are driven through the bindings AEngiPC sets up in SetupPlayerInputComponent (Jump, MoveForward,
+ * MoveRight, SpecialAction), either from random input or from a script shared by every bot. A script line
+ * is "<frame> <binding> <value>", actions press on 1 and release on 0, axes hold their value until the next line.
+ *
+ * Bots start at the player starts of a map with more than one, such as those ClimbStressMap generates.
+ *
+ * The report has game thread ms per frame (mean, p50, p99, max), traces per frame, the share of wall probes the contact
+ * cache answered and latch/release counts, as JSON.
+ * -CountAllocs adds the heap allocations made inside climbing's per-frame code after warmup (see FClimbAllocCounter),
+ * and -MaxAllocs fails the run when there are more than that, so a scripted run with -MaxAllocs=0 guards the hot path.
+ * Both need -ClimbCountAllocs as well, which installs the counter when the module starts. The Climb.Memory automation
+ * test runs a 10k-frame scripted climb this way, and the Climb.Bench automation test runs TestLevel with random input.
+ */
+UCLASS()
+class FPSCLIMBCPPTEST_API UClimbBenchCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UClimbBenchCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,71 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineTypes.h"
+#include "ClimbTraceProvider.h"
+
+/**
+ * Remembers the last body/head wall hits of a latched climber.
+ * A climber moves a couple of centimetres a step, so a cached hit is not keyed on the exact segment: while the
+ * probe keeps its length and direction and has slid no more than climb.ContactCacheTolerance from where it was
+ * traced, it is answered by moving the hit along the plane of the wall it landed on. The intent has to be
+ * unchanged, the climber must not have turned, the hit component must not have moved and the hit must be younger
+ * than climb.ContactCacheMaxAge frames. Hits on the baked triangles have no component, they are static and cached too.
+ */
+class FPSCLIMBCPPTEST_API FClimbContactCache
+{
+public:
+	FClimbContactCache();
+
+	/** Only the body/head wall probes are worth caching, everything else changes every step */
+	static bool IsCacheable(EClimbProbe Probe);
+
+	/** Returns true and fills OutHit, moved onto Start-End, if the cached hit for this probe is still good from ActorTransform */
+	bool Find(EClimbProbe Probe, int8 Intent, const FVector& Start, const FVector& End, const FTransform& ActorTransform, FHitResult& OutHit);
+
+	/**
+	 * Records a blocking hit traced along Start-End from ActorTransform, misses just clear the entry.
+	 * ComponentTransform is where the hit component was, a hit without a component is a baked triangle's
+	 */
+	void Store(EClimbProbe Probe, int8 Intent, const FVector& Start, const FVector& End, const FTransform& ActorTransform, bool bHit, const FHitResult& Hit, const FTransform& ComponentTransform);
+
+	/**
+	 * Game thread: drops contacts on components that moved since they were traced. Until EndComponentCheck, Find takes
+	 * the rest as they are and reads no component, so the cache can be used from a worker thread
+	 */
+	void CheckComponents();
+	void EndComponentCheck() { bComponentsChecked = false; }
+
+	/** Forgets every contact */
+	void Invalidate();
+
+	uint32 GetHitCount() const { return HitCount; }
+	uint32 GetMissCount() const { return MissCount; }
+	void ResetCounters();
+
+private:
+	struct FContact
+	{
+		FHitResult Hit;
+		//Segment the hit was traced along, the probes move it with the input and with what the step sweep hit
+		FVector Start;
+		FVector End;
+		FTransform ActorTransform;
+		FTransform ComponentTransform;
+		//GFrameCounter when traced
+		uint64 Frame;
+		int8 Intent;
+		//From the baked triangles, nothing can move it
+		bool bStatic;
+		bool bValid;
+	};
+
+	FContact Contacts[(int32)EClimbProbe::Count];
+
+	bool bComponentsChecked;
+
+	uint32 HitCount;
+	uint32 MissCount;
+};
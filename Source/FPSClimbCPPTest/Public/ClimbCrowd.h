@@ -0,0 +1,118 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "ClimbCrowdSimulation.h"
+#include "ClimbCrowd.generated.h"
+
+class ACharacter;
+class UInstancedStaticMeshComponent;
+class UClimbSurfaceGraph;
+
+/**
+ * Hundreds of AI climbers in one actor.
+ *
+ * Far climbers live in FClimbCrowdSimulation and are drawn as mesh instances. A climber that
+ * comes within PromoteDistance of a player is handed to a full ProxyClass character, which
+ * climbs with UClimbingMovementComponent and is fed the same input. Once every player is past
+ * DemoteDistance again the character goes back into the crowd.
+ *
+ * Needs the level's baked climb graph, see UClimbGraphBakeCommandlet.
+ */
+UCLASS()
+class FPSCLIMBCPPTEST_API AClimbCrowd : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	AClimbCrowd();
+
+	virtual void Tick(float DeltaTime) override;
+
+	/** One instance per climber */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Climb Crowd")
+		UInstancedStaticMeshComponent* Instances;
+
+	/** Climbers scattered over the level's walls on BeginPlay */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Climb Crowd", meta = (ClampMin = "0", UIMin = "0"))
+		int32 InitialClimbers;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Climb Crowd")
+		int32 Seed;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Climb Crowd", meta = (ClampMin = "0", UIMin = "0"))
+		float ClimbSpeed;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Climb Crowd", meta = (ClampMin = "0", UIMin = "0"))
+		float WallOffset;
+
+	/** Climbers per parallel task */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Climb Crowd", meta = (ClampMin = "1", UIMin = "1"))
+		int32 BatchSize;
+
+	/** Character spawned for a climber near a player, needs a UClimbingMovementComponent */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Climb Crowd|Promotion")
+		TSubclassOf<ACharacter> ProxyClass;
+
+	/** Climbers closer than this to a player become full characters, 0 never promotes */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Climb Crowd|Promotion", meta = (ClampMin = "0", UIMin = "0"))
+		float PromoteDistance;
+
+	/** Characters farther than this from every player go back into the crowd, keep it above PromoteDistance */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Climb Crowd|Promotion", meta = (ClampMin = "0", UIMin = "0"))
+		float DemoteDistance;
+
+	/** Seconds between promotion checks */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Climb Crowd|Promotion", meta = (ClampMin = "0", UIMin = "0"))
+		float PromoteInterval;
+
+	/** Most characters alive at once */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Climb Crowd|Promotion", meta = (ClampMin = "0", UIMin = "0"))
+		int32 MaxProxies;
+
+	/** Adds a climber on the wall in front of Location. Returns its index, or INDEX_NONE if there is no baked wall there */
+	UFUNCTION(BlueprintCallable, Category = "Climb Crowd")
+		int32 AddClimber(const FVector& Location, const FVector& Facing, FVector2D Input);
+
+	/** Indices change when a climber is removed, the last climber takes its place */
+	UFUNCTION(BlueprintCallable, Category = "Climb Crowd")
+		void SetClimberInput(int32 Index, FVector2D Input);
+
+	UFUNCTION(BlueprintPure, Category = "Climb Crowd")
+		int32 GetNumClimbers() const { return Simulation.Num(); }
+
+	const FClimbCrowdSimulation& GetSimulation() const { return Simulation; }
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/** Drops climbers on random patches of the graph */
+	void Scatter(int32 Count);
+
+	void RemoveClimber(int32 Index);
+
+	/** Swaps climbers between the crowd and full characters depending on how close players are */
+	void UpdatePromotion();
+	void Promote(int32 Index);
+	void Demote(int32 Index);
+
+	/** Copies the simulation into the mesh instances */
+	void UpdateInstances();
+
+	UPROPERTY(Transient)
+		UClimbSurfaceGraph* SurfaceGraph;
+
+	FClimbCrowdSimulation Simulation;
+
+	/** Character standing in for each climber, parallel to the simulation arrays */
+	TArray<TWeakObjectPtr<ACharacter>> Proxies;
+
+	/** Instance transforms, rebuilt every tick */
+	TArray<FTransform> InstanceTransforms;
+
+	float PromoteTimer;
+	int32 NumProxies;
+};
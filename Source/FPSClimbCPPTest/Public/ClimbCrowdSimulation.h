@@ -0,0 +1,80 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UClimbSurfaceGraph;
+
+//Per-climber flags, stored as bits in FClimbCrowdSimulation::Flags
+enum class EClimbCrowdFlags : uint8
+{
+	None = 0,
+	/** On a wall and moving along it */
+	Latched = 1 << 0,
+	/** A full character is climbing for this entry, the simulation leaves it alone */
+	Promoted = 1 << 1,
+	/** Went over a ledge this update */
+	Mantled = 1 << 2,
+};
+ENUM_CLASS_FLAGS(EClimbCrowdFlags);
+
+/**
+ * Climbing for many AI climbers without an actor each.
+ *
+ * Every climber is one index into the arrays below (structure of arrays), so an update walks
+ * tightly packed positions and inputs instead of chasing actors and components. Climbers move on
+ * the patches of a baked UClimbSurfaceGraph, which is read only, so the update runs in parallel
+ * batches with no traces. Removing a climber swaps the last one into its index.
+ */
+class FPSCLIMBCPPTEST_API FClimbCrowdSimulation
+{
+public:
+	FClimbCrowdSimulation();
+
+	/** Capsule centre on the wall */
+	TArray<FVector> Positions;
+
+	/** Normal of the wall each climber is on */
+	TArray<FVector> WallNormals;
+
+	/** X is up/down, Y is left/right along the wall, -1 to 1 */
+	TArray<FVector2D> Inputs;
+
+	/** Graph patch each climber is on, INDEX_NONE when not on a wall */
+	TArray<int32> Patches;
+
+	TArray<EClimbCrowdFlags> Flags;
+
+	/** Climbing speed in cm/s */
+	float ClimbSpeed;
+
+	/** Distance kept between the capsule centre and the wall */
+	float WallOffset;
+
+	/** Climbers per ParallelFor task */
+	int32 BatchSize;
+
+	/** Climbers reverse their input at the end of a wall instead of stopping */
+	bool bWander;
+
+	int32 Num() const { return Positions.Num(); }
+
+	/** Latches a new climber onto a patch. Returns its index */
+	int32 Add(const UClimbSurfaceGraph& Graph, int32 Patch, const FVector& Location, const FVector2D& Input);
+
+	/** Puts an existing climber on a patch, as close to Location as the patch allows */
+	void Latch(const UClimbSurfaceGraph& Graph, int32 Index, int32 Patch, const FVector& Location);
+
+	/** Moves the last climber into Index */
+	void RemoveAtSwap(int32 Index);
+
+	void Reset();
+
+	/** Moves every latched, non-promoted climber along its wall for DeltaTime */
+	void Update(const UClimbSurfaceGraph& Graph, float DeltaTime);
+
+private:
+	/** One climber's step, touches nothing but its own index */
+	void UpdateClimber(const UClimbSurfaceGraph& Graph, int32 Index, float DeltaTime);
+};
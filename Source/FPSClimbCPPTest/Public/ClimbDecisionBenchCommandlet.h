@@ -0,0 +1,29 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "ClimbDecisionBenchCommandlet.generated.h"
+
+/**
+ * Times FClimbDecisions on its own against a mock scene, no map, world or physics scene is loaded.
+ *
+ * UE4Editor-Cmd FPSClimbCPPTest -run=ClimbDecisionBench -nullrhi [-Decisions=200000] [-Seed=0] [-MinRate=0]
+ *     [-Output=Saved/ClimbDecisionBench.json]
+ *
+ * The scene is a field of random boxes in a triangle BVH. Climbers grab a box, then step with random input,
+ * wrapping round the corners they reach, until they mantle or let go and grab again. Reports decisions per
+ * second, traces per decision and a checksum of where the climbers ended up as JSON, and fails below MinRate
+ * decisions per second.
+ */
+UCLASS()
+class FPSCLIMBCPPTEST_API UClimbDecisionBenchCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UClimbDecisionBenchCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,86 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineBaseTypes.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ClimbEvaluateSubsystem.generated.h"
+
+class UClimbingMovementComponent;
+class UClimbEvaluateSubsystem;
+
+//Runs the evaluate phase, every climbing movement tick waits for it
+USTRUCT()
+struct FClimbEvaluateTickFunction : public FTickFunction
+{
+	GENERATED_BODY()
+
+	UClimbEvaluateSubsystem* Target;
+
+	FClimbEvaluateTickFunction()
+		: Target(nullptr)
+	{
+	}
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+};
+
+template<>
+struct TStructOpsTypeTraits<FClimbEvaluateTickFunction> : public TStructOpsTypeTraitsBase2<FClimbEvaluateTickFunction>
+{
+	enum
+	{
+		WithCopy = false,
+	};
+};
+
+/**
+ * Splits climbing into an evaluate and an apply phase.
+ *
+ * Evaluate runs once a frame in TG_PrePhysics, ahead of every climbing movement tick, and works out
+ * the first climbing step of every latched climber in a ParallelFor. That step is all scene queries
+ * and reads, and each climber's probe batch and contact cache are only touched by its own task.
+ * The tasks read no UObjects besides the physics scene: the climber's pose and settings and the
+ * transforms, proxies and surfaces of the walls its probes hit last frame are copied on the game
+ * thread first. A probe that lands on anything else throws the climber's plan away.
+ * Apply is each climber's own movement tick, serial as before, which moves the capsule, sets the
+ * rotations and changes state from the plan it was handed.
+ *
+ * A plan is only used if the climber still stands where it was evaluated with the same input, so
+ * anything that moves it in between (input that arrived late, a correction) falls back to the
+ * serial step. Remote players on a server have already run this frame's moves when their RPCs
+ * came in, theirs is prepared for the first move of the next frame. Async probe batches are left
+ * to the serial step.
+ */
+UCLASS()
+class FPSCLIMBCPPTEST_API UClimbEvaluateSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Deinitialize() override;
+
+	/** The climber's movement tick waits for the evaluate phase from now on */
+	void RegisterClimber(UClimbingMovementComponent* Climber);
+	void UnregisterClimber(UClimbingMovementComponent* Climber);
+
+	/** Sets input for climbers before they are evaluated, like AClimbCrowd or a player controller */
+	void AddInputSource(AActor* Source);
+
+	/** Evaluate phase, called by the tick function */
+	void Evaluate();
+
+private:
+	void RegisterEvaluateTick();
+
+	FClimbEvaluateTickFunction EvaluateTick;
+
+	UPROPERTY(Transient)
+		TArray<UClimbingMovementComponent*> Climbers;
+
+	/** Scratch, climbers evaluated this frame */
+	TArray<UClimbingMovementComponent*> Candidates;
+};
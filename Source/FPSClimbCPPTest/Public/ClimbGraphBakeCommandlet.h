@@ -0,0 +1,28 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "ClimbGraphBakeCommandlet.generated.h"
+
+/**
+ * Bakes the climbable walls, ledges and corners of a map into a UClimbSurfaceGraph next to it,
+ * along with the simple collision triangles of its static geometry for climb.TriangleProbes.
+ * Meshes with a climb proxy (UClimbProxyCommandlet) are baked from the proxy for wall probes.
+ *
+ * UE4Editor-Cmd FPSClimbCPPTest -run=ClimbGraphBake -Map=/Game/TestLevel [-Full] [-CellSize=200]
+ *
+ * Only actors whose transform or collision changed since the last bake are baked again, -Full rebuilds everything.
+ * Whether there is room to stand on top of a ledge is checked again for every ledge on every bake.
+ */
+UCLASS()
+class FPSCLIMBCPPTEST_API UClimbGraphBakeCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UClimbGraphBakeCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,33 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UInputComponent;
+class UWorld;
+
+/**
+ * What the commandlets that play a map without a player (ClimbBench, ClimbReplay) share: loading the map as a
+ * game world and feeding a character's input bindings directly.
+ */
+namespace ClimbHeadless
+{
+	/** Loads MapName and runs it as a game world without a game mode, actors get BeginPlay straight from the world settings. Null if it would not load */
+	FPSCLIMBCPPTEST_API UWorld* LoadGameWorld(const FString& MapName);
+
+	/** Tears down a world from LoadGameWorld */
+	FPSCLIMBCPPTEST_API void DestroyGameWorld(UWorld* World);
+
+	/** Calls whatever the character bound to an axis, the same way a player controller would */
+	FPSCLIMBCPPTEST_API void SetAxis(UInputComponent* Input, FName Axis, float Value);
+
+	/** Fires the pressed or released bindings of an action */
+	FPSCLIMBCPPTEST_API void SetAction(UInputComponent* Input, FName Action, bool bPressed);
+
+	/** Is anything bound to the action */
+	FPSCLIMBCPPTEST_API bool IsAction(UInputComponent* Input, FName Action);
+
+	/** Of an ascending array, 0 if it is empty */
+	FPSCLIMBCPPTEST_API float Percentile(const TArray<double>& Sorted, float Fraction);
+}
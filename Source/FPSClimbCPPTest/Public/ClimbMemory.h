@@ -0,0 +1,56 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/LowLevelMemTracker.h"
+
+#if ENABLE_LOW_LEVEL_MEM_TRACKER
+//Climbing's own line in "stat LLM" and -llmcsv captures, registered when the module starts
+#define LLM_TAG_CLIMBING ((ELLMTag)((int32)ELLMTag::ProjectTagStart + 0))
+#endif
+
+/**
+ * Counts the heap allocations made inside FClimbAllocScopes, on any thread.
+ *
+ * Counting needs GMalloc wrapped in a proxy. Like the engine's own malloc proxies (-stompmalloc, -poisonproxy) it
+ * is put in place once, at startup, behind a command line switch: -ClimbCountAllocs, read when the module starts.
+ * Without it a scope costs a thread local bool and Start() does nothing. Once installed the proxy stays for the
+ * life of the process.
+ *
+ * The engine's proxies go in before any other thread exists, a game module starts later than that, with the task
+ * graph and loading threads already running. So the swap is a single compare-exchange of GMalloc, done at most
+ * once, and the proxy owns no memory: it forwards every call to the allocator it wrapped. A thread that read
+ * GMalloc just before the swap finishes its call on that allocator, which is the same one, and memory freed through
+ * either ends up in the same place. The cost is that allocations racing the swap are not counted, and since no
+ * world exists yet when the module starts, none of them are climbing's. Something else wrapping GMalloc at the same
+ * moment is wrapped in turn rather than overwritten.
+ */
+class FPSCLIMBCPPTEST_API FClimbAllocCounter
+{
+public:
+	/** Wraps GMalloc if -ClimbCountAllocs is on the command line. Called once when the module starts */
+	static void InstallIfRequested();
+	static bool IsInstalled();
+
+	/** Counts from zero. False, and nothing is counted, if the proxy was not installed at startup */
+	static bool Start();
+	static void Stop();
+
+	static bool IsCounting();
+	static uint64 GetCount();
+};
+
+//Allocations in here are the climbing hot path's, bCount = false exempts one-off work like state changes
+class FPSCLIMBCPPTEST_API FClimbAllocScope
+{
+public:
+	explicit FClimbAllocScope(bool bCount = true);
+	~FClimbAllocScope();
+
+private:
+	bool bWasCounted;
+};
+
+//Climbing memory for LLM and the allocation counter, at the top of every per-frame climbing entry point
+#define CLIMB_MEMORY_SCOPE() LLM_SCOPE(LLM_TAG_CLIMBING); FClimbAllocScope ClimbAllocScope
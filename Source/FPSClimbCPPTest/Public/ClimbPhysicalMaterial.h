@@ -0,0 +1,40 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PhysicalMaterials/PhysicalMaterial.h"
+#include "ClimbTraceProvider.h"
+#include "ClimbPhysicalMaterial.generated.h"
+
+/**
+ * Physical material with climbing settings.
+ * Surfaces using a plain UPhysicalMaterial climb with the defaults.
+ */
+UCLASS()
+class FPSCLIMBCPPTEST_API UClimbPhysicalMaterial : public UPhysicalMaterial
+{
+	GENERATED_BODY()
+
+public:
+	UClimbPhysicalMaterial();
+
+	/** Can this surface be climbed at all */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Climbing)
+		bool bClimbable;
+
+	/** Multiplier on the climber's max climb speed */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Climbing, meta = (ClampMin = "0", UIMin = "0", EditCondition = "bClimbable"))
+		float ClimbSpeedScale;
+
+	/** Multiplier on the tilt a climber can hold before falling off, below 1 is slippery */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Climbing, meta = (ClampMin = "0", UIMin = "0", EditCondition = "bClimbable"))
+		float Grip;
+
+	/** Re-trace this surface against its render triangles. Only for meshes whose simple collision is too coarse to climb */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Climbing, AdvancedDisplay, meta = (EditCondition = "bClimbable"))
+		bool bTraceComplex;
+
+	/** Climb settings of whatever the hit landed on */
+	static FClimbSurface GetSurface(const FHitResult& Hit);
+};
@@ -0,0 +1,218 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/Atomic.h"
+#include "CollisionQueryParams.h"
+#include "CollisionShape.h"
+#include "Engine/EngineTypes.h"
+#include "WorldCollision.h"
+#include "ClimbContactCache.h"
+#include "ClimbProbeRecorder.h"
+#include "ClimbTraceProvider.h"
+
+class UWorld;
+class AActor;
+class UPrimitiveComponent;
+class UPhysicalMaterial;
+class UClimbSurfaceGraph;
+class UClimbProxyUserData;
+struct FClimbQueryHit;
+
+/**
+ * Holds the climb probes of one character for one frame.
+ *
+ * Sync mode: a probe is traced the first time its result is asked for, so a branch that is
+ * never reached never pays for its traces. That can be on a worker thread, see UClimbEvaluateSubsystem,
+ * one batch is only ever used by one thread at a time. Between BeginWorkerFrame and EndWorkerFrame the
+ * batch reads the walls it hits from a copy taken on the game thread instead of from their objects.
+ *
+ * Async mode: every probe added during the frame is submitted in one go through the async
+ * trace path on Flush(), and the results are read back by BeginFrame() on the next frame.
+ * Batches are always async while a climb query budget is set, see UClimbQuerySchedulerSubsystem.
+ *
+ * Either way, body/head wall probes are answered from the contact cache while the character holds still.
+ *
+ * Wall probes trace the Climbable channel and clearance sweeps trace Visibility, both against simple
+ * collision. A wall whose UClimbPhysicalMaterial is not climbable counts as a miss, and one that opts
+ * into complex tracing is traced again against its triangles.
+ *
+ * With climb.TriangleProbes on, probes are answered from the static collision triangles baked into the
+ * level's climb graph instead, and async batches send their line probes through it a packet at a time.
+ *
+ * Other climbers are only in the way if the owner does not know about them, see SetIgnoredActors.
+ *
+ * With climb.RecordProbes above 0 every resolved probe also goes into the batch's FClimbProbeRecorder.
+ */
+class FPSCLIMBCPPTEST_API FClimbProbeBatch
+{
+public:
+	FClimbProbeBatch();
+
+	/** Binds the batch to its owner, the owner is ignored by every probe */
+	void Init(AActor* InOwner);
+
+	/**
+	 * Actors every probe ignores besides the owner, the climbers next to it on the wall, so their capsules are not
+	 * taken for the wall. Only rebuilds the query params when the set changes
+	 */
+	void SetIgnoredActors(TArrayView<AActor* const> Actors);
+
+	/** Graph whose baked triangles answer probes when climb.TriangleProbes is on */
+	void SetSurfaceGraph(const UClimbSurfaceGraph* InGraph) { SurfaceGraph = InGraph; }
+
+	/** Starts a new frame and collects last frame's async results. Only does work on the first call of a frame */
+	void BeginFrame();
+
+	/** Drops every pending and resolved probe along with the cached contacts */
+	void Reset();
+
+	/** Intent is whatever drove the probe (usually the sign of the axis), results only count if it still matches */
+	void AddLine(EClimbProbe Probe, const FVector& Start, const FVector& End, int8 Intent = 0);
+	void AddSweep(EClimbProbe Probe, const FVector& Start, const FVector& End, const FCollisionShape& Shape, int8 Intent = 0);
+
+	/** Sync: always true. Async: true if last frame's batch returned this probe with the same intent */
+	bool HasResult(EClimbProbe Probe, int8 Intent = 0) const;
+	bool HasResults(std::initializer_list<EClimbProbe> Probes, int8 Intent = 0) const;
+
+	/** Did the probe block. Traces the probe right away in sync mode */
+	bool IsHit(EClimbProbe Probe);
+	const FHitResult& GetHit(EClimbProbe Probe) const;
+
+	/** Climb settings of the surface the probe hit */
+	FClimbSurface GetSurface(EClimbProbe Probe) const;
+
+	/**
+	 * Game thread, before the batch is handed to a worker thread: copies the owner's transform and the transform,
+	 * climb proxy and surface of everything last frame's probes hit. Until EndWorkerFrame probes read only the copy,
+	 * a hit on anything it does not have is dropped and flagged, see HasMissedWorkerSnapshot.
+	 */
+	void BeginWorkerFrame();
+	void EndWorkerFrame();
+
+	/** Did a probe since BeginWorkerFrame hit something the copy did not have, its answers can't be trusted */
+	bool HasMissedWorkerSnapshot() const { return bMissedWorkerSnapshot; }
+
+	/** Submits this frame's probes through the async trace path, does nothing in sync mode. Returns the physics queries it sent */
+	int32 Flush();
+
+	/** Probes added since the last flush */
+	int32 NumPending() const;
+
+	bool IsAsync() const { return bAsync; }
+
+	/** Probes that look for a wall to hold on to, as opposed to clearance sweeps */
+	static bool IsWallProbe(EClimbProbe Probe);
+
+	/** Physics queries issued by every batch since startup, sync and async */
+	static uint64 GetNumTraces() { return NumTraces.Load(); }
+
+	/** Last probes, null unless climb.RecordProbes is on */
+	const FClimbProbeRecorder* GetRecorder() const { return Recorder.Get(); }
+
+	const FClimbContactCache& GetContactCache() const { return ContactCache; }
+	FClimbContactCache& GetContactCache() { return ContactCache; }
+
+private:
+	struct FSlot
+	{
+		// Geometry added this frame
+		FVector Start;
+		FVector End;
+		FCollisionShape Shape;
+		int8 Intent;
+		bool bAdded;
+
+		// Handle of the async trace in flight, or the cache or baked triangles answering for it
+		FTraceHandle Handle;
+		FTransform HandleTransform;
+		int8 HandleIntent;
+		bool bHandleAnswered;
+
+		// Latest result
+		FHitResult Hit;
+		int8 ResultIntent;
+		bool bResolved;
+		bool bHit;
+
+		// Last surface hit asked for complex tracing
+		bool bComplex;
+
+		// Latest result was traced complex, or came from a climb proxy
+		bool bTracedComplex;
+		bool bProxy;
+	};
+
+	void Trace(EClimbProbe Probe, FSlot& Slot);
+
+	/** Can the baked triangles answer this probe */
+	bool CanQueryTriangles(const FSlot& Slot) const;
+
+	/** Answers a probe from the baked triangles right away */
+	void QueryTriangles(EClimbProbe Probe, FSlot& Slot);
+	void SetTriangleHit(const FClimbQueryHit& QueryHit, FSlot& Slot) const;
+
+	/** Applies the climb settings of the surface that was hit, returns true if it wants a complex trace */
+	bool ApplySurface(EClimbProbe Probe, FSlot& Slot);
+
+	/** Re-answers a wall hit from the climb proxy of the mesh it landed on, returns true if the hit is the proxy's */
+	bool ApplyProxy(FSlot& Slot) const;
+	FTransform GetOwnerTransform() const;
+
+	/** Transform of the component a hit landed on, identity for the baked triangles. False if the worker snapshot lacks it */
+	bool GetComponentTransform(const FHitResult& Hit, FTransform& OutTransform) const;
+
+	/** Climb settings of what a hit landed on, from the worker snapshot in a worker frame */
+	FClimbSurface FindSurface(const FHitResult& Hit) const;
+
+	/** The world and graph, the raw pointers taken by BeginWorkerFrame in a worker frame */
+	UWorld* GetProbeWorld() const;
+	const UClimbSurfaceGraph* GetProbeGraph() const;
+
+	/** Draws a resolved probe when climb.DebugDraw is on */
+	void DrawDebug(const FSlot& Slot) const;
+
+	/** Hands a resolved probe to the recorder, if there is one */
+	void Record(EClimbProbe Probe, const FSlot& Slot, EClimbProbeSource Source, bool bAsyncResult);
+
+	FSlot Slots[(int32)EClimbProbe::Count];
+
+	TWeakObjectPtr<UWorld> World;
+	TWeakObjectPtr<AActor> Owner;
+	TWeakObjectPtr<const UClimbSurfaceGraph> SurfaceGraph;
+	FClimbContactCache ContactCache;
+	TUniquePtr<FClimbProbeRecorder> Recorder;
+	FCollisionQueryParams QueryParams;
+	FCollisionQueryParams ComplexQueryParams;
+
+	//Only compared against, never dereferenced
+	TArray<const AActor*, TInlineAllocator<16>> IgnoredActors;
+
+	/** What a worker frame reads instead of the objects, see BeginWorkerFrame. The weak pointers are only compared */
+	struct FWorkerComponent
+	{
+		TWeakObjectPtr<UPrimitiveComponent> Component;
+		FTransform Transform;
+		const UClimbProxyUserData* Proxy;
+	};
+
+	struct FWorkerSurface
+	{
+		TWeakObjectPtr<UPhysicalMaterial> Material;
+		FClimbSurface Surface;
+	};
+
+	TArray<FWorkerComponent> WorkerComponents;
+	TArray<FWorkerSurface> WorkerSurfaces;
+	FTransform WorkerOwnerTransform;
+	UWorld* WorkerWorld;
+	const UClimbSurfaceGraph* WorkerGraph;
+	bool bWorkerFrame;
+	mutable bool bMissedWorkerSnapshot;
+
+	uint64 FrameNumber;
+	bool bAsync;
+
+	static TAtomic<uint64> NumTraces;
+};
@@ -0,0 +1,105 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/Atomic.h"
+
+class UWorld;
+enum class EClimbProbe : uint8;
+
+//Where a probe's answer came from
+enum class EClimbProbeSource : uint8
+{
+	Scene,
+	Cache,
+	Triangles
+};
+
+enum class EClimbProbeRecordFlags : uint8
+{
+	None = 0,
+	Hit = 1,
+	StartPenetrating = 2,
+	//Traced async, the answer is used the frame after it was asked for
+	Async = 4,
+	//Traced again against the surface's render triangles
+	Complex = 8,
+	//Re-answered from the climb proxy of the mesh it hit
+	Proxy = 16
+};
+
+ENUM_CLASS_FLAGS(EClimbProbeRecordFlags);
+
+//One resolved climb probe
+struct FClimbProbeRecord
+{
+	FVector Start;
+	FVector End;
+	/** Shape extent, zero for a line */
+	FVector Extent;
+	FVector HitLocation;
+	FVector HitNormal;
+	uint32 Frame;
+	EClimbProbe Probe;
+	uint8 ShapeType;
+	EClimbProbeSource Source;
+	EClimbProbeRecordFlags Flags;
+	int8 Intent;
+
+	bool IsHit() const { return EnumHasAnyFlags(Flags, EClimbProbeRecordFlags::Hit); }
+
+	friend FArchive& operator<<(FArchive& Ar, FClimbProbeRecord& Record);
+};
+
+/**
+ * Fixed-size ring of the last probes of one FClimbProbeBatch, kept while climb.RecordProbes is above 0.
+ *
+ * Only the thread using the batch records, and records are never locked: a reader copies the ring out and
+ * drops whatever the writer may have overwritten while it copied. Drawn with climb.DrawProbes and written
+ * to disk with climb.DumpProbes, so a server's recent probes can be looked at offline with climb.DrawProbeDump.
+ */
+class FPSCLIMBCPPTEST_API FClimbProbeRecorder
+{
+public:
+	explicit FClimbProbeRecorder(int32 InCapacity);
+
+	void Record(const FClimbProbeRecord& InRecord);
+
+	/** Records of the last NumFrames recorded frames, oldest first. Safe from any thread */
+	void GetRecords(TArray<FClimbProbeRecord>& OutRecords, uint32 NumFrames = MAX_uint32) const;
+
+	int32 GetCapacity() const { return Records.Num(); }
+
+	/** Draws records for Seconds, green where they hit and red where they missed, paler when answered without the physics scene */
+	static void Draw(UWorld* World, TArrayView<const FClimbProbeRecord> InRecords, float Seconds);
+
+private:
+	TArray<FClimbProbeRecord> Records;
+
+	/** Records written since the ring was made, the next one goes to Head % capacity */
+	TAtomic<uint64> Head;
+};
+
+/**
+ * Recorded probes of every climber in a world, as written by climb.DumpProbes.
+ */
+struct FPSCLIMBCPPTEST_API FClimbProbeDump
+{
+	struct FClimber
+	{
+		FString Name;
+		TArray<FClimbProbeRecord> Records;
+	};
+
+	FString MapName;
+	double Time;
+	TArray<FClimber> Climbers;
+
+	FClimbProbeDump();
+
+	bool Save(const FString& Filename);
+	bool Load(const FString& Filename);
+
+	void Serialize(FArchive& Ar);
+};
@@ -0,0 +1,30 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "ClimbProxyCommandlet.generated.h"
+
+/**
+ * Generates climb proxies (UClimbProxyUserData) for the climbable static meshes of a map, so wall probes on
+ * high-poly art can skip the complex trace.
+ *
+ * UE4Editor-Cmd FPSClimbCPPTest -run=ClimbProxy -Map=/Game/TestLevel [-Meshes=/Game/Rocks/A,/Game/Rocks/B]
+ *     [-MaxError=2] [-Force] [-Output=Saved/ClimbProxy.json]
+ *
+ * Every mesh placed with climbable collision in the map is tagged, plus any listed in -Meshes. A mesh is
+ * decimated from its complex collision triangles until the measured deviation is within its MaxError, and
+ * is skipped if neither those triangles nor MaxError changed since its proxy was made. Writes the triangle
+ * counts and worst deviation of every mesh as JSON. Re-run ClimbGraphBake afterwards for climb.TriangleProbes.
+ */
+UCLASS()
+class FPSCLIMBCPPTEST_API UClimbProxyCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UClimbProxyCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,69 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/AssetUserData.h"
+#include "CollisionShape.h"
+#include "ClimbTriangleBVH.h"
+#include "ClimbProxyUserData.generated.h"
+
+class UPrimitiveComponent;
+struct FHitResult;
+
+/**
+ * Climb proxy of a static mesh: its render triangles simplified to within MaxError, for climb probes to
+ * hit instead of tracing complex. Add it to a mesh's Asset User Data to tag the mesh, then run
+ * UClimbProxyCommandlet to fill it in. Meshes placed as climbable in a map are tagged by the commandlet.
+ */
+UCLASS()
+class FPSCLIMBCPPTEST_API UClimbProxyUserData : public UAssetUserData
+{
+	GENERATED_BODY()
+
+public:
+	UClimbProxyUserData();
+
+	virtual void PostLoad() override;
+
+	/** Furthest the proxy may stray from the render triangles, in cm */
+	UPROPERTY(EditAnywhere, Category = Climbing, meta = (ClampMin = "0.1", UIMin = "0.1"))
+		float MaxError;
+
+	/** Proxy triangles in mesh space, three vertices each */
+	UPROPERTY(VisibleAnywhere, Category = Climbing)
+		TArray<FVector> Vertices;
+
+	/** Render triangles the proxy was generated from */
+	UPROPERTY(VisibleAnywhere, Category = Climbing)
+		int32 SourceTriangles;
+
+	/** Worst distance between the proxy and the render triangles the commandlet measured, in cm */
+	UPROPERTY(VisibleAnywhere, Category = Climbing)
+		float MaxDeviation;
+
+	/** Render triangles and MaxError the proxy was generated from, a mesh is only regenerated when this changes */
+	UPROPERTY()
+		uint32 SourceHash;
+
+	/** Proxy of whatever static mesh Component shows, null if it has none */
+	static const UClimbProxyUserData* FindForComponent(const UPrimitiveComponent* Component);
+
+	/** Replaces the proxy and rebuilds its tree */
+	void SetTriangles(TArray<FVector>&& InVertices);
+
+	int32 NumTriangles() const { return Vertices.Num() / 3; }
+	bool IsEmpty() const { return TriangleBVH.IsEmpty(); }
+
+	/**
+	 * Re-answers a probe that hit Component's simple collision against the proxy, in world space.
+	 * Rays work for any transform, capsules only while the component is upright and uniformly scaled.
+	 * Returns false if the proxy can't answer it, true with OutHit filled in (hit or miss) if it did.
+	 */
+	bool Query(const FTransform& ComponentTransform, const FVector& Start, const FVector& End, const FCollisionShape& Shape, FHitResult& InOutHit) const;
+
+private:
+	void BuildTree();
+
+	FClimbTriangleBVH TriangleBVH;
+};
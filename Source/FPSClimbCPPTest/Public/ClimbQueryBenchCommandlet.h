@@ -0,0 +1,30 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "ClimbQueryBenchCommandlet.generated.h"
+
+/**
+ * Times the baked triangle BVH of a map's climb graph on its own, no world is loaded.
+ *
+ * UE4Editor-Cmd FPSClimbCPPTest -run=ClimbQueryBench -nullrhi -Map=/Game/TestLevel [-Rays=65536] [-Seed=0]
+ *     [-Output=Saved/ClimbQueryBench.json]
+ *
+ * Fires the same random probe-length rays one at a time and in packets, and sweeps a climb-sized capsule
+ * for every eighth one. Reports ns per query, hit counts, and any ray the two ray paths disagree on, as JSON.
+ *
+ * The ClimbQueryBench program target runs the same measurements on a generated level without the editor, and
+ * the Climb.Query automation tests check packets against single rays and sweeps against known hits.
+ */
+UCLASS()
+class FPSCLIMBCPPTEST_API UClimbQueryBenchCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UClimbQueryBenchCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
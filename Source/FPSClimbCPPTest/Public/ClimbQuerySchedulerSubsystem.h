@@ -0,0 +1,83 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "ClimbQuerySchedulerSubsystem.generated.h"
+
+class UClimbingMovementComponent;
+
+/**
+ * Spends a per-frame budget of physics traces on climb probes.
+ *
+ * With climb.QueryBudget above 0 every probe batch runs async, and instead of flushing at the end of
+ * its owner's tick it is queued here. Once all actors have ticked the queue is flushed in priority
+ * order until the traces issued this frame reach the budget: locally controlled characters first,
+ * then the rest by distance to the nearest player divided by the frames they have waited. Flushing
+ * only queues async traces, so the budget counts traces rather than time.
+ *
+ * A batch that doesn't fit is dropped, not carried over: its owner's next BeginFrame clears it and the
+ * owner asks for its probes again. The owner keeps its place in the queue and moves up for every frame
+ * it waits, and holds still until one of its batches gets through.
+ *
+ * Locally controlled characters are never deferred, the budget only ever holds back everyone else.
+ * The first batch of a frame always goes, so a budget smaller than one batch still makes progress.
+ */
+UCLASS()
+class FPSCLIMBCPPTEST_API UClimbQuerySchedulerSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	UClimbQuerySchedulerSubsystem();
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+
+	/** Is the budget set, probe batches go async when it is */
+	static bool IsBudgeted();
+
+	/** Queues the climber's probes for this frame's flush, a climber already waiting keeps its place */
+	void Submit(UClimbingMovementComponent* Climber);
+
+	/** Drops a climber that is going away */
+	void Cancel(UClimbingMovementComponent* Climber);
+
+	/** Batches held back since the last reset, see climb.QueryBudgetReport */
+	uint32 GetNumDeferred() const { return NumDeferred; }
+	uint32 GetNumOverBudgetFrames() const { return NumOverBudgetFrames; }
+	uint32 GetMaxWait() const { return MaxWait; }
+	void ResetReport();
+
+private:
+	struct FRequest
+	{
+		TWeakObjectPtr<UClimbingMovementComponent> Climber;
+
+		/** Frames since it was first queued */
+		int32 FramesWaited;
+
+		/** Lower goes first */
+		float Priority;
+		bool bLocal;
+	};
+
+	TArray<FRequest> Queue;
+
+	/** Scratch, player view locations this frame */
+	TArray<FVector> Viewers;
+
+	uint32 NumDeferred;
+	uint32 NumOverBudgetFrames;
+	uint32 MaxWait;
+
+	bool bInitialized;
+};
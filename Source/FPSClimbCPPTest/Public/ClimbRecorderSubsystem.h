@@ -0,0 +1,64 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "InputCoreTypes.h"
+#include "ClimbRecording.h"
+#include "ClimbRecorderSubsystem.generated.h"
+
+class AEngiPC;
+
+/**
+ * Records the first local player's input and climb state, a frame at a time, to a file the ClimbReplay
+ * commandlet plays back. Started with climb.Record or -ClimbRecord=<file> on the command line, stopped
+ * with climb.StopRecording, when the world goes away or the player loses its pawn. The first frame is the
+ * first one the player is standing on the ground, which is where ClimbReplay starts the character.
+ *
+ * Each frame reads the MoveForward and MoveRight axes the pawn's bindings were given, which of the keys
+ * mapped to Jump and SpecialAction are down, the control rotation and what the frame did to the character.
+ * Costs nothing while not recording.
+ */
+UCLASS()
+class FPSCLIMBCPPTEST_API UClimbRecorderSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	UClimbRecorderSubsystem();
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+
+	/** Starts on the next frame the local player has a pawn on the ground. An empty filename picks one in Saved/ClimbRecordings */
+	void StartRecording(const FString& Filename);
+	void StopRecording();
+
+	bool IsRecording() const { return Writer.IsOpen() || !PendingFilename.IsEmpty(); }
+
+private:
+	AEngiPC* GetRecordedCharacter() const;
+
+	/** Is Character standing on the ground, not climbing or falling */
+	bool CanBeginRecording(const AEngiPC* Character) const;
+
+	/** Opens the file at where Character is now */
+	bool BeginRecording(AEngiPC* Character);
+
+	FClimbRecordingWriter Writer;
+	FString PendingFilename;
+	FString Filename;
+
+	/** Keys mapped to each recorded action */
+	TArray<FKey> ActionKeys[FClimbRecordedFrame::NumActions];
+
+	bool bInitialized;
+};
@@ -0,0 +1,126 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+//Actions a recording holds, bits of FClimbRecordedFrame::Actions
+enum class EClimbRecordedAction : uint8
+{
+	None = 0,
+	Jump = 1,
+	SpecialAction = 2
+};
+
+ENUM_CLASS_FLAGS(EClimbRecordedAction);
+
+/**
+ * One frame of a player: the input the frame was driven by, then where that left the character.
+ * What is read back has been through the file's quantization, locations to the millimetre and
+ * rotations to 1/65536 of a turn.
+ */
+struct FClimbRecordedFrame
+{
+	/** Frame time the world ticked with, to 10 microseconds */
+	float DeltaTime;
+
+	/** MoveForward and MoveRight, to 1/127 */
+	float Forward;
+	float Right;
+
+	/** Held this frame */
+	EClimbRecordedAction Actions;
+
+	/** Look, after this frame's mouse and the climb turned it */
+	FRotator ControlRotation;
+
+	FVector Location;
+	/** Capsule */
+	FRotator Rotation;
+	/** First person camera, relative to the capsule */
+	FRotator CameraRotation;
+
+	/** EClimbState, EMovementMode and the custom mode */
+	uint8 ClimbState;
+	uint8 MovementMode;
+	uint8 CustomMode;
+
+	FClimbRecordedFrame();
+
+	/** Bindings the bits of Actions go to, in bit order */
+	static const int32 NumActions = 2;
+	static FName GetActionName(int32 Index);
+};
+
+/** Where and on what a recording starts */
+struct FClimbRecordingHeader
+{
+	FString MapName;
+	FVector StartLocation;
+	FRotator StartRotation;
+	FRotator StartControlRotation;
+	uint8 StartClimbState;
+
+	FClimbRecordingHeader();
+};
+
+/**
+ * Streams frames to a recording file.
+ *
+ * Frames are delta coded against the one before and packed into chunks of FramesPerChunk; each chunk starts
+ * over from zero so it decodes on its own, and is written to disk once it is full. A session cut short
+ * loses at most the chunk it was filling. A frame where nothing changed is one byte.
+ */
+class FPSCLIMBCPPTEST_API FClimbRecordingWriter
+{
+public:
+	FClimbRecordingWriter();
+	~FClimbRecordingWriter();
+
+	bool Open(const FString& Filename, const FClimbRecordingHeader& Header);
+	void AddFrame(const FClimbRecordedFrame& Frame);
+
+	/** Writes the chunk being filled and closes the file */
+	bool Close();
+
+	bool IsOpen() const { return Writer.IsValid(); }
+	int32 GetNumFrames() const { return NumFrames; }
+	int64 GetNumBytes() const;
+
+	static const int32 FramesPerChunk = 256;
+
+private:
+	void FlushChunk();
+
+	TUniquePtr<FArchive> Writer;
+	TArray<uint8> Chunk;
+	int32 ChunkFrames;
+	int32 NumFrames;
+
+	/** Last frame of the chunk, quantized, what the next one is coded against */
+	TArray<int32> Previous;
+};
+
+/** Reads a recording back a frame at a time, a chunk is decoded when the first of its frames is asked for */
+class FPSCLIMBCPPTEST_API FClimbRecordingReader
+{
+public:
+	FClimbRecordingReader();
+	~FClimbRecordingReader();
+
+	bool Open(const FString& Filename);
+	const FClimbRecordingHeader& GetHeader() const { return Header; }
+
+	/** False at the end of the recording, or where it was cut short */
+	bool Next(FClimbRecordedFrame& OutFrame);
+
+private:
+	bool ReadChunk();
+
+	TUniquePtr<FArchive> Reader;
+	FClimbRecordingHeader Header;
+	TArray<uint8> Chunk;
+	int32 ChunkOffset;
+	int32 ChunkFrames;
+	TArray<int32> Previous;
+};
@@ -0,0 +1,35 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "ClimbReplayCommandlet.generated.h"
+
+/**
+ * Plays a climb.Record recording back headless and reports where it went somewhere else and what each frame cost.
+ *
+ * UE4Editor-Cmd FPSClimbCPPTest -run=ClimbReplay -nullrhi -Recording=Saved/ClimbRecordings/X.climbrec [-Map=]
+ *     [-Tolerance=1] [-RotationTolerance=1] [-MaxDivergentFrames=0] [-MaxFrameMs=0] [-Output=Saved/ClimbReplay.json]
+ *
+ * Loads the recording's map (or -Map), spawns an AEngiPC where the recording started and, frame by frame, sets
+ * the recorded look, fires the recorded presses and releases through the character's own bindings, feeds it
+ * the recorded axes and ticks the world with the recorded frame time. Each frame after that is checked against
+ * the recorded location (Tolerance in cm), capsule rotation (RotationTolerance in degrees), climb state and
+ * movement mode. Only a player's own input is recorded, so recordings of a standalone game are the ones that
+ * replay exactly; one from a networked client replays without the server's corrections or other players.
+ *
+ * The report has game thread ms per frame (mean, p50, p99, max), the slowest frames next to the frame times
+ * recorded in the field, and the divergent frames as JSON. Fails on more than MaxDivergentFrames divergent
+ * frames, or a p99 over MaxFrameMs where that is set.
+ */
+UCLASS()
+class FPSCLIMBCPPTEST_API UClimbReplayCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UClimbReplayCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
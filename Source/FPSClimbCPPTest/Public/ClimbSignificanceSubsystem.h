@@ -0,0 +1,82 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "ClimbingMovementComponent.h"
+#include "ClimbSignificanceSubsystem.generated.h"
+
+/**
+ * Sorts climbers into LOD tiers through the significance manager.
+ *
+ * Every frame the view of every player controller in the world is handed to the manager, all
+ * local split-screen players on a client and every connected player on a server. A climber's
+ * tier is the best it gets from any of those views. Player-controlled climbers are always at
+ * full detail, their moves have to match what their owner predicted.
+ *
+ * Tier distances are climb.SignificanceReducedDistance and climb.SignificanceMinimalDistance,
+ * what a tier costs is set on UClimbingMovementComponent.
+ */
+UCLASS()
+class FPSCLIMBCPPTEST_API UClimbSignificanceSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	UClimbSignificanceSubsystem();
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+
+	/** Climbers start at full detail and are moved between tiers by the manager */
+	void RegisterClimber(UClimbingMovementComponent* Climber);
+	void UnregisterClimber(UClimbingMovementComponent* Climber);
+
+	int32 GetNumClimbers(EClimbLOD LOD) const { return NumClimbers[(int32)LOD]; }
+
+	/** Tier a climber at Current gets at Distance from a view, a band around each boundary keeps climbers near it from flipping */
+	static EClimbLOD GetLOD(EClimbLOD Current, float Distance, float ReducedDistance, float MinimalDistance);
+
+	/** Most significant first, the manager keeps the highest value over all views */
+	static float ToSignificance(EClimbLOD LOD);
+	static EClimbLOD FromSignificance(float Significance);
+
+private:
+	/** What the significance functions know of a climber, taken on the game thread before the manager updates */
+	struct FClimberView
+	{
+		FVector Location;
+		EClimbLOD LOD;
+		bool bPlayerControlled;
+	};
+
+	/** Tier a climber gets from one view. Worker threads, reads only Views and the cvars */
+	EClimbLOD GetLOD(const UClimbingMovementComponent* Climber, const FTransform& Viewpoint) const;
+
+	void OnSignificanceChanged(UClimbingMovementComponent* Climber, float NewSignificance);
+
+	/** Copies every climber's location and tier into Views */
+	void UpdateViews();
+
+	/** Cvars read once a frame, the significance functions run on worker threads */
+	float ReducedDistance;
+	float MinimalDistance;
+	bool bEnabled;
+
+	TArray<FTransform> Viewpoints;
+
+	/** Registered climbers. Only added to and removed from on the game thread, outside the manager's update */
+	TMap<const UClimbingMovementComponent*, FClimberView> Views;
+
+	int32 NumClimbers[(int32)EClimbLOD::Count];
+
+	bool bInitialized;
+};
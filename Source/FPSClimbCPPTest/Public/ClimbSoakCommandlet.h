@@ -0,0 +1,32 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "ClimbSoakCommandlet.generated.h"
+
+/**
+ * Soak tests climbing over the network: starts a dedicated server and headless bot clients on this machine,
+ * waits out the run and fails it on the server's summary (see UClimbSoakSubsystem).
+ *
+ * UE4Editor-Cmd FPSClimbCPPTest -run=ClimbSoak -Map=/Game/TestLevel [-Clients=4] [-Minutes=120] [-SampleSeconds=10]
+ *     [-PktLag=100] [-PktLagVariance=20] [-PktLoss=1] [-Port=17777] [-Seed=0] [-MaxMemoryGrowth=0] [-MaxCorrections=0]
+ *     [-ServerExe=] [-ClientExe=] [-Output=Saved/ClimbSoak]
+ *
+ * Server and clients are this executable with the project unless -ServerExe or -ClientExe name a packaged build,
+ * such as the FPSClimbCPPTestServer target. Every process gets the packet lag and loss, which the engine only
+ * simulates outside shipping builds. The server writes Server.csv and Summary.json to the output directory and
+ * every client its own Client<N>.log. MaxMemoryGrowth is in MB per hour and MaxCorrections per client per minute,
+ * 0 does not check.
+ */
+UCLASS()
+class FPSCLIMBCPPTEST_API UClimbSoakCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UClimbSoakCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,116 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "InputCoreTypes.h"
+#include "Engine/EngineBaseTypes.h"
+#include "ClimbSoakSubsystem.generated.h"
+
+class APlayerController;
+class UNetDriver;
+
+/**
+ * One side of a climbing soak test, only created in game worlds of a process started with -ClimbSoak
+ * (the ClimbSoak commandlet starts them).
+ *
+ * Client: plays the local player as a bot, pressing the keys mapped to MoveForward, MoveRight, Jump and
+ * SpecialAction so every grab, shimmy, mantle and release goes through the player's own input, saved moves and RPCs.
+ * Exits when it loses the server.
+ *
+ * Dedicated server: every -ClimbSoakSampleSeconds appends a row to <output>/Server.csv with the world's tick
+ * time, bytes per second of every connection, the climbers' corrections (see climb.NetReport) and memory.
+ * After -ClimbSoakMinutes it writes <output>/Summary.json, with memory growth per hour fitted over the samples,
+ * and exits. The run fails when growth is over -ClimbSoakMaxMemoryGrowth (MB/hour) or corrections are over
+ * -ClimbSoakMaxCorrections (per client per minute), where those are set.
+ */
+UCLASS()
+class FPSCLIMBCPPTEST_API UClimbSoakSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	UClimbSoakSubsystem();
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+
+private:
+	struct FSample
+	{
+		double Time;
+		float TickMsMean;
+		float TickMsMax;
+		int32 TickCount;
+		int32 Connections;
+		float InBytesPerConnection;
+		float OutBytesPerConnection;
+		float MaxOutBytes;
+		uint64 Corrections;
+		uint64 TransitionCorrections;
+		double UsedMB;
+		double ClimbingMB;
+		int32 Objects;
+	};
+
+	void TickBot();
+	void TickServer();
+
+	/** Presses Key, releasing the one pressed before it for the same binding */
+	void PressKey(APlayerController* Controller, FKey& Held, const FKey& Key);
+
+	void OnWorldTickStart(UWorld* InWorld, ELevelTick TickType, float DeltaSeconds);
+	void OnEndFrame();
+	void OnNetworkFailure(UWorld* InWorld, UNetDriver* NetDriver, ENetworkFailure::Type FailureType, const FString& ErrorString);
+
+	void WriteSample(const FSample& Sample);
+	void Finish();
+
+	/** First key mapped to an axis at Scale, or to an action */
+	static FKey FindAxisKey(FName Axis, float Scale);
+	static FKey FindActionKey(FName Action);
+
+	FString OutputDir;
+	double StartTime;
+	double Duration;
+	double SampleSeconds;
+	double NextSampleTime;
+	float MaxMemoryGrowth;
+	float MaxCorrections;
+
+	/** Server tick time, the world's tick through to the end of the frame so replication counts and the idle wait does not */
+	double TickStartTime;
+	double TickMsTotal;
+	float TickMsMax;
+	int32 TickCount;
+
+	/** Every tick of the run in ClimbSoak::HistogramMs buckets, for the summary's percentiles */
+	TArray<uint32> TickHistogram;
+
+	FDelegateHandle TickStartHandle;
+	FDelegateHandle EndFrameHandle;
+	FDelegateHandle NetworkFailureHandle;
+
+	TArray<FSample> Samples;
+
+	/** Bot */
+	FRandomStream Stream;
+	double NextChangeTime;
+	FKey ForwardKey;
+	FKey RightKey;
+	FKey JumpKey;
+	FKey SprintKey;
+	bool bJumpHeld;
+	bool bSprintHeld;
+
+	bool bInitialized;
+	bool bFinished;
+};
@@ -0,0 +1,102 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ClimbSpatialHashSubsystem.generated.h"
+
+class AActor;
+class UClimbingMovementComponent;
+
+/** Another climber near the one asking, where the hash last saw it */
+struct FClimbNeighbour
+{
+	const UClimbingMovementComponent* Climber;
+	AActor* Owner;
+	FVector Location;
+	FVector WallNormal;
+};
+
+//Sized for a crowded wall without touching the heap
+typedef TArray<FClimbNeighbour, TInlineAllocator<16>> FClimbNeighbours;
+
+/**
+ * Uniform grid of the climbers latched to a wall, so climbers can find each other without physics queries.
+ *
+ * Cells are hashed into a fixed table of buckets, each a list threaded through the entries, so moving a
+ * climber to another cell, the common update, only relinks it. Entries are only added and freed when a
+ * climber latches and lets go. Climbers keep the index Add returns and hand it back to Move and Remove.
+ */
+class FPSCLIMBCPPTEST_API FClimbSpatialHash
+{
+public:
+	FClimbSpatialHash();
+
+	/** Returns the climber's index in the hash */
+	int32 Add(const UClimbingMovementComponent* Climber, AActor* Owner, const FVector& Location, const FVector& WallNormal);
+	void Move(int32 Index, const FVector& Location, const FVector& WallNormal);
+	void Remove(int32 Index);
+
+	/** Every climber within Radius of Location, except the one at IgnoreIndex. Unsorted */
+	void FindNeighbours(const FVector& Location, float Radius, int32 IgnoreIndex, FClimbNeighbours& OutNeighbours) const;
+
+	void Reset();
+
+	int32 GetNumClimbers() const { return NumClimbers; }
+
+	static FIntVector GetCell(const FVector& Location);
+	static int32 GetBucket(const FIntVector& Cell);
+
+private:
+	struct FEntry
+	{
+		FClimbNeighbour Neighbour;
+		FIntVector Cell;
+
+		// Bucket list, or the free list while unused
+		int32 Prev;
+		int32 Next;
+		bool bUsed;
+	};
+
+	void Link(int32 Index);
+	void Unlink(int32 Index);
+
+	TArray<FEntry> Entries;
+	TArray<int32> Buckets;
+	int32 FreeList;
+	int32 NumClimbers;
+};
+
+/**
+ * The world's FClimbSpatialHash.
+ *
+ * Written by the climbers' movement on the game thread, read by them the same way. Nothing in here is
+ * safe to call from the evaluate phase's worker threads.
+ */
+UCLASS()
+class FPSCLIMBCPPTEST_API UClimbSpatialHashSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Deinitialize() override;
+
+	/** Returns the climber's index in the hash */
+	int32 Add(UClimbingMovementComponent* Climber, const FVector& Location, const FVector& WallNormal);
+	void Move(int32 Index, const FVector& Location, const FVector& WallNormal) { Hash.Move(Index, Location, WallNormal); }
+	void Remove(int32 Index) { Hash.Remove(Index); }
+
+	/** Every climber within Radius of Location, except the one at IgnoreIndex. Unsorted */
+	void FindNeighbours(const FVector& Location, float Radius, int32 IgnoreIndex, FClimbNeighbours& OutNeighbours) const
+	{
+		Hash.FindNeighbours(Location, Radius, IgnoreIndex, OutNeighbours);
+	}
+
+	int32 GetNumClimbers() const { return Hash.GetNumClimbers(); }
+
+private:
+	FClimbSpatialHash Hash;
+};
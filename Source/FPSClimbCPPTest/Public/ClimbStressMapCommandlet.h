@@ -0,0 +1,33 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "ClimbStressMapCommandlet.generated.h"
+
+/**
+ * Generates a climbing stress map from a seed, for load testing climbing on far more geometry than TestLevel.
+ *
+ * UE4Editor-Cmd FPSClimbCPPTest -run=ClimbStressMap -Map=/Game/Stress/StressLevel [-Seed=0] [-Walls=100]
+ *     [-CornerDensity=0.3] [-Ledges=50] [-Overhangs=0.25] [-OverhangSpread=10] [-Density=16] [-Roughness=1]
+ *     [-Climbers=32] [-Spacing=1500] [-Output=Saved/ClimbStressMap.json]
+ *
+ * Walls stand one to a cell of a square grid -Spacing apart. Each turns a corner with -CornerDensity chance, up to
+ * three times. -Overhangs of the straight walls lean over or back to within -OverhangSpread degrees of the climber's
+ * ReleaseTilt. -Ledges shelves are spread over the walls' faces. The climbable face of every wall is a -Density by
+ * -Density grid roughened by up to -Roughness cm, traced complex, and -Climbers player starts face the foot of a wall.
+ *
+ * TestLevel is about twenty blocks, so -Walls=100 is roughly ten times its geometry and -Walls=1000 a hundred.
+ * The same parameters always give the same map. Run ClimbProxy and ClimbGraphBake -Full on it afterwards.
+ */
+UCLASS()
+class FPSCLIMBCPPTEST_API UClimbStressMapCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UClimbStressMapCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
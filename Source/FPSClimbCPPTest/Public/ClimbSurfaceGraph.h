@@ -0,0 +1,275 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "ClimbTriangleBVH.h"
+#include "ClimbSurfaceGraph.generated.h"
+
+class UWorld;
+class AActor;
+class UPhysicalMaterial;
+
+//Trace channels a baked triangle blocks
+enum class EClimbTriangleChannel : uint8
+{
+	None = 0,
+	Climbable = 1,
+	Visibility = 2,
+};
+ENUM_CLASS_FLAGS(EClimbTriangleChannel);
+
+//Flat rectangle of wall that can be climbed
+USTRUCT()
+struct FClimbWallPatch
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+		FVector Center;
+
+	/** Points away from the wall */
+	UPROPERTY()
+		FVector Normal;
+
+	/** Along the wall, horizontal */
+	UPROPERTY()
+		FVector Right;
+
+	/** Half width along Right, half height along Z */
+	UPROPERTY()
+		FVector2D Extent;
+
+	/** Index into BakedActors */
+	UPROPERTY()
+		int32 Source;
+
+	FClimbWallPatch()
+		: Center(ForceInitToZero), Normal(ForceInitToZero), Right(ForceInitToZero), Extent(ForceInitToZero), Source(INDEX_NONE)
+	{
+	}
+};
+
+//Top edge of a patch with open floor above it
+USTRUCT()
+struct FClimbLedge
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+		FVector Start;
+
+	UPROPERTY()
+		FVector End;
+
+	/** From the edge to where the capsule centre ends up after mantling */
+	UPROPERTY()
+		FVector MantleOffset;
+
+	UPROPERTY()
+		int32 Patch;
+
+	/** No room to stand on top as of the last bake. Kept so the next bake checks it again, never handed out */
+	UPROPERTY()
+		bool bBlocked;
+
+	FClimbLedge()
+		: Start(ForceInitToZero), End(ForceInitToZero), MantleOffset(ForceInitToZero), Patch(INDEX_NONE), bBlocked(false)
+	{
+	}
+};
+
+//Two patches meeting on a vertical edge
+USTRUCT()
+struct FClimbCorner
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+		int32 PatchA;
+
+	UPROPERTY()
+		int32 PatchB;
+
+	/** Middle of the shared edge */
+	UPROPERTY()
+		FVector Pivot;
+
+	/** Inside corners face each other, outside corners face away */
+	UPROPERTY()
+		bool bInside;
+
+	FClimbCorner()
+		: PatchA(INDEX_NONE), PatchB(INDEX_NONE), Pivot(ForceInitToZero), bInside(false)
+	{
+	}
+};
+
+//Static collision triangle, lets climb probes skip the physics scene
+USTRUCT()
+struct FClimbTriangle
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+		FVector A;
+
+	UPROPERTY()
+		FVector B;
+
+	UPROPERTY()
+		FVector C;
+
+	/** Index into BakedActors */
+	UPROPERTY()
+		int32 Source;
+
+	/** Index into TriangleMaterials, INDEX_NONE for the default material */
+	UPROPERTY()
+		int32 Material;
+
+	/** EClimbTriangleChannel bits */
+	UPROPERTY()
+		uint8 Channels;
+
+	/** Baked from the mesh's climb proxy rather than its simple collision, close enough to never trace complex */
+	UPROPERTY()
+		bool bClimbProxy;
+
+	FClimbTriangle()
+		: A(ForceInitToZero), B(ForceInitToZero), C(ForceInitToZero), Source(INDEX_NONE), Material(INDEX_NONE), Channels(0), bClimbProxy(false)
+	{
+	}
+};
+
+//Actor the bake read, so a re-bake can skip it if it has not changed
+USTRUCT()
+struct FClimbBakedActor
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+		FString ActorPath;
+
+	UPROPERTY()
+		uint32 Hash;
+
+	FClimbBakedActor()
+		: Hash(0)
+	{
+	}
+};
+
+/**
+ * Climbable walls, ledges and corners of one level, baked offline by UClimbGraphBakeCommandlet.
+ * Lookups go through a spatial hash built on load.
+ */
+UCLASS()
+class FPSCLIMBCPPTEST_API UClimbSurfaceGraph : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	UClimbSurfaceGraph();
+
+	virtual void PostLoad() override;
+
+	UPROPERTY(VisibleAnywhere, Category = "Climb Graph")
+		TArray<FClimbWallPatch> Patches;
+
+	UPROPERTY(VisibleAnywhere, Category = "Climb Graph")
+		TArray<FClimbLedge> Ledges;
+
+	UPROPERTY(VisibleAnywhere, Category = "Climb Graph")
+		TArray<FClimbCorner> Corners;
+
+	UPROPERTY(VisibleAnywhere, Category = "Climb Graph")
+		TArray<FClimbBakedActor> BakedActors;
+
+	/** Simple collision of the level's static geometry, see climb.TriangleProbes */
+	UPROPERTY(VisibleAnywhere, Category = "Climb Graph")
+		TArray<FClimbTriangle> Triangles;
+
+	UPROPERTY(VisibleAnywhere, Category = "Climb Graph")
+		TArray<UPhysicalMaterial*> TriangleMaterials;
+
+	/** Size of a spatial hash cell */
+	UPROPERTY(EditAnywhere, Category = "Climb Graph", meta = (ClampMin = "50", UIMin = "50"))
+		float CellSize;
+
+	/** Graph baked for the world's persistent level, if there is one */
+	static UClimbSurfaceGraph* FindForWorld(UWorld* World);
+
+	/** Graph baked for a map package, without loading the map */
+	static UClimbSurfaceGraph* FindForMap(const FString& MapPackageName);
+
+	/** Asset path the bake writes for a map package */
+	static FString GetGraphPackageName(const FString& MapPackageName);
+
+	/**
+	 * Finds the wall a ray from Start along Direction would hit within MaxDistance.
+	 * Returns the patch index, or INDEX_NONE if no baked wall is there.
+	 */
+	int32 FindWall(const FVector& Start, const FVector& Direction, float MaxDistance, FVector& OutPoint, FVector& OutNormal) const;
+
+	/** Finds a ledge within Radius of Location. Returns the ledge index, or INDEX_NONE */
+	int32 FindLedge(const FVector& Location, float Radius, FVector& OutMantlePoint) const;
+
+	/** Is Location in front of a baked wall (within MaxDistance of it) */
+	bool IsCovered(const FVector& Location, float MaxDistance) const;
+
+	/** Ledge along the top of a patch, or INDEX_NONE */
+	int32 GetPatchLedge(int32 Patch) const { return PatchLedges.IsValidIndex(Patch) ? PatchLedges[Patch] : INDEX_NONE; }
+
+	/** Tree over Triangles, hits report indices into Triangles */
+	const FClimbTriangleBVH& GetTriangleBVH() const { return TriangleBVH; }
+
+	/** Physical material of a triangle, null for the default */
+	UPhysicalMaterial* GetTriangleMaterial(int32 Triangle) const;
+
+	/** Was the triangle baked from a climb proxy */
+	bool IsProxyTriangle(int32 Triangle) const { return Triangles.IsValidIndex(Triangle) && Triangles[Triangle].bClimbProxy; }
+
+	/** Corner on the Right (Side > 0) or left edge of a patch, or INDEX_NONE */
+	int32 GetPatchCorner(int32 Patch, float Side) const
+	{
+		const int32 Index = Patch * 2 + (Side > 0.0f ? 1 : 0);
+		return PatchCorners.IsValidIndex(Index) ? PatchCorners[Index] : INDEX_NONE;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	// Baking
+
+	/** Drops every patch, ledge, corner and triangle that came from BakedActors[Source] */
+	void RemoveSource(int32 Source);
+
+	/** Adds the walls and ledges of one collision box, in world space */
+	void AddBox(int32 Source, const FTransform& BoxTransform, const FVector& HalfExtent, float StandHalfHeight, float StandRadius);
+
+	/** Adds collision triangles in world space, three vertices each */
+	void AddTriangles(int32 Source, TArrayView<const FVector> Vertices, UPhysicalMaterial* Material, EClimbTriangleChannel Channels, bool bClimbProxy = false);
+
+	/** Rebuilds every corner link, patches from different actors can share corners */
+	void BuildCorners(float Tolerance);
+
+	/** Rebuilds the spatial hash, patch links and triangle BVH, call after changing patches, ledges or triangles */
+	void BuildSpatialHash();
+
+private:
+	FIntVector GetCell(const FVector& Location) const;
+
+	/** Rebuilds PatchLedges and PatchCorners */
+	void BuildAdjacency();
+
+	/** Cells touched by a patch or ledge, patch indices are positive and ledge indices are stored as -1 - Index */
+	TMultiMap<FIntVector, int32> SpatialHash;
+
+	/** Ledge index per patch */
+	TArray<int32> PatchLedges;
+
+	/** Corner index per patch edge, two per patch (left, right) */
+	TArray<int32> PatchCorners;
+
+	FClimbTriangleBVH TriangleBVH;
+};
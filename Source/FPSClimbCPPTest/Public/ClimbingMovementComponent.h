@@ -0,0 +1,582 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "ClimbProbeBatch.h"
+#include "ClimbPhysicalMaterial.h"
+#include "ClimbDecisions.h"
+#include "ClimbSpatialHashSubsystem.h"
+#include "ClimbingMovementComponent.generated.h"
+
+class UClimbSurfaceGraph;
+class UCurveFloat;
+class UCurveVector;
+
+UENUM(BlueprintType)
+enum ECustomMovementMode
+{
+	CMOVE_None			UMETA(Hidden),
+	CMOVE_Climbing		UMETA(DisplayName = "Climbing"),
+	CMOVE_MAX			UMETA(Hidden),
+};
+
+//Where a character is in the climb, transitions only happen on events (grab, attach done, ledge, release, landing)
+UENUM(BlueprintType)
+enum class EClimbState : uint8
+{
+	/** Not on a wall, climbing costs nothing */
+	Grounded,
+	/** Being pulled onto a wall */
+	Attaching,
+	/** Holding on and moving along the wall */
+	Latched,
+	/** Going over a ledge */
+	Mantling,
+	/** Let go of the wall, falling until landing */
+	Releasing,
+};
+
+//How much of the climb a character runs, set by UClimbSignificanceSubsystem from its distance to the players
+UENUM(BlueprintType)
+enum class EClimbLOD : uint8
+{
+	/** Every step probes */
+	Full,
+	/** Some steps probe, the rest slide along the last wall found */
+	Reduced,
+	/** Few steps probe, and the character ticks less often */
+	Minimal,
+
+	Count UMETA(Hidden)
+};
+
+//Fired when the character latches onto (true) or lets go of (false) a wall
+DECLARE_MULTICAST_DELEGATE_OneParam(FClimbLatchSignature, bool);
+
+//Fired after every climb state change, with the old and the new state
+DECLARE_MULTICAST_DELEGATE_TwoParams(FClimbStateSignature, EClimbState, EClimbState);
+
+/**
+ * What simulated proxies need to show a climber: the state, the wall it faces and where it looks.
+ * The wall normal is octahedral in 8+8 bits and the look is yaw/pitch in a byte each, so a climber
+ * on a wall costs 35 bits per update and one off it 3.
+ */
+USTRUCT()
+struct FClimbNetState
+{
+	GENERATED_BODY()
+
+	/** EClimbState */
+	uint8 State;
+
+	/** Wall normal, see PackNormal. Only sent while on a wall */
+	uint16 PackedNormal;
+
+	/** Look relative to the wall, see PackLook. Only sent while on a wall */
+	uint16 PackedLook;
+
+	FClimbNetState()
+		: State(0), PackedNormal(0), PackedLook(0)
+	{
+	}
+
+	/** Attaching, latched or mantling, the only states with a wall and a look worth sending */
+	bool IsOnWall() const;
+
+	/** Bits NetSerialize writes for this state */
+	int32 GetNetBits() const;
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+
+	bool operator==(const FClimbNetState& Other) const
+	{
+		return State == Other.State && PackedNormal == Other.PackedNormal && PackedLook == Other.PackedLook;
+	}
+
+	static uint16 PackNormal(const FVector& Normal);
+	static FVector UnpackNormal(uint16 Packed);
+
+	static uint16 PackLook(const FRotator& Look);
+	static FRotator UnpackLook(uint16 Packed);
+};
+
+template<>
+struct TStructOpsTypeTraits<FClimbNetState> : public TStructOpsTypeTraitsBase2<FClimbNetState>
+{
+	enum
+	{
+		WithNetSerializer = true,
+		WithIdenticalViaEquality = true,
+	};
+};
+
+/** Climb intent rides in FLAG_Custom_0, climb input in the move's acceleration */
+class FSavedMove_Climbing : public FSavedMove_Character
+{
+public:
+	typedef FSavedMove_Character Super;
+
+	virtual void Clear() override;
+	virtual uint8 GetCompressedFlags() const override;
+	virtual bool CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* InCharacter, float MaxDelta) const override;
+	virtual void CombineWith(const FSavedMove_Character* OldMove, ACharacter* InCharacter, APlayerController* PC, const FVector& OldStartLocation) override;
+	virtual void SetMoveFor(ACharacter* C, float InDeltaTime, FVector const& NewAccel, class FNetworkPredictionData_Client_Character& ClientData) override;
+	virtual void PrepMoveFor(ACharacter* C) override;
+
+	uint8 bSavedWantsToClimb : 1;
+	uint8 bSavedLatched : 1;
+	uint16 SavedClimbLook;
+
+	/** Step time carried into the move, see FClimbNetworkMoveData::PackStepCarry. The server and replays split the move into the same climbing steps from it */
+	uint8 SavedClimbStepCarry;
+};
+
+class FNetworkPredictionData_Client_Climbing : public FNetworkPredictionData_Client_Character
+{
+public:
+	typedef FNetworkPredictionData_Client_Character Super;
+
+	FNetworkPredictionData_Client_Climbing(const UCharacterMovementComponent& ClientMovement);
+
+	virtual FSavedMovePtr AllocateNewMove() override;
+};
+
+/** Adds the packed look and step carry to moves made on a wall, nothing to the rest */
+struct FClimbNetworkMoveData : public FCharacterNetworkMoveData
+{
+	typedef FCharacterNetworkMoveData Super;
+
+	uint16 ClimbLook;
+	uint8 ClimbStepCarry;
+
+	FClimbNetworkMoveData()
+		: ClimbLook(0), ClimbStepCarry(0)
+	{
+	}
+
+	/** Time carried over to the next climbing step as a fraction of StepTime in a byte */
+	static uint8 PackStepCarry(float Carry, float StepTime);
+	static float UnpackStepCarry(uint8 Packed, float StepTime);
+
+	virtual void ClientFillNetworkMoveData(const FSavedMove_Character& ClientMove, ENetworkMoveType MoveType) override;
+	virtual bool Serialize(UCharacterMovementComponent& CharacterMovement, FArchive& Ar, UPackageMap* PackageMap, ENetworkMoveType MoveType) override;
+};
+
+struct FClimbNetworkMoveDataContainer : public FCharacterNetworkMoveDataContainer
+{
+	FClimbNetworkMoveDataContainer()
+	{
+		NewMoveData = &ClimbMoveData[0];
+		PendingMoveData = &ClimbMoveData[1];
+		OldMoveData = &ClimbMoveData[2];
+	}
+
+	FClimbNetworkMoveData ClimbMoveData[3];
+};
+
+/**
+ * Character movement with a dedicated climbing mode (MOVE_Custom / CMOVE_Climbing).
+ * Climbing runs in fixed steps of 1 / ClimbSimulationRate seconds so the path up a wall
+ * does not depend on frame rate or on how often the input axes fire.
+ */
+UCLASS()
+class FPSCLIMBCPPTEST_API UClimbingMovementComponent : public UCharacterMovementComponent
+{
+	GENERATED_BODY()
+
+public:
+	UClimbingMovementComponent();
+
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+	virtual float GetMaxSpeed() const override;
+	virtual void OnMovementModeChanged(EMovementMode PreviousMovementMode, uint8 PreviousCustomMode) override;
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	////////////////////////////////////////////////////////////////////////////////
+	// Networking
+
+	virtual FNetworkPredictionData_Client* GetPredictionData_Client() const override;
+	virtual void UpdateFromCompressedFlags(uint8 Flags) override;
+	virtual void UpdateCharacterStateBeforeMovement(float DeltaSeconds) override;
+	virtual void MoveAutonomous(float ClientTimeStamp, float DeltaTime, uint8 CompressedFlags, const FVector& NewAccel) override;
+	virtual FVector ConstrainInputAcceleration(const FVector& InputVector) const override;
+	virtual bool ServerCheckClientError(float ClientTimeStamp, float DeltaTime, const FVector& Accel, const FVector& ClientLoc, const FVector& RelativeClientLoc,
+		UPrimitiveComponent* ClientMovementBase, FName ClientBaseBoneName, uint8 ClientMovementMode) override;
+
+	////////////////////////////////////////////////////////////////////////////////
+	// Climbing Settings
+
+	/** Climbing steps per second. Lower it on low-end clients, every step costs one set of probes */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement: Climbing", meta = (ClampMin = "10", UIMin = "10"))
+		float ClimbSimulationRate;
+
+	/** Most steps a single frame may run, time beyond that is dropped */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement: Climbing", meta = (ClampMin = "1", UIMin = "1"))
+		int32 MaxClimbSubsteps;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement: Climbing", meta = (ClampMin = "0", UIMin = "0"))
+		float MaxClimbSpeed;
+
+	/** Distance kept between the capsule centre and the wall */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement: Climbing", meta = (ClampMin = "0", UIMin = "0"))
+		float WallOffset;
+
+	/** Pitch (either way) at which the character falls off the wall */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement: Climbing", meta = (ClampMin = "0", UIMin = "0", ClampMax = "90", UIMax = "90"))
+		float ReleaseTilt;
+
+	/** Seconds the pull onto the wall takes, the character latches when it ends */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement: Climbing", meta = (ClampMin = "0.01", UIMin = "0.01"))
+		float AttachDuration;
+
+	/** Easing of the attach, maps 0-1 time to 0-1 progress. Linear if not set */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement: Climbing")
+		UCurveFloat* AttachCurve;
+
+	/** Seconds the move over a ledge takes */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement: Climbing", meta = (ClampMin = "0.01", UIMin = "0.01"))
+		float MantleDuration;
+
+	/** Easing of the mantle, maps 0-1 time to 0-1 progress. Linear if not set */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement: Climbing")
+		UCurveFloat* MantleCurve;
+
+	/** Offset from the straight line over the ledge against 0-1 progress, for an arc over the lip */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement: Climbing")
+		UCurveVector* MantlePathCurve;
+
+	/** Seconds a wrap round a corner takes, run in climbing steps so it is the same at any frame rate */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement: Climbing", meta = (ClampMin = "0.01", UIMin = "0.01"))
+		float CornerDuration;
+
+	/** Easing of the corner wrap, maps 0-1 time to 0-1 progress. Linear if not set */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement: Climbing")
+		UCurveFloat* CornerCurve;
+
+	/** Closest another climber on the same wall gets, centre to centre. Steps towards one nearer than this stop short */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement: Climbing", meta = (ClampMin = "0", UIMin = "0"))
+		float ClimberSpacing;
+
+	/** Yaw off the wall (either way) past which letting go with jump pushes off instead of dropping */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement: Climbing", meta = (ClampMin = "0", UIMin = "0", ClampMax = "180", UIMax = "180"))
+		float JumpOffAngle;
+
+	/** Horizontal speed of a push off the wall, along the look */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement: Climbing", meta = (ClampMin = "0", UIMin = "0"))
+		float JumpOffSpeed;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement: Climbing", meta = (ClampMin = "0", UIMin = "0"))
+		float JumpOffZVelocity;
+
+	////////////////////////////////////////////////////////////////////////////////
+	// Climbing LOD
+
+	/** Climbing steps per probed step at reduced detail, the steps between slide along the last wall found */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement: Climbing LOD", meta = (ClampMin = "1", UIMin = "1"))
+		int32 ReducedProbeInterval;
+
+	/** Climbing steps per probed step at minimal detail */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement: Climbing LOD", meta = (ClampMin = "1", UIMin = "1"))
+		int32 MinimalProbeInterval;
+
+	/** Seconds between character and movement ticks at reduced detail, 0 keeps the full rate */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement: Climbing LOD", meta = (ClampMin = "0", UIMin = "0"))
+		float ReducedTickInterval;
+
+	/** Seconds between character and movement ticks at minimal detail */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement: Climbing LOD", meta = (ClampMin = "0", UIMin = "0"))
+		float MinimalTickInterval;
+
+	////////////////////////////////////////////////////////////////////////////////
+	// Climbing
+
+	bool IsClimbing() const;
+	bool IsLatched() const { return ClimbState == EClimbState::Latched; }
+
+	/** Latched and wrapping round a corner */
+	bool IsCornering() const { return CornerTime >= 0.0f; }
+
+	EClimbState GetClimbState() const { return ClimbState; }
+
+	/** An async grab is waiting on its probes */
+	bool IsGrabPending() const { return bGrabPending; }
+
+	/** Looks for a wall in front of the character and attaches to it */
+	void TryGrabWall();
+
+	/** Lets go of the wall and falls, also cancels an attach or mantle in progress */
+	void ReleaseWall();
+
+	/** Grab (true) or let go of (false) the wall on the next move. Predicted here and sent to the server with the move */
+	void SetWantsToClimb(bool bWants) { bWantsToClimb = bWants; }
+	bool WantsToClimb() const { return bWantsToClimb; }
+
+	/** Camera rotation relative to the wall, quantized the way it goes over the network */
+	void SetClimbLook(const FRotator& Look) { PackedClimbLook = FClimbNetState::PackLook(Look); }
+	FRotator GetClimbLook() const { return FClimbNetState::UnpackLook(PackedClimbLook); }
+
+	/** Frame time not yet simulated by a climbing step. Sent with every move made on a wall and put back when it is replayed */
+	float GetClimbTimeAccumulator() const { return ClimbTimeAccumulator; }
+	void SetClimbTimeAccumulator(float Time) { ClimbTimeAccumulator = Time; }
+
+	/** The accumulator the way moves carry it, see FClimbNetworkMoveData::PackStepCarry */
+	uint8 GetPackedClimbTimeAccumulator() const { return FClimbNetworkMoveData::PackStepCarry(ClimbTimeAccumulator, GetClimbStepTime()); }
+	void SetPackedClimbTimeAccumulator(uint8 Packed) { ClimbTimeAccumulator = FClimbNetworkMoveData::UnpackStepCarry(Packed, GetClimbStepTime()); }
+
+	/** Normal of the wall being climbed, zero off a wall */
+	const FVector& GetWallNormal() const { return WallNormal; }
+
+	/** Drawn between climbing steps along with the mesh, see climb.SmoothSteps. Usually the first person camera */
+	void SetClimbSmoothedComponent(USceneComponent* Component);
+
+	/** Where the mesh and the smoothed component are drawn from the capsule, world space. Zero off a wall */
+	const FVector& GetClimbVisualOffset() const { return ClimbVisualOffset; }
+
+	/** Axis values for this frame, consumed by the climbing steps */
+	void SetClimbForwardInput(float Val) { ClimbInput.X = Val; }
+	void SetClimbRightInput(float Val) { ClimbInput.Y = Val; }
+
+	FClimbProbeBatch& GetClimbProbes() { return ClimbProbes; }
+
+	/** Climbers around this one as of its last climbing frame or grab, see climb.NeighbourRadius */
+	const FClimbNeighbours& GetNeighbours() const { return Neighbours; }
+
+	EClimbLOD GetClimbLOD() const { return ClimbLOD; }
+
+	/** Changes probe and tick rates, back at full detail every step probes again straight away */
+	void SetClimbLOD(EClimbLOD NewLOD);
+
+	/** Is this climber's next step worth evaluating ahead of its tick. Game thread */
+	bool CanPrepareClimbStep() const;
+
+	/** Evaluate phase, game thread: copies everything PrepareClimbStep reads from the character and the walls it holds */
+	void BeginPrepareClimbStep();
+
+	/**
+	 * Evaluate phase: probes and decides the first climbing step of this frame so the tick only has to apply it.
+	 * Safe on a worker thread between BeginPrepareClimbStep and EndPrepareClimbStep as long as nothing else touches
+	 * this climber, see UClimbEvaluateSubsystem.
+	 */
+	void PrepareClimbStep();
+
+	/** Evaluate phase, game thread, once every PrepareClimbStep of the phase is done */
+	void EndPrepareClimbStep();
+
+	/** Net state updates and bits since the last reset, see climb.NetReport */
+	uint32 GetNetStateUpdates() const { return NetStateUpdates; }
+	uint32 GetNetStateBits() const { return NetStateBits; }
+	uint32 GetNetMoveBits() const { return NetMoveBits; }
+	uint32 GetNetCorrections() const { return NetCorrections; }
+	uint32 GetNetTransitionCorrections() const { return NetTransitionCorrections; }
+	float GetNetReportSeconds() const;
+	void ResetNetReport();
+
+	/** Server corrections of every climber since startup, and those within climb.NetTransitionWindow of a climb state change */
+	static uint64 GetNumNetCorrections() { return NumNetCorrections.Load(); }
+	static uint64 GetNumNetTransitionCorrections() { return NumNetTransitionCorrections.Load(); }
+
+	FClimbLatchSignature OnLatchChanged;
+	FClimbStateSignature OnClimbStateChanged;
+
+protected:
+	virtual void PhysCustom(float deltaTime, int32 Iterations) override;
+
+	void PhysClimbing(float deltaTime, int32 Iterations);
+
+	/** One fixed climbing step. Returns false if the character left the wall */
+	bool ClimbStep(float StepTime);
+
+	/** Probes and decisions of a step through FClimbDecisions, moves nothing and changes no state */
+	void EvaluateClimbStep(const FClimbSnapshot& Snapshot, const FClimbStepSettings& Settings, const FVector2D& Input, float StepTime, FClimbStepPlan& OutPlan);
+
+	/** Commits a step: wall, mantle, move, rotation and the tilt release. Returns false if the character left the wall */
+	bool ApplyClimbStep(const FClimbSnapshot& Snapshot, const FClimbStepPlan& Plan, float StepTime);
+
+	/** Hands over the plan PrepareClimbStep made, if it was made for this frame (or a remote player's move next frame), pose and input */
+	bool ConsumePreparedStep(const FClimbSnapshot& Snapshot, float StepTime, FClimbStepPlan& OutPlan);
+
+	/** Seconds per climbing step, see climb.SimulationRate */
+	float GetClimbStepTime() const;
+
+	/** Climbing steps per probed step at the current LOD */
+	int32 GetProbeInterval() const;
+
+	/** Starts the wrap round a corner a step planned */
+	void StartCorner(const FClimbStepPlan& Plan);
+
+	/** One climbing step of the corner wrap, swings round the pivot without probing */
+	void CornerStep(float StepTime);
+
+	/** Moves along the wall the last probes found without probing again. Used between probed steps below full detail */
+	void ExtrapolateStep(float StepTime);
+
+	/** Places the mesh and the smoothed component between the last two steps by how far the next one is along */
+	void UpdateClimbVisualOffset(float StepTime);
+	void SetClimbVisualOffset(const FVector& Offset);
+
+	/** Moves this climber in the spatial hash if it is in it, finds the climbers around it and has the probes ignore them */
+	void UpdateNeighbours();
+	void RemoveFromSpatialHash();
+
+	/** Delta without the part of it that closes in on a neighbour on the same wall nearer than ClimberSpacing */
+	FVector AvoidNeighbours(const FVector& Delta) const;
+
+	/** Transform and probe origins at the start of a step, read once and shared by every probe of the step */
+	FClimbSnapshot TakeClimbSnapshot() const;
+
+	/** Settings FClimbDecisions decides this climber's steps with */
+	FClimbStepSettings GetClimbStepSettings() const;
+
+	/** Attaches to the wall if the grab probes found it at body and head height */
+	void ResolveGrab();
+
+	/** Starts the attach move onto a wall point */
+	void AttachToWall(const FVector& WallPoint, const FVector& InWallNormal, const FClimbSurface& Surface);
+
+	/** Lets go of the wall and moves up onto the ledge */
+	void StartMantle(const FVector& Target);
+
+	/** Exits the current state and enters the new one, does nothing if already there */
+	void SetClimbState(EClimbState NewState);
+	void OnExitState(EClimbState OldState, EClimbState NewState);
+	void OnEnterState(EClimbState NewState, EClimbState OldState);
+
+	/** Clears everything the wall left behind, and falls unless something else takes over the movement */
+	void LeaveWall(bool bFall);
+
+	/** Starts a root motion move to Target, returns its id */
+	uint16 ApplyClimbMove(FName InstanceName, const FVector& Target, float Duration, UCurveFloat* TimeCurve, UCurveVector* PathCurve);
+
+	/** Moves along the attach or mantle root motion and changes state once it is done */
+	void PhysClimbMove(float deltaTime);
+
+	/** Probes only matter on a wall or while a grab waits on them */
+	bool NeedsClimbProbes() const;
+
+	/** Lets go on the player's request, pushing off if they jumped while looking away from the wall */
+	void JumpOffWall();
+
+	/** Server only, copies the climb into ClimbNetState when a proxy would see the difference */
+	void UpdateClimbNetState();
+
+	UFUNCTION()
+		void OnRep_ClimbNetState();
+
+	/** Baked graph of this level, null if there is none or climb.UseSurfaceGraph is off */
+	const UClimbSurfaceGraph* GetSurfaceGraph() const;
+
+	/** Location the head probes start from */
+	FVector GetHeadLocation() const;
+
+	/** Max climb speed on the current wall */
+	float GetClimbSpeed() const;
+
+	/** Every climb probe of this frame, see climb.AsyncProbes */
+	FClimbProbeBatch ClimbProbes;
+
+	UPROPERTY(Transient)
+		UClimbSurfaceGraph* SurfaceGraph;
+
+	/** Climb settings of the wall under the body probe */
+	FClimbSurface WallSurface;
+
+	/** X is MoveForward, Y is MoveRight */
+	FVector2D ClimbInput;
+
+	/** Frame time not yet simulated by a climbing step */
+	float ClimbTimeAccumulator;
+
+	/** Capsule location before the last climbing step, what the visuals are drawn from */
+	FVector PreviousStepLocation;
+	FVector ClimbVisualOffset;
+
+	UPROPERTY(Transient)
+		USceneComponent* SmoothedComponent;
+	FVector SmoothedComponentLocation;
+
+	EClimbState ClimbState;
+
+	/** Where the attach move ends and which way it faces */
+	FVector AttachLocation;
+	FRotator AttachRotation;
+
+	/** Root motion sources of the attach and mantle moves, 0 when not running */
+	uint16 AttachRootMotionID;
+	uint16 MantleRootMotionID;
+
+	/** Where the mantle move ends */
+	FVector MantleTarget;
+
+	/** Corner wrap in progress, see StartCorner. CornerTime is below 0 when there is none */
+	FVector CornerStart;
+	FVector CornerPivot;
+	FVector CornerTarget;
+	FRotator CornerStartRotation;
+	FRotator CornerRotation;
+	float CornerTime;
+
+	/** Set while an async grab is waiting on its probes */
+	bool bGrabPending;
+
+	/** Player wants to be on a wall. Sent with every move, the server grabs and lets go on it */
+	bool bWantsToClimb;
+
+	/** See SetClimbLook */
+	uint16 PackedClimbLook;
+
+	/** Normal of the wall under the body probe */
+	FVector WallNormal;
+
+	/** Climb as simulated proxies see it */
+	UPROPERTY(ReplicatedUsing = OnRep_ClimbNetState)
+		FClimbNetState ClimbNetState;
+
+	/** Move data with room for the climb look */
+	FClimbNetworkMoveDataContainer ClimbMoveDataContainer;
+
+	EClimbLOD ClimbLOD;
+
+	/** Steps since the last probed one */
+	int32 StepsSinceProbe;
+
+	/** Index in the world's UClimbSpatialHashSubsystem while latched, INDEX_NONE otherwise */
+	int32 SpatialHashIndex;
+	FClimbNeighbours Neighbours;
+
+	/** Tick intervals the character came with, what full detail goes back to */
+	float FullActorTickInterval;
+	float FullComponentTickInterval;
+
+	/** Step worked out by the evaluate phase, PreparedFrame is 0 once it has been used or thrown away */
+	FClimbStepPlan PreparedPlan;
+	FVector PreparedLocation;
+	FRotator PreparedRotation;
+	FVector2D PreparedInput;
+	float PreparedStepTime;
+	uint64 PreparedFrame;
+
+	/** What the step is prepared from, taken by BeginPrepareClimbStep */
+	FClimbSnapshot PrepareSnapshot;
+	FClimbStepSettings PrepareSettings;
+
+	/** Prepared for the move the owner sends next frame, a remote player's on the server */
+	bool bPreparedAhead;
+
+	/** Bandwidth counters, see climb.NetReport */
+	uint32 NetStateUpdates;
+	uint32 NetStateBits;
+	uint32 NetMoveBits;
+	uint32 NetCorrections;
+	uint32 NetTransitionCorrections;
+	float NetReportStartTime;
+
+	/** World time of the last climb state change, corrections soon after it are put down to the transition */
+	float LastClimbStateTime;
+
+	static TAtomic<uint64> NumNetCorrections;
+	static TAtomic<uint64> NumNetTransitionCorrections;
+};
@@ -9,6 +9,8 @@
 //Foward Declaration
 class UCameraComponent;
 class UArrowComponent;
+class UClimbingMovementComponent;
+enum class EClimbState : uint8;
 
 UCLASS()
 class FPSCLIMBCPPTEST_API AEngiPC : public ACharacter
@@ -17,7 +19,7 @@ class FPSCLIMBCPPTEST_API AEngiPC : public ACharacter
 
 public:
 	// Sets default values for this character's properties
-	AEngiPC();
+	AEngiPC(const FObjectInitializer& ObjectInitializer);
 
 	/** First person camera */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Camera, meta = (AllowPrivateAccess = "true"))
@@ -67,8 +69,24 @@ public:
 	void GrabWall();
 	void ReleaseWall();
 
-	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-		bool Latched;
+	UFUNCTION(BlueprintPure)
+		bool IsLatched() const;
+
+protected:
+	/** Swaps the camera between the wall and the normal control scheme */
+	void OnClimbLatchChanged(bool bLatched);
+
+	/** Actor tick only runs while the character is on a wall */
+	void OnClimbStateChanged(EClimbState OldState, EClimbState NewState);
+
+	/** Hands the camera's rotation on the wall to the movement, it goes to the server with the moves */
+	void UpdateClimbLook();
+
+	/** Movement component cast once, does the actual climbing */
+	UPROPERTY()
+		UClimbingMovementComponent* ClimbingMovement;
+
+public:
 
 	////////////////////////////////////////////////////////////////////////////////
 	// 
@@ -94,6 +112,12 @@ public:
 	// Called to bind functionality to input
 	virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override;
 
+	/** Head probes start at the camera */
+	virtual FVector GetPawnViewLocation() const override;
+
 	/** Returns FirstPersonCameraComponent subobject **/
 	UCameraComponent* GetFirstPersonCameraComponent() const { return FPCameraComponent; }
+
+	/** Returns ClimbingMovement subobject **/
+	UClimbingMovementComponent* GetClimbingMovement() const { return ClimbingMovement; }
 };
\ No newline at end of file